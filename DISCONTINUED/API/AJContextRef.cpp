@@ -50,6 +50,7 @@ limitations under the License.
 #include "AJClassRef.h"
 #include "AJGlobalObject.h"
 #include "AJObject.h"
+#include <algorithm>
 #include <wtf/text/StringHash.h>
 
 #if OS(DARWIN)
@@ -77,6 +78,131 @@ void AJContextGroupRelease(AJContextGroupRef group)
     toJS(group)->deref();
 }
 
+void AJContextGroupSetIncrementalMarkingBudget(AJContextGroupRef group, double milliseconds)
+{
+    AJGlobalData* globalData = toJS(group);
+    APIEntryShim entryShim(globalData, false);
+
+    globalData->heap.setIncrementalMarkingBudget(milliseconds);
+}
+
+void AJContextGroupSetHeapLimits(AJContextGroupRef group, size_t softLimit, size_t hardLimit)
+{
+    AJGlobalData* globalData = toJS(group);
+    APIEntryShim entryShim(globalData, false);
+
+    if (hardLimit && softLimit > hardLimit)
+        softLimit = hardLimit;
+    globalData->heap.setHeapLimits(softLimit, hardLimit);
+}
+
+void AJContextGroupLowMemoryNotification(AJContextGroupRef group)
+{
+    AJGlobalData* globalData = toJS(group);
+    APIEntryShim entryShim(globalData, false);
+
+    if (!globalData->heap.isBusy())
+        globalData->heap.lowMemoryNotification();
+}
+
+bool AJContextGroupCollectIfIdle(AJContextGroupRef group, double deadlineMs)
+{
+    AJGlobalData* globalData = toJS(group);
+    APIEntryShim entryShim(globalData, false);
+
+    if (globalData->heap.isBusy())
+        return false;
+    return globalData->heap.collectIfIdle(deadlineMs);
+}
+
+static AJGarbageCollectionTrigger toRef(Heap::CollectionTrigger trigger)
+{
+    switch (trigger) {
+    case Heap::AllocationTrigger:
+        return kAJGarbageCollectionTriggerAllocation;
+    case Heap::ExtraCostTrigger:
+        return kAJGarbageCollectionTriggerExtraCost;
+    case Heap::ExplicitTrigger:
+        return kAJGarbageCollectionTriggerExplicit;
+    case Heap::IdleTrigger:
+        return kAJGarbageCollectionTriggerIdle;
+    case Heap::MemoryPressureTrigger:
+        return kAJGarbageCollectionTriggerMemoryPressure;
+    }
+    ASSERT_NOT_REACHED();
+    return kAJGarbageCollectionTriggerAllocation;
+}
+
+size_t AJContextGroupCopyGarbageCollectionRecords(AJContextGroupRef group, AJGarbageCollectionRecord* records, size_t maxCount)
+{
+    AJGlobalData* globalData = toJS(group);
+    APIEntryShim entryShim(globalData, false);
+
+    Heap::CollectionRecord heapRecords[COLLECTION_RECORD_COUNT];
+    size_t count = globalData->heap.copyCollectionRecords(heapRecords, maxCount);
+    for (size_t i = 0; i < count; ++i) {
+        const Heap::CollectionRecord& heapRecord = heapRecords[i];
+        AJGarbageCollectionRecord& record = records[i];
+        record.startTime = heapRecord.startTime;
+        record.markTime = heapRecord.markTime;
+        record.sweepTime = heapRecord.sweepTime;
+        record.liveBytesBefore = heapRecord.liveBytesBefore;
+        record.liveBytesAfter = heapRecord.liveBytesAfter;
+        record.blocksFreed = heapRecord.blocksFreed;
+        record.trigger = toRef(heapRecord.trigger);
+        record.isMajor = heapRecord.isMajor;
+    }
+    return count;
+}
+
+void AJContextGroupGetGarbageCollectionPauseHistogram(AJContextGroupRef group, size_t counts[kAJGarbageCollectionPauseHistogramSize])
+{
+    COMPILE_ASSERT(kAJGarbageCollectionPauseHistogramSize == PAUSE_HISTOGRAM_SIZE, pause_histogram_sizes_match);
+
+    AJGlobalData* globalData = toJS(group);
+    APIEntryShim entryShim(globalData, false);
+
+    const size_t* histogram = globalData->heap.pauseHistogram();
+    std::copy(histogram, histogram + PAUSE_HISTOGRAM_SIZE, counts);
+}
+
+static bool hasMoreBytes(const AJHeapCensusEntry& a, const AJHeapCensusEntry& b)
+{
+    return a.bytes > b.bytes;
+}
+
+size_t AJContextGroupCopyHeapCensus(AJContextGroupRef group, AJHeapCensusEntry* entries, size_t maxCount)
+{
+    AJGlobalData* globalData = toJS(group);
+    APIEntryShim entryShim(globalData, false);
+
+    if (globalData->heap.isBusy())
+        return 0;
+
+    OwnPtr<Heap::TypeStatisticsMap> statistics(globalData->heap.objectTypeStatistics());
+    Vector<AJHeapCensusEntry> census;
+    census.reserveCapacity(statistics->size());
+    Heap::TypeStatisticsMap::iterator end = statistics->end();
+    for (Heap::TypeStatisticsMap::iterator it = statistics->begin(); it != end; ++it) {
+        AJHeapCensusEntry entry = { it->first, it->second.count, it->second.bytes };
+        census.append(entry);
+    }
+
+    std::sort(census.begin(), census.end(), hasMoreBytes);
+    std::copy(census.begin(), census.begin() + std::min(maxCount, census.size()), entries);
+    return census.size();
+}
+
+bool AJContextGroupWriteHeapSnapshot(AJContextGroupRef group, const char* path)
+{
+    AJGlobalData* globalData = toJS(group);
+    APIEntryShim entryShim(globalData, false);
+
+    if (globalData->heap.isBusy())
+        return false;
+    return globalData->heap.writeSnapshot(path);
+}
+
 AJGlobalContextRef AJGlobalContextCreate(AJClassRef globalObjectClass)
 {
     initializeThreading();
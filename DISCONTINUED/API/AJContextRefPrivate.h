@@ -63,6 +63,139 @@ extern "C" {
 */
 JS_EXPORT AJGlobalContextRef AJContextGetGlobalContext(AJContextRef ctx);
 
+/*!
+@function
+@abstract Sets how long a garbage collection may pause the contexts in a AJContextGroup.
+@param group The AJContextGroup whose collections you want to bound.
+@param milliseconds The longest marking step, in milliseconds. Pass 0 to mark the whole heap in a single pause, which is the default.
+@discussion With a non-zero budget, full collections mark the heap in steps that are interleaved with allocation. The final step, which scans the stacks, may take longer than the budget.
+*/
+JS_EXPORT void AJContextGroupSetIncrementalMarkingBudget(AJContextGroupRef group, double milliseconds);
+
+/*!
+@function
+@abstract Limits the memory used by the garbage collected heap of a AJContextGroup.
+@param group The AJContextGroup whose heap you want to limit.
+@param softLimit The heap size, in bytes, past which collections happen more often and free memory is returned to the system. Pass 0 for no limit.
+@param hardLimit The heap size, in bytes, past which running scripts throw an out of memory error. Pass 0 for no limit.
+@discussion The heap size counts object and storage blocks, plus the memory that objects have reported using since the last collection. A single allocation may take the heap past the hard limit; the error is thrown at the next loop iteration or function call, if a collection does not bring the heap back under the limit.
+*/
+JS_EXPORT void AJContextGroupSetHeapLimits(AJContextGroupRef group, size_t softLimit, size_t hardLimit);
+
+/*!
+@function
+@abstract Tells a AJContextGroup that the process is running low on memory.
+@param group The AJContextGroup that should give back memory.
+@discussion Collects garbage in the group and returns as much free memory as possible to the system.
+*/
+JS_EXPORT void AJContextGroupLowMemoryNotification(AJContextGroupRef group);
+
+/*!
+@function
+@abstract Lets a AJContextGroup use idle time for garbage collection.
+@param group The AJContextGroup whose heap you want to collect.
+@param deadlineMs How long, in milliseconds, the collector may run.
+@result true if no collection work is left, false if the deadline was reached first.
+@discussion Marks and sweeps the heap in steps until the deadline. Work done here is not repeated when allocation next needs a collection. The final marking step scans the stacks and may take longer than the deadline allows. Call this again with the next idle period until it returns true.
+*/
+JS_EXPORT bool AJContextGroupCollectIfIdle(AJContextGroupRef group, double deadlineMs);
+
+/*!
+@enum AJGarbageCollectionTrigger
+@abstract Why a garbage collection started.
+@constant kAJGarbageCollectionTriggerAllocation The heap ran out of room for new objects.
+@constant kAJGarbageCollectionTriggerExtraCost Objects reported using a lot of memory outside the heap.
+@constant kAJGarbageCollectionTriggerExplicit AJGarbageCollect, or another explicit request.
+@constant kAJGarbageCollectionTriggerIdle AJContextGroupCollectIfIdle.
+@constant kAJGarbageCollectionTriggerMemoryPressure AJContextGroupLowMemoryNotification, or the heap passing its hard limit.
+*/
+typedef enum {
+    kAJGarbageCollectionTriggerAllocation,
+    kAJGarbageCollectionTriggerExtraCost,
+    kAJGarbageCollectionTriggerExplicit,
+    kAJGarbageCollectionTriggerIdle,
+    kAJGarbageCollectionTriggerMemoryPressure
+} AJGarbageCollectionTrigger;
+
+/*!
+@struct AJGarbageCollectionRecord
+@abstract Describes one garbage collection.
+@field startTime When the collection started, in seconds since the epoch.
+@field markTime Milliseconds spent marking, over every step of an incremental collection.
+@field sweepTime Milliseconds spent sweeping, including the lazy sweeping done up to the next collection.
+@field liveBytesBefore The bytes of objects and their storage before the collection.
+@field liveBytesAfter The bytes of objects and their storage that survived the collection.
+@field blocksFreed The heap blocks the collection returned to the system.
+@field trigger Why the collection started.
+@field isMajor true if the collection traced the whole heap, false if it only traced objects allocated since the previous one.
+*/
+typedef struct {
+    double startTime;
+    double markTime;
+    double sweepTime;
+    size_t liveBytesBefore;
+    size_t liveBytesAfter;
+    size_t blocksFreed;
+    AJGarbageCollectionTrigger trigger;
+    bool isMajor;
+} AJGarbageCollectionRecord;
+
+/*!
+@function
+@abstract Gets the records of the latest garbage collections in a AJContextGroup.
+@param group The AJContextGroup whose collections you want to examine.
+@param records A buffer for up to maxCount records.
+@param maxCount The size of records. The group keeps the records of its latest 64 collections.
+@result The number of records copied, oldest first.
+*/
+JS_EXPORT size_t AJContextGroupCopyGarbageCollectionRecords(AJContextGroupRef group, AJGarbageCollectionRecord* records, size_t maxCount);
+
+/*! @constant kAJGarbageCollectionPauseHistogramSize The number of buckets in a garbage collection pause histogram. */
+#define kAJGarbageCollectionPauseHistogramSize 12
+
+/*!
+@function
+@abstract Gets how long garbage collection has paused the scripts of a AJContextGroup.
+@param group The AJContextGroup whose pauses you want to examine.
+@param counts Filled in with the number of pauses of each duration. Bucket 0 counts pauses under 0.25ms, and each following bucket pauses under twice the limit of the one before. The last bucket counts pauses of 256ms or more.
+@discussion Every pause since the group was created is counted. Collection work done by AJContextGroupCollectIfIdle is not a pause.
+*/
+JS_EXPORT void AJContextGroupGetGarbageCollectionPauseHistogram(AJContextGroupRef group, size_t counts[kAJGarbageCollectionPauseHistogramSize]);
+
+/*!
+@struct AJHeapCensusEntry
+@abstract Describes the live objects of one class.
+@field className The name of the class, or of the kind of value for strings and other cells without a class. Valid for the life of the process.
+@field count The number of live objects.
+@field bytes The bytes taken by the objects and their property or array storage.
+*/
+typedef struct {
+    const char* className;
+    size_t count;
+    size_t bytes;
+} AJHeapCensusEntry;
+
+/*!
+@function
+@abstract Counts the live objects in a AJContextGroup by class.
+@param group The AJContextGroup whose heap you want to examine.
+@param entries A buffer for up to maxCount entries, filled in largest first.
+@param maxCount The size of entries.
+@result The number of classes with live objects, which may be more than maxCount.
+@discussion Objects are live if the last garbage collection found them reachable, or if they were allocated since. Taking a census walks the whole heap.
+*/
+JS_EXPORT size_t AJContextGroupCopyHeapCensus(AJContextGroupRef group, AJHeapCensusEntry* entries, size_t maxCount);
+
+/*!
+@function
+@abstract Writes a snapshot of the heap of a AJContextGroup to a file.
+@param group The AJContextGroup whose heap you want to examine.
+@param path The file to write. An existing file is replaced.
+@result true if the snapshot was written.
+@discussion Collects garbage, then writes every live object with its size, the objects it refers to, and the roots that keep objects alive. The snapshot is streamed to the file as the heap is walked. The analyze-heap-snapshot tool reads it and reports what each object retains.
+*/
+JS_EXPORT bool AJContextGroupWriteHeapSnapshot(AJContextGroupRef group, const char* path);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,111 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "config.h"
+#include "AJHandleRefPrivate.h"
+
+#include "APICast.h"
+#include "APIShims.h"
+#include "HandleHeap.h"
+
+using namespace AJ;
+
+static inline HandleSlot toJS(AJHandleRef handle)
+{
+    return reinterpret_cast<HandleSlot>(handle);
+}
+
+static inline AJHandleRef toRef(HandleSlot slot)
+{
+    return reinterpret_cast<AJHandleRef>(slot);
+}
+
+static inline AJValue toJSForHandle(ExecState* exec, AJValueRef value)
+{
+    return value ? toJSForGC(exec, value) : AJValue();
+}
+
+AJHandleRef AJHandleCreate(AJContextRef ctx, AJValueRef value)
+{
+    ExecState* exec = toJS(ctx);
+    APIEntryShim entryShim(exec);
+
+    HandleSlot slot = exec->heap()->handleHeap().allocate();
+    *slot = toJSForHandle(exec, value);
+    return toRef(slot);
+}
+
+AJHandleRef AJWeakHandleCreate(AJContextRef ctx, AJValueRef value)
+{
+    ExecState* exec = toJS(ctx);
+    APIEntryShim entryShim(exec);
+
+    HandleSlot slot = exec->heap()->weakHandleHeap().allocate();
+    *slot = toJSForHandle(exec, value);
+    return toRef(slot);
+}
+
+void AJHandleRelease(AJContextRef ctx, AJHandleRef handle)
+{
+    ExecState* exec = toJS(ctx);
+    APIEntryShim entryShim(exec);
+
+    HandleHeap::deallocate(toJS(handle));
+}
+
+AJValueRef AJHandleGetValue(AJContextRef ctx, AJHandleRef handle)
+{
+    ExecState* exec = toJS(ctx);
+    APIEntryShim entryShim(exec);
+
+    AJValue value = *toJS(handle);
+    return value ? toRef(exec, value) : 0;
+}
+
+void AJHandleSetValue(AJContextRef ctx, AJHandleRef handle, AJValueRef value)
+{
+    ExecState* exec = toJS(ctx);
+    APIEntryShim entryShim(exec);
+
+    *toJS(handle) = toJSForHandle(exec, value);
+}
+
+AJHandleFrame AJHandleFramePush(AJContextRef ctx)
+{
+    ExecState* exec = toJS(ctx);
+    APIEntryShim entryShim(exec);
+
+    return exec->heap()->handleHeap().pushFrame();
+}
+
+void AJHandleFramePop(AJContextRef ctx, AJHandleFrame frame)
+{
+    ExecState* exec = toJS(ctx);
+    APIEntryShim entryShim(exec);
+
+    exec->heap()->handleHeap().popFrame(frame);
+}
+
+AJHandleRef AJHandleCreateTemporary(AJContextRef ctx, AJValueRef value)
+{
+    ExecState* exec = toJS(ctx);
+    APIEntryShim entryShim(exec);
+
+    HandleSlot slot = exec->heap()->handleHeap().allocateTemporary();
+    *slot = toJSForHandle(exec, value);
+    return toRef(slot);
+}
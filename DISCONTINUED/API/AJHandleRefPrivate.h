@@ -0,0 +1,113 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef AJHandleRefPrivate_h
+#define AJHandleRefPrivate_h
+
+#include <AJCore/AJContextRef.h>
+#include <AJCore/AJValueRef.h>
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! @typedef AJHandleRef A slot holding a AJ value, which keeps the value from being garbage collected. */
+typedef struct OpaqueAJHandle* AJHandleRef;
+
+/*! @typedef AJHandleFrame Marks where a frame of temporary handles starts. */
+typedef size_t AJHandleFrame;
+
+/*!
+@function
+@abstract Creates a handle that keeps a AJ value from being garbage collected.
+@param ctx The execution context to use.
+@param value The AJValue to hold, or NULL.
+@result A handle, which must be released with AJHandleRelease.
+@discussion Handles are a faster alternative to AJValueProtect for values that native code holds on to: creating and releasing a handle take constant time, and each handle holds its value once. AJValueProtect and AJValueUnprotect keep working as before.
+*/
+JS_EXPORT AJHandleRef AJHandleCreate(AJContextRef ctx, AJValueRef value);
+
+/*!
+@function
+@abstract Creates a handle that refers to a AJ value without keeping it from being garbage collected.
+@param ctx The execution context to use.
+@param value The AJValue to refer to, or NULL.
+@result A handle, which must be released with AJHandleRelease.
+@discussion Once the value is collected, AJHandleGetValue returns NULL. The collector clears every weak handle whose value it found unreachable in one pass at the end of marking.
+*/
+JS_EXPORT AJHandleRef AJWeakHandleCreate(AJContextRef ctx, AJValueRef value);
+
+/*!
+@function
+@abstract Releases a handle created by AJHandleCreate or AJWeakHandleCreate.
+@param ctx The execution context to use.
+@param handle The handle to release. It must not be used again.
+*/
+JS_EXPORT void AJHandleRelease(AJContextRef ctx, AJHandleRef handle);
+
+/*!
+@function
+@abstract Gets the value held by a handle.
+@param ctx The execution context to use.
+@param handle The handle whose value you want to get.
+@result The value, or NULL if the handle holds none.
+*/
+JS_EXPORT AJValueRef AJHandleGetValue(AJContextRef ctx, AJHandleRef handle);
+
+/*!
+@function
+@abstract Replaces the value held by a handle.
+@param ctx The execution context to use.
+@param handle The handle whose value you want to set.
+@param value The AJValue to hold, or NULL.
+*/
+JS_EXPORT void AJHandleSetValue(AJContextRef ctx, AJHandleRef handle, AJValueRef value);
+
+/*!
+@function
+@abstract Starts a frame of temporary handles.
+@param ctx The execution context to use.
+@result The frame, to pass to AJHandleFramePop.
+@discussion Frames nest. Every temporary handle created after a frame is pushed is released when it is popped.
+*/
+JS_EXPORT AJHandleFrame AJHandleFramePush(AJContextRef ctx);
+
+/*!
+@function
+@abstract Releases every temporary handle created since a frame was pushed.
+@param ctx The execution context to use.
+@param frame The frame to pop. Frames pushed after it must have been popped already.
+*/
+JS_EXPORT void AJHandleFramePop(AJContextRef ctx, AJHandleFrame frame);
+
+/*!
+@function
+@abstract Creates a handle that lasts until the current frame is popped.
+@param ctx The execution context to use.
+@param value The AJValue to hold, or NULL.
+@result A handle, which must not be passed to AJHandleRelease.
+@discussion A frame must have been pushed with AJHandleFramePush.
+*/
+JS_EXPORT AJHandleRef AJHandleCreateTemporary(AJContextRef ctx, AJValueRef value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AJHandleRefPrivate_h */
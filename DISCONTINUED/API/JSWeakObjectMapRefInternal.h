@@ -58,9 +58,9 @@ typedef AJ::WeakGCMap<void*, AJ::AJObject*> WeakMapType;
 
 struct OpaqueJSWeakObjectMap : public RefCounted<OpaqueJSWeakObjectMap> {
 public:
-    static PassRefPtr<OpaqueJSWeakObjectMap> create(void* data, JSWeakMapDestroyedCallback callback)
+    static PassRefPtr<OpaqueJSWeakObjectMap> create(AJ::Heap* heap, void* data, JSWeakMapDestroyedCallback callback)
     {
-        return adoptRef(new OpaqueJSWeakObjectMap(data, callback));
+        return adoptRef(new OpaqueJSWeakObjectMap(heap, data, callback));
     }
 
     WeakMapType& map() { return m_map; }
@@ -71,8 +71,9 @@ public:
     }
 
 private:
-    OpaqueJSWeakObjectMap(void* data, JSWeakMapDestroyedCallback callback)
-        : m_data(data)
+    OpaqueJSWeakObjectMap(AJ::Heap* heap, void* data, JSWeakMapDestroyedCallback callback)
+        : m_map(heap)
+        , m_data(data)
         , m_callback(callback)
     {
     }
@@ -81,5 +82,13 @@ private:
     JSWeakMapDestroyedCallback m_callback;
 };
 
+typedef AJ::EphemeronGCMap<AJ::AJObject*, AJ::AJValue> EphemeronMapType;
+
+struct OpaqueAJEphemeronMap : public EphemeronMapType {
+    OpaqueAJEphemeronMap(AJ::Heap* heap)
+        : EphemeronMapType(heap)
+    {
+    }
+};
 
 #endif // JSWeakObjectMapInternal_h
@@ -63,7 +63,7 @@ JSWeakObjectMapRef JSWeakObjectMapCreate(AJContextRef context, void* privateData
 {
     ExecState* exec = toJS(context);
     APIEntryShim entryShim(exec);
-    RefPtr<OpaqueJSWeakObjectMap> map = OpaqueJSWeakObjectMap::create(privateData, callback);
+    RefPtr<OpaqueJSWeakObjectMap> map = OpaqueJSWeakObjectMap::create(exec->heap(), privateData, callback);
     exec->lexicalGlobalObject()->registerWeakMap(map.get());
     return map.get();
 }
@@ -96,6 +96,45 @@ bool JSWeakObjectMapClear(AJContextRef ctx, JSWeakObjectMapRef map, void* key, A
     return false;
 }
 
+AJEphemeronMapRef AJEphemeronMapCreate(AJContextRef ctx)
+{
+    ExecState* exec = toJS(ctx);
+    APIEntryShim entryShim(exec);
+    return new OpaqueAJEphemeronMap(exec->heap());
+}
+
+void AJEphemeronMapRelease(AJContextRef ctx, AJEphemeronMapRef map)
+{
+    ExecState* exec = toJS(ctx);
+    APIEntryShim entryShim(exec);
+    delete map;
+}
+
+void AJEphemeronMapSet(AJContextRef ctx, AJEphemeronMapRef map, AJObjectRef key, AJValueRef value)
+{
+    ExecState* exec = toJS(ctx);
+    APIEntryShim entryShim(exec);
+    AJObject* obj = toJS(key);
+    if (!obj)
+        return;
+    map->set(obj, toJSForGC(exec, value));
+}
+
+AJValueRef AJEphemeronMapGet(AJContextRef ctx, AJEphemeronMapRef map, AJObjectRef key)
+{
+    ExecState* exec = toJS(ctx);
+    APIEntryShim entryShim(exec);
+    AJValue value = map->get(toJS(key));
+    return value ? toRef(exec, value) : 0;
+}
+
+bool AJEphemeronMapRemove(AJContextRef ctx, AJEphemeronMapRef map, AJObjectRef key)
+{
+    ExecState* exec = toJS(ctx);
+    APIEntryShim entryShim(exec);
+    return map->remove(toJS(key));
+}
+
 #ifdef __cplusplus
 }
 #endif
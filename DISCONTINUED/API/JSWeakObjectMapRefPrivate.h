@@ -69,8 +69,8 @@ typedef void (*JSWeakMapDestroyedCallback)(JSWeakObjectMapRef map, void* data);
  @param destructor A function to call when the weak map is destroyed.
  @result A JSWeakObjectMapRef bound to the given context, data and destructor.
  @discussion The JSWeakObjectMapRef can be used as a storage mechanism to hold custom JS objects without forcing those objects to
- remain live as AJValueProtect would.  Any objects that are intended to be stored in a weak map must be user defined objects that
- remove themselves from the map in their finalizer.
+ remain live as AJValueProtect would.  Any objects that are intended to be stored in a weak map must be user defined objects.
+ The garbage collector removes the entries whose objects it collects.
  */
 JS_EXPORT JSWeakObjectMapRef JSWeakObjectMapCreate(AJContextRef ctx, void* data, JSWeakMapDestroyedCallback destructor);
 
@@ -105,6 +105,57 @@ JS_EXPORT AJObjectRef JSWeakObjectMapGet(AJContextRef ctx, JSWeakObjectMapRef ma
  */
 JS_EXPORT bool JSWeakObjectMapClear(AJContextRef ctx, JSWeakObjectMapRef map, void* key, AJObjectRef object);
 
+/*! @typedef AJEphemeronMapRef A map from objects to values that keeps each value alive only while its key is alive. */
+typedef struct OpaqueAJEphemeronMap* AJEphemeronMapRef;
+
+/*!
+ @function
+ @abstract Creates an ephemeron map.
+ @param ctx The execution context to use.
+ @result An AJEphemeronMapRef, which must be released with AJEphemeronMapRelease before the context group is released.
+ @discussion Keys are held weakly, and a value is only kept alive by the map while its key is alive, even if the value refers
+ back to the key. The garbage collector removes the entries whose keys it collects.
+ */
+JS_EXPORT AJEphemeronMapRef AJEphemeronMapCreate(AJContextRef ctx);
+
+/*!
+ @function
+ @abstract Releases an ephemeron map.
+ @param ctx The execution context to use.
+ @param map The map to release.
+ */
+JS_EXPORT void AJEphemeronMapRelease(AJContextRef ctx, AJEphemeronMapRef map);
+
+/*!
+ @function
+ @abstract Associates a value with a key in an ephemeron map.
+ @param ctx The execution context to use.
+ @param map The map to operate on.
+ @param key The object to associate the value with.
+ @param value The value to associate with the key.
+ */
+JS_EXPORT void AJEphemeronMapSet(AJContextRef ctx, AJEphemeronMapRef map, AJObjectRef key, AJValueRef value);
+
+/*!
+ @function
+ @abstract Retrieves the value associated with a key in an ephemeron map.
+ @param ctx The execution context to use.
+ @param map The map to query.
+ @param key The object to search for.
+ @result The value associated with the key, or NULL if there is none.
+ */
+JS_EXPORT AJValueRef AJEphemeronMapGet(AJContextRef ctx, AJEphemeronMapRef map, AJObjectRef key);
+
+/*!
+ @function
+ @abstract Removes the value associated with a key in an ephemeron map.
+ @param ctx The execution context to use.
+ @param map The map to operate on.
+ @param key The object whose association to remove.
+ @result Returns true if the key was present in map, and has been removed.
+ */
+JS_EXPORT bool AJEphemeronMapRemove(AJContextRef ctx, AJEphemeronMapRef map, AJObjectRef key);
+
 #ifdef __cplusplus
 }
 #endif
@@ -51,9 +51,12 @@ using namespace AJ;
 
 PassRefPtr<OpaqueAJString> OpaqueAJString::create(const UString& ustring)
 {
-    if (!ustring.isNull())
-        return adoptRef(new OpaqueAJString(ustring.data(), ustring.size()));
-    return 0;
+    if (ustring.isNull())
+        return 0;
+    // Widened here, so that the string does not keep a 16-bit copy of itself.
+    if (ustring.is8Bit())
+        return adoptRef(new OpaqueAJString(ustring.rep()->characters8(), ustring.size()));
+    return adoptRef(new OpaqueAJString(ustring.data(), ustring.size()));
 }
 
 UString OpaqueAJString::ustring() const
@@ -86,6 +86,13 @@ private:
         memcpy(m_characters, characters, length * sizeof(UChar));
     }
 
+    OpaqueAJString(const LChar* characters, unsigned length)
+        : m_length(length)
+    {
+        m_characters = new UChar[length];
+        AJ::UStringImpl::copyChars(m_characters, characters, length);
+    }
+
     ~OpaqueAJString()
     {
         delete[] m_characters;
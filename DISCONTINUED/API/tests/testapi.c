@@ -43,9 +43,12 @@ limitations under the License.
 #include "AJCore.h"
 #include "AJBasePrivate.h"
 #include "AJContextRefPrivate.h"
+#include "AJHandleRefPrivate.h"
 #include "AJObjectRefPrivate.h"
+#include "JSWeakObjectMapRefPrivate.h"
 #include <math.h>
 #define ASSERT_DISABLED 0
+#include <wtf/AlwaysInline.h>
 #include <wtf/Assertions.h>
 #include <wtf/UnusedParam.h>
 
@@ -781,6 +784,33 @@ static void makeGlobalNumberValue(AJContextRef context) {
     v = NULL;
 }
 
+// The objects these make are only reachable through weak references once they
+// return. They are not inlined, so that no pointer to the objects is left in
+// main's frame.
+static NEVER_INLINE AJHandleRef makeWeakHandleToGarbage(AJContextRef context)
+{
+    return AJWeakHandleCreate(context, AJObjectMake(context, NULL, NULL));
+}
+
+static NEVER_INLINE void makeEphemeronToGarbage(AJContextRef context, AJEphemeronMapRef map, AJHandleRef* key, AJHandleRef* value)
+{
+    AJObjectRef keyObject = AJObjectMake(context, NULL, NULL);
+    AJObjectRef valueObject = AJObjectMake(context, NULL, NULL);
+    AJEphemeronMapSet(context, map, keyObject, valueObject);
+    *key = AJWeakHandleCreate(context, keyObject);
+    *value = AJWeakHandleCreate(context, valueObject);
+}
+
+// Overwrites the stack the helpers above used, since the collector scans it
+// conservatively.
+static NEVER_INLINE void clearStack(void)
+{
+    volatile char buffer[8192];
+    size_t i;
+    for (i = 0; i < sizeof(buffer); ++i)
+        buffer[i] = 0;
+}
+
 int main(int argc, char* argv[])
 {
     const char *scriptPath = "testapi.js";
@@ -1098,6 +1128,41 @@ int main(int argc, char* argv[])
     AJValueUnprotect(context, jsGlobalValue);
     AJValueUnprotect(context, jsNumberValue);
 
+    AJHandleRef handle = AJHandleCreate(context, AJObjectMake(context, NULL, NULL));
+    AJHandleFrame handleFrame = AJHandleFramePush(context);
+    AJHandleRef temporaryHandle = AJHandleCreateTemporary(context, AJObjectMake(context, NULL, NULL));
+    AJGarbageCollect(context);
+    ASSERT(AJValueIsObject(context, AJHandleGetValue(context, handle)));
+    ASSERT(AJValueIsObject(context, AJHandleGetValue(context, temporaryHandle)));
+    AJHandleFramePop(context, handleFrame);
+    AJHandleSetValue(context, handle, NULL);
+    ASSERT(!AJHandleGetValue(context, handle));
+    AJHandleRelease(context, handle);
+
+    AJEphemeronMapRef ephemeronMap = AJEphemeronMapCreate(context);
+    AJHandleRef ephemeronKey = AJHandleCreate(context, AJObjectMake(context, NULL, NULL));
+    AJHandleRef ephemeronValue = AJWeakHandleCreate(context, AJObjectMake(context, NULL, NULL));
+    AJEphemeronMapSet(context, ephemeronMap, (AJObjectRef)AJHandleGetValue(context, ephemeronKey), AJHandleGetValue(context, ephemeronValue));
+    AJGarbageCollect(context);
+    ASSERT(AJValueIsObject(context, AJHandleGetValue(context, ephemeronValue)));
+    ASSERT(AJEphemeronMapGet(context, ephemeronMap, (AJObjectRef)AJHandleGetValue(context, ephemeronKey)) == AJHandleGetValue(context, ephemeronValue));
+    ASSERT(AJEphemeronMapRemove(context, ephemeronMap, (AJObjectRef)AJHandleGetValue(context, ephemeronKey)));
+    ASSERT(!AJEphemeronMapGet(context, ephemeronMap, (AJObjectRef)AJHandleGetValue(context, ephemeronKey)));
+    AJHandleRelease(context, ephemeronValue);
+    AJHandleRelease(context, ephemeronKey);
+
+    AJHandleRef deadHandle = makeWeakHandleToGarbage(context);
+    makeEphemeronToGarbage(context, ephemeronMap, &ephemeronKey, &ephemeronValue);
+    clearStack();
+    AJGarbageCollect(context);
+    ASSERT(!AJHandleGetValue(context, deadHandle));
+    ASSERT(!AJHandleGetValue(context, ephemeronKey));
+    ASSERT(!AJHandleGetValue(context, ephemeronValue));
+    AJHandleRelease(context, deadHandle);
+    AJHandleRelease(context, ephemeronValue);
+    AJHandleRelease(context, ephemeronKey);
+    AJEphemeronMapRelease(context, ephemeronMap);
+
     AJStringRef goodSyntax = AJStringCreateWithUTF8CString("x = 1;");
     AJStringRef badSyntax = AJStringCreateWithUTF8CString("x := 1;");
     ASSERT(AJCheckScriptSyntax(context, goodSyntax, NULL, 0, NULL));
@@ -84,27 +84,29 @@ void Debugger::recompileAllAJFunctions(AJGlobalData* globalData)
     FunctionExecutableSet functionExecutables;
     SourceProviderMap sourceProviders;
 
-    LiveObjectIterator it = globalData->heap.primaryHeapBegin();
-    LiveObjectIterator heapEnd = globalData->heap.primaryHeapEnd();
-    for ( ; it != heapEnd; ++it) {
-        if (!(*it)->inherits(&AJFunction::info))
-            continue;
-
-        AJFunction* function = asFunction(*it);
-        if (function->executable()->isHostFunction())
-            continue;
-
-        FunctionExecutable* executable = function->jsExecutable();
-
-        // Check if the function is already in the set - if so,
-        // we've already retranslated it, nothing to do here.
-        if (!functionExecutables.add(executable).second)
-            continue;
-
-        ExecState* exec = function->scope().globalObject()->AJGlobalObject::globalExec();
-        executable->recompile();
-        if (function->scope().globalObject()->debugger() == this)
-            sourceProviders.add(executable->source().provider(), exec);
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        LiveObjectIterator it = globalData->heap.liveObjectsBegin(sizeClass);
+        LiveObjectIterator heapEnd = globalData->heap.liveObjectsEnd(sizeClass);
+        for ( ; it != heapEnd; ++it) {
+            if (!(*it)->inherits(&AJFunction::info))
+                continue;
+
+            AJFunction* function = asFunction(*it);
+            if (function->executable()->isHostFunction())
+                continue;
+
+            FunctionExecutable* executable = function->jsExecutable();
+
+            // Check if the function is already in the set - if so,
+            // we've already retranslated it, nothing to do here.
+            if (!functionExecutables.add(executable).second)
+                continue;
+
+            ExecState* exec = function->scope().globalObject()->AJGlobalObject::globalExec();
+            executable->recompile();
+            if (function->scope().globalObject()->debugger() == this)
+                sourceProviders.add(executable->source().provider(), exec);
+        }
     }
 
     // Call sourceParsed() after reparsing all functions because it will execute
@@ -68,6 +68,7 @@ limitations under the License.
 #include "LiteralParser.h"
 #include "AJStaticScopeObject.h"
 #include "AJString.h"
+#include "AJTypedArray.h"
 #include "ObjectPrototype.h"
 #include "Operations.h"
 #include "Parser.h"
@@ -1335,6 +1336,10 @@ AJValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFi
             goto vm_throw; \
         } \
         tickCount = globalData->timeoutChecker.ticksUntilNextCheck(); \
+    } \
+    if (UNLIKELY(globalData->heap.isOverHardLimit()) && globalData->heap.shouldThrowOutOfMemoryError()) { \
+        exceptionValue = createOutOfMemoryError(callFrame); \
+        goto vm_throw; \
     }
     
 #if ENABLE(OPCODE_SAMPLING)
@@ -2643,9 +2648,14 @@ skip_id_custom_self:
 
         Identifier& ident = callFrame->codeBlock()->identifier(property);
         AJValue baseValue = callFrame->r(base).jsValue();
-        PropertySlot slot(baseValue);
-        AJValue result = baseValue.get(callFrame, ident, slot);
-        CHECK_FOR_EXCEPTION();
+        MegamorphicCache& megamorphicCache = callFrame->globalData().megamorphicCache;
+        AJValue result;
+        if (!baseValue.isCell() || !megamorphicCache.get(baseValue.asCell(), ident, result)) {
+            PropertySlot slot(baseValue);
+            result = baseValue.get(callFrame, ident, slot);
+            CHECK_FOR_EXCEPTION();
+            megamorphicCache.add(baseValue, ident, slot);
+        }
 
         callFrame->r(dst) = result;
         vPC += OPCODE_LENGTH(op_get_by_id_generic);
@@ -3015,13 +3025,15 @@ skip_id_custom_self:
             if (isAJArray(globalData, baseValue)) {
                 AJArray* jsArray = asArray(baseValue);
                 if (jsArray->canGetIndex(i))
-                    result = jsArray->getIndex(i);
+                    result = jsArray->getIndex(callFrame, i);
                 else
                     result = jsArray->AJArray::get(callFrame, i);
             } else if (isAJString(globalData, baseValue) && asString(baseValue)->canGetIndex(i))
                 result = asString(baseValue)->getIndex(callFrame, i);
             else if (isAJArrayArray(globalData, baseValue) && asByteArray(baseValue)->canAccessIndex(i))
                 result = asByteArray(baseValue)->getIndex(callFrame, i);
+            else if (isAJTypedArray(globalData, baseValue) && asTypedArray(baseValue)->canAccessIndex(i))
+                result = asTypedArray(baseValue)->getIndex(callFrame, i);
             else
                 result = baseValue.get(callFrame, i);
         } else {
@@ -3057,7 +3069,7 @@ skip_id_custom_self:
             if (isAJArray(globalData, baseValue)) {
                 AJArray* jsArray = asArray(baseValue);
                 if (jsArray->canSetIndex(i))
-                    jsArray->setIndex(i, callFrame->r(value).jsValue());
+                    jsArray->setIndex(callFrame, i, callFrame->r(value).jsValue());
                 else
                     jsArray->AJArray::put(callFrame, i, callFrame->r(value).jsValue());
             } else if (isAJArrayArray(globalData, baseValue) && asByteArray(baseValue)->canAccessIndex(i)) {
@@ -3070,6 +3082,16 @@ skip_id_custom_self:
                     jsByteArray->setIndex(i, dValue);
                 else
                     baseValue.put(callFrame, i, jsValue);
+            } else if (isAJTypedArray(globalData, baseValue) && asTypedArray(baseValue)->canAccessIndex(i)) {
+                AJTypedArray* jsTypedArray = asTypedArray(baseValue);
+                double dValue = 0;
+                AJValue jsValue = callFrame->r(value).jsValue();
+                if (jsValue.isInt32())
+                    jsTypedArray->setIndex(i, jsValue.asInt32());
+                else if (jsValue.getNumber(dValue))
+                    jsTypedArray->setIndex(i, dValue);
+                else
+                    jsTypedArray->setIndex(callFrame, i, jsValue);
             } else
                 baseValue.put(callFrame, i, callFrame->r(value).jsValue());
         } else {
@@ -3482,7 +3504,7 @@ skip_id_custom_self:
             if (value->length() != 1)
                 vPC += defaultOffset;
             else
-                vPC += callFrame->codeBlock()->characterSwitchJumpTable(tableIndex).offsetForValue(value->characters()[0], defaultOffset);
+                vPC += callFrame->codeBlock()->characterSwitchJumpTable(tableIndex).offsetForValue((*value)[0], defaultOffset);
         }
         NEXT_INSTRUCTION();
     }
@@ -4021,10 +4043,10 @@ skip_id_custom_self:
             Structure* structure;
             AJValue prototype = callFrame->r(proto).jsValue();
             if (prototype.isObject())
-                structure = asObject(prototype)->inheritorID();
+                structure = asObject(prototype)->inheritorIDForConstruct();
             else
                 structure = callDataScopeChain->globalObject->emptyObjectStructure();
-            AJObject* newObject = new (globalData) AJObject(structure);
+            AJObject* newObject = AJObject::createForConstruct(globalData, structure);
 
             callFrame->r(thisRegister) = AJValue(newObject); // "this" value
 
@@ -216,6 +216,11 @@ namespace AJ {
             JIT jit(globalData, codeBlock);
             jit.privateCompileGetByIdProtoList(stubInfo, prototypeStructureList, currentIndex, structure, prototypeStructure, ident, slot, cachedOffset, callFrame);
         }
+        static void compileGetByIdMegamorphic(AJGlobalData* globalData, CodeBlock* codeBlock, StructureStubInfo* stubInfo, CodeLocationLabel failureTarget, const Identifier& ident)
+        {
+            JIT jit(globalData, codeBlock);
+            jit.privateCompileGetByIdMegamorphic(stubInfo, failureTarget, ident);
+        }
         static void compileGetByIdChainList(AJGlobalData* globalData, CallFrame* callFrame, CodeBlock* codeBlock, StructureStubInfo* stubInfo, PolymorphicAccessStructureList* prototypeStructureList, int currentIndex, Structure* structure, StructureChain* chain, size_t count, const Identifier& ident, const PropertySlot& slot, size_t cachedOffset)
         {
             JIT jit(globalData, codeBlock);
@@ -276,6 +281,7 @@ namespace AJ {
         void privateCompileGetByIdProto(StructureStubInfo*, Structure*, Structure* prototypeStructure, const Identifier&, const PropertySlot&, size_t cachedOffset, ReturnAddressPtr returnAddress, CallFrame* callFrame);
         void privateCompileGetByIdSelfList(StructureStubInfo*, PolymorphicAccessStructureList*, int, Structure*, const Identifier&, const PropertySlot&, size_t cachedOffset);
         void privateCompileGetByIdProtoList(StructureStubInfo*, PolymorphicAccessStructureList*, int, Structure*, Structure* prototypeStructure, const Identifier&, const PropertySlot&, size_t cachedOffset, CallFrame* callFrame);
+        void privateCompileGetByIdMegamorphic(StructureStubInfo*, CodeLocationLabel failureTarget, const Identifier&);
         void privateCompileGetByIdChainList(StructureStubInfo*, PolymorphicAccessStructureList*, int, Structure*, StructureChain* chain, size_t count, const Identifier&, const PropertySlot&, size_t cachedOffset, CallFrame* callFrame);
         void privateCompileGetByIdChain(StructureStubInfo*, Structure*, StructureChain*, size_t count, const Identifier&, const PropertySlot&, size_t cachedOffset, ReturnAddressPtr returnAddress, CallFrame* callFrame);
         void privateCompilePutByIdTransition(StructureStubInfo*, Structure*, Structure*, size_t cachedOffset, StructureChain*, ReturnAddressPtr returnAddress, bool direct);
@@ -305,6 +311,13 @@ namespace AJ {
         void emitLoadInt32ToDouble(unsigned index, FPRegisterID value);
 
         void testPrototype(Structure*, JumpList& failureCases);
+        void emitWriteBarrier(RegisterID owner, RegisterID scratch);
+        void emitLoadGlobalObjectStructure(ptrdiff_t globalObjectDataOffset, RegisterID dst);
+        void emitLoadFreeCell(size_t bytes, RegisterID cell);
+        void emitTakeFreeCell(size_t bytes, RegisterID cell, RegisterID scratch);
+        void emitInitializeObject(RegisterID cell, void* vptr, RegisterID structure);
+        void emitAllocateEmptyObject();
+        void emitAllocateEmptyArray();
 
 #if USE(JSVALUE32_64)
         bool getOperandConstantImmediateInt(unsigned op1, unsigned op2, unsigned& op, int32_t& constant);
@@ -834,6 +847,8 @@ namespace AJ {
         void emitSlow_op_mul(Instruction*, Vector<SlowCaseEntry>::iterator&);
         void emitSlow_op_negate(Instruction*, Vector<SlowCaseEntry>::iterator&);
         void emitSlow_op_neq(Instruction*, Vector<SlowCaseEntry>::iterator&);
+        void emitSlow_op_new_array(Instruction*, Vector<SlowCaseEntry>::iterator&);
+        void emitSlow_op_new_object(Instruction*, Vector<SlowCaseEntry>::iterator&);
         void emitSlow_op_not(Instruction*, Vector<SlowCaseEntry>::iterator&);
         void emitSlow_op_nstricteq(Instruction*, Vector<SlowCaseEntry>::iterator&);
         void emitSlow_op_post_dec(Instruction*, Vector<SlowCaseEntry>::iterator&);
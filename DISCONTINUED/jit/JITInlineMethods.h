@@ -116,6 +116,7 @@ ALWAYS_INLINE void JIT::emitLoadCharacterString(RegisterID src, RegisterID dst,
     failures.append(branchTest32(NonZero, Address(src, OBJECT_OFFSETOF(AJString, m_fiberCount))));
     failures.append(branch32(NotEqual, MacroAssembler::Address(src, ThunkHelpers::jsStringLengthOffset()), Imm32(1)));
     loadPtr(MacroAssembler::Address(src, ThunkHelpers::jsStringValueOffset()), dst);
+    failures.append(branchTest32(NonZero, MacroAssembler::Address(dst, ThunkHelpers::stringImplFlagsOffset()), Imm32(ThunkHelpers::stringImplIs8BitFlag())));
     loadPtr(MacroAssembler::Address(dst, ThunkHelpers::stringImplDataOffset()), dst);
     load16(MacroAssembler::Address(dst, 0), dst);
 }
@@ -289,6 +290,110 @@ ALWAYS_INLINE void JIT::emitJumpSlowToHot(Jump jump, int relativeOffset)
     jump.linkTo(m_labels[m_bytecodeIndex + relativeOffset], this);
 }
 
+// Dirties the card holding the start of owner; see Heap::writeBarrier. Clobbers owner.
+ALWAYS_INLINE void JIT::emitWriteBarrier(RegisterID owner, RegisterID scratch)
+{
+    move(owner, scratch);
+    urshift32(Imm32(CARD_SHIFT - 2), scratch);
+    and32(Imm32((CARDS_PER_BLOCK - 1) << 2), scratch);
+    andPtr(Imm32(static_cast<int32_t>(BLOCK_MASK)), owner);
+    addPtr(scratch, owner);
+    store32(Imm32(1), Address(owner, OBJECT_OFFSETOF(CollectorBlock, cards)));
+}
+
+// Loads one of the Structures the lexical global object keeps for new objects,
+// and marks it, as AJObject::didStartUsingStructure() does. Adds a slow case
+// for a Structure the heap does not know about yet.
+ALWAYS_INLINE void JIT::emitLoadGlobalObjectStructure(ptrdiff_t globalObjectDataOffset, RegisterID dst)
+{
+    emitGetFromCallFrameHeaderPtr(RegisterFile::ScopeChain, dst);
+    loadPtr(Address(dst, OBJECT_OFFSETOF(ScopeChainNode, globalObject)), dst);
+    loadPtr(Address(dst, OBJECT_OFFSETOF(JSVariableObject, d)), dst);
+    loadPtr(Address(dst, globalObjectDataOffset), dst);
+    addSlowCase(branchTestPtr(Zero, Address(dst, OBJECT_OFFSETOF(Structure, m_heap))));
+    store32(Imm32(1), Address(dst, OBJECT_OFFSETOF(Structure, m_isMarked)));
+}
+
+// Loads the first cell on the free list of the size class for a cell of the
+// given size, adding a slow case if the list is empty. The cell stays on the
+// list until emitTakeFreeCell(), so that more slow cases can come in between.
+ALWAYS_INLINE void JIT::emitLoadFreeCell(size_t bytes, RegisterID cell)
+{
+    loadPtr(&m_globalData->heap.m_allocationBuffer.freeLists[Heap::sizeClassFor(bytes)], cell);
+    addSlowCase(branchTestPtr(Zero, cell));
+}
+
+// Pops the cell emitLoadFreeCell() loaded; see Heap::allocate().
+ALWAYS_INLINE void JIT::emitTakeFreeCell(size_t bytes, RegisterID cell, RegisterID scratch)
+{
+    loadPtr(Address(cell, sizeof(AJCell)), scratch); // Heap::nextFreeCell()
+    storePtr(scratch, &m_globalData->heap.m_allocationBuffer.freeLists[Heap::sizeClassFor(bytes)]);
+}
+
+// Fills in the fields AJObject's constructor sets.
+ALWAYS_INLINE void JIT::emitInitializeObject(RegisterID cell, void* vptr, RegisterID structure)
+{
+    storePtr(ImmPtr(vptr), Address(cell));
+    storePtr(structure, Address(cell, OBJECT_OFFSETOF(AJCell, m_structure)));
+    storePtr(ImmPtr(0), Address(cell, OBJECT_OFFSETOF(AJObject, m_inheritorID)));
+}
+
+// Allocates the object for an empty object literal into regT0, as
+// constructEmptyObject() does. Clobbers regT1 and regT2; adds two slow cases.
+inline void JIT::emitAllocateEmptyObject()
+{
+    emitLoadGlobalObjectStructure(OBJECT_OFFSETOF(AJGlobalObject::AJGlobalObjectData, emptyObjectStructure), regT2);
+    emitLoadFreeCell(sizeof(AJObject), regT0);
+    emitTakeFreeCell(sizeof(AJObject), regT0, regT1);
+    emitInitializeObject(regT0, m_globalData->jsObjectVPtr, regT2);
+}
+
+// Allocates the array for an empty array literal into regT0, as AJArray's
+// default constructor does, bump allocating its storage from the copied
+// space's current block. Clobbers regT1 - regT3; adds four slow cases.
+inline void JIT::emitAllocateEmptyArray()
+{
+    static const size_t storageBytes = sizeof(ArrayStorage) - sizeof(AJValue);
+    static const size_t bytes = sizeof(CopiedSpace::Header) + storageBytes;
+    COMPILE_ASSERT(!(storageBytes % 8), empty_ArrayStorage_needs_no_rounding);
+    COMPILE_ASSERT(sizeof(AJArray::VectorMode) == sizeof(int32_t), VectorMode_is_32_bits);
+
+    CopiedSpace& copiedSpace = m_globalData->heap.m_copiedSpace;
+
+    emitLoadGlobalObjectStructure(OBJECT_OFFSETOF(AJGlobalObject::AJGlobalObjectData, arrayStructure), regT2);
+    emitLoadFreeCell(sizeof(AJArray), regT0);
+
+    // The buffer goes at the top of the current block, if it fits below the end.
+    loadPtr(&copiedSpace.m_currentBlock, regT3);
+    addSlowCase(branchTestPtr(Zero, regT3));
+    loadPtr(Address(regT3, CopiedSpace::offsetOfBlockTop()), regT1);
+    addPtr(Imm32(BLOCK_SIZE - bytes), regT3);
+    addSlowCase(branchPtr(Above, regT1, regT3));
+    subPtr(Imm32(BLOCK_SIZE - bytes), regT3);
+
+    // Nothing can fail from here on.
+    addPtr(Imm32(bytes), regT1);
+    storePtr(regT1, Address(regT3, CopiedSpace::offsetOfBlockTop()));
+    subPtr(Imm32(bytes), regT1);
+    emitTakeFreeCell(sizeof(AJArray), regT0, regT3);
+
+    move(regT0, regT3);
+    addPtr(Imm32(OBJECT_OFFSETOF(AJArray, m_storage)), regT3);
+    storePtr(regT3, Address(regT1, OBJECT_OFFSETOF(CopiedSpace::Header, owner)));
+    storePtr(ImmPtr(reinterpret_cast<void*>(storageBytes)), Address(regT1, OBJECT_OFFSETOF(CopiedSpace::Header, size)));
+    addPtr(Imm32(sizeof(CopiedSpace::Header)), regT1);
+    store32(Imm32(0), Address(regT1, OBJECT_OFFSETOF(ArrayStorage, m_length)));
+    store32(Imm32(0), Address(regT1, OBJECT_OFFSETOF(ArrayStorage, m_numValuesInVector)));
+
+    emitInitializeObject(regT0, m_globalData->jsArrayVPtr, regT2);
+    store32(Imm32(0), Address(regT0, OBJECT_OFFSETOF(AJArray, m_vectorLength)));
+    store32(Imm32(AJArray::Int32Vector), Address(regT0, OBJECT_OFFSETOF(AJArray, m_vectorMode)));
+    storePtr(regT1, Address(regT0, OBJECT_OFFSETOF(AJArray, m_storage)));
+    storePtr(ImmPtr(0), Address(regT0, OBJECT_OFFSETOF(AJArray, m_sparseValueMap)));
+    storePtr(ImmPtr(0), Address(regT0, OBJECT_OFFSETOF(AJArray, m_subclassData)));
+    storePtr(ImmPtr(0), Address(regT0, OBJECT_OFFSETOF(AJArray, m_reportedMapCapacity)));
+}
+
 #if ENABLE(SAMPLING_FLAGS)
 ALWAYS_INLINE void JIT::setSamplingFlag(int32_t flag)
 {
@@ -548,6 +548,14 @@ void JIT::emit_op_loop_if_lesseq(Instruction* currentInstruction)
 
 void JIT::emit_op_new_object(Instruction* currentInstruction)
 {
+    emitAllocateEmptyObject();
+    emitPutVirtualRegister(currentInstruction[1].u.operand);
+}
+
+void JIT::emitSlow_op_new_object(Instruction* currentInstruction, Vector<SlowCaseEntry>::iterator& iter)
+{
+    linkSlowCase(iter); // Structure not in the heap
+    linkSlowCase(iter); // free list empty
     JITStubCall(this, cti_op_new_object).call(currentInstruction[1].u.operand);
 }
 
@@ -713,12 +721,32 @@ void JIT::emit_op_ret(Instruction* currentInstruction)
 
 void JIT::emit_op_new_array(Instruction* currentInstruction)
 {
+    // The elements of a literal decide its vector mode, so only an empty
+    // literal is allocated inline.
+    if (!currentInstruction[3].u.operand) {
+        emitAllocateEmptyArray();
+        emitPutVirtualRegister(currentInstruction[1].u.operand);
+        return;
+    }
+
     JITStubCall stubCall(this, cti_op_new_array);
     stubCall.addArgument(Imm32(currentInstruction[2].u.operand));
     stubCall.addArgument(Imm32(currentInstruction[3].u.operand));
     stubCall.call(currentInstruction[1].u.operand);
 }
 
+void JIT::emitSlow_op_new_array(Instruction* currentInstruction, Vector<SlowCaseEntry>::iterator& iter)
+{
+    linkSlowCase(iter); // Structure not in the heap
+    linkSlowCase(iter); // free list empty
+    linkSlowCase(iter); // no current block
+    linkSlowCase(iter); // current block full
+    JITStubCall stubCall(this, cti_op_new_array);
+    stubCall.addArgument(Imm32(currentInstruction[2].u.operand));
+    stubCall.addArgument(Imm32(0));
+    stubCall.call(currentInstruction[1].u.operand);
+}
+
 void JIT::emit_op_resolve(Instruction* currentInstruction)
 {
     JITStubCall stubCall(this, cti_op_resolve);
@@ -1454,8 +1482,17 @@ void JIT::emitSlow_op_put_by_val(Instruction* currentInstruction, Vector<SlowCas
 
     linkSlowCase(iter); // property int32 check
     linkSlowCaseIfNotAJCell(iter, base); // base cell check
-    linkSlowCase(iter); // base not array check
     linkSlowCase(iter); // in vector check
+#if USE(JSVALUE64)
+    linkSlowCase(iter); // vector mode check
+    linkSlowCase(iter); // int32 value check
+    linkSlowCase(iter); // int32 vector hole check
+#else
+    linkSlowCase(iter); // vector mode check
+#endif
+    linkSlowCase(iter); // base not array or Int32Array check
+    linkSlowCase(iter); // Int32Array length check
+    linkSlowCase(iter); // Int32Array int32 value check
 
     JITStubCall stubPutByValCall(this, cti_op_put_by_val);
     stubPutByValCall.addArgument(regT0);
@@ -511,6 +511,14 @@ void JIT::emitSlow_op_loop_if_lesseq(Instruction* currentInstruction, Vector<Slo
 
 void JIT::emit_op_new_object(Instruction* currentInstruction)
 {
+    emitAllocateEmptyObject();
+    emitStoreCell(currentInstruction[1].u.operand, regT0);
+}
+
+void JIT::emitSlow_op_new_object(Instruction* currentInstruction, Vector<SlowCaseEntry>::iterator& iter)
+{
+    linkSlowCase(iter); // Structure not in the heap
+    linkSlowCase(iter); // free list empty
     JITStubCall(this, cti_op_new_object).call(currentInstruction[1].u.operand);
 }
 
@@ -664,12 +672,32 @@ void JIT::emit_op_tear_off_arguments(Instruction*)
 
 void JIT::emit_op_new_array(Instruction* currentInstruction)
 {
+    // The elements of a literal decide its vector mode, so only an empty
+    // literal is allocated inline.
+    if (!currentInstruction[3].u.operand) {
+        emitAllocateEmptyArray();
+        emitStoreCell(currentInstruction[1].u.operand, regT0);
+        return;
+    }
+
     JITStubCall stubCall(this, cti_op_new_array);
     stubCall.addArgument(Imm32(currentInstruction[2].u.operand));
     stubCall.addArgument(Imm32(currentInstruction[3].u.operand));
     stubCall.call(currentInstruction[1].u.operand);
 }
 
+void JIT::emitSlow_op_new_array(Instruction* currentInstruction, Vector<SlowCaseEntry>::iterator& iter)
+{
+    linkSlowCase(iter); // Structure not in the heap
+    linkSlowCase(iter); // free list empty
+    linkSlowCase(iter); // no current block
+    linkSlowCase(iter); // current block full
+    JITStubCall stubCall(this, cti_op_new_array);
+    stubCall.addArgument(Imm32(currentInstruction[2].u.operand));
+    stubCall.addArgument(Imm32(0));
+    stubCall.call(currentInstruction[1].u.operand);
+}
+
 void JIT::emit_op_resolve(Instruction* currentInstruction)
 {
     JITStubCall stubCall(this, cti_op_resolve);
@@ -55,6 +55,7 @@ limitations under the License.
 #include "AJArray.h"
 #include "AJFunction.h"
 #include "AJPropertyNameIterator.h"
+#include "AJTypedArray.h"
 #include "Interpreter.h"
 #include "LinkBuffer.h"
 #include "RepatchBuffer.h"
@@ -84,6 +85,7 @@ PassRefPtr<NativeExecutable> JIT::stringGetByValStubGenerator(AJGlobalData* glob
     // Load string length to regT1, and start the process of loading the data pointer into regT0
     jit.load32(Address(regT0, ThunkHelpers::jsStringLengthOffset()), regT2);
     jit.loadPtr(Address(regT0, ThunkHelpers::jsStringValueOffset()), regT0);
+    failures.append(jit.branchTest32(NonZero, Address(regT0, ThunkHelpers::stringImplFlagsOffset()), Imm32(ThunkHelpers::stringImplIs8BitFlag())));
     jit.loadPtr(Address(regT0, ThunkHelpers::stringImplDataOffset()), regT0);
     
     // Do an unsigned compare to simultaneously filter negative indices as well as indices that are too large
@@ -125,14 +127,48 @@ void JIT::emit_op_get_by_val(Instruction* currentInstruction)
     emitFastArithImmToInt(regT1);
 #endif
     emitJumpSlowCaseIfNotAJCell(regT0, base);
-    addSlowCase(branchPtr(NotEqual, Address(regT0), ImmPtr(m_globalData->jsArrayVPtr)));
+    Jump notArray = branchPtr(NotEqual, Address(regT0), ImmPtr(m_globalData->jsArrayVPtr));
 
     loadPtr(Address(regT0, OBJECT_OFFSETOF(AJArray, m_storage)), regT2);
     addSlowCase(branch32(AboveOrEqual, regT1, Address(regT0, OBJECT_OFFSETOF(AJArray, m_vectorLength))));
+    Jump notValueVector = branch32(NotEqual, Address(regT0, OBJECT_OFFSETOF(AJArray, m_vectorMode)), Imm32(AJArray::ValueVector));
 
     loadPtr(BaseIndex(regT2, regT1, ScalePtr, OBJECT_OFFSETOF(ArrayStorage, m_vector[0])), regT0);
     addSlowCase(branchTestPtr(Zero, regT0));
 
+#if USE(JSVALUE64)
+    Jump arrayDone = jump();
+
+    // Int32s are boxed here, doubles by the stub.
+    notValueVector.link(this);
+    addSlowCase(branch32(NotEqual, Address(regT0, OBJECT_OFFSETOF(AJArray, m_vectorMode)), Imm32(AJArray::Int32Vector)));
+    addSlowCase(branch32(AboveOrEqual, regT1, Address(regT2, OBJECT_OFFSETOF(ArrayStorage, m_numValuesInVector))));
+    load32(BaseIndex(regT2, regT1, TimesFour, OBJECT_OFFSETOF(ArrayStorage, m_vector[0])), regT0);
+    emitFastArithIntToImmNoCheck(regT0, regT0);
+    arrayDone.link(this);
+#else
+    // An int32 may not fit in an immediate, so the stub boxes every number.
+    addSlowCase(notValueVector);
+#endif
+    Jump done = jump();
+
+    // Int32Array elements are loaded here too. The other views have no
+    // inline path, since the assembler has no byte or float loads; the stub
+    // handles them without a generic property lookup.
+    notArray.link(this);
+    addSlowCase(branchPtr(NotEqual, Address(regT0), ImmPtr(m_globalData->jsTypedArrayVPtrs[AJTypedArray::Int32])));
+    addSlowCase(branch32(AboveOrEqual, regT1, Address(regT0, OBJECT_OFFSETOF(AJTypedArray, m_length))));
+    loadPtr(Address(regT0, OBJECT_OFFSETOF(AJTypedArray, m_data)), regT2);
+    load32(BaseIndex(regT2, regT1, TimesFour), regT0);
+#if USE(JSVALUE64)
+    emitFastArithIntToImmNoCheck(regT0, regT0);
+#else
+    addSlowCase(branchAdd32(Overflow, regT0, regT0));
+    signExtend32ToPtr(regT0, regT0);
+    emitFastArithReTagImmediate(regT0, regT0);
+#endif
+
+    done.link(this);
     emitPutVirtualRegister(dst);
 }
 
@@ -145,7 +181,16 @@ void JIT::emitSlow_op_get_by_val(Instruction* currentInstruction, Vector<SlowCas
     linkSlowCase(iter); // property int32 check
     linkSlowCaseIfNotAJCell(iter, base); // base cell check
     Jump nonCell = jump();
-    linkSlowCase(iter); // base array check
+    linkSlowCase(iter); // vector length check
+    linkSlowCase(iter); // empty value
+#if USE(JSVALUE64)
+    linkSlowCase(iter); // vector mode check
+    linkSlowCase(iter); // int32 vector length check
+#else
+    linkSlowCase(iter); // vector mode check
+#endif
+    Jump arraySlowCase = jump();
+    linkSlowCase(iter); // base array or Int32Array check
     Jump notString = branchPtr(NotEqual, Address(regT0), ImmPtr(m_globalData->jsStringVPtr));
     emitNakedCall(m_globalData->getThunk(stringGetByValStubGenerator)->generatedJITCode().addressForCall());
     Jump failed = branchTestPtr(Zero, regT0);
@@ -153,10 +198,12 @@ void JIT::emitSlow_op_get_by_val(Instruction* currentInstruction, Vector<SlowCas
     emitJumpSlowToHot(jump(), OPCODE_LENGTH(op_get_by_val));
     failed.link(this);
     notString.link(this);
+    linkSlowCase(iter); // Int32Array length check
+#if USE(JSVALUE32)
+    linkSlowCase(iter); // Int32Array element fits in an immediate check
+#endif
     nonCell.link(this);
-    
-    linkSlowCase(iter); // vector length check
-    linkSlowCase(iter); // empty value
+    arraySlowCase.link(this);
     
     JITStubCall stubCall(this, cti_op_get_by_val);
     stubCall.addArgument(base, regT2);
@@ -167,9 +214,10 @@ void JIT::emitSlow_op_get_by_val(Instruction* currentInstruction, Vector<SlowCas
 void JIT::compileGetDirectOffset(RegisterID base, RegisterID result, RegisterID structure, RegisterID offset, RegisterID scratch)
 {
     ASSERT(sizeof(((Structure*)0)->m_propertyStorageCapacity) == sizeof(int32_t));
-    ASSERT(sizeof(AJObject::inlineStorageCapacity) == sizeof(int32_t));
+    ASSERT(sizeof(((Structure*)0)->m_inlineStorageCapacity) == sizeof(int32_t));
 
-    Jump notUsingInlineStorage = branch32(NotEqual, Address(structure, OBJECT_OFFSETOF(Structure, m_propertyStorageCapacity)), Imm32(AJObject::inlineStorageCapacity));
+    load32(Address(structure, OBJECT_OFFSETOF(Structure, m_inlineStorageCapacity)), scratch);
+    Jump notUsingInlineStorage = branch32(NotEqual, Address(structure, OBJECT_OFFSETOF(Structure, m_propertyStorageCapacity)), scratch);
     loadPtr(BaseIndex(base, offset, ScalePtr, OBJECT_OFFSETOF(AJObject, m_inlineStorage)), result);
     Jump finishedLoad = jump();
     notUsingInlineStorage.link(this);
@@ -235,10 +283,15 @@ void JIT::emit_op_put_by_val(Instruction* currentInstruction)
     emitFastArithImmToInt(regT1);
 #endif
     emitJumpSlowCaseIfNotAJCell(regT0, base);
-    addSlowCase(branchPtr(NotEqual, Address(regT0), ImmPtr(m_globalData->jsArrayVPtr)));
+    Jump notArray = branchPtr(NotEqual, Address(regT0), ImmPtr(m_globalData->jsArrayVPtr));
     addSlowCase(branch32(AboveOrEqual, regT1, Address(regT0, OBJECT_OFFSETOF(AJArray, m_vectorLength))));
 
     loadPtr(Address(regT0, OBJECT_OFFSETOF(AJArray, m_storage)), regT2);
+#if USE(JSVALUE64)
+    Jump notValueVector = branch32(NotEqual, Address(regT0, OBJECT_OFFSETOF(AJArray, m_vectorMode)), Imm32(AJArray::ValueVector));
+#else
+    addSlowCase(branch32(NotEqual, Address(regT0, OBJECT_OFFSETOF(AJArray, m_vectorMode)), Imm32(AJArray::ValueVector)));
+#endif
 
     Jump empty = branchTestPtr(Zero, BaseIndex(regT2, regT1, ScalePtr, OBJECT_OFFSETOF(ArrayStorage, m_vector[0])));
 
@@ -256,7 +309,49 @@ void JIT::emit_op_put_by_val(Instruction* currentInstruction)
     store32(regT0, Address(regT2, OBJECT_OFFSETOF(ArrayStorage, m_length)));
     jump().linkTo(storeResult, this);
 
+#if USE(JSVALUE64)
+    // Int32s go into an Int32Vector here, anywhere up to just past its last
+    // value. The slow case still wants the base in regT0.
+    notValueVector.link(this);
+    addSlowCase(branch32(NotEqual, Address(regT0, OBJECT_OFFSETOF(AJArray, m_vectorMode)), Imm32(AJArray::Int32Vector)));
+    emitGetVirtualRegister(value, regT3);
+    addSlowCase(emitJumpIfNotImmediateInteger(regT3));
+    Jump append = branch32(AboveOrEqual, regT1, Address(regT2, OBJECT_OFFSETOF(ArrayStorage, m_numValuesInVector)));
+
+    Label storeInt32(this);
+    store32(regT3, BaseIndex(regT2, regT1, TimesFour, OBJECT_OFFSETOF(ArrayStorage, m_vector[0])));
+    Jump int32Stored = jump();
+
+    append.link(this);
+    addSlowCase(branch32(NotEqual, regT1, Address(regT2, OBJECT_OFFSETOF(ArrayStorage, m_numValuesInVector)))); // would leave a hole
+    add32(Imm32(1), Address(regT2, OBJECT_OFFSETOF(ArrayStorage, m_numValuesInVector)));
+    branch32(Below, regT1, Address(regT2, OBJECT_OFFSETOF(ArrayStorage, m_length))).linkTo(storeInt32, this);
+
+    move(regT1, regT0);
+    add32(Imm32(1), regT0);
+    store32(regT0, Address(regT2, OBJECT_OFFSETOF(ArrayStorage, m_length)));
+    jump().linkTo(storeInt32, this);
+
+    int32Stored.link(this);
+#endif
     end.link(this);
+
+    emitGetVirtualRegister(base, regT0);
+    emitWriteBarrier(regT0, regT2);
+    Jump done = jump();
+
+    // Int32s go into an Int32Array here, with no write barrier since they
+    // are not cells. The slow case still wants the base in regT0.
+    notArray.link(this);
+    addSlowCase(branchPtr(NotEqual, Address(regT0), ImmPtr(m_globalData->jsTypedArrayVPtrs[AJTypedArray::Int32])));
+    addSlowCase(branch32(AboveOrEqual, regT1, Address(regT0, OBJECT_OFFSETOF(AJTypedArray, m_length))));
+    emitGetVirtualRegister(value, regT3);
+    addSlowCase(emitJumpIfNotImmediateInteger(regT3));
+    emitFastArithImmToInt(regT3);
+    loadPtr(Address(regT0, OBJECT_OFFSETOF(AJTypedArray, m_data)), regT2);
+    store32(regT3, BaseIndex(regT2, regT1, TimesFour));
+
+    done.link(this);
 }
 
 void JIT::emit_op_put_by_index(Instruction* currentInstruction)
@@ -549,6 +644,10 @@ void JIT::emit_op_put_by_id(Instruction* currentInstruction)
     END_UNINTERRUPTED_SEQUENCE(sequencePutById);
 
     ASSERT_JIT_OFFSET(differenceBetween(hotPathBegin, displacementLabel), patchOffsetPutByIdPropertyMapOffset);
+
+    // The store above overwrote the base register with its property storage.
+    emitGetVirtualRegister(baseVReg, regT0);
+    emitWriteBarrier(regT0, regT2);
 }
 
 void JIT::emitSlow_op_put_by_id(Instruction* currentInstruction, Vector<SlowCaseEntry>::iterator& iter)
@@ -651,12 +750,14 @@ void JIT::privateCompilePutByIdTransition(StructureStubInfo* stubInfo, Structure
         restoreReturnAddressBeforeReturn(regT3);
     }
 
-    // Assumes m_refCount can be decremented easily, refcount decrement is safe as 
-    // codeblock should ensure oldStructure->m_refCount > 0
-    sub32(Imm32(1), AbsoluteAddress(oldStructure->addressOfCount()));
-    add32(Imm32(1), AbsoluteAddress(newStructure->addressOfCount()));
+    // Cells do not count references to their Structure, but mark it when
+    // they start using it, like AJObject::setStructure().
+    store32(Imm32(1), &newStructure->m_isMarked);
     storePtr(ImmPtr(newStructure), Address(regT0, OBJECT_OFFSETOF(AJCell, m_structure)));
 
+    move(regT0, regT2);
+    emitWriteBarrier(regT2, regT3);
+
     // write the value
     compilePutDirectOffset(regT0, regT1, newStructure, cachedOffset);
 
@@ -908,6 +1009,56 @@ void JIT::privateCompileGetByIdSelfList(StructureStubInfo* stubInfo, Polymorphic
     repatchBuffer.relink(jumpLocation, entryLabel);
 }
 
+void JIT::privateCompileGetByIdMegamorphic(StructureStubInfo* stubInfo, CodeLocationLabel failureTarget, const Identifier& ident)
+{
+    // regT0 holds a AJCell*
+    UString::Rep* name = ident.ustring().rep();
+    JumpList failureCases;
+
+    // Find the entry the way MegamorphicCache::index does. Only the low bits
+    // of the shifted Structure are kept, so it does not matter which way it
+    // is shifted.
+    loadPtr(Address(regT0, OBJECT_OFFSETOF(AJCell, m_structure)), regT1);
+    move(regT1, regT2);
+    rshift32(Imm32(MegamorphicCache::structureShift), regT2);
+    xor32(Imm32(name->existingHash() & (MegamorphicCache::size - 1)), regT2);
+    and32(Imm32(MegamorphicCache::size - 1), regT2);
+    lshift32(Imm32(MegamorphicCache::entrySizeShift), regT2);
+    addPtr(ImmPtr(m_globalData->megamorphicCache.entries()), regT2);
+    failureCases.append(branchPtr(NotEqual, Address(regT2, OBJECT_OFFSETOF(MegamorphicCache::Entry, structure)), regT1));
+    failureCases.append(branchPtr(NotEqual, Address(regT2, OBJECT_OFFSETOF(MegamorphicCache::Entry, name)), ImmPtr(name)));
+
+    // A property of the prototype is read from the prototype, if its Structure
+    // is still the one the entry was made with. regT0 keeps the base cell
+    // until nothing can fail.
+    loadPtr(Address(regT2, OBJECT_OFFSETOF(MegamorphicCache::Entry, prototypeStructure)), regT3);
+    Jump isOwnProperty = branchTestPtr(Zero, regT3);
+    loadPtr(Address(regT1, OBJECT_OFFSETOF(Structure, m_prototype)), regT1);
+    failureCases.append(branchPtr(NotEqual, Address(regT1, OBJECT_OFFSETOF(AJCell, m_structure)), regT3));
+    move(regT1, regT0);
+    move(regT3, regT1);
+    isOwnProperty.link(this);
+
+    load32(Address(regT2, OBJECT_OFFSETOF(MegamorphicCache::Entry, offset)), regT2);
+    compileGetDirectOffset(regT0, regT0, regT1, regT2, regT3);
+    Jump success = jump();
+
+    LinkBuffer patchBuffer(this, m_codeBlock->executablePool(), 0);
+
+    // Misses go on to the stubs for the Structures the site has cached itself.
+    patchBuffer.link(failureCases, failureTarget);
+
+    // On success return back to the hot patch code, at a point it will perform the store to dest for us.
+    patchBuffer.link(success, stubInfo->hotPathBegin.labelAtOffset(patchOffsetGetByIdPutResult));
+
+    CodeLocationLabel entryLabel = patchBuffer.finalizeCodeAddendum();
+
+    // Finally patch the jump to slow case back in the hot path to jump here instead.
+    CodeLocationJump jumpLocation = stubInfo->hotPathBegin.jumpAtOffset(patchOffsetGetByIdBranchToSlowCase);
+    RepatchBuffer repatchBuffer(m_codeBlock);
+    repatchBuffer.relink(jumpLocation, entryLabel);
+}
+
 void JIT::privateCompileGetByIdProtoList(StructureStubInfo* stubInfo, PolymorphicAccessStructureList* prototypeStructures, int currentIndex, Structure* structure, Structure* prototypeStructure, const Identifier& ident, const PropertySlot& slot, size_t cachedOffset, CallFrame* callFrame)
 {
     // The prototype object definitely exists (if this stub exists the CodeBlock is referencing a Structure that is
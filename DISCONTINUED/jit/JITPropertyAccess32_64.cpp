@@ -54,6 +54,7 @@ limitations under the License.
 #include "AJArray.h"
 #include "AJFunction.h"
 #include "AJPropertyNameIterator.h"
+#include "AJTypedArray.h"
 #include "Interpreter.h"
 #include "LinkBuffer.h"
 #include "RepatchBuffer.h"
@@ -296,6 +297,7 @@ PassRefPtr<NativeExecutable> JIT::stringGetByValStubGenerator(AJGlobalData* glob
     // Load string length to regT1, and start the process of loading the data pointer into regT0
     jit.load32(Address(regT0, ThunkHelpers::jsStringLengthOffset()), regT1);
     jit.loadPtr(Address(regT0, ThunkHelpers::jsStringValueOffset()), regT0);
+    failures.append(jit.branchTest32(NonZero, Address(regT0, ThunkHelpers::stringImplFlagsOffset()), Imm32(ThunkHelpers::stringImplIs8BitFlag())));
     jit.loadPtr(Address(regT0, ThunkHelpers::stringImplDataOffset()), regT0);
     
     // Do an unsigned compare to simultaneously filter negative indices as well as indices that are too large
@@ -328,15 +330,37 @@ void JIT::emit_op_get_by_val(Instruction* currentInstruction)
     
     addSlowCase(branch32(NotEqual, regT3, Imm32(AJValue::Int32Tag)));
     emitJumpSlowCaseIfNotAJCell(base, regT1);
-    addSlowCase(branchPtr(NotEqual, Address(regT0), ImmPtr(m_globalData->jsArrayVPtr)));
+    Jump notArray = branchPtr(NotEqual, Address(regT0), ImmPtr(m_globalData->jsArrayVPtr));
     
     loadPtr(Address(regT0, OBJECT_OFFSETOF(AJArray, m_storage)), regT3);
     addSlowCase(branch32(AboveOrEqual, regT2, Address(regT0, OBJECT_OFFSETOF(AJArray, m_vectorLength))));
+    Jump notValueVector = branch32(NotEqual, Address(regT0, OBJECT_OFFSETOF(AJArray, m_vectorMode)), Imm32(AJArray::ValueVector));
     
     load32(BaseIndex(regT3, regT2, TimesEight, OBJECT_OFFSETOF(ArrayStorage, m_vector[0]) + 4), regT1); // tag
     load32(BaseIndex(regT3, regT2, TimesEight, OBJECT_OFFSETOF(ArrayStorage, m_vector[0])), regT0); // payload
     addSlowCase(branch32(Equal, regT1, Imm32(AJValue::EmptyValueTag)));
-    
+    Jump done = jump();
+
+    // Int32s are boxed here, doubles by the stub.
+    notValueVector.link(this);
+    addSlowCase(branch32(NotEqual, Address(regT0, OBJECT_OFFSETOF(AJArray, m_vectorMode)), Imm32(AJArray::Int32Vector)));
+    addSlowCase(branch32(AboveOrEqual, regT2, Address(regT3, OBJECT_OFFSETOF(ArrayStorage, m_numValuesInVector))));
+    load32(BaseIndex(regT3, regT2, TimesFour, OBJECT_OFFSETOF(ArrayStorage, m_vector[0])), regT0);
+    move(Imm32(AJValue::Int32Tag), regT1);
+    Jump int32Loaded = jump();
+
+    // Int32Array elements are loaded here too. The other views have no
+    // inline path, since the assembler has no byte or float loads; the stub
+    // handles them without a generic property lookup.
+    notArray.link(this);
+    addSlowCase(branchPtr(NotEqual, Address(regT0), ImmPtr(m_globalData->jsTypedArrayVPtrs[AJTypedArray::Int32])));
+    addSlowCase(branch32(AboveOrEqual, regT2, Address(regT0, OBJECT_OFFSETOF(AJTypedArray, m_length))));
+    loadPtr(Address(regT0, OBJECT_OFFSETOF(AJTypedArray, m_data)), regT3);
+    load32(BaseIndex(regT3, regT2, TimesFour), regT0);
+    move(Imm32(AJValue::Int32Tag), regT1);
+
+    done.link(this);
+    int32Loaded.link(this);
     emitStore(dst, regT1, regT0);
     map(m_bytecodeIndex + OPCODE_LENGTH(op_get_by_val), dst, regT1, regT0);
 }
@@ -351,7 +375,13 @@ void JIT::emitSlow_op_get_by_val(Instruction* currentInstruction, Vector<SlowCas
     linkSlowCaseIfNotAJCell(iter, base); // base cell check
 
     Jump nonCell = jump();
-    linkSlowCase(iter); // base array check
+    linkSlowCase(iter); // vector length check
+    linkSlowCase(iter); // empty value
+    linkSlowCase(iter); // vector mode check
+    linkSlowCase(iter); // int32 vector length check
+    Jump arraySlowCase = jump();
+
+    linkSlowCase(iter); // base array or Int32Array check
     Jump notString = branchPtr(NotEqual, Address(regT0), ImmPtr(m_globalData->jsStringVPtr));
     emitNakedCall(m_globalData->getThunk(stringGetByValStubGenerator)->generatedJITCode().addressForCall());
     Jump failed = branchTestPtr(Zero, regT0);
@@ -359,10 +389,9 @@ void JIT::emitSlow_op_get_by_val(Instruction* currentInstruction, Vector<SlowCas
     emitJumpSlowToHot(jump(), OPCODE_LENGTH(op_get_by_val));
     failed.link(this);
     notString.link(this);
+    linkSlowCase(iter); // Int32Array length check
     nonCell.link(this);
-
-    linkSlowCase(iter); // vector length check
-    linkSlowCase(iter); // empty value
+    arraySlowCase.link(this);
     
     JITStubCall stubCall(this, cti_op_get_by_val);
     stubCall.addArgument(base);
@@ -380,10 +409,11 @@ void JIT::emit_op_put_by_val(Instruction* currentInstruction)
     
     addSlowCase(branch32(NotEqual, regT3, Imm32(AJValue::Int32Tag)));
     emitJumpSlowCaseIfNotAJCell(base, regT1);
-    addSlowCase(branchPtr(NotEqual, Address(regT0), ImmPtr(m_globalData->jsArrayVPtr)));
+    Jump notArray = branchPtr(NotEqual, Address(regT0), ImmPtr(m_globalData->jsArrayVPtr));
     addSlowCase(branch32(AboveOrEqual, regT2, Address(regT0, OBJECT_OFFSETOF(AJArray, m_vectorLength))));
     
     loadPtr(Address(regT0, OBJECT_OFFSETOF(AJArray, m_storage)), regT3);
+    Jump notValueVector = branch32(NotEqual, Address(regT0, OBJECT_OFFSETOF(AJArray, m_vectorMode)), Imm32(AJArray::ValueVector));
     
     Jump empty = branch32(Equal, BaseIndex(regT3, regT2, TimesEight, OBJECT_OFFSETOF(ArrayStorage, m_vector[0]) + 4), Imm32(AJValue::EmptyValueTag));
     
@@ -400,8 +430,45 @@ void JIT::emit_op_put_by_val(Instruction* currentInstruction)
     add32(Imm32(1), regT2, regT0);
     store32(regT0, Address(regT3, OBJECT_OFFSETOF(ArrayStorage, m_length)));
     jump().linkTo(storeResult, this);
-    
+
+    // Int32s go into an Int32Vector here, anywhere up to just past its last value.
+    notValueVector.link(this);
+    addSlowCase(branch32(NotEqual, Address(regT0, OBJECT_OFFSETOF(AJArray, m_vectorMode)), Imm32(AJArray::Int32Vector)));
+    emitLoad(value, regT1, regT0);
+    addSlowCase(branch32(NotEqual, regT1, Imm32(AJValue::Int32Tag)));
+    Jump append = branch32(AboveOrEqual, regT2, Address(regT3, OBJECT_OFFSETOF(ArrayStorage, m_numValuesInVector)));
+
+    Label storeInt32(this);
+    store32(regT0, BaseIndex(regT3, regT2, TimesFour, OBJECT_OFFSETOF(ArrayStorage, m_vector[0])));
+    Jump int32Stored = jump();
+
+    append.link(this);
+    addSlowCase(branch32(NotEqual, regT2, Address(regT3, OBJECT_OFFSETOF(ArrayStorage, m_numValuesInVector)))); // would leave a hole
+    add32(Imm32(1), Address(regT3, OBJECT_OFFSETOF(ArrayStorage, m_numValuesInVector)));
+    branch32(Below, regT2, Address(regT3, OBJECT_OFFSETOF(ArrayStorage, m_length))).linkTo(storeInt32, this);
+
+    add32(Imm32(1), regT2, regT1);
+    store32(regT1, Address(regT3, OBJECT_OFFSETOF(ArrayStorage, m_length)));
+    jump().linkTo(storeInt32, this);
+
+    int32Stored.link(this);
     end.link(this);
+
+    emitLoadPayload(base, regT0);
+    emitWriteBarrier(regT0, regT1);
+    Jump done = jump();
+
+    // Int32s go into an Int32Array here, with no write barrier since they
+    // are not cells.
+    notArray.link(this);
+    addSlowCase(branchPtr(NotEqual, Address(regT0), ImmPtr(m_globalData->jsTypedArrayVPtrs[AJTypedArray::Int32])));
+    addSlowCase(branch32(AboveOrEqual, regT2, Address(regT0, OBJECT_OFFSETOF(AJTypedArray, m_length))));
+    loadPtr(Address(regT0, OBJECT_OFFSETOF(AJTypedArray, m_data)), regT3);
+    emitLoad(value, regT1, regT0);
+    addSlowCase(branch32(NotEqual, regT1, Imm32(AJValue::Int32Tag)));
+    store32(regT0, BaseIndex(regT3, regT2, TimesFour));
+
+    done.link(this);
 }
 
 void JIT::emitSlow_op_put_by_val(Instruction* currentInstruction, Vector<SlowCaseEntry>::iterator& iter)
@@ -412,8 +479,13 @@ void JIT::emitSlow_op_put_by_val(Instruction* currentInstruction, Vector<SlowCas
     
     linkSlowCase(iter); // property int32 check
     linkSlowCaseIfNotAJCell(iter, base); // base cell check
-    linkSlowCase(iter); // base not array check
     linkSlowCase(iter); // in vector check
+    linkSlowCase(iter); // vector mode check
+    linkSlowCase(iter); // int32 value check
+    linkSlowCase(iter); // int32 vector hole check
+    linkSlowCase(iter); // base not array or Int32Array check
+    linkSlowCase(iter); // Int32Array length check
+    linkSlowCase(iter); // Int32Array int32 value check
     
     JITStubCall stubPutByValCall(this, cti_op_put_by_val);
     stubPutByValCall.addArgument(base);
@@ -544,6 +616,10 @@ void JIT::emit_op_put_by_id(Instruction* currentInstruction)
     
     ASSERT(differenceBetween(hotPathBegin, displacementLabel1) == patchOffsetPutByIdPropertyMapOffset1);
     ASSERT(differenceBetween(hotPathBegin, displacementLabel2) == patchOffsetPutByIdPropertyMapOffset2);
+
+    // The store above overwrote the base register with its property storage.
+    emitLoadPayload(base, regT0);
+    emitWriteBarrier(regT0, regT1);
 }
 
 void JIT::emitSlow_op_put_by_id(Instruction* currentInstruction, Vector<SlowCaseEntry>::iterator& iter)
@@ -646,9 +722,13 @@ void JIT::privateCompilePutByIdTransition(StructureStubInfo* stubInfo, Structure
         restoreReturnAddressBeforeReturn(regT3);
     }
     
-    sub32(Imm32(1), AbsoluteAddress(oldStructure->addressOfCount()));
-    add32(Imm32(1), AbsoluteAddress(newStructure->addressOfCount()));
+    // Cells do not count references to their Structure, but mark it when
+    // they start using it, like AJObject::setStructure().
+    store32(Imm32(1), &newStructure->m_isMarked);
     storePtr(ImmPtr(newStructure), Address(regT0, OBJECT_OFFSETOF(AJCell, m_structure)));
+
+    move(regT0, regT2);
+    emitWriteBarrier(regT2, regT3);
     
     load32(Address(stackPointerRegister, OBJECT_OFFSETOF(struct JITStackFrame, args[2]) + sizeof(void*)), regT3);
     load32(Address(stackPointerRegister, OBJECT_OFFSETOF(struct JITStackFrame, args[2]) + sizeof(void*) + 4), regT2);
@@ -911,6 +991,69 @@ void JIT::privateCompileGetByIdSelfList(StructureStubInfo* stubInfo, Polymorphic
     repatchBuffer.relink(jumpLocation, entryLabel);
 }
 
+void JIT::privateCompileGetByIdMegamorphic(StructureStubInfo* stubInfo, CodeLocationLabel failureTarget, const Identifier& ident)
+{
+    // regT0 holds a AJCell*, and regT1 its tag, which the slow case needs
+    // back if the cache misses.
+    UString::Rep* name = ident.ustring().rep();
+    JumpList failureCases;
+
+    // Find the entry the way MegamorphicCache::index does. Only the low bits
+    // of the shifted Structure are kept, so it does not matter which way it
+    // is shifted.
+    loadPtr(Address(regT0, OBJECT_OFFSETOF(AJCell, m_structure)), regT2);
+    move(regT2, regT3);
+    rshift32(Imm32(MegamorphicCache::structureShift), regT3);
+    xor32(Imm32(name->existingHash() & (MegamorphicCache::size - 1)), regT3);
+    and32(Imm32(MegamorphicCache::size - 1), regT3);
+    lshift32(Imm32(MegamorphicCache::entrySizeShift), regT3);
+    addPtr(ImmPtr(m_globalData->megamorphicCache.entries()), regT3);
+    failureCases.append(branchPtr(NotEqual, Address(regT3, OBJECT_OFFSETOF(MegamorphicCache::Entry, structure)), regT2));
+    failureCases.append(branchPtr(NotEqual, Address(regT3, OBJECT_OFFSETOF(MegamorphicCache::Entry, name)), ImmPtr(name)));
+
+    // A property of the prototype is read from the prototype, if its Structure
+    // is still the one the entry was made with.
+    Jump isPrototypeProperty = branchTestPtr(NonZero, Address(regT3, OBJECT_OFFSETOF(MegamorphicCache::Entry, prototypeStructure)));
+    loadPtr(Address(regT0, OBJECT_OFFSETOF(AJCell, m_structure)), regT1);
+    Jump holderLoaded = jump();
+    isPrototypeProperty.link(this);
+    loadPtr(Address(regT2, OBJECT_OFFSETOF(Structure, m_prototype) + OBJECT_OFFSETOF(AJValue, u.asBits.payload)), regT2);
+    loadPtr(Address(regT2, OBJECT_OFFSETOF(AJCell, m_structure)), regT2);
+    failureCases.append(branchPtr(NotEqual, Address(regT3, OBJECT_OFFSETOF(MegamorphicCache::Entry, prototypeStructure)), regT2));
+    move(regT2, regT1);
+    loadPtr(Address(regT0, OBJECT_OFFSETOF(AJCell, m_structure)), regT0);
+    loadPtr(Address(regT0, OBJECT_OFFSETOF(Structure, m_prototype) + OBJECT_OFFSETOF(AJValue, u.asBits.payload)), regT0);
+    holderLoaded.link(this);
+
+    // regT0 holds the object with the property, and regT1 its Structure.
+    load32(Address(regT3, OBJECT_OFFSETOF(MegamorphicCache::Entry, offset)), regT2);
+    load32(Address(regT1, OBJECT_OFFSETOF(Structure, m_inlineStorageCapacity)), regT3);
+    Jump notUsingInlineStorage = branch32(NotEqual, Address(regT1, OBJECT_OFFSETOF(Structure, m_propertyStorageCapacity)), regT3);
+    addPtr(Imm32(OBJECT_OFFSETOF(AJObject, m_inlineStorage)), regT0, regT3);
+    Jump storageLoaded = jump();
+    notUsingInlineStorage.link(this);
+    loadPtr(Address(regT0, OBJECT_OFFSETOF(AJObject, m_externalStorage)), regT3);
+    storageLoaded.link(this);
+    load32(BaseIndex(regT3, regT2, TimesEight, OBJECT_OFFSETOF(AJValue, u.asBits.payload)), regT0);
+    load32(BaseIndex(regT3, regT2, TimesEight, OBJECT_OFFSETOF(AJValue, u.asBits.tag)), regT1);
+    Jump success = jump();
+
+    LinkBuffer patchBuffer(this, m_codeBlock->executablePool(), 0);
+
+    // Misses go on to the stubs for the Structures the site has cached itself.
+    patchBuffer.link(failureCases, failureTarget);
+
+    // On success return back to the hot patch code, at a point it will perform the store to dest for us.
+    patchBuffer.link(success, stubInfo->hotPathBegin.labelAtOffset(patchOffsetGetByIdPutResult));
+
+    CodeLocationLabel entryLabel = patchBuffer.finalizeCodeAddendum();
+
+    // Finally patch the jump to slow case back in the hot path to jump here instead.
+    CodeLocationJump jumpLocation = stubInfo->hotPathBegin.jumpAtOffset(patchOffsetGetByIdBranchToSlowCase);
+    RepatchBuffer repatchBuffer(m_codeBlock);
+    repatchBuffer.relink(jumpLocation, entryLabel);
+}
+
 void JIT::privateCompileGetByIdProtoList(StructureStubInfo* stubInfo, PolymorphicAccessStructureList* prototypeStructures, int currentIndex, Structure* structure, Structure* prototypeStructure, const Identifier& ident, const PropertySlot& slot, size_t cachedOffset, CallFrame* callFrame)
 {
     // regT0 holds a AJCell*
@@ -1140,10 +1283,11 @@ void JIT::privateCompileGetByIdChain(StructureStubInfo* stubInfo, Structure* str
 void JIT::compileGetDirectOffset(RegisterID base, RegisterID resultTag, RegisterID resultPayload, RegisterID structure, RegisterID offset)
 {
     ASSERT(sizeof(((Structure*)0)->m_propertyStorageCapacity) == sizeof(int32_t));
-    ASSERT(sizeof(AJObject::inlineStorageCapacity) == sizeof(int32_t));
+    ASSERT(sizeof(((Structure*)0)->m_inlineStorageCapacity) == sizeof(int32_t));
     ASSERT(sizeof(AJValue) == 8);
     
-    Jump notUsingInlineStorage = branch32(NotEqual, Address(structure, OBJECT_OFFSETOF(Structure, m_propertyStorageCapacity)), Imm32(AJObject::inlineStorageCapacity));
+    load32(Address(structure, OBJECT_OFFSETOF(Structure, m_inlineStorageCapacity)), resultTag);
+    Jump notUsingInlineStorage = branch32(NotEqual, Address(structure, OBJECT_OFFSETOF(Structure, m_propertyStorageCapacity)), resultTag);
     loadPtr(BaseIndex(base, offset, TimesEight, OBJECT_OFFSETOF(AJObject, m_inlineStorage)+OBJECT_OFFSETOF(AJValue, u.asBits.payload)), resultPayload);
     loadPtr(BaseIndex(base, offset, TimesEight, OBJECT_OFFSETOF(AJObject, m_inlineStorage)+OBJECT_OFFSETOF(AJValue, u.asBits.tag)), resultTag);
     Jump finishedLoad = jump();
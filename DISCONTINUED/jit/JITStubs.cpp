@@ -66,6 +66,7 @@ limitations under the License.
 #include "AJPropertyNameIterator.h"
 #include "AJStaticScopeObject.h"
 #include "AJString.h"
+#include "AJTypedArray.h"
 #include "ObjectPrototype.h"
 #include "Operations.h"
 #include "Parser.h"
@@ -1291,6 +1292,9 @@ DEFINE_STUB_FUNCTION(int, timeout_check)
     } else if (timeoutChecker.didTimeOut(stackFrame.callFrame)) {
         globalData->exception = createInterruptedExecutionException(globalData);
         VM_THROW_EXCEPTION_AT_END();
+    } else if (globalData->heap.isOverHardLimit() && globalData->heap.shouldThrowOutOfMemoryError()) {
+        globalData->exception = createOutOfMemoryError(stackFrame.callFrame);
+        VM_THROW_EXCEPTION_AT_END();
     }
 
     return timeoutChecker.ticksUntilNextCheck();
@@ -1348,16 +1352,25 @@ DEFINE_STUB_FUNCTION(void, op_put_by_id_direct_generic)
     CHECK_FOR_EXCEPTION_AT_END();
 }
 
+static inline AJValue getByIdMegamorphic(CallFrame* callFrame, AJValue baseValue, const Identifier& ident)
+{
+    MegamorphicCache& megamorphicCache = callFrame->globalData().megamorphicCache;
+    AJValue result;
+    if (baseValue.isCell() && megamorphicCache.get(baseValue.asCell(), ident, result))
+        return result;
+
+    PropertySlot slot(baseValue);
+    result = baseValue.get(callFrame, ident, slot);
+    if (!callFrame->hadException())
+        megamorphicCache.add(baseValue, ident, slot);
+    return result;
+}
+
 DEFINE_STUB_FUNCTION(EncodedAJValue, op_get_by_id_generic)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
 
-    CallFrame* callFrame = stackFrame.callFrame;
-    Identifier& ident = stackFrame.args[1].identifier();
-
-    AJValue baseValue = stackFrame.args[0].jsValue();
-    PropertySlot slot(baseValue);
-    AJValue result = baseValue.get(callFrame, ident, slot);
+    AJValue result = getByIdMegamorphic(stackFrame.callFrame, stackFrame.args[0].jsValue(), stackFrame.args[1].identifier());
 
     CHECK_FOR_EXCEPTION_AT_END();
     return AJValue::encode(result);
@@ -1576,8 +1589,10 @@ DEFINE_STUB_FUNCTION(EncodedAJValue, op_get_by_id_self_fail)
             stubInfo->u.getByIdSelfList.listSize++;
             JIT::compileGetByIdSelfList(callFrame->scopeChain()->globalData, codeBlock, stubInfo, polymorphicStructureList, listIndex, asCell(baseValue)->structure(), ident, slot, slot.cachedOffset());
 
-            if (listIndex == (POLYMORPHIC_LIST_CACHE_SIZE - 1))
+            if (listIndex == (POLYMORPHIC_LIST_CACHE_SIZE - 1)) {
+                JIT::compileGetByIdMegamorphic(callFrame->scopeChain()->globalData, codeBlock, stubInfo, polymorphicStructureList->list[listIndex].stubRoutine, ident);
                 ctiPatchCallByReturnAddress(codeBlock, STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_id_generic));
+            }
         }
     } else
         ctiPatchCallByReturnAddress(callFrame->codeBlock(), STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_id_generic));
@@ -1688,8 +1703,10 @@ DEFINE_STUB_FUNCTION(EncodedAJValue, op_get_by_id_proto_list)
         if (listIndex < POLYMORPHIC_LIST_CACHE_SIZE) {
             JIT::compileGetByIdProtoList(callFrame->scopeChain()->globalData, callFrame, codeBlock, stubInfo, prototypeStructureList, listIndex, structure, slotBaseObject->structure(), propertyName, slot, offset);
 
-            if (listIndex == (POLYMORPHIC_LIST_CACHE_SIZE - 1))
+            if (listIndex == (POLYMORPHIC_LIST_CACHE_SIZE - 1)) {
+                JIT::compileGetByIdMegamorphic(callFrame->scopeChain()->globalData, codeBlock, stubInfo, prototypeStructureList->list[listIndex].stubRoutine, propertyName);
                 ctiPatchCallByReturnAddress(codeBlock, STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_id_proto_list_full));
+            }
         }
     } else if (size_t count = normalizePrototypeChain(callFrame, baseValue, slot.slotBase(), propertyName, offset)) {
         ASSERT(!asCell(baseValue)->structure()->isDictionary());
@@ -1700,8 +1717,10 @@ DEFINE_STUB_FUNCTION(EncodedAJValue, op_get_by_id_proto_list)
             StructureChain* protoChain = structure->prototypeChain(callFrame);
             JIT::compileGetByIdChainList(callFrame->scopeChain()->globalData, callFrame, codeBlock, stubInfo, prototypeStructureList, listIndex, structure, protoChain, count, propertyName, slot, offset);
 
-            if (listIndex == (POLYMORPHIC_LIST_CACHE_SIZE - 1))
+            if (listIndex == (POLYMORPHIC_LIST_CACHE_SIZE - 1)) {
+                JIT::compileGetByIdMegamorphic(callFrame->scopeChain()->globalData, codeBlock, stubInfo, prototypeStructureList->list[listIndex].stubRoutine, propertyName);
                 ctiPatchCallByReturnAddress(codeBlock, STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_id_proto_list_full));
+            }
         }
     } else
         ctiPatchCallByReturnAddress(codeBlock, STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_id_proto_fail));
@@ -1713,9 +1732,7 @@ DEFINE_STUB_FUNCTION(EncodedAJValue, op_get_by_id_proto_list_full)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
 
-    AJValue baseValue = stackFrame.args[0].jsValue();
-    PropertySlot slot(baseValue);
-    AJValue result = baseValue.get(stackFrame.callFrame, stackFrame.args[1].identifier(), slot);
+    AJValue result = getByIdMegamorphic(stackFrame.callFrame, stackFrame.args[0].jsValue(), stackFrame.args[1].identifier());
 
     CHECK_FOR_EXCEPTION_AT_END();
     return AJValue::encode(result);
@@ -2109,10 +2126,10 @@ DEFINE_STUB_FUNCTION(AJObject*, op_construct_JSConstruct)
 
     Structure* structure;
     if (stackFrame.args[3].jsValue().isObject())
-        structure = asObject(stackFrame.args[3].jsValue())->inheritorID();
+        structure = asObject(stackFrame.args[3].jsValue())->inheritorIDForConstruct();
     else
         structure = constructor->scope().node()->globalObject->emptyObjectStructure();
-    return new (stackFrame.globalData) AJObject(structure);
+    return AJObject::createForConstruct(stackFrame.globalData, structure);
 }
 
 DEFINE_STUB_FUNCTION(EncodedAJValue, op_construct_NotJSConstruct)
@@ -2173,6 +2190,10 @@ DEFINE_STUB_FUNCTION(EncodedAJValue, op_get_by_val)
 
     if (subscript.isUInt32()) {
         uint32_t i = subscript.asUInt32();
+        if (isAJArray(globalData, baseValue) && asArray(baseValue)->canGetIndex(i)) {
+            // The values the hot path leaves to us are unboxed numbers, and boxing one cannot throw.
+            return AJValue::encode(asArray(baseValue)->getIndex(callFrame, i));
+        }
         if (isAJString(globalData, baseValue) && asString(baseValue)->canGetIndex(i)) {
             ctiPatchCallByReturnAddress(callFrame->codeBlock(), STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_val_string));
             AJValue result = asString(baseValue)->getIndex(callFrame, i);
@@ -2184,6 +2205,11 @@ DEFINE_STUB_FUNCTION(EncodedAJValue, op_get_by_val)
             ctiPatchCallByReturnAddress(callFrame->codeBlock(), STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_val_byte_array));
             return AJValue::encode(asByteArray(baseValue)->getIndex(callFrame, i));
         }
+        if (isAJTypedArray(globalData, baseValue) && asTypedArray(baseValue)->canAccessIndex(i)) {
+            // Typed array accesses cannot throw either.
+            ctiPatchCallByReturnAddress(callFrame->codeBlock(), STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_val_typed_array));
+            return AJValue::encode(asTypedArray(baseValue)->getIndex(callFrame, i));
+        }
         AJValue result = baseValue.get(callFrame, i);
         CHECK_FOR_EXCEPTION();
         return AJValue::encode(result);
@@ -2256,6 +2282,35 @@ DEFINE_STUB_FUNCTION(EncodedAJValue, op_get_by_val_byte_array)
     return AJValue::encode(result);
 }
 
+DEFINE_STUB_FUNCTION(EncodedAJValue, op_get_by_val_typed_array)
+{
+    STUB_INIT_STACK_FRAME(stackFrame);
+    
+    CallFrame* callFrame = stackFrame.callFrame;
+    AJGlobalData* globalData = stackFrame.globalData;
+    
+    AJValue baseValue = stackFrame.args[0].jsValue();
+    AJValue subscript = stackFrame.args[1].jsValue();
+    
+    AJValue result;
+
+    if (LIKELY(subscript.isUInt32())) {
+        uint32_t i = subscript.asUInt32();
+        if (isAJTypedArray(globalData, baseValue) && asTypedArray(baseValue)->canAccessIndex(i))
+            return AJValue::encode(asTypedArray(baseValue)->getIndex(callFrame, i));
+
+        result = baseValue.get(callFrame, i);
+        if (!isAJTypedArray(globalData, baseValue))
+            ctiPatchCallByReturnAddress(callFrame->codeBlock(), STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_val));
+    } else {
+        Identifier property(callFrame, subscript.toString(callFrame));
+        result = baseValue.get(callFrame, property);
+    }
+    
+    CHECK_FOR_EXCEPTION_AT_END();
+    return AJValue::encode(result);
+}
+
 DEFINE_STUB_FUNCTION(EncodedAJValue, op_sub)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
@@ -2290,7 +2345,7 @@ DEFINE_STUB_FUNCTION(void, op_put_by_val)
         if (isAJArray(globalData, baseValue)) {
             AJArray* jsArray = asArray(baseValue);
             if (jsArray->canSetIndex(i))
-                jsArray->setIndex(i, value);
+                jsArray->setIndex(callFrame, i, value);
             else
                 jsArray->AJArray::put(callFrame, i, value);
         } else if (isAJArrayArray(globalData, baseValue) && asByteArray(baseValue)->canAccessIndex(i)) {
@@ -2309,6 +2364,20 @@ DEFINE_STUB_FUNCTION(void, op_put_by_val)
             }
 
             baseValue.put(callFrame, i, value);
+        } else if (isAJTypedArray(globalData, baseValue) && asTypedArray(baseValue)->canAccessIndex(i)) {
+            AJTypedArray* jsTypedArray = asTypedArray(baseValue);
+            ctiPatchCallByReturnAddress(callFrame->codeBlock(), STUB_RETURN_ADDRESS, FunctionPtr(cti_op_put_by_val_typed_array));
+            // Storing a number cannot throw, so return without the exception check.
+            if (value.isInt32()) {
+                jsTypedArray->setIndex(i, value.asInt32());
+                return;
+            }
+            double dValue = 0;
+            if (value.getNumber(dValue)) {
+                jsTypedArray->setIndex(i, dValue);
+                return;
+            }
+            jsTypedArray->setIndex(callFrame, i, value);
         } else
             baseValue.put(callFrame, i, value);
     } else {
@@ -2365,6 +2434,47 @@ DEFINE_STUB_FUNCTION(void, op_put_by_val_byte_array)
     CHECK_FOR_EXCEPTION_AT_END();
 }
 
+DEFINE_STUB_FUNCTION(void, op_put_by_val_typed_array)
+{
+    STUB_INIT_STACK_FRAME(stackFrame);
+    
+    CallFrame* callFrame = stackFrame.callFrame;
+    AJGlobalData* globalData = stackFrame.globalData;
+    
+    AJValue baseValue = stackFrame.args[0].jsValue();
+    AJValue subscript = stackFrame.args[1].jsValue();
+    AJValue value = stackFrame.args[2].jsValue();
+    
+    if (LIKELY(subscript.isUInt32())) {
+        uint32_t i = subscript.asUInt32();
+        if (isAJTypedArray(globalData, baseValue) && asTypedArray(baseValue)->canAccessIndex(i)) {
+            AJTypedArray* jsTypedArray = asTypedArray(baseValue);
+            if (value.isInt32()) {
+                jsTypedArray->setIndex(i, value.asInt32());
+                return;
+            }
+            double dValue = 0;
+            if (value.getNumber(dValue)) {
+                jsTypedArray->setIndex(i, dValue);
+                return;
+            }
+            jsTypedArray->setIndex(callFrame, i, value);
+        } else {
+            if (!isAJTypedArray(globalData, baseValue))
+                ctiPatchCallByReturnAddress(callFrame->codeBlock(), STUB_RETURN_ADDRESS, FunctionPtr(cti_op_put_by_val));
+            baseValue.put(callFrame, i, value);
+        }
+    } else {
+        Identifier property(callFrame, subscript.toString(callFrame));
+        if (!stackFrame.globalData->exception) { // Don't put to an object if toString threw an exception.
+            PutPropertySlot slot;
+            baseValue.put(callFrame, property, value, slot);
+        }
+    }
+    
+    CHECK_FOR_EXCEPTION_AT_END();
+}
+
 DEFINE_STUB_FUNCTION(EncodedAJValue, op_lesseq)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
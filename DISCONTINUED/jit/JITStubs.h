@@ -330,6 +330,7 @@ extern "C" {
     EncodedAJValue JIT_STUB cti_op_get_by_id_string_fail(STUB_ARGS_DECLARATION);
     EncodedAJValue JIT_STUB cti_op_get_by_val(STUB_ARGS_DECLARATION);
     EncodedAJValue JIT_STUB cti_op_get_by_val_byte_array(STUB_ARGS_DECLARATION);
+    EncodedAJValue JIT_STUB cti_op_get_by_val_typed_array(STUB_ARGS_DECLARATION);
     EncodedAJValue JIT_STUB cti_op_get_by_val_string(STUB_ARGS_DECLARATION);
     EncodedAJValue JIT_STUB cti_op_in(STUB_ARGS_DECLARATION);
     EncodedAJValue JIT_STUB cti_op_instanceof(STUB_ARGS_DECLARATION);
@@ -407,6 +408,7 @@ extern "C" {
     void JIT_STUB cti_op_put_by_index(STUB_ARGS_DECLARATION);
     void JIT_STUB cti_op_put_by_val(STUB_ARGS_DECLARATION);
     void JIT_STUB cti_op_put_by_val_byte_array(STUB_ARGS_DECLARATION);
+    void JIT_STUB cti_op_put_by_val_typed_array(STUB_ARGS_DECLARATION);
     void JIT_STUB cti_op_put_getter(STUB_ARGS_DECLARATION);
     void JIT_STUB cti_op_put_setter(STUB_ARGS_DECLARATION);
     void JIT_STUB cti_op_ret_scopeChain(STUB_ARGS_DECLARATION);
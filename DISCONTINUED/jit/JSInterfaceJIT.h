@@ -195,6 +195,8 @@ namespace AJ {
 
     struct ThunkHelpers {
         static unsigned stringImplDataOffset() { return Aphid::StringImpl::dataOffset(); }
+        static unsigned stringImplFlagsOffset() { return Aphid::StringImpl::flagsOffset(); }
+        static unsigned stringImplIs8BitFlag() { return Aphid::StringImpl::flagIs8Bit(); }
         static unsigned jsStringLengthOffset() { return OBJECT_OFFSETOF(AJString, m_length); }
         static unsigned jsStringValueOffset() { return OBJECT_OFFSETOF(AJString, m_value); }
     };
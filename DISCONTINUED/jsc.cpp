@@ -91,6 +91,10 @@ static bool fillBufferWithContentsOfFile(const UString& fileName, Vector<char>&
 static AJValue JSC_HOST_CALL functionPrint(ExecState*, AJObject*, AJValue, const ArgList&);
 static AJValue JSC_HOST_CALL functionDebug(ExecState*, AJObject*, AJValue, const ArgList&);
 static AJValue JSC_HOST_CALL functionGC(ExecState*, AJObject*, AJValue, const ArgList&);
+static AJValue JSC_HOST_CALL functionCollectIfIdle(ExecState*, AJObject*, AJValue, const ArgList&);
+static AJValue JSC_HOST_CALL functionWriteHeapSnapshot(ExecState*, AJObject*, AJValue, const ArgList&);
+static AJValue JSC_HOST_CALL functionSetMarkerThreadCount(ExecState*, AJObject*, AJValue, const ArgList&);
+static AJValue JSC_HOST_CALL functionSetHeapLimit(ExecState*, AJObject*, AJValue, const ArgList&);
 static AJValue JSC_HOST_CALL functionVersion(ExecState*, AJObject*, AJValue, const ArgList&);
 static AJValue JSC_HOST_CALL functionRun(ExecState*, AJObject*, AJValue, const ArgList&);
 static AJValue JSC_HOST_CALL functionLoad(ExecState*, AJObject*, AJValue, const ArgList&);
@@ -118,11 +122,13 @@ struct Options {
     Options()
         : interactive(false)
         , dump(false)
+        , printsCollectorSummary(false)
     {
     }
 
     bool interactive;
     bool dump;
+    bool printsCollectorSummary;
     Vector<Script> scripts;
     Vector<UString> arguments;
 };
@@ -171,6 +177,10 @@ GlobalObject::GlobalObject(const Vector<UString>& arguments)
     putDirectFunction(globalExec(), new (globalExec()) NativeFunctionWrapper(globalExec(), prototypeFunctionStructure(), 1, Identifier(globalExec(), "print"), functionPrint));
     putDirectFunction(globalExec(), new (globalExec()) NativeFunctionWrapper(globalExec(), prototypeFunctionStructure(), 0, Identifier(globalExec(), "quit"), functionQuit));
     putDirectFunction(globalExec(), new (globalExec()) NativeFunctionWrapper(globalExec(), prototypeFunctionStructure(), 0, Identifier(globalExec(), "gc"), functionGC));
+    putDirectFunction(globalExec(), new (globalExec()) NativeFunctionWrapper(globalExec(), prototypeFunctionStructure(), 1, Identifier(globalExec(), "collectIfIdle"), functionCollectIfIdle));
+    putDirectFunction(globalExec(), new (globalExec()) NativeFunctionWrapper(globalExec(), prototypeFunctionStructure(), 1, Identifier(globalExec(), "writeHeapSnapshot"), functionWriteHeapSnapshot));
+    putDirectFunction(globalExec(), new (globalExec()) NativeFunctionWrapper(globalExec(), prototypeFunctionStructure(), 1, Identifier(globalExec(), "setMarkerThreadCount"), functionSetMarkerThreadCount));
+    putDirectFunction(globalExec(), new (globalExec()) NativeFunctionWrapper(globalExec(), prototypeFunctionStructure(), 1, Identifier(globalExec(), "setHeapLimit"), functionSetHeapLimit));
     putDirectFunction(globalExec(), new (globalExec()) NativeFunctionWrapper(globalExec(), prototypeFunctionStructure(), 1, Identifier(globalExec(), "version"), functionVersion));
     putDirectFunction(globalExec(), new (globalExec()) NativeFunctionWrapper(globalExec(), prototypeFunctionStructure(), 1, Identifier(globalExec(), "run"), functionRun));
     putDirectFunction(globalExec(), new (globalExec()) NativeFunctionWrapper(globalExec(), prototypeFunctionStructure(), 1, Identifier(globalExec(), "load"), functionLoad));
@@ -215,6 +225,37 @@ AJValue JSC_HOST_CALL functionGC(ExecState* exec, AJObject*, AJValue, const ArgL
     return jsUndefined();
 }
 
+AJValue JSC_HOST_CALL functionCollectIfIdle(ExecState* exec, AJObject*, AJValue, const ArgList& args)
+{
+    AJLock lock(SilenceAssertionsOnly);
+    return jsBoolean(exec->heap()->collectIfIdle(args.at(0).toNumber(exec)));
+}
+
+AJValue JSC_HOST_CALL functionWriteHeapSnapshot(ExecState* exec, AJObject*, AJValue, const ArgList& args)
+{
+    AJLock lock(SilenceAssertionsOnly);
+    UString path = args.at(0).toString(exec);
+    if (exec->hadException())
+        return jsUndefined();
+    return jsBoolean(exec->heap()->writeSnapshot(path.UTF8String().data()));
+}
+
+AJValue JSC_HOST_CALL functionSetMarkerThreadCount(ExecState* exec, AJObject*, AJValue, const ArgList& args)
+{
+    AJLock lock(SilenceAssertionsOnly);
+    exec->heap()->setMarkerThreadCount(args.at(0).toUInt32(exec));
+    return jsNumber(exec, exec->heap()->markerThreadCount());
+}
+
+// Like the -l option; 0 removes the limit.
+AJValue JSC_HOST_CALL functionSetHeapLimit(ExecState* exec, AJObject*, AJValue, const ArgList& args)
+{
+    AJLock lock(SilenceAssertionsOnly);
+    size_t hardLimit = static_cast<size_t>(args.at(0).toNumber(exec) * 1024 * 1024);
+    exec->heap()->setHeapLimits(hardLimit / 2, hardLimit);
+    return jsUndefined();
+}
+
 AJValue JSC_HOST_CALL functionVersion(ExecState*, AJObject*, AJValue, const ArgList&)
 {
     // We need this function for compatibility with the Mozilla JS tests but for now
@@ -472,11 +513,15 @@ static void runInteractive(GlobalObject* globalObject)
 static NO_RETURN void printUsageStatement(AJGlobalData* globalData, bool help = false)
 {
     fprintf(stderr, "Usage: jsc [options] [files] [-- arguments]\n");
+    fprintf(stderr, "  -b <ms>    Marks the heap incrementally, in steps of about ms milliseconds\n");
     fprintf(stderr, "  -d         Dumps bytecode (debug builds only)\n");
     fprintf(stderr, "  -e         Evaluate argument as script code\n");
     fprintf(stderr, "  -f         Specifies a source file (deprecated)\n");
+    fprintf(stderr, "  -g         Prints a summary of garbage collection at exit\n");
     fprintf(stderr, "  -h|--help  Prints this help message\n");
     fprintf(stderr, "  -i         Enables interactive mode (default if no files are specified)\n");
+    fprintf(stderr, "  -l <mb>    Limits the heap to mb megabytes, collecting more often past half of that\n");
+    fprintf(stderr, "  -m <n>     Marks the heap with n threads during garbage collection\n");
 #if HAVE(SIGNAL_H)
     fprintf(stderr, "  -s         Installs signal handlers that exit on a crash (Unix platforms only)\n");
 #endif
@@ -510,6 +555,29 @@ static void parseArguments(int argc, char** argv, Options& options, AJGlobalData
             options.dump = true;
             continue;
         }
+        if (!strcmp(arg, "-g")) {
+            options.printsCollectorSummary = true;
+            continue;
+        }
+        if (!strcmp(arg, "-b")) {
+            if (++i == argc)
+                printUsageStatement(globalData);
+            globalData->heap.setIncrementalMarkingBudget(atof(argv[i]));
+            continue;
+        }
+        if (!strcmp(arg, "-l")) {
+            if (++i == argc)
+                printUsageStatement(globalData);
+            size_t hardLimit = static_cast<size_t>(atof(argv[i]) * 1024 * 1024);
+            globalData->heap.setHeapLimits(hardLimit / 2, hardLimit);
+            continue;
+        }
+        if (!strcmp(arg, "-m")) {
+            if (++i == argc)
+                printUsageStatement(globalData);
+            globalData->heap.setMarkerThreadCount(atoi(argv[i]));
+            continue;
+        }
         if (!strcmp(arg, "-s")) {
 #if HAVE(SIGNAL_H)
             signal(SIGILL, _exit);
@@ -535,6 +603,67 @@ static void parseArguments(int argc, char** argv, Options& options, AJGlobalData
         options.arguments.append(argv[i]);
 }
 
+static bool hasMoreBytes(const pair<const char*, Heap::TypeStatistics>& a, const pair<const char*, Heap::TypeStatistics>& b)
+{
+    return a.second.bytes > b.second.bytes;
+}
+
+static void printCollectorSummary(Heap& heap)
+{
+    static const char* const triggerNames[] = { "allocation", "extra cost", "explicit", "idle", "memory pressure" };
+    static const size_t classesToPrint = 10;
+
+    Heap::Statistics statistics = heap.statistics();
+    fprintf(stderr, "GC: %zu collections (%zu minor, %zu major)\n", heap.collectionCount(), statistics.minorCollections, statistics.majorCollections);
+    fprintf(stderr, "  objects: %zu constructed, %zu presized; %zu property storage spills\n", statistics.constructedObjects, statistics.presizedObjects, statistics.propertyStorageSpills);
+    fprintf(stderr, "  structures: %zu in the heap, %zu freed\n", statistics.structures, statistics.freedStructures);
+
+    Heap::CollectionRecord records[COLLECTION_RECORD_COUNT];
+    size_t recordCount = heap.copyCollectionRecords(records, COLLECTION_RECORD_COUNT);
+    if (recordCount) {
+        double markTime = 0;
+        double sweepTime = 0;
+        size_t blocksFreed = 0;
+        size_t triggerCounts[sizeof(triggerNames) / sizeof(triggerNames[0])] = { 0 };
+        for (size_t i = 0; i < recordCount; ++i) {
+            markTime += records[i].markTime;
+            sweepTime += records[i].sweepTime;
+            blocksFreed += records[i].blocksFreed;
+            ++triggerCounts[records[i].trigger];
+        }
+        fprintf(stderr, "  last %zu: %.2fms marking, %.2fms sweeping, %zu blocks freed; triggered by", recordCount, markTime, sweepTime, blocksFreed);
+        for (size_t i = 0; i < sizeof(triggerNames) / sizeof(triggerNames[0]); ++i) {
+            if (triggerCounts[i])
+                fprintf(stderr, " %s %zu", triggerNames[i], triggerCounts[i]);
+        }
+        const Heap::CollectionRecord& last = records[recordCount - 1];
+        fprintf(stderr, "\n  last: %zuKB live before, %zuKB after\n", last.liveBytesBefore / 1024, last.liveBytesAfter / 1024);
+    }
+
+    fprintf(stderr, "  pauses:");
+    const size_t* pauses = heap.pauseHistogram();
+    double limit = 0.25;
+    for (size_t i = 0; i < PAUSE_HISTOGRAM_SIZE; ++i, limit *= 2) {
+        if (!pauses[i])
+            continue;
+        if (i < PAUSE_HISTOGRAM_SIZE - 1)
+            fprintf(stderr, " <%gms %zu", limit, pauses[i]);
+        else
+            fprintf(stderr, " >=%gms %zu", limit / 2, pauses[i]);
+    }
+    fprintf(stderr, "\n");
+
+    OwnPtr<Heap::TypeStatisticsMap> typeStatistics(heap.objectTypeStatistics());
+    Vector<pair<const char*, Heap::TypeStatistics> > classes;
+    Heap::TypeStatisticsMap::iterator end = typeStatistics->end();
+    for (Heap::TypeStatisticsMap::iterator it = typeStatistics->begin(); it != end; ++it)
+        classes.append(*it);
+    std::sort(classes.begin(), classes.end(), hasMoreBytes);
+    fprintf(stderr, "  live classes by size:\n");
+    for (size_t i = 0; i < classes.size() && i < classesToPrint; ++i)
+        fprintf(stderr, "    %-20s %8zu %8zuKB\n", classes[i].first, classes[i].second.count, classes[i].second.bytes / 1024);
+}
+
 int jscmain(int argc, char** argv, AJGlobalData* globalData)
 {
     AJLock lock(SilenceAssertionsOnly);
@@ -546,6 +675,8 @@ int jscmain(int argc, char** argv, AJGlobalData* globalData)
     bool success = runWithScripts(globalObject, options.scripts, options.dump);
     if (options.interactive && success)
         runInteractive(globalObject);
+    if (options.printsCollectorSummary)
+        printCollectorSummary(globalData->heap);
 
     return success ? 0 : 3;
 }
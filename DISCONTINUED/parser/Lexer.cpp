@@ -76,75 +76,99 @@ Lexer::~Lexer()
     m_keywordTable.deleteTable();
 }
 
-inline const UChar* Lexer::currentCharacter() const
+template <> inline Lexer::Code<LChar>& Lexer::code<LChar>()
 {
-    return m_code - 4;
+    return m_code8;
 }
 
-inline int Lexer::currentOffset() const
+template <> inline Lexer::Code<UChar>& Lexer::code<UChar>()
 {
-    return currentCharacter() - m_codeStart;
+    return m_code16;
 }
 
-ALWAYS_INLINE void Lexer::shift1()
+template <> inline const Lexer::Code<LChar>& Lexer::code<LChar>() const
 {
+    return m_code8;
+}
+
+template <> inline const Lexer::Code<UChar>& Lexer::code<UChar>() const
+{
+    return m_code16;
+}
+
+template <typename CharType> inline const CharType* Lexer::currentCharacter() const
+{
+    return code<CharType>().position - 4;
+}
+
+template <typename CharType> inline int Lexer::currentOffset() const
+{
+    return currentCharacter<CharType>() - code<CharType>().start;
+}
+
+template <typename CharType> ALWAYS_INLINE void Lexer::shift1()
+{
+    Code<CharType>& code = this->code<CharType>();
     m_current = m_next1;
     m_next1 = m_next2;
     m_next2 = m_next3;
-    if (LIKELY(m_code < m_codeEnd))
-        m_next3 = m_code[0];
+    if (LIKELY(code.position < code.end))
+        m_next3 = code.position[0];
     else
         m_next3 = -1;
 
-    ++m_code;
+    ++code.position;
 }
 
-ALWAYS_INLINE void Lexer::shift2()
+template <typename CharType> ALWAYS_INLINE void Lexer::shift2()
 {
+    Code<CharType>& code = this->code<CharType>();
     m_current = m_next2;
     m_next1 = m_next3;
-    if (LIKELY(m_code + 1 < m_codeEnd)) {
-        m_next2 = m_code[0];
-        m_next3 = m_code[1];
+    if (LIKELY(code.position + 1 < code.end)) {
+        m_next2 = code.position[0];
+        m_next3 = code.position[1];
     } else {
-        m_next2 = m_code < m_codeEnd ? m_code[0] : -1;
+        m_next2 = code.position < code.end ? code.position[0] : -1;
         m_next3 = -1;
     }
 
-    m_code += 2;
+    code.position += 2;
 }
 
-ALWAYS_INLINE void Lexer::shift3()
+template <typename CharType> ALWAYS_INLINE void Lexer::shift3()
 {
+    Code<CharType>& code = this->code<CharType>();
     m_current = m_next3;
-    if (LIKELY(m_code + 2 < m_codeEnd)) {
-        m_next1 = m_code[0];
-        m_next2 = m_code[1];
-        m_next3 = m_code[2];
+    if (LIKELY(code.position + 2 < code.end)) {
+        m_next1 = code.position[0];
+        m_next2 = code.position[1];
+        m_next3 = code.position[2];
     } else {
-        m_next1 = m_code < m_codeEnd ? m_code[0] : -1;
-        m_next2 = m_code + 1 < m_codeEnd ? m_code[1] : -1;
+        m_next1 = code.position < code.end ? code.position[0] : -1;
+        m_next2 = code.position + 1 < code.end ? code.position[1] : -1;
         m_next3 = -1;
     }
 
-    m_code += 3;
+    code.position += 3;
 }
 
-ALWAYS_INLINE void Lexer::shift4()
+template <typename CharType> ALWAYS_INLINE void Lexer::shift4()
 {
-    if (LIKELY(m_code + 3 < m_codeEnd)) {
-        m_current = m_code[0];
-        m_next1 = m_code[1];
-        m_next2 = m_code[2];
-        m_next3 = m_code[3];
+    Code<CharType>& code = this->code<CharType>();
+    if (LIKELY(code.position + 3 < code.end)) {
+        m_current = code.position[0];
+        m_next1 = code.position[1];
+        m_next2 = code.position[2];
+        m_next3 = code.position[3];
     } else {
-        m_current = m_code < m_codeEnd ? m_code[0] : -1;
-        m_next1 = m_code + 1 < m_codeEnd ? m_code[1] : -1;
-        m_next2 = m_code + 2 < m_codeEnd ? m_code[2] : -1;
+        m_current = code.position < code.end ? code.position[0] : -1;
+        m_next1 = code.position + 1 < code.end ? code.position[1] : -1;
+        m_next2 = code.position + 2 < code.end ? code.position[2] : -1;
         m_next3 = -1;
     }
 
-    m_code += 4;
+    code.position += 4;
 }
 
 void Lexer::setCode(const SourceCode& source, ParserArena& arena)
@@ -155,22 +179,38 @@ void Lexer::setCode(const SourceCode& source, ParserArena& arena)
     m_delimited = false;
     m_lastToken = -1;
 
-    const UChar* data = source.provider()->data();
-
     m_source = &source;
-    m_codeStart = data;
-    m_code = data + source.startOffset();
-    m_codeEnd = data + source.endOffset();
     m_error = false;
     m_atLineStart = true;
 
     m_buffer8.reserveInitialCapacity(initialReadBufferCapacity);
-    m_buffer16.reserveInitialCapacity((m_codeEnd - m_code) / 2);
+    m_buffer16.reserveInitialCapacity(source.length() / 2);
+
+    // Lex Latin-1 source as it is held; widening it would keep a UTF-16
+    // copy on the source string for as long as the source lives.
+    SourceProvider* provider = source.provider();
+    m_is8Bit = provider->is8Bit();
+    if (m_is8Bit) {
+        const LChar* data = provider->data8();
+        m_code8.start = data;
+        m_code8.position = data + source.startOffset();
+        m_code8.end = data + source.endOffset();
+
+        // Read the first characters into the 4-character buffer.
+        shift4<LChar>();
+        ASSERT(currentOffset<LChar>() == source.startOffset());
+        return;
+    }
+
+    const UChar* data = provider->data();
+    m_code16.start = data;
+    m_code16.position = data + source.startOffset();
+    m_code16.end = data + source.endOffset();
 
     // ECMA-262 calls for stripping all Cf characters, but we only strip BOM characters.
     // See <https://bugs.webkit.org/show_bug.cgi?id=4931> for details.
-    if (source.provider()->hasBOMs()) {
-        for (const UChar* p = m_codeStart; p < m_codeEnd; ++p) {
+    if (provider->hasBOMs()) {
+        for (const UChar* p = m_code16.start; p < m_code16.end; ++p) {
             if (UNLIKELY(*p == byteOrderMark)) {
                 copyCodeWithoutBOMs();
                 break;
@@ -179,8 +219,8 @@ void Lexer::setCode(const SourceCode& source, ParserArena& arena)
     }
 
     // Read the first characters into the 4-character buffer.
-    shift4();
-    ASSERT(currentOffset() == source.startOffset());
+    shift4<UChar>();
+    ASSERT(currentOffset<UChar>() == source.startOffset());
 }
 
 void Lexer::copyCodeWithoutBOMs()
@@ -190,27 +230,27 @@ void Lexer::copyCodeWithoutBOMs()
     // should strip the BOMs when creating the SourceProvider object and do its own
     // mapping of offsets within the stripped text to original text offset.
 
-    m_codeWithoutBOMs.reserveCapacity(m_codeEnd - m_code);
-    for (const UChar* p = m_code; p < m_codeEnd; ++p) {
+    m_codeWithoutBOMs.reserveCapacity(m_code16.end - m_code16.position);
+    for (const UChar* p = m_code16.position; p < m_code16.end; ++p) {
         UChar c = *p;
         if (c != byteOrderMark)
             m_codeWithoutBOMs.append(c);
     }
-    ptrdiff_t startDelta = m_codeStart - m_code;
-    m_code = m_codeWithoutBOMs.data();
-    m_codeStart = m_code + startDelta;
-    m_codeEnd = m_codeWithoutBOMs.data() + m_codeWithoutBOMs.size();
+    ptrdiff_t startDelta = m_code16.start - m_code16.position;
+    m_code16.position = m_codeWithoutBOMs.data();
+    m_code16.start = m_code16.position + startDelta;
+    m_code16.end = m_codeWithoutBOMs.data() + m_codeWithoutBOMs.size();
 }
 
-void Lexer::shiftLineTerminator()
+template <typename CharType> void Lexer::shiftLineTerminator()
 {
     ASSERT(isLineTerminator(m_current));
 
     // Allow both CRLF and LFCR.
     if (m_current + m_next1 == '\n' + '\r')
-        shift2();
+        shift2<CharType>();
     else
-        shift1();
+        shift1<CharType>();
 
     ++m_lineNumber;
 }
@@ -220,6 +260,11 @@ ALWAYS_INLINE const Identifier* Lexer::makeIdentifier(const UChar* characters, s
     return &m_arena->makeIdentifier(m_globalData, characters, length);
 }
 
+ALWAYS_INLINE const Identifier* Lexer::makeIdentifier(const LChar* characters, size_t length)
+{
+    return &m_arena->makeIdentifier(m_globalData, characters, length);
+}
+
 inline bool Lexer::lastTokenWasRestrKeyword() const
 {
     return m_lastToken == CONTINUE || m_lastToken == BREAK || m_lastToken == RETURN || m_lastToken == THROW;
@@ -286,6 +331,13 @@ inline void Lexer::record16(int c)
 }
 
 int Lexer::lex(void* p1, void* p2)
+{
+    if (m_is8Bit)
+        return lex<LChar>(p1, p2);
+    return lex<UChar>(p1, p2);
+}
+
+template <typename CharType> int Lexer::lex(void* p1, void* p2)
 {
     ASSERT(!m_error);
     ASSERT(m_buffer8.isEmpty());
@@ -298,9 +350,9 @@ int Lexer::lex(void* p1, void* p2)
 
 start:
     while (isWhiteSpace(m_current))
-        shift1();
+        shift1<CharType>();
 
-    int startOffset = currentOffset();
+    int startOffset = currentOffset<CharType>();
 
     if (m_current == -1) {
         if (!m_terminator && !m_delimited && !m_isReparsing) {
@@ -316,87 +368,87 @@ start:
         case '>':
             if (m_next1 == '>' && m_next2 == '>') {
                 if (m_next3 == '=') {
-                    shift4();
+                    shift4<CharType>();
                     token = URSHIFTEQUAL;
                     break;
                 }
-                shift3();
+                shift3<CharType>();
                 token = URSHIFT;
                 break;
             }
             if (m_next1 == '>') {
                 if (m_next2 == '=') {
-                    shift3();
+                    shift3<CharType>();
                     token = RSHIFTEQUAL;
                     break;
                 }
-                shift2();
+                shift2<CharType>();
                 token = RSHIFT;
                 break;
             }
             if (m_next1 == '=') {
-                shift2();
+                shift2<CharType>();
                 token = GE;
                 break;
             }
-            shift1();
+            shift1<CharType>();
             token = '>';
             break;
         case '=':
             if (m_next1 == '=') {
                 if (m_next2 == '=') {
-                    shift3();
+                    shift3<CharType>();
                     token = STREQ;
                     break;
                 }
-                shift2();
+                shift2<CharType>();
                 token = EQEQ;
                 break;
             }
-            shift1();
+            shift1<CharType>();
             token = '=';
             break;
         case '!':
             if (m_next1 == '=') {
                 if (m_next2 == '=') {
-                    shift3();
+                    shift3<CharType>();
                     token = STRNEQ;
                     break;
                 }
-                shift2();
+                shift2<CharType>();
                 token = NE;
                 break;
             }
-            shift1();
+            shift1<CharType>();
             token = '!';
             break;
         case '<':
             if (m_next1 == '!' && m_next2 == '-' && m_next3 == '-') {
                 // <!-- marks the beginning of a line comment (for www usage)
-                shift4();
+                shift4<CharType>();
                 goto inSingleLineComment;
             }
             if (m_next1 == '<') {
                 if (m_next2 == '=') {
-                    shift3();
+                    shift3<CharType>();
                     token = LSHIFTEQUAL;
                     break;
                 }
-                shift2();
+                shift2<CharType>();
                 token = LSHIFT;
                 break;
             }
             if (m_next1 == '=') {
-                shift2();
+                shift2<CharType>();
                 token = LE;
                 break;
             }
-            shift1();
+            shift1<CharType>();
             token = '<';
             break;
         case '+':
             if (m_next1 == '+') {
-                shift2();
+                shift2<CharType>();
                 if (m_terminator) {
                     token = AUTOPLUSPLUS;
                     break;
@@ -405,20 +457,20 @@ start:
                 break;
             }
             if (m_next1 == '=') {
-                shift2();
+                shift2<CharType>();
                 token = PLUSEQUAL;
                 break;
             }
-            shift1();
+            shift1<CharType>();
             token = '+';
             break;
         case '-':
             if (m_next1 == '-') {
                 if (m_atLineStart && m_next2 == '>') {
-                    shift3();
+                    shift3<CharType>();
                     goto inSingleLineComment;
                 }
-                shift2();
+                shift2<CharType>();
                 if (m_terminator) {
                     token = AUTOMINUSMINUS;
                     break;
@@ -427,91 +479,91 @@ start:
                 break;
             }
             if (m_next1 == '=') {
-                shift2();
+                shift2<CharType>();
                 token = MINUSEQUAL;
                 break;
             }
-            shift1();
+            shift1<CharType>();
             token = '-';
             break;
         case '*':
             if (m_next1 == '=') {
-                shift2();
+                shift2<CharType>();
                 token = MULTEQUAL;
                 break;
             }
-            shift1();
+            shift1<CharType>();
             token = '*';
             break;
         case '/':
             if (m_next1 == '/') {
-                shift2();
+                shift2<CharType>();
                 goto inSingleLineComment;
             }
             if (m_next1 == '*')
                 goto inMultiLineComment;
             if (m_next1 == '=') {
-                shift2();
+                shift2<CharType>();
                 token = DIVEQUAL;
                 break;
             }
-            shift1();
+            shift1<CharType>();
             token = '/';
             break;
         case '&':
             if (m_next1 == '&') {
-                shift2();
+                shift2<CharType>();
                 token = AND;
                 break;
             }
             if (m_next1 == '=') {
-                shift2();
+                shift2<CharType>();
                 token = ANDEQUAL;
                 break;
             }
-            shift1();
+            shift1<CharType>();
             token = '&';
             break;
         case '^':
             if (m_next1 == '=') {
-                shift2();
+                shift2<CharType>();
                 token = XOREQUAL;
                 break;
             }
-            shift1();
+            shift1<CharType>();
             token = '^';
             break;
         case '%':
             if (m_next1 == '=') {
-                shift2();
+                shift2<CharType>();
                 token = MODEQUAL;
                 break;
             }
-            shift1();
+            shift1<CharType>();
             token = '%';
             break;
         case '|':
             if (m_next1 == '=') {
-                shift2();
+                shift2<CharType>();
                 token = OREQUAL;
                 break;
             }
             if (m_next1 == '|') {
-                shift2();
+                shift2<CharType>();
                 token = OR;
                 break;
             }
-            shift1();
+            shift1<CharType>();
             token = '|';
             break;
         case '.':
             if (isASCIIDigit(m_next1)) {
                 record8('.');
-                shift1();
+                shift1<CharType>();
                 goto inNumberAfterDecimalPoint;
             }
             token = '.';
-            shift1();
+            shift1<CharType>();
             break;
         case ',':
         case '~':
@@ -522,21 +574,21 @@ start:
         case '[':
         case ']':
             token = m_current;
-            shift1();
+            shift1<CharType>();
             break;
         case ';':
-            shift1();
+            shift1<CharType>();
             m_delimited = true;
             token = ';';
             break;
         case '{':
-            lvalp->intValue = currentOffset();
-            shift1();
+            lvalp->intValue = currentOffset<CharType>();
+            shift1<CharType>();
             token = OPENBRACE;
             break;
         case '}':
-            lvalp->intValue = currentOffset();
-            shift1();
+            lvalp->intValue = currentOffset<CharType>();
+            shift1<CharType>();
             m_delimited = true;
             token = CLOSEBRACE;
             break;
@@ -561,7 +613,7 @@ start:
             if (isIdentStart(m_current))
                 goto startIdentifierOrKeyword;
             if (isLineTerminator(m_current)) {
-                shiftLineTerminator();
+                shiftLineTerminator<CharType>();
                 m_atLineStart = true;
                 m_terminator = true;
                 if (lastTokenWasRestrKeyword()) {
@@ -578,21 +630,21 @@ start:
 
 startString: {
     int stringQuoteCharacter = m_current;
-    shift1();
+    shift1<CharType>();
 
-    const UChar* stringStart = currentCharacter();
+    const CharType* stringStart = currentCharacter<CharType>();
     while (m_current != stringQuoteCharacter) {
         // Fast check for characters that require special handling.
         // Catches -1, \n, \r, \, 0x2028, and 0x2029 as efficiently
         // as possible, and lets through all common ASCII characters.
         if (UNLIKELY(m_current == '\\') || UNLIKELY(((static_cast<unsigned>(m_current) - 0xE) & 0x2000))) {
-            m_buffer16.append(stringStart, currentCharacter() - stringStart);
+            m_buffer16.append(stringStart, currentCharacter<CharType>() - stringStart);
             goto inString;
         }
-        shift1();
+        shift1<CharType>();
     }
-    lvalp->ident = makeIdentifier(stringStart, currentCharacter() - stringStart);
-    shift1();
+    lvalp->ident = makeIdentifier(stringStart, currentCharacter<CharType>() - stringStart);
+    shift1<CharType>();
     m_atLineStart = false;
     m_delimited = false;
     token = STRING;
@@ -607,17 +659,17 @@ inString:
         if (UNLIKELY(m_current == -1))
             goto returnError;
         record16(m_current);
-        shift1();
+        shift1<CharType>();
     }
     goto doneString;
 
 inStringEscapeSequence:
-    shift1();
+    shift1<CharType>();
     if (m_current == 'x') {
-        shift1();
+        shift1<CharType>();
         if (isASCIIHexDigit(m_current) && isASCIIHexDigit(m_next1)) {
             record16(convertHex(m_current, m_next1));
-            shift2();
+            shift2<CharType>();
             goto inString;
         }
         record16('x');
@@ -626,10 +678,10 @@ inStringEscapeSequence:
         goto inString;
     }
     if (m_current == 'u') {
-        shift1();
+        shift1<CharType>();
         if (isASCIIHexDigit(m_current) && isASCIIHexDigit(m_next1) && isASCIIHexDigit(m_next2) && isASCIIHexDigit(m_next3)) {
             record16(convertUnicode(m_current, m_next1, m_next2, m_next3));
-            shift4();
+            shift4<CharType>();
             goto inString;
         }
         if (m_current == stringQuoteCharacter) {
@@ -641,34 +693,34 @@ inStringEscapeSequence:
     if (isASCIIOctalDigit(m_current)) {
         if (m_current >= '0' && m_current <= '3' && isASCIIOctalDigit(m_next1) && isASCIIOctalDigit(m_next2)) {
             record16((m_current - '0') * 64 + (m_next1 - '0') * 8 + m_next2 - '0');
-            shift3();
+            shift3<CharType>();
             goto inString;
         }
         if (isASCIIOctalDigit(m_next1)) {
             record16((m_current - '0') * 8 + m_next1 - '0');
-            shift2();
+            shift2<CharType>();
             goto inString;
         }
         record16(m_current - '0');
-        shift1();
+        shift1<CharType>();
         goto inString;
     }
     if (isLineTerminator(m_current)) {
-        shiftLineTerminator();
+        shiftLineTerminator<CharType>();
         goto inString;
     }
     if (m_current == -1)
         goto returnError;
     record16(singleEscape(m_current));
-    shift1();
+    shift1<CharType>();
     goto inString;
 }
 
 startIdentifierWithBackslash:
-    shift1();
+    shift1<CharType>();
     if (UNLIKELY(m_current != 'u'))
         goto returnError;
-    shift1();
+    shift1<CharType>();
     if (UNLIKELY(!isASCIIHexDigit(m_current) || !isASCIIHexDigit(m_next1) || !isASCIIHexDigit(m_next2) || !isASCIIHexDigit(m_next3)))
         goto returnError;
     token = convertUnicode(m_current, m_next1, m_next2, m_next3);
@@ -677,22 +729,22 @@ startIdentifierWithBackslash:
     goto inIdentifierAfterCharacterCheck;
 
 startIdentifierOrKeyword: {
-    const UChar* identifierStart = currentCharacter();
-    shift1();
+    const CharType* identifierStart = currentCharacter<CharType>();
+    shift1<CharType>();
     while (isIdentPart(m_current))
-        shift1();
+        shift1<CharType>();
     if (LIKELY(m_current != '\\')) {
-        lvalp->ident = makeIdentifier(identifierStart, currentCharacter() - identifierStart);
+        lvalp->ident = makeIdentifier(identifierStart, currentCharacter<CharType>() - identifierStart);
         goto doneIdentifierOrKeyword;
     }
-    m_buffer16.append(identifierStart, currentCharacter() - identifierStart);
+    m_buffer16.append(identifierStart, currentCharacter<CharType>() - identifierStart);
 }
 
     do {
-        shift1();
+        shift1<CharType>();
         if (UNLIKELY(m_current != 'u'))
             goto returnError;
-        shift1();
+        shift1<CharType>();
         if (UNLIKELY(!isASCIIHexDigit(m_current) || !isASCIIHexDigit(m_next1) || !isASCIIHexDigit(m_next2) || !isASCIIHexDigit(m_next3)))
             goto returnError;
         token = convertUnicode(m_current, m_next1, m_next2, m_next3);
@@ -700,11 +752,11 @@ startIdentifierOrKeyword: {
             goto returnError;
 inIdentifierAfterCharacterCheck:
         record16(token);
-        shift4();
+        shift4<CharType>();
 
         while (isIdentPart(m_current)) {
             record16(m_current);
-            shift1();
+            shift1<CharType>();
         }
     } while (UNLIKELY(m_current == '\\'));
     goto doneIdentifier;
@@ -713,9 +765,9 @@ inSingleLineComment:
     while (!isLineTerminator(m_current)) {
         if (UNLIKELY(m_current == -1))
             return 0;
-        shift1();
+        shift1<CharType>();
     }
-    shiftLineTerminator();
+    shiftLineTerminator<CharType>();
     m_atLineStart = true;
     m_terminator = true;
     if (lastTokenWasRestrKeyword())
@@ -723,36 +775,36 @@ inSingleLineComment:
     goto start;
 
 inMultiLineComment:
-    shift2();
+    shift2<CharType>();
     while (m_current != '*' || m_next1 != '/') {
         if (isLineTerminator(m_current))
-            shiftLineTerminator();
+            shiftLineTerminator<CharType>();
         else {
-            shift1();
+            shift1<CharType>();
             if (UNLIKELY(m_current == -1))
                 goto returnError;
         }
     }
-    shift2();
+    shift2<CharType>();
     m_atLineStart = false;
     goto start;
 
 startNumberWithZeroDigit:
-    shift1();
+    shift1<CharType>();
     if ((m_current | 0x20) == 'x' && isASCIIHexDigit(m_next1)) {
-        shift1();
+        shift1<CharType>();
         goto inHex;
     }
     if (m_current == '.') {
         record8('0');
         record8('.');
-        shift1();
+        shift1<CharType>();
         goto inNumberAfterDecimalPoint;
     }
     if ((m_current | 0x20) == 'e') {
         record8('0');
         record8('e');
-        shift1();
+        shift1<CharType>();
         goto inExponentIndicator;
     }
     if (isASCIIOctalDigit(m_current))
@@ -765,11 +817,11 @@ startNumberWithZeroDigit:
 inNumberAfterDecimalPoint:
     while (isASCIIDigit(m_current)) {
         record8(m_current);
-        shift1();
+        shift1<CharType>();
     }
     if ((m_current | 0x20) == 'e') {
         record8('e');
-        shift1();
+        shift1<CharType>();
         goto inExponentIndicator;
     }
     goto doneNumber;
@@ -777,20 +829,20 @@ inNumberAfterDecimalPoint:
 inExponentIndicator:
     if (m_current == '+' || m_current == '-') {
         record8(m_current);
-        shift1();
+        shift1<CharType>();
     }
     if (!isASCIIDigit(m_current))
         goto returnError;
     do {
         record8(m_current);
-        shift1();
+        shift1<CharType>();
     } while (isASCIIDigit(m_current));
     goto doneNumber;
 
 inOctal: {
     do {
         record8(m_current);
-        shift1();
+        shift1<CharType>();
     } while (isASCIIOctalDigit(m_current));
     if (isASCIIDigit(m_current))
         goto startNumber;
@@ -814,7 +866,7 @@ inOctal: {
 inHex: {
     do {
         record8(m_current);
-        shift1();
+        shift1<CharType>();
     } while (isASCIIHexDigit(m_current));
 
     double dval = 0;
@@ -835,19 +887,19 @@ inHex: {
 
 startNumber:
     record8(m_current);
-    shift1();
+    shift1<CharType>();
     while (isASCIIDigit(m_current)) {
         record8(m_current);
-        shift1();
+        shift1<CharType>();
     }
     if (m_current == '.') {
         record8('.');
-        shift1();
+        shift1<CharType>();
         goto inNumberAfterDecimalPoint;
     }
     if ((m_current | 0x20) == 'e') {
         record8('e');
-        shift1();
+        shift1<CharType>();
         goto inExponentIndicator;
     }
 
@@ -895,7 +947,7 @@ doneIdentifierOrKeyword: {
 
 doneString:
     // Atomize constant strings in case they're later used in property lookup.
-    shift1();
+    shift1<CharType>();
     m_atLineStart = false;
     m_delimited = false;
     lvalp->ident = makeIdentifier(m_buffer16.data(), m_buffer16.size());
@@ -909,7 +961,7 @@ returnToken: {
     llocp->first_line = lineNumber;
     llocp->last_line = lineNumber;
     llocp->first_column = startOffset;
-    llocp->last_column = currentOffset();
+    llocp->last_column = currentOffset<CharType>();
 
     m_lastToken = token;
     return token;
@@ -921,6 +973,13 @@ returnError:
 }
 
 bool Lexer::scanRegExp(const Identifier*& pattern, const Identifier*& flags, UChar patternPrefix)
+{
+    if (m_is8Bit)
+        return scanRegExp<LChar>(pattern, flags, patternPrefix);
+    return scanRegExp<UChar>(pattern, flags, patternPrefix);
+}
+
+template <typename CharType> bool Lexer::scanRegExp(const Identifier*& pattern, const Identifier*& flags, UChar patternPrefix)
 {
     ASSERT(m_buffer16.isEmpty());
 
@@ -942,7 +1001,7 @@ bool Lexer::scanRegExp(const Identifier*& pattern, const Identifier*& flags, UCh
             return false;
         }
 
-        shift1();
+        shift1<CharType>();
 
         if (current == '/' && !lastWasEscape && !inBrackets)
             break;
@@ -972,7 +1031,7 @@ bool Lexer::scanRegExp(const Identifier*& pattern, const Identifier*& flags, UCh
 
     while (isIdentPart(m_current)) {
         record16(m_current);
-        shift1();
+        shift1<CharType>();
     }
 
     flags = makeIdentifier(m_buffer16.data(), m_buffer16.size());
@@ -982,6 +1041,13 @@ bool Lexer::scanRegExp(const Identifier*& pattern, const Identifier*& flags, UCh
 }
 
 bool Lexer::skipRegExp()
+{
+    if (m_is8Bit)
+        return skipRegExp<LChar>();
+    return skipRegExp<UChar>();
+}
+
+template <typename CharType> bool Lexer::skipRegExp()
 {
     bool lastWasEscape = false;
     bool inBrackets = false;
@@ -992,7 +1058,7 @@ bool Lexer::skipRegExp()
         if (isLineTerminator(current) || current == -1)
             return false;
 
-        shift1();
+        shift1<CharType>();
 
         if (current == '/' && !lastWasEscape && !inBrackets)
             break;
@@ -1016,7 +1082,7 @@ bool Lexer::skipRegExp()
     }
 
     while (isIdentPart(m_current))
-        shift1();
+        shift1<CharType>();
 
     return true;
 }
@@ -81,11 +81,15 @@ namespace AJ {
         Lexer(AJGlobalData*);
         ~Lexer();
 
-        void shift1();
-        void shift2();
-        void shift3();
-        void shift4();
-        void shiftLineTerminator();
+        template <typename CharType> int lex(void* lvalp, void* llocp);
+        template <typename CharType> bool scanRegExp(const Identifier*& pattern, const Identifier*& flags, UChar patternPrefix);
+        template <typename CharType> bool skipRegExp();
+
+        template <typename CharType> void shift1();
+        template <typename CharType> void shift2();
+        template <typename CharType> void shift3();
+        template <typename CharType> void shift4();
+        template <typename CharType> void shiftLineTerminator();
 
         void record8(int);
         void record16(int);
@@ -93,10 +97,21 @@ namespace AJ {
 
         void copyCodeWithoutBOMs();
 
-        int currentOffset() const;
-        const UChar* currentCharacter() const;
+        // Where the lexer is in the source, which it reads as it is held:
+        // Latin-1 in m_code8 or UTF-16 in m_code16, as m_is8Bit says.
+        template <typename CharType> struct Code {
+            const CharType* start;
+            const CharType* position;
+            const CharType* end;
+        };
+        template <typename CharType> Code<CharType>& code();
+        template <typename CharType> const Code<CharType>& code() const;
+
+        template <typename CharType> int currentOffset() const;
+        template <typename CharType> const CharType* currentCharacter() const;
 
         const Identifier* makeIdentifier(const UChar* characters, size_t length);
+        const Identifier* makeIdentifier(const LChar* characters, size_t length);
 
         bool lastTokenWasRestrKeyword() const;
 
@@ -111,9 +126,9 @@ namespace AJ {
         int m_lastToken;
 
         const SourceCode* m_source;
-        const UChar* m_code;
-        const UChar* m_codeStart;
-        const UChar* m_codeEnd;
+        Code<LChar> m_code8;
+        Code<UChar> m_code16;
+        bool m_is8Bit;
         bool m_isReparsing;
         bool m_atLineStart;
         bool m_error;
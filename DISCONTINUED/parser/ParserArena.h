@@ -54,6 +54,7 @@ namespace AJ {
     class IdentifierArena : public FastAllocBase {
     public:
         ALWAYS_INLINE const Identifier& makeIdentifier(AJGlobalData*, const UChar* characters, size_t length);
+        ALWAYS_INLINE const Identifier& makeIdentifier(AJGlobalData*, const LChar* characters, size_t length);
         const Identifier& makeNumericIdentifier(AJGlobalData*, double number);
 
         void clear() { m_identifiers.clear(); }
@@ -70,6 +71,12 @@ namespace AJ {
         return m_identifiers.last();
     }
 
+    ALWAYS_INLINE const Identifier& IdentifierArena::makeIdentifier(AJGlobalData* globalData, const LChar* characters, size_t length)
+    {
+        m_identifiers.append(Identifier(globalData, characters, length));
+        return m_identifiers.last();
+    }
+
     inline const Identifier& IdentifierArena::makeNumericIdentifier(AJGlobalData* globalData, double number)
     {
         m_identifiers.append(Identifier(globalData, UString::from(number)));
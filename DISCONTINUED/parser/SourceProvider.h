@@ -65,6 +65,10 @@ namespace AJ {
         virtual UString getRange(int start, int end) const = 0;
         virtual const UChar* data() const = 0;
         virtual int length() const = 0;
+
+        // Latin-1 source can be read through data8() without widening it.
+        virtual bool is8Bit() const { return false; }
+        virtual const LChar* data8() const { ASSERT_NOT_REACHED(); return 0; }
         
         const UString& url() { return m_url; }
         intptr_t asID() { return reinterpret_cast<intptr_t>(this); }
@@ -86,6 +90,8 @@ namespace AJ {
         UString getRange(int start, int end) const { return m_source.substr(start, end - start); }
         const UChar* data() const { return m_source.data(); }
         int length() const { return m_source.size(); }
+        bool is8Bit() const { return m_source.is8Bit(); }
+        const LChar* data8() const { return m_source.rep()->characters8(); }
 
     private:
         UStringSourceProvider(const UString& source, const UString& url)
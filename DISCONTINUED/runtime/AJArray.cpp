@@ -84,11 +84,26 @@ ASSERT_CLASS_FITS_IN_CELL(AJArray);
 //   * Where (MAX_STORAGE_VECTOR_INDEX < i <= MAX_ARRAY_INDEX) the value will always be stored
 //     in the sparse array.
 
+// An array that has only held numbers keeps them unboxed, as int32_ts until it holds
+// a number that is not an int32 and as doubles after that, in place of the AJValues
+// of the storage vector. Such an array has no holes before its last value and no
+// sparse map; the first store that would need either, or that is not a number,
+// boxes the values and moves it to the general representation above for good.
+//
+// With JSVALUE32 a double is boxed in a number cell, so a vector of doubles would
+// allocate a cell on every get. Arrays of doubles keep their values boxed there.
+#if USE(JSVALUE32)
+static const AJArray::VectorMode vectorModeForDoubles = AJArray::ValueVector;
+#else
+static const AJArray::VectorMode vectorModeForDoubles = AJArray::DoubleVector;
+#endif
+
 // The definition of MAX_STORAGE_VECTOR_LENGTH is dependant on the definition storageSize
 // function below - the MAX_STORAGE_VECTOR_LENGTH limit is defined such that the storage
 // size calculation cannot overflow.  (sizeof(ArrayStorage) - sizeof(AJValue)) +
-// (vectorLength * sizeof(AJValue)) must be <= 0xFFFFFFFFU (which is maximum value of size_t).
-#define MAX_STORAGE_VECTOR_LENGTH static_cast<unsigned>((0xFFFFFFFFU - (sizeof(ArrayStorage) - sizeof(AJValue))) / sizeof(AJValue))
+// (vectorLength * MAX_VECTOR_ELEMENT_SIZE) must be <= 0xFFFFFFFFU (which is maximum value of size_t).
+#define MAX_VECTOR_ELEMENT_SIZE (sizeof(AJValue) > sizeof(double) ? sizeof(AJValue) : sizeof(double))
+#define MAX_STORAGE_VECTOR_LENGTH static_cast<unsigned>((0xFFFFFFFFU - (sizeof(ArrayStorage) - sizeof(AJValue))) / MAX_VECTOR_ELEMENT_SIZE)
 
 // These values have to be macros to be used in max() and min() without introducing
 // a PIC branch in Mach-O binaries, see <rdar://problem/5971391>.
@@ -105,20 +120,48 @@ static const unsigned minDensityMultiplier = 8;
 
 const ClassInfo AJArray::info = {"Array", 0, 0, 0};
 
-static inline size_t storageSize(unsigned vectorLength)
+static inline size_t vectorElementSize(AJArray::VectorMode mode)
+{
+    switch (mode) {
+    case AJArray::Int32Vector:
+        return sizeof(int32_t);
+    case AJArray::DoubleVector:
+        return sizeof(double);
+    case AJArray::ValueVector:
+        break;
+    }
+    return sizeof(AJValue);
+}
+
+static inline size_t storageSize(AJArray::VectorMode mode, unsigned vectorLength)
 {
     ASSERT(vectorLength <= MAX_STORAGE_VECTOR_LENGTH);
 
     // MAX_STORAGE_VECTOR_LENGTH is defined such that provided (vectorLength <= MAX_STORAGE_VECTOR_LENGTH)
     // - as asserted above - the following calculation cannot overflow.
-    size_t size = (sizeof(ArrayStorage) - sizeof(AJValue)) + (vectorLength * sizeof(AJValue));
+    size_t elementSize = vectorElementSize(mode);
+    size_t size = (sizeof(ArrayStorage) - sizeof(AJValue)) + (vectorLength * elementSize);
     // Assertion to detect integer overflow in previous calculation (should not be possible, provided that
     // MAX_STORAGE_VECTOR_LENGTH is correctly defined).
-    ASSERT(((size - (sizeof(ArrayStorage) - sizeof(AJValue))) / sizeof(AJValue) == vectorLength) && (size >= (sizeof(ArrayStorage) - sizeof(AJValue))));
+    ASSERT(((size - (sizeof(ArrayStorage) - sizeof(AJValue))) / elementSize == vectorLength) && (size >= (sizeof(ArrayStorage) - sizeof(AJValue))));
 
     return size;
 }
 
+// Also true of an int32 that JSVALUE32 had to put in a number cell.
+static inline bool isInt32Number(AJValue value, int32_t& result)
+{
+    if (value.isInt32()) {
+        result = value.asInt32();
+        return true;
+    }
+    if (!value.isDouble())
+        return false;
+    double d = value.asDouble();
+    result = static_cast<int32_t>(d);
+    return result == d && (result || !signbit(d));
+}
+
 static inline unsigned increasedVectorLength(unsigned newLength)
 {
     ASSERT(newLength <= MAX_STORAGE_VECTOR_LENGTH);
@@ -149,10 +192,16 @@ inline void AJArray::checkConsistency(ConsistencyCheckType)
 
 AJArray::AJArray(NonNullPassRefPtr<Structure> structure)
     : AJObject(structure)
+    , m_vectorMode(Int32Vector)
+    , m_sparseValueMap(0)
+    , m_subclassData(0)
+    , m_reportedMapCapacity(0)
 {
     unsigned initialCapacity = 0;
 
-    m_storage = static_cast<ArrayStorage*>(fastZeroedMalloc(storageSize(initialCapacity)));
+    m_storage = static_cast<ArrayStorage*>(Heap::heap(this)->allocateStorage(storageSize(m_vectorMode, initialCapacity), reinterpret_cast<void**>(&m_storage)));
+    m_storage->m_length = 0;
+    m_storage->m_numValuesInVector = 0;
     m_vectorLength = initialCapacity;
 
     checkConsistency();
@@ -160,56 +209,86 @@ AJArray::AJArray(NonNullPassRefPtr<Structure> structure)
 
 AJArray::AJArray(NonNullPassRefPtr<Structure> structure, unsigned initialLength)
     : AJObject(structure)
+    , m_vectorMode(Int32Vector)
+    , m_sparseValueMap(0)
+    , m_subclassData(0)
+    , m_reportedMapCapacity(0)
 {
     unsigned initialCapacity = min(initialLength, MIN_SPARSE_ARRAY_INDEX);
 
-    m_storage = static_cast<ArrayStorage*>(fastMalloc(storageSize(initialCapacity)));
+    // Every index is a hole, which needs no clearing while the vector holds numbers.
+    m_storage = static_cast<ArrayStorage*>(Heap::heap(this)->allocateStorage(storageSize(m_vectorMode, initialCapacity), reinterpret_cast<void**>(&m_storage)));
     m_storage->m_length = initialLength;
     m_vectorLength = initialCapacity;
     m_storage->m_numValuesInVector = 0;
-    m_storage->m_sparseValueMap = 0;
-    m_storage->subclassData = 0;
-    m_storage->reportedMapCapacity = 0;
-
-    AJValue* vector = m_storage->m_vector;
-    for (size_t i = 0; i < initialCapacity; ++i)
-        vector[i] = AJValue();
 
     checkConsistency();
 
-    Heap::heap(this)->reportExtraMemoryCost(initialCapacity * sizeof(AJValue));
+    Heap::heap(this)->reportExtraMemoryCost(initialCapacity * vectorElementSize(m_vectorMode));
 }
 
 AJArray::AJArray(NonNullPassRefPtr<Structure> structure, const ArgList& list)
     : AJObject(structure)
+    , m_vectorMode(Int32Vector)
+    , m_sparseValueMap(0)
+    , m_subclassData(0)
+    , m_reportedMapCapacity(0)
 {
     unsigned initialCapacity = list.size();
 
-    m_storage = static_cast<ArrayStorage*>(fastMalloc(storageSize(initialCapacity)));
+    ArgList::const_iterator end = list.end();
+    for (ArgList::const_iterator it = list.begin(); it != end; ++it) {
+        int32_t unused;
+        if (!it->isNumber()) {
+            m_vectorMode = ValueVector;
+            break;
+        }
+        if (!isInt32Number(*it, unused)) {
+            m_vectorMode = vectorModeForDoubles;
+            if (m_vectorMode == ValueVector)
+                break;
+        }
+    }
+
+    m_storage = static_cast<ArrayStorage*>(Heap::heap(this)->allocateStorage(storageSize(m_vectorMode, initialCapacity), reinterpret_cast<void**>(&m_storage)));
     m_storage->m_length = initialCapacity;
     m_vectorLength = initialCapacity;
     m_storage->m_numValuesInVector = initialCapacity;
-    m_storage->m_sparseValueMap = 0;
-    m_storage->subclassData = 0;
-    m_storage->reportedMapCapacity = 0;
 
     size_t i = 0;
-    ArgList::const_iterator end = list.end();
-    for (ArgList::const_iterator it = list.begin(); it != end; ++it, ++i)
-        m_storage->m_vector[i] = *it;
+    if (m_vectorMode == Int32Vector) {
+        for (ArgList::const_iterator it = list.begin(); it != end; ++it, ++i)
+            isInt32Number(*it, m_storage->int32Vector()[i]);
+    } else if (m_vectorMode == DoubleVector) {
+        for (ArgList::const_iterator it = list.begin(); it != end; ++it, ++i)
+            m_storage->doubleVector()[i] = it->uncheckedGetNumber();
+    } else {
+        for (ArgList::const_iterator it = list.begin(); it != end; ++it, ++i)
+            m_storage->m_vector[i] = *it;
+    }
 
     checkConsistency();
 
-    Heap::heap(this)->reportExtraMemoryCost(storageSize(initialCapacity));
+    Heap::heap(this)->reportExtraMemoryCost(storageSize(m_vectorMode, initialCapacity));
+}
+
+AJArray::AJArray(VPtrStealingHackType)
+    : AJObject(AJObject::VPtrStealingHack, createStructure(jsNull()))
+    , m_vectorLength(0)
+    , m_vectorMode(ValueVector)
+    , m_storage(0)
+    , m_sparseValueMap(0)
+    , m_subclassData(0)
+    , m_reportedMapCapacity(0)
+{
 }
 
 AJArray::~AJArray()
 {
     ASSERT(vptr() == AJGlobalData::jsArrayVPtr);
-    checkConsistency(DestructorConsistencyCheck);
 
-    delete m_storage->m_sparseValueMap;
-    fastFree(m_storage);
+    // The storage belongs to the collector, and may already be gone.
+    delete m_sparseValueMap;
 }
 
 bool AJArray::getOwnPropertySlot(ExecState* exec, unsigned i, PropertySlot& slot)
@@ -222,13 +301,18 @@ bool AJArray::getOwnPropertySlot(ExecState* exec, unsigned i, PropertySlot& slot
         return false;
     }
 
-    if (i < m_vectorLength) {
+    if (m_vectorMode != ValueVector) {
+        if (i < storage->m_numValuesInVector) {
+            slot.setValue(getIndex(exec, i));
+            return true;
+        }
+    } else if (i < m_vectorLength) {
         AJValue& valueSlot = storage->m_vector[i];
         if (valueSlot) {
             slot.setValueSlot(&valueSlot);
             return true;
         }
-    } else if (SparseArrayValueMap* map = storage->m_sparseValueMap) {
+    } else if (SparseArrayValueMap* map = m_sparseValueMap) {
         if (i >= MIN_SPARSE_ARRAY_INDEX) {
             SparseArrayValueMap::iterator it = map->find(i);
             if (it != map->end()) {
@@ -268,13 +352,18 @@ bool AJArray::getOwnPropertyDescriptor(ExecState* exec, const Identifier& proper
     if (isArrayIndex) {
         if (i >= m_storage->m_length)
             return false;
-        if (i < m_vectorLength) {
+        if (m_vectorMode != ValueVector) {
+            if (i < m_storage->m_numValuesInVector) {
+                descriptor.setDescriptor(getIndex(exec, i), 0);
+                return true;
+            }
+        } else if (i < m_vectorLength) {
             AJValue& value = m_storage->m_vector[i];
             if (value) {
                 descriptor.setDescriptor(value, 0);
                 return true;
             }
-        } else if (SparseArrayValueMap* map = m_storage->m_sparseValueMap) {
+        } else if (SparseArrayValueMap* map = m_sparseValueMap) {
             if (i >= MIN_SPARSE_ARRAY_INDEX) {
                 SparseArrayValueMap::iterator it = map->find(i);
                 if (it != map->end()) {
@@ -314,6 +403,15 @@ void AJArray::put(ExecState* exec, unsigned i, AJValue value)
 {
     checkConsistency();
 
+    if (m_vectorMode != ValueVector) {
+        if (putNumberDirect(i, value) || putNumberSlowCase(exec, i, value)) {
+            checkConsistency();
+            return;
+        }
+    }
+
+    Heap::writeBarrier(this, value);
+
     unsigned length = m_storage->m_length;
     if (i >= length && i <= MAX_ARRAY_INDEX) {
         length = i + 1;
@@ -336,10 +434,108 @@ void AJArray::put(ExecState* exec, unsigned i, AJValue value)
     putSlowCase(exec, i, value);
 }
 
+// Returns false once the array has moved to ValueVector, leaving the store to the caller.
+NEVER_INLINE bool AJArray::putNumberSlowCase(ExecState* exec, unsigned i, AJValue value)
+{
+    ArrayStorage* storage = m_storage;
+    int32_t int32Value = 0;
+    bool isInt32 = isInt32Number(value, int32Value);
+    bool fits = value.isNumber() && (isInt32 || m_vectorMode == DoubleVector || vectorModeForDoubles == DoubleVector);
+    if (!fits || i > storage->m_numValuesInVector || i >= MAX_STORAGE_VECTOR_INDEX) {
+        if (!convertToValueVector(exec)) {
+            throwOutOfMemoryError(exec);
+            return true;
+        }
+        return false;
+    }
+
+    if (m_vectorMode == Int32Vector && !isInt32 && !convertToDoubleVector()) {
+        throwOutOfMemoryError(exec);
+        return true;
+    }
+
+    if (i >= m_vectorLength && !increaseVectorLength(i + 1)) {
+        throwOutOfMemoryError(exec);
+        return true;
+    }
+
+    storage = m_storage;
+    if (m_vectorMode == Int32Vector)
+        storage->int32Vector()[i] = int32Value;
+    else
+        storage->doubleVector()[i] = value.uncheckedGetNumber();
+    if (i == storage->m_numValuesInVector) {
+        ++storage->m_numValuesInVector;
+        if (i >= storage->m_length)
+            storage->m_length = i + 1;
+    }
+    return true;
+}
+
+bool AJArray::convertToDoubleVector()
+{
+    ASSERT(m_vectorMode == Int32Vector);
+
+    ArrayStorage* storage = static_cast<ArrayStorage*>(Heap::heap(this)->tryReallocateStorage(m_storage, storageSize(Int32Vector, m_vectorLength), storageSize(DoubleVector, m_vectorLength), reinterpret_cast<void**>(&m_storage)));
+    if (!storage)
+        return false;
+
+    // Each double covers the int32_ts at and after its own index, so going
+    // down reads every int32_t before it is overwritten.
+    int32_t* int32Vector = storage->int32Vector();
+    double* doubleVector = storage->doubleVector();
+    for (unsigned i = storage->m_numValuesInVector; i--; )
+        doubleVector[i] = int32Vector[i];
+
+    m_storage = storage;
+    m_vectorMode = DoubleVector;
+
+    Heap::heap(this)->reportExtraMemoryCost(m_vectorLength * (sizeof(double) - sizeof(int32_t)));
+    return true;
+}
+
+bool AJArray::convertToValueVector(ExecState* exec)
+{
+    if (m_vectorMode == ValueVector)
+        return true;
+
+    // Boxing a number can allocate, and a collection can move the storage,
+    // so the numbers are set aside and boxed into the new vector one by one.
+    unsigned numValuesInVector = m_storage->m_numValuesInVector;
+    Vector<double> values(numValuesInVector);
+    for (unsigned i = 0; i < numValuesInVector; ++i)
+        values[i] = m_vectorMode == Int32Vector ? m_storage->int32Vector()[i] : m_storage->doubleVector()[i];
+
+    size_t oldSize = storageSize(m_vectorMode, m_vectorLength);
+    size_t newSize = storageSize(ValueVector, m_vectorLength);
+    ArrayStorage* storage = static_cast<ArrayStorage*>(Heap::heap(this)->tryReallocateStorage(m_storage, storageSize(m_vectorMode, 0), newSize, reinterpret_cast<void**>(&m_storage)));
+    if (!storage)
+        return false;
+
+    for (unsigned i = 0; i < m_vectorLength; ++i)
+        storage->m_vector[i] = AJValue();
+    storage->m_numValuesInVector = 0;
+    m_storage = storage;
+    m_vectorMode = ValueVector;
+
+    for (unsigned i = 0; i < numValuesInVector; ++i) {
+        AJValue value = jsNumber(exec, values[i]);
+        m_storage->m_vector[i] = value;
+        ++m_storage->m_numValuesInVector;
+        Heap::writeBarrier(this, value);
+    }
+
+    checkConsistency();
+
+    if (newSize > oldSize)
+        Heap::heap(this)->reportExtraMemoryCost(newSize - oldSize);
+    return true;
+}
+
 NEVER_INLINE void AJArray::putSlowCase(ExecState* exec, unsigned i, AJValue value)
 {
     ArrayStorage* storage = m_storage;
-    SparseArrayValueMap* map = storage->m_sparseValueMap;
+    SparseArrayValueMap* map = m_sparseValueMap;
 
     if (i >= MIN_SPARSE_ARRAY_INDEX) {
         if (i > MAX_ARRAY_INDEX) {
@@ -353,7 +549,7 @@ NEVER_INLINE void AJArray::putSlowCase(ExecState* exec, unsigned i, AJValue valu
         if ((i > MAX_STORAGE_VECTOR_INDEX) || !isDenseEnoughForVector(i + 1, storage->m_numValuesInVector + 1)) {
             if (!map) {
                 map = new SparseArrayValueMap;
-                storage->m_sparseValueMap = map;
+                m_sparseValueMap = map;
             }
 
             pair<SparseArrayValueMap::iterator, bool> result = map->add(i, value);
@@ -363,9 +559,9 @@ NEVER_INLINE void AJArray::putSlowCase(ExecState* exec, unsigned i, AJValue valu
             }
 
             size_t capacity = map->capacity();
-            if (capacity != storage->reportedMapCapacity) {
-                Heap::heap(this)->reportExtraMemoryCost((capacity - storage->reportedMapCapacity) * (sizeof(unsigned) + sizeof(AJValue)));
-                storage->reportedMapCapacity = capacity;
+            if (capacity != m_reportedMapCapacity) {
+                Heap::heap(this)->reportExtraMemoryCost((capacity - m_reportedMapCapacity) * (sizeof(unsigned) + sizeof(AJValue)));
+                m_reportedMapCapacity = capacity;
             }
             return;
         }
@@ -405,13 +601,14 @@ NEVER_INLINE void AJArray::putSlowCase(ExecState* exec, unsigned i, AJValue valu
         }
     }
 
-    if (!tryFastRealloc(storage, storageSize(newVectorLength)).getValue(storage)) {
+    unsigned vectorLength = m_vectorLength;
+
+    storage = static_cast<ArrayStorage*>(Heap::heap(this)->tryReallocateStorage(storage, storageSize(ValueVector, vectorLength), storageSize(ValueVector, newVectorLength), reinterpret_cast<void**>(&m_storage)));
+    if (!storage) {
         throwOutOfMemoryError(exec);
         return;
     }
 
-    unsigned vectorLength = m_vectorLength;
-
     if (newNumValuesInVector == storage->m_numValuesInVector + 1) {
         for (unsigned j = vectorLength; j < newVectorLength; ++j)
             storage->m_vector[j] = AJValue();
@@ -433,7 +630,7 @@ NEVER_INLINE void AJArray::putSlowCase(ExecState* exec, unsigned i, AJValue valu
 
     checkConsistency();
 
-    Heap::heap(this)->reportExtraMemoryCost(storageSize(newVectorLength) - storageSize(vectorLength));
+    Heap::heap(this)->reportExtraMemoryCost(storageSize(ValueVector, newVectorLength) - storageSize(ValueVector, vectorLength));
 }
 
 bool AJArray::deleteProperty(ExecState* exec, const Identifier& propertyName)
@@ -453,6 +650,22 @@ bool AJArray::deleteProperty(ExecState* exec, unsigned i)
 {
     checkConsistency();
 
+    if (m_vectorMode != ValueVector && i < m_vectorLength) {
+        // Only the last value can go without leaving a hole.
+        unsigned numValuesInVector = m_storage->m_numValuesInVector;
+        if (i >= numValuesInVector)
+            return false;
+        if (i == numValuesInVector - 1) {
+            m_storage->m_numValuesInVector = i;
+            checkConsistency();
+            return true;
+        }
+        if (!convertToValueVector(exec)) {
+            throwOutOfMemoryError(exec);
+            return false;
+        }
+    }
+
     ArrayStorage* storage = m_storage;
 
     if (i < m_vectorLength) {
@@ -467,7 +680,7 @@ bool AJArray::deleteProperty(ExecState* exec, unsigned i)
         return true;
     }
 
-    if (SparseArrayValueMap* map = storage->m_sparseValueMap) {
+    if (SparseArrayValueMap* map = m_sparseValueMap) {
         if (i >= MIN_SPARSE_ARRAY_INDEX) {
             SparseArrayValueMap::iterator it = map->find(i);
             if (it != map->end()) {
@@ -494,13 +707,18 @@ void AJArray::getOwnPropertyNames(ExecState* exec, PropertyNameArray& propertyNa
 
     ArrayStorage* storage = m_storage;
 
-    unsigned usedVectorLength = min(storage->m_length, m_vectorLength);
-    for (unsigned i = 0; i < usedVectorLength; ++i) {
-        if (storage->m_vector[i])
+    if (m_vectorMode != ValueVector) {
+        for (unsigned i = 0; i < storage->m_numValuesInVector; ++i)
             propertyNames.add(Identifier::from(exec, i));
+    } else {
+        unsigned usedVectorLength = min(storage->m_length, m_vectorLength);
+        for (unsigned i = 0; i < usedVectorLength; ++i) {
+            if (storage->m_vector[i])
+                propertyNames.add(Identifier::from(exec, i));
+        }
     }
 
-    if (SparseArrayValueMap* map = storage->m_sparseValueMap) {
+    if (SparseArrayValueMap* map = m_sparseValueMap) {
         SparseArrayValueMap::iterator end = map->end();
         for (SparseArrayValueMap::iterator it = map->begin(); it != end; ++it)
             propertyNames.add(Identifier::from(exec, it->first));
@@ -524,17 +742,21 @@ bool AJArray::increaseVectorLength(unsigned newLength)
     ASSERT(newLength <= MAX_STORAGE_VECTOR_INDEX);
     unsigned newVectorLength = increasedVectorLength(newLength);
 
-    if (!tryFastRealloc(storage, storageSize(newVectorLength)).getValue(storage))
+    storage = static_cast<ArrayStorage*>(Heap::heap(this)->tryReallocateStorage(storage, storageSize(m_vectorMode, vectorLength), storageSize(m_vectorMode, newVectorLength), reinterpret_cast<void**>(&m_storage)));
+    if (!storage)
         return false;
 
     m_vectorLength = newVectorLength;
 
-    for (unsigned i = vectorLength; i < newVectorLength; ++i)
-        storage->m_vector[i] = AJValue();
+    // Holes in a vector of numbers are the indices past the last value, so need no clearing.
+    if (m_vectorMode == ValueVector) {
+        for (unsigned i = vectorLength; i < newVectorLength; ++i)
+            storage->m_vector[i] = AJValue();
+    }
 
     m_storage = storage;
 
-    Heap::heap(this)->reportExtraMemoryCost(storageSize(newVectorLength) - storageSize(vectorLength));
+    Heap::heap(this)->reportExtraMemoryCost(storageSize(m_vectorMode, newVectorLength) - storageSize(m_vectorMode, vectorLength));
 
     return true;
 }
@@ -547,7 +769,10 @@ void AJArray::setLength(unsigned newLength)
 
     unsigned length = m_storage->m_length;
 
-    if (newLength < length) {
+    if (m_vectorMode != ValueVector) {
+        if (newLength < storage->m_numValuesInVector)
+            storage->m_numValuesInVector = newLength;
+    } else if (newLength < length) {
         unsigned usedVectorLength = min(length, m_vectorLength);
         for (unsigned i = newLength; i < usedVectorLength; ++i) {
             AJValue& valueSlot = storage->m_vector[i];
@@ -556,7 +781,7 @@ void AJArray::setLength(unsigned newLength)
             storage->m_numValuesInVector -= hadValue;
         }
 
-        if (SparseArrayValueMap* map = storage->m_sparseValueMap) {
+        if (SparseArrayValueMap* map = m_sparseValueMap) {
             SparseArrayValueMap copy = *map;
             SparseArrayValueMap::iterator end = copy.end();
             for (SparseArrayValueMap::iterator it = copy.begin(); it != end; ++it) {
@@ -565,7 +790,7 @@ void AJArray::setLength(unsigned newLength)
             }
             if (map->isEmpty()) {
                 delete map;
-                storage->m_sparseValueMap = 0;
+                m_sparseValueMap = 0;
             }
         }
     }
@@ -575,7 +800,7 @@ void AJArray::setLength(unsigned newLength)
     checkConsistency();
 }
 
-AJValue AJArray::pop()
+AJValue AJArray::pop(ExecState* exec)
 {
     checkConsistency();
 
@@ -587,7 +812,13 @@ AJValue AJArray::pop()
 
     AJValue result;
 
-    if (length < m_vectorLength) {
+    if (m_vectorMode != ValueVector) {
+        if (length < m_storage->m_numValuesInVector) {
+            result = getIndex(exec, length);
+            m_storage->m_numValuesInVector = length;
+        } else
+            result = jsUndefined();
+    } else if (length < m_vectorLength) {
         AJValue& valueSlot = m_storage->m_vector[length];
         if (valueSlot) {
             --m_storage->m_numValuesInVector;
@@ -597,14 +828,14 @@ AJValue AJArray::pop()
             result = jsUndefined();
     } else {
         result = jsUndefined();
-        if (SparseArrayValueMap* map = m_storage->m_sparseValueMap) {
+        if (SparseArrayValueMap* map = m_sparseValueMap) {
             SparseArrayValueMap::iterator it = map->find(length);
             if (it != map->end()) {
                 result = it->second;
                 map->remove(it);
                 if (map->isEmpty()) {
                     delete map;
-                    m_storage->m_sparseValueMap = 0;
+                    m_sparseValueMap = 0;
                 }
             }
         }
@@ -621,6 +852,16 @@ void AJArray::push(ExecState* exec, AJValue value)
 {
     checkConsistency();
 
+    if (m_vectorMode != ValueVector) {
+        unsigned length = m_storage->m_length;
+        if (putNumberDirect(length, value) || putNumberSlowCase(exec, length, value)) {
+            checkConsistency();
+            return;
+        }
+    }
+
+    Heap::writeBarrier(this, value);
+
     if (m_storage->m_length < m_vectorLength) {
         m_storage->m_vector[m_storage->m_length] = value;
         ++m_storage->m_numValuesInVector;
@@ -630,7 +871,7 @@ void AJArray::push(ExecState* exec, AJValue value)
     }
 
     if (m_storage->m_length < MIN_SPARSE_ARRAY_INDEX) {
-        SparseArrayValueMap* map = m_storage->m_sparseValueMap;
+        SparseArrayValueMap* map = m_sparseValueMap;
         if (!map || map->isEmpty()) {
             if (increaseVectorLength(m_storage->m_length + 1)) {
                 m_storage->m_vector[m_storage->m_length] = value;
@@ -660,6 +901,20 @@ static int compareNumbersForQSort(const void* a, const void* b)
     return (da > db) - (da < db);
 }
 
+static int compareInt32sForQSort(const void* a, const void* b)
+{
+    int32_t ia = *static_cast<const int32_t*>(a);
+    int32_t ib = *static_cast<const int32_t*>(b);
+    return (ia > ib) - (ia < ib);
+}
+
+static int compareDoublesForQSort(const void* a, const void* b)
+{
+    double da = *static_cast<const double*>(a);
+    double db = *static_cast<const double*>(b);
+    return (da > db) - (da < db);
+}
+
 static int compareByStringPairForQSort(const void* a, const void* b)
 {
     const ValueStringPair* va = static_cast<const ValueStringPair*>(a);
@@ -669,8 +924,20 @@ static int compareByStringPairForQSort(const void* a, const void* b)
 
 void AJArray::sortNumeric(ExecState* exec, AJValue compareFunction, CallType callType, const CallData& callData)
 {
+    // A vector of numbers is already compacted, and holds nothing but numbers.
+    if (m_vectorMode == Int32Vector) {
+        qsort(m_storage->int32Vector(), m_storage->m_numValuesInVector, sizeof(int32_t), compareInt32sForQSort);
+        checkConsistency(SortConsistencyCheck);
+        return;
+    }
+    if (m_vectorMode == DoubleVector) {
+        qsort(m_storage->doubleVector(), m_storage->m_numValuesInVector, sizeof(double), compareDoublesForQSort);
+        checkConsistency(SortConsistencyCheck);
+        return;
+    }
+
     unsigned lengthNotIncludingUndefined = compactForSorting();
-    if (m_storage->m_sparseValueMap) {
+    if (m_sparseValueMap) {
         throwOutOfMemoryError(exec);
         return;
     }
@@ -700,8 +967,13 @@ void AJArray::sortNumeric(ExecState* exec, AJValue compareFunction, CallType cal
 
 void AJArray::sort(ExecState* exec)
 {
+    if (!convertToValueVector(exec)) {
+        throwOutOfMemoryError(exec);
+        return;
+    }
+
     unsigned lengthNotIncludingUndefined = compactForSorting();
-    if (m_storage->m_sparseValueMap) {
+    if (m_sparseValueMap) {
         throwOutOfMemoryError(exec);
         return;
     }
@@ -858,6 +1130,11 @@ void AJArray::sort(ExecState* exec, AJValue compareFunction, CallType callType,
     if (!m_storage->m_length)
         return;
 
+    if (!convertToValueVector(exec)) {
+        throwOutOfMemoryError(exec);
+        return;
+    }
+
     unsigned usedVectorLength = min(m_storage->m_length, m_vectorLength);
 
     AVLTree<AVLTreeAbstractorForArrayCompare, 44> tree; // Depth 44 is enough for 2^31 items
@@ -866,7 +1143,7 @@ void AJArray::sort(ExecState* exec, AJValue compareFunction, CallType callType,
     tree.abstractor().m_compareCallType = callType;
     tree.abstractor().m_compareCallData = &callData;
     tree.abstractor().m_globalThisValue = exec->globalThisValue();
-    tree.abstractor().m_nodes.resize(usedVectorLength + (m_storage->m_sparseValueMap ? m_storage->m_sparseValueMap->size() : 0));
+    tree.abstractor().m_nodes.resize(usedVectorLength + (m_sparseValueMap ? m_sparseValueMap->size() : 0));
 
     if (callType == CallTypeJS)
         tree.abstractor().m_cachedCall.set(new CachedCall(exec, asFunction(compareFunction), 2, exec->exceptionSlot()));
@@ -905,7 +1182,7 @@ void AJArray::sort(ExecState* exec, AJValue compareFunction, CallType callType,
 
     unsigned newUsedVectorLength = numDefined + numUndefined;
 
-    if (SparseArrayValueMap* map = m_storage->m_sparseValueMap) {
+    if (SparseArrayValueMap* map = m_sparseValueMap) {
         newUsedVectorLength += map->size();
         if (newUsedVectorLength > m_vectorLength) {
             // Check that it is possible to allocate an array large enough to hold all the entries.
@@ -923,7 +1200,7 @@ void AJArray::sort(ExecState* exec, AJValue compareFunction, CallType callType,
         }
 
         delete map;
-        m_storage->m_sparseValueMap = 0;
+        m_sparseValueMap = 0;
     }
 
     ASSERT(tree.abstractor().m_nodes.size() >= numDefined);
@@ -954,15 +1231,10 @@ void AJArray::sort(ExecState* exec, AJValue compareFunction, CallType callType,
 
 void AJArray::fillArgList(ExecState* exec, MarkedArgumentBuffer& args)
 {
-    AJValue* vector = m_storage->m_vector;
     unsigned vectorEnd = min(m_storage->m_length, m_vectorLength);
     unsigned i = 0;
-    for (; i < vectorEnd; ++i) {
-        AJValue& v = vector[i];
-        if (!v)
-            break;
-        args.append(v);
-    }
+    for (; i < vectorEnd && canGetIndex(i); ++i)
+        args.append(getIndex(exec, i));
 
     for (; i < m_storage->m_length; ++i)
         args.append(get(exec, i));
@@ -972,15 +1244,10 @@ void AJArray::copyToRegisters(ExecState* exec, Register* buffer, uint32_t maxSiz
 {
     ASSERT(m_storage->m_length >= maxSize);
     UNUSED_PARAM(maxSize);
-    AJValue* vector = m_storage->m_vector;
     unsigned vectorEnd = min(maxSize, m_vectorLength);
     unsigned i = 0;
-    for (; i < vectorEnd; ++i) {
-        AJValue& v = vector[i];
-        if (!v)
-            break;
-        buffer[i] = v;
-    }
+    for (; i < vectorEnd && canGetIndex(i); ++i)
+        buffer[i] = getIndex(exec, i);
 
     for (; i < maxSize; ++i)
         buffer[i] = get(exec, i);
@@ -988,6 +1255,7 @@ void AJArray::copyToRegisters(ExecState* exec, Register* buffer, uint32_t maxSiz
 
 unsigned AJArray::compactForSorting()
 {
+    ASSERT(m_vectorMode == ValueVector);
     checkConsistency();
 
     ArrayStorage* storage = m_storage;
@@ -1014,7 +1282,7 @@ unsigned AJArray::compactForSorting()
 
     unsigned newUsedVectorLength = numDefined + numUndefined;
 
-    if (SparseArrayValueMap* map = storage->m_sparseValueMap) {
+    if (SparseArrayValueMap* map = m_sparseValueMap) {
         newUsedVectorLength += map->size();
         if (newUsedVectorLength > m_vectorLength) {
             // Check that it is possible to allocate an array large enough to hold all the entries - if not,
@@ -1029,7 +1297,7 @@ unsigned AJArray::compactForSorting()
             storage->m_vector[numDefined++] = it->second;
 
         delete map;
-        storage->m_sparseValueMap = 0;
+        m_sparseValueMap = 0;
     }
 
     for (unsigned i = numDefined; i < newUsedVectorLength; ++i)
@@ -1046,12 +1314,12 @@ unsigned AJArray::compactForSorting()
 
 void* AJArray::subclassData() const
 {
-    return m_storage->subclassData;
+    return m_subclassData;
 }
 
 void AJArray::setSubclassData(void* d)
 {
-    m_storage->subclassData = d;
+    m_subclassData = d;
 }
 
 #if CHECK_ARRAY_CONSISTENCY
@@ -1060,14 +1328,20 @@ void AJArray::checkConsistency(ConsistencyCheckType type)
 {
     ASSERT(m_storage);
     if (type == SortConsistencyCheck)
-        ASSERT(!m_storage->m_sparseValueMap);
+        ASSERT(!m_sparseValueMap);
+
+    if (m_vectorMode != ValueVector) {
+        ASSERT(!m_sparseValueMap);
+        ASSERT(m_storage->m_numValuesInVector <= m_vectorLength);
+        ASSERT(m_storage->m_numValuesInVector <= m_storage->m_length);
+        return;
+    }
 
     unsigned numValuesInVector = 0;
     for (unsigned i = 0; i < m_vectorLength; ++i) {
         if (AJValue value = m_storage->m_vector[i]) {
             ASSERT(i < m_storage->m_length);
-            if (type != DestructorConsistencyCheck)
-                value->type(); // Likely to crash if the object was deallocated.
+            value->type(); // Likely to crash if the object was deallocated.
             ++numValuesInVector;
         } else {
             if (type == SortConsistencyCheck)
@@ -1077,16 +1351,15 @@ void AJArray::checkConsistency(ConsistencyCheckType type)
     ASSERT(numValuesInVector == m_storage->m_numValuesInVector);
     ASSERT(numValuesInVector <= m_storage->m_length);
 
-    if (m_storage->m_sparseValueMap) {
-        SparseArrayValueMap::iterator end = m_storage->m_sparseValueMap->end();
-        for (SparseArrayValueMap::iterator it = m_storage->m_sparseValueMap->begin(); it != end; ++it) {
+    if (m_sparseValueMap) {
+        SparseArrayValueMap::iterator end = m_sparseValueMap->end();
+        for (SparseArrayValueMap::iterator it = m_sparseValueMap->begin(); it != end; ++it) {
             unsigned index = it->first;
             ASSERT(index < m_storage->m_length);
             ASSERT(index >= m_vectorLength);
             ASSERT(index <= MAX_ARRAY_INDEX);
             ASSERT(it->second);
-            if (type != DestructorConsistencyCheck)
-                it->second->type(); // Likely to crash if the object was deallocated.
+            it->second->type(); // Likely to crash if the object was deallocated.
         }
     }
 }
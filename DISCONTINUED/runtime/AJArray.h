@@ -39,18 +39,22 @@ limitations under the License.
 #define AJArray_h
 
 #include "AJObject.h"
+#include "ParallelMarker.h"
 
 namespace AJ {
 
     typedef HashMap<unsigned, AJValue> SparseArrayValueMap;
 
+    // Lives in the heap's CopiedSpace, which may move it during a collection.
+    // Anything a dead array must free is kept in the AJArray itself.
     struct ArrayStorage {
         unsigned m_length;
         unsigned m_numValuesInVector;
-        SparseArrayValueMap* m_sparseValueMap;
-        void* subclassData; // A AJArray subclass can use this to fill the vector lazily.
-        size_t reportedMapCapacity;
         AJValue m_vector[1];
+
+        // The vector of an array that keeps its numbers unboxed.
+        int32_t* int32Vector() { return reinterpret_cast<int32_t*>(m_vector); }
+        double* doubleVector() { return reinterpret_cast<double*>(m_vector); }
     };
 
     class AJArray : public AJObject {
@@ -63,6 +67,10 @@ namespace AJ {
         AJArray(NonNullPassRefPtr<Structure>, const ArgList& initialValues);
         virtual ~AJArray();
 
+        // Only used by AJGlobalData::storeVPtrs, for an array outside the heap.
+        enum VPtrStealingHackType { VPtrStealingHack };
+        AJArray(VPtrStealingHackType);
+
         virtual bool getOwnPropertySlot(ExecState*, const Identifier& propertyName, PropertySlot&);
         virtual bool getOwnPropertySlot(ExecState*, unsigned propertyName, PropertySlot&);
         virtual bool getOwnPropertyDescriptor(ExecState*, const Identifier&, PropertyDescriptor&);
@@ -78,19 +86,40 @@ namespace AJ {
         void sortNumeric(ExecState*, AJValue compareFunction, CallType, const CallData&);
 
         void push(ExecState*, AJValue);
-        AJValue pop();
+        AJValue pop(ExecState*);
+
+        // An array that has only held numbers, with no holes before its last
+        // value, keeps them unboxed: its vector holds int32_ts or doubles, the
+        // values are at [0, m_numValuesInVector) and there is no sparse map.
+        // The first store that does not fit moves the array on to the next
+        // mode, and it never moves back.
+        enum VectorMode { Int32Vector, DoubleVector, ValueVector };
 
-        bool canGetIndex(unsigned i) { return i < m_vectorLength && m_storage->m_vector[i]; }
-        AJValue getIndex(unsigned i)
+        bool canGetIndex(unsigned i)
+        {
+            if (m_vectorMode == ValueVector)
+                return i < m_vectorLength && m_storage->m_vector[i];
+            return i < m_storage->m_numValuesInVector;
+        }
+        AJValue getIndex(ExecState* exec, unsigned i)
         {
             ASSERT(canGetIndex(i));
-            return m_storage->m_vector[i];
+            if (m_vectorMode == ValueVector)
+                return m_storage->m_vector[i];
+            if (m_vectorMode == Int32Vector)
+                return jsNumber(exec, m_storage->int32Vector()[i]);
+            return jsNumber(exec, m_storage->doubleVector()[i]);
         }
 
         bool canSetIndex(unsigned i) { return i < m_vectorLength; }
-        void setIndex(unsigned i, AJValue v)
+        void setIndex(ExecState* exec, unsigned i, AJValue v)
         {
             ASSERT(canSetIndex(i));
+            if (m_vectorMode != ValueVector) {
+                if (!putNumberDirect(i, v))
+                    AJArray::put(exec, i, v);
+                return;
+            }
             AJValue& x = m_storage->m_vector[i];
             if (!x) {
                 ++m_storage->m_numValuesInVector;
@@ -98,6 +127,7 @@ namespace AJ {
                     m_storage->m_length = i + 1;
             }
             x = v;
+            Heap::writeBarrier(this, v);
         }
 
         void fillArgList(ExecState*, MarkedArgumentBuffer&);
@@ -127,15 +157,24 @@ namespace AJ {
         bool getOwnPropertySlotSlowCase(ExecState*, unsigned propertyName, PropertySlot&);
         void putSlowCase(ExecState*, unsigned propertyName, AJValue);
 
+        inline bool putNumberDirect(unsigned propertyName, AJValue);
+        bool putNumberSlowCase(ExecState*, unsigned propertyName, AJValue);
+        bool convertToDoubleVector();
+        bool convertToValueVector(ExecState*);
+
         bool increaseVectorLength(unsigned newLength);
         
         unsigned compactForSorting();
 
-        enum ConsistencyCheckType { NormalConsistencyCheck, DestructorConsistencyCheck, SortConsistencyCheck };
+        enum ConsistencyCheckType { NormalConsistencyCheck, SortConsistencyCheck };
         void checkConsistency(ConsistencyCheckType = NormalConsistencyCheck);
 
         unsigned m_vectorLength;
+        VectorMode m_vectorMode;
         ArrayStorage* m_storage;
+        SparseArrayValueMap* m_sparseValueMap;
+        void* m_subclassData; // A AJArray subclass can use this to fill the vector lazily.
+        size_t m_reportedMapCapacity;
     };
 
     AJArray* asArray(AJValue);
@@ -157,16 +196,48 @@ namespace AJ {
     }
     inline bool isAJArray(AJGlobalData* globalData, AJCell* cell) { return cell->vptr() == globalData->jsArrayVPtr; }
 
+    // Stores v if it fits the vector's mode and leaves no hole, which is all
+    // an array of numbers usually sees.
+    inline bool AJArray::putNumberDirect(unsigned i, AJValue v)
+    {
+        ASSERT(m_vectorMode != ValueVector);
+        ArrayStorage* storage = m_storage;
+        unsigned numValuesInVector = storage->m_numValuesInVector;
+        if (i > numValuesInVector || i >= m_vectorLength)
+            return false;
+
+        if (m_vectorMode == Int32Vector) {
+            if (!v.isInt32())
+                return false;
+            storage->int32Vector()[i] = v.asInt32();
+        } else {
+            if (!v.isNumber())
+                return false;
+            storage->doubleVector()[i] = v.uncheckedGetNumber();
+        }
+
+        if (i == numValuesInVector) {
+            storage->m_numValuesInVector = i + 1;
+            if (i >= storage->m_length)
+                storage->m_length = i + 1;
+        }
+        return true;
+    }
+
     inline void AJArray::markChildrenDirect(MarkStack& markStack)
     {
         AJObject::markChildrenDirect(markStack);
-        
+
+        // Numbers are all there is in the other modes.
+        if (m_vectorMode != ValueVector)
+            return;
+
         ArrayStorage* storage = m_storage;
 
         unsigned usedVectorLength = std::min(storage->m_length, m_vectorLength);
         markStack.appendValues(storage->m_vector, usedVectorLength, MayContainNullValues);
 
-        if (SparseArrayValueMap* map = storage->m_sparseValueMap) {
+        if (SparseArrayValueMap* map = m_sparseValueMap) {
             SparseArrayValueMap::iterator end = map->end();
             for (SparseArrayValueMap::iterator it = map->begin(); it != end; ++it)
                 markStack.append(it->second);
@@ -176,6 +247,7 @@ namespace AJ {
     inline void MarkStack::markChildren(AJCell* cell)
     {
         ASSERT(Heap::isCellMarked(cell));
+        cell->structure()->mark();
         if (!cell->structure()->typeInfo().overridesMarkChildren()) {
 #ifdef NDEBUG
             asObject(cell)->markChildrenDirect(*this);
@@ -211,7 +283,7 @@ namespace AJ {
                 current.m_values++;
 
                 AJCell* cell;
-                if (!value || !value.isCell() || Heap::isCellMarked(cell = value.asCell())) {
+                if (!value || !value.isCell() || !testAndSetMarked(cell = value.asCell())) {
                     if (current.m_values == end) {
                         m_markSets.removeLast();
                         continue;
@@ -219,7 +291,6 @@ namespace AJ {
                     goto findNextUnmarkedNullValue;
                 }
 
-                Heap::markCell(cell);
                 if (cell->structure()->typeInfo().type() < CompoundType) {
                     if (current.m_values == end) {
                         m_markSets.removeLast();
@@ -233,9 +304,34 @@ namespace AJ {
 
                 markChildren(cell);
             }
-            while (!m_values.isEmpty())
+            while (!m_values.isEmpty()) {
                 markChildren(m_values.removeLast());
+#if ENABLE(PARALLEL_MARKING)
+                if (m_parallelMarker && m_parallelMarker->hasIdleMarkers())
+                    m_parallelMarker->donateWork(*this);
+#endif
+            }
+        }
+    }
+
+    inline bool MarkStack::drain(size_t cellLimit)
+    {
+        size_t visitedCells = 0;
+        while (!m_markSets.isEmpty() || !m_values.isEmpty()) {
+            if (!m_markSets.isEmpty()) {
+                MarkSet& current = m_markSets.last();
+                AJValue value = *current.m_values++;
+                if (current.m_values == current.m_end)
+                    m_markSets.removeLast();
+                if (value && value.isCell())
+                    append(value.asCell());
+                continue;
+            }
+            if (visitedCells++ == cellLimit)
+                return false;
+            markChildren(m_values.removeLast());
         }
+        return true;
     }
     
 } // namespace AJ
@@ -118,7 +118,7 @@ namespace AJ {
     private:
         enum VPtrStealingHackType { VPtrStealingHack };
         AJArrayArray(VPtrStealingHackType) 
-            : AJObject(createStructure(jsNull()))
+            : AJObject(AJObject::VPtrStealingHack, createStructure(jsNull()))
             , m_classInfo(0)
         {
         }
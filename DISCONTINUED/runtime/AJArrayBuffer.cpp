@@ -0,0 +1,109 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "config.h"
+#include "AJArrayBuffer.h"
+
+#include "AJGlobalObject.h"
+#include "Error.h"
+#include "PropertyNameArray.h"
+#include <wtf/FastMalloc.h>
+
+using namespace ATF;
+
+namespace AJ {
+
+ASSERT_CLASS_FITS_IN_CELL(AJArrayBuffer);
+
+const ClassInfo AJArrayBuffer::info = { "ArrayBuffer", 0, 0, 0 };
+
+AJArrayBuffer* AJArrayBuffer::create(ExecState* exec, unsigned byteLength)
+{
+    // As in Heap::shouldThrowOutOfMemoryError(), garbage may be all that is
+    // in the way.
+    Heap* heap = exec->heap();
+    if (heap->wouldExceedHardLimit(byteLength)) {
+        if (!heap->isBusy())
+            heap->lowMemoryNotification();
+        if (heap->wouldExceedHardLimit(byteLength)) {
+            throwError(exec, RangeError, "Out of memory allocating array buffer.");
+            return 0;
+        }
+    }
+
+    // An empty buffer still gets a byte, so that data() is never null.
+    void* data;
+    if (!tryFastCalloc(byteLength ? byteLength : 1, 1).getValue(data)) {
+        throwError(exec, RangeError, "Out of memory allocating array buffer.");
+        return 0;
+    }
+    return new (exec) AJArrayBuffer(exec->lexicalGlobalObject()->arrayBufferStructure(), static_cast<unsigned char*>(data), byteLength);
+}
+
+AJArrayBuffer::AJArrayBuffer(NonNullPassRefPtr<Structure> structure, unsigned char* data, unsigned byteLength)
+    : AJObject(structure)
+    , m_data(data)
+    , m_byteLength(byteLength)
+{
+    Heap::heap(this)->reportExtraMemoryCost(byteLength);
+}
+
+AJArrayBuffer::~AJArrayBuffer()
+{
+    fastFree(m_data);
+}
+
+bool AJArrayBuffer::getOwnPropertySlot(ExecState* exec, const Identifier& propertyName, PropertySlot& slot)
+{
+    if (propertyName == exec->propertyNames().byteLength) {
+        slot.setValue(jsNumber(exec, byteLength()));
+        return true;
+    }
+    return AJObject::getOwnPropertySlot(exec, propertyName, slot);
+}
+
+bool AJArrayBuffer::getOwnPropertyDescriptor(ExecState* exec, const Identifier& propertyName, PropertyDescriptor& descriptor)
+{
+    if (propertyName == exec->propertyNames().byteLength) {
+        descriptor.setDescriptor(jsNumber(exec, byteLength()), ReadOnly | DontDelete | DontEnum);
+        return true;
+    }
+    return AJObject::getOwnPropertyDescriptor(exec, propertyName, descriptor);
+}
+
+void AJArrayBuffer::put(ExecState* exec, const Identifier& propertyName, AJValue value, PutPropertySlot& slot)
+{
+    if (propertyName == exec->propertyNames().byteLength)
+        return;
+    AJObject::put(exec, propertyName, value, slot);
+}
+
+bool AJArrayBuffer::deleteProperty(ExecState* exec, const Identifier& propertyName)
+{
+    if (propertyName == exec->propertyNames().byteLength)
+        return false;
+    return AJObject::deleteProperty(exec, propertyName);
+}
+
+void AJArrayBuffer::getOwnPropertyNames(ExecState* exec, PropertyNameArray& propertyNames, EnumerationMode mode)
+{
+    if (mode == IncludeDontEnumProperties)
+        propertyNames.add(exec->propertyNames().byteLength);
+    AJObject::getOwnPropertyNames(exec, propertyNames, mode);
+}
+
+} // namespace AJ
@@ -0,0 +1,72 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef AJArrayBuffer_h
+#define AJArrayBuffer_h
+
+#include "AJObject.h"
+
+namespace AJ {
+
+    // The storage behind typed-array views. The bytes are malloc'ed, not
+    // allocated in the collector's heap, and the views point straight into
+    // them; the buffer reports their size to the collector as extra cost.
+    class AJArrayBuffer : public AJObject {
+    public:
+        // The contents start out zeroed. Throws a RangeError and returns 0 if
+        // they would take the heap past its hard limit, or cannot be allocated.
+        static AJArrayBuffer* create(ExecState*, unsigned byteLength);
+        virtual ~AJArrayBuffer();
+
+        static PassRefPtr<Structure> createStructure(AJValue prototype)
+        {
+            return Structure::create(prototype, TypeInfo(ObjectType, StructureFlags), AnonymousSlotCount);
+        }
+
+        virtual bool getOwnPropertySlot(ExecState*, const Identifier& propertyName, PropertySlot&);
+        virtual bool getOwnPropertyDescriptor(ExecState*, const Identifier&, PropertyDescriptor&);
+        virtual void put(ExecState*, const Identifier& propertyName, AJValue, PutPropertySlot&);
+        virtual bool deleteProperty(ExecState*, const Identifier& propertyName);
+        virtual void getOwnPropertyNames(ExecState*, PropertyNameArray&, EnumerationMode mode = ExcludeDontEnumProperties);
+
+        virtual const ClassInfo* classInfo() const { return &info; }
+        static const ClassInfo info;
+
+        unsigned byteLength() const { return m_byteLength; }
+        unsigned char* data() const { return m_data; }
+
+    protected:
+        static const unsigned StructureFlags = OverridesGetOwnPropertySlot | OverridesGetPropertyNames | AJObject::StructureFlags;
+
+    private:
+        AJArrayBuffer(NonNullPassRefPtr<Structure>, unsigned char* data, unsigned byteLength);
+
+        unsigned char* m_data;
+        unsigned m_byteLength;
+    };
+
+    AJArrayBuffer* asArrayBuffer(AJValue);
+
+    inline AJArrayBuffer* asArrayBuffer(AJValue value)
+    {
+        ASSERT(asObject(value)->inherits(&AJArrayBuffer::info));
+        return static_cast<AJArrayBuffer*>(asObject(value));
+    }
+
+} // namespace AJ
+
+#endif // AJArrayBuffer_h
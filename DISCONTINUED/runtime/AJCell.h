@@ -180,6 +180,37 @@ namespace AJ {
     {
     }
 
+    // A free cell is a dummy AJCell, so it is still safe to mark, followed by the
+    // link to the next cell on its size class's free list and the number of
+    // cells on the list from it on, so the list's length is known without
+    // walking it.
+    inline AJCell*& Heap::nextFreeCell(AJCell* cell)
+    {
+        return *reinterpret_cast<AJCell**>(reinterpret_cast<char*>(cell) + sizeof(AJCell));
+    }
+
+    inline size_t& Heap::freeCellsFrom(AJCell* cell)
+    {
+        return *reinterpret_cast<size_t*>(reinterpret_cast<char*>(cell) + sizeof(AJCell) + sizeof(AJCell*));
+    }
+
+    inline void* Heap::allocate(size_t s)
+    {
+        ASSERT(s <= LARGEST_CELL_SIZE);
+        ASSERT(m_operationInProgress == NoOperation);
+
+#if !COLLECT_ON_EVERY_ALLOCATION
+        // Fast case: pop a cell off the allocation buffer.
+        AJCell*& freeList = m_allocationBuffer.freeLists[sizeClassFor(s)];
+        if (AJCell* cell = freeList) {
+            freeList = nextFreeCell(cell);
+            return cell;
+        }
+#endif
+
+        return allocateSlowCase(s);
+    }
+
     inline void* AJCell::operator new(size_t size, AJGlobalData* globalData)
     {
         return globalData->heap.allocate(size);
@@ -340,13 +371,35 @@ namespace AJ {
         return isCell() ? asCell()->toThisObject(exec) : toThisObjectSlowCase(exec);
     }
 
+    ALWAYS_INLINE bool MarkStack::testAndSetMarked(AJCell* cell)
+    {
+        if (Heap::isCellMarked(cell))
+            return false;
+#if ENABLE(PARALLEL_MARKING)
+        // Another marker may be setting a neighbouring bit in the same word.
+        if (m_parallelMarker)
+            return Heap::testAndSetMarkedAtomically(cell);
+#endif
+        Heap::markCell(cell);
+        return true;
+    }
+
     ALWAYS_INLINE void MarkStack::append(AJCell* cell)
     {
         ASSERT(!m_isCheckingForDefaultMarkViolation);
         ASSERT(cell);
-        if (Heap::isCellMarked(cell))
+        if (!testAndSetMarked(cell)) {
+            if (UNLIKELY(m_heapSnapshot != 0))
+                recordSnapshotEdge(cell);
             return;
-        Heap::markCell(cell);
+        }
+        if (cell->structure()->typeInfo().type() >= CompoundType)
+            m_values.append(cell);
+    }
+
+    ALWAYS_INLINE void MarkStack::appendChildren(AJCell* cell)
+    {
+        ASSERT(Heap::isCellMarked(cell));
         if (cell->structure()->typeInfo().type() >= CompoundType)
             m_values.append(cell);
     }
@@ -67,8 +67,8 @@ bool AJFunction::isHostFunctionNonInline() const
     return isHostFunction();
 }
 
-AJFunction::AJFunction(NonNullPassRefPtr<Structure> structure)
-    : Base(structure)
+AJFunction::AJFunction(VPtrStealingHackType)
+    : Base(VPtrStealingHack, createStructure(jsNull()))
     , m_executable(adoptRef(new VPtrHackExecutable()))
 {
 }
@@ -289,10 +289,10 @@ AJObject* AJFunction::construct(ExecState* exec, const ArgList& args)
     Structure* structure;
     AJValue prototype = get(exec, exec->propertyNames().prototype);
     if (prototype.isObject())
-        structure = asObject(prototype)->inheritorID();
+        structure = asObject(prototype)->inheritorIDForConstruct();
     else
         structure = exec->lexicalGlobalObject()->emptyObjectStructure();
-    AJObject* thisObj = new (exec) AJObject(structure);
+    AJObject* thisObj = AJObject::createForConstruct(&exec->globalData(), structure);
 
     AJValue result = exec->interpreter()->execute(jsExecutable(), exec, this, thisObj, args, scopeChain().node(), exec->exceptionSlot());
     if (exec->hadException() || !result.isObject())
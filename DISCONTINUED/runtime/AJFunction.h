@@ -95,7 +95,7 @@ namespace AJ {
         const static unsigned StructureFlags = OverridesGetOwnPropertySlot | ImplementsHasInstance | OverridesMarkChildren | OverridesGetPropertyNames | InternalFunction::StructureFlags;
 
     private:
-        AJFunction(NonNullPassRefPtr<Structure>);
+        AJFunction(VPtrStealingHackType);
 
         bool isHostFunctionNonInline() const;
 
@@ -60,6 +60,7 @@ limitations under the License.
 #include "AJClassRef.h"
 #include "AJFunction.h"
 #include "AJLock.h"
+#include "AJTypedArray.h"
 #include "JSNotAnObject.h"
 #include "AJPropertyNameIterator.h"
 #include "AJStaticScopeObject.h"
@@ -92,25 +93,61 @@ extern JSC_CONST_HASHTABLE HashTable regExpTable;
 extern JSC_CONST_HASHTABLE HashTable regExpConstructorTable;
 extern JSC_CONST_HASHTABLE HashTable stringTable;
 
+void* AJGlobalData::jsObjectVPtr;
 void* AJGlobalData::jsArrayVPtr;
 void* AJGlobalData::jsByteArrayVPtr;
+void* AJGlobalData::jsTypedArrayVPtrs[8];
 void* AJGlobalData::jsStringVPtr;
 void* AJGlobalData::jsFunctionVPtr;
 
+template <typename TypedArray> void* AJGlobalData::stealTypedArrayVPtr(void* storage)
+{
+    COMPILE_ASSERT(sizeof(TypedArray) <= sizeof(CollectorCell), sizeof_AJTypedArray_must_be_less_than_CollectorCell);
+    AJCell* jsTypedArray = new (storage) TypedArray(TypedArray::VPtrStealingHack);
+    void* vptr = jsTypedArray->vptr();
+    Structure* structure = jsTypedArray->structure();
+    jsTypedArray->~AJCell();
+    structure->deref();
+    return vptr;
+}
+
 void AJGlobalData::storeVPtrs()
 {
     CollectorCell cell;
     void* storage = &cell;
 
+    COMPILE_ASSERT(sizeof(AJObject) <= sizeof(CollectorCell), sizeof_AJObject_must_be_less_than_CollectorCell);
+    // The objects hold the only references to their Structures, which are
+    // not in any heap.
+    AJCell* jsObject = new (storage) AJObject(AJObject::VPtrStealingHack, AJObject::createStructure(jsNull()));
+    AJGlobalData::jsObjectVPtr = jsObject->vptr();
+    Structure* structure = jsObject->structure();
+    jsObject->~AJCell();
+    structure->deref();
+
     COMPILE_ASSERT(sizeof(AJArray) <= sizeof(CollectorCell), sizeof_AJArray_must_be_less_than_CollectorCell);
-    AJCell* jsArray = new (storage) AJArray(AJArray::createStructure(jsNull()));
+    AJCell* jsArray = new (storage) AJArray(AJArray::VPtrStealingHack);
     AJGlobalData::jsArrayVPtr = jsArray->vptr();
+    structure = jsArray->structure();
     jsArray->~AJCell();
+    structure->deref();
 
     COMPILE_ASSERT(sizeof(AJArrayArray) <= sizeof(CollectorCell), sizeof_AJArrayArray_must_be_less_than_CollectorCell);
     AJCell* jsByteArray = new (storage) AJArrayArray(AJArrayArray::VPtrStealingHack);
     AJGlobalData::jsByteArrayVPtr = jsByteArray->vptr();
+    structure = jsByteArray->structure();
     jsByteArray->~AJCell();
+    structure->deref();
+
+    COMPILE_ASSERT(sizeof(jsTypedArrayVPtrs) / sizeof(void*) == AJTypedArray::TypeCount, jsTypedArrayVPtrs_has_a_vptr_for_each_type);
+    AJGlobalData::jsTypedArrayVPtrs[AJTypedArray::Int8] = stealTypedArrayVPtr<AJInt8Array>(storage);
+    AJGlobalData::jsTypedArrayVPtrs[AJTypedArray::Uint8] = stealTypedArrayVPtr<AJUint8Array>(storage);
+    AJGlobalData::jsTypedArrayVPtrs[AJTypedArray::Int16] = stealTypedArrayVPtr<AJInt16Array>(storage);
+    AJGlobalData::jsTypedArrayVPtrs[AJTypedArray::Uint16] = stealTypedArrayVPtr<AJUint16Array>(storage);
+    AJGlobalData::jsTypedArrayVPtrs[AJTypedArray::Int32] = stealTypedArrayVPtr<AJInt32Array>(storage);
+    AJGlobalData::jsTypedArrayVPtrs[AJTypedArray::Uint32] = stealTypedArrayVPtr<AJUint32Array>(storage);
+    AJGlobalData::jsTypedArrayVPtrs[AJTypedArray::Float32] = stealTypedArrayVPtr<AJFloat32Array>(storage);
+    AJGlobalData::jsTypedArrayVPtrs[AJTypedArray::Float64] = stealTypedArrayVPtr<AJFloat64Array>(storage);
 
     COMPILE_ASSERT(sizeof(AJString) <= sizeof(CollectorCell), sizeof_AJString_must_be_less_than_CollectorCell);
     AJCell* jsString = new (storage) AJString(AJString::VPtrStealingHack);
@@ -118,9 +155,11 @@ void AJGlobalData::storeVPtrs()
     jsString->~AJCell();
 
     COMPILE_ASSERT(sizeof(AJFunction) <= sizeof(CollectorCell), sizeof_AJFunction_must_be_less_than_CollectorCell);
-    AJCell* jsFunction = new (storage) AJFunction(AJFunction::createStructure(jsNull()));
+    AJCell* jsFunction = new (storage) AJFunction(AJFunction::VPtrStealingHack);
     AJGlobalData::jsFunctionVPtr = jsFunction->vptr();
+    structure = jsFunction->structure();
     jsFunction->~AJCell();
+    structure->deref();
 }
 
 AJGlobalData::AJGlobalData(GlobalDataType globalDataType, ThreadStackType threadStackType)
@@ -327,13 +366,15 @@ void AJGlobalData::recompileAllAJFunctions()
     // up throwing away code that is live on the stack.
     ASSERT(!dynamicGlobalObject);
 
-    LiveObjectIterator it = heap.primaryHeapBegin();
-    LiveObjectIterator heapEnd = heap.primaryHeapEnd();
-    for ( ; it != heapEnd; ++it) {
-        if ((*it)->inherits(&AJFunction::info)) {
-            AJFunction* function = asFunction(*it);
-            if (!function->executable()->isHostFunction())
-                function->jsExecutable()->recompile();
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        LiveObjectIterator it = heap.liveObjectsBegin(sizeClass);
+        LiveObjectIterator heapEnd = heap.liveObjectsEnd(sizeClass);
+        for ( ; it != heapEnd; ++it) {
+            if ((*it)->inherits(&AJFunction::info)) {
+                AJFunction* function = asFunction(*it);
+                if (!function->executable()->isHostFunction())
+                    function->jsExecutable()->recompile();
+            }
         }
     }
 }
@@ -53,6 +53,7 @@ limitations under the License.
 #include "JITStubs.h"
 #include "AJValue.h"
 #include "MarkStack.h"
+#include "MegamorphicCache.h"
 #include "NumericStrings.h"
 #include "SmallStrings.h"
 #include "Terminator.h"
@@ -167,8 +168,10 @@ namespace AJ {
 #endif
 
         static void storeVPtrs();
+        static JS_EXPORTDATA void* jsObjectVPtr;
         static JS_EXPORTDATA void* jsArrayVPtr;
         static JS_EXPORTDATA void* jsByteArrayVPtr;
+        static JS_EXPORTDATA void* jsTypedArrayVPtrs[8]; // Indexed by AJTypedArray::Type.
         static JS_EXPORTDATA void* jsStringVPtr;
         static JS_EXPORTDATA void* jsFunctionVPtr;
 
@@ -178,6 +181,7 @@ namespace AJ {
         SmallStrings smallStrings;
         NumericStrings numericStrings;
         DateInstanceCache dateInstanceCache;
+        MegamorphicCache megamorphicCache;
         
 #if ENABLE(ASSEMBLER)
         ExecutableAllocator executableAllocator;
@@ -253,6 +257,7 @@ namespace AJ {
         AJGlobalData(GlobalDataType, ThreadStackType);
         static AJGlobalData*& sharedInstanceInternal();
         void createNativeThunk();
+        template <typename TypedArray> static void* stealTypedArrayVPtr(void* storage);
 #if ENABLE(JIT) && ENABLE(INTERPRETER)
         bool m_canUseJIT;
 #endif
@@ -52,6 +52,8 @@ limitations under the License.
 #include "AJCallbackObject.h"
 
 #include "Arguments.h"
+#include "ArrayBufferConstructor.h"
+#include "ArrayBufferPrototype.h"
 #include "ArrayConstructor.h"
 #include "ArrayPrototype.h"
 #include "BooleanConstructor.h"
@@ -85,6 +87,8 @@ limitations under the License.
 #include "ScopeChainMark.h"
 #include "StringConstructor.h"
 #include "StringPrototype.h"
+#include "TypedArrayConstructor.h"
+#include "TypedArrayPrototype.h"
 #include "Debugger.h"
 
 namespace AJ {
@@ -257,6 +261,15 @@ void AJGlobalObject::reset(AJValue prototype)
     d()->regExpPrototype = new (exec) RegExpPrototype(exec, RegExpPrototype::createStructure(d()->objectPrototype), d()->prototypeFunctionStructure.get());
     d()->regExpStructure = RegExpObject::createStructure(d()->regExpPrototype);
 
+    ArrayBufferPrototype* arrayBufferPrototype = new (exec) ArrayBufferPrototype(exec, ArrayBufferPrototype::createStructure(d()->objectPrototype), d()->prototypeFunctionStructure.get());
+    d()->arrayBufferStructure = AJArrayBuffer::createStructure(arrayBufferPrototype);
+
+    TypedArrayPrototype* typedArrayPrototypes[AJTypedArray::TypeCount];
+    for (unsigned i = 0; i < AJTypedArray::TypeCount; ++i) {
+        typedArrayPrototypes[i] = new (exec) TypedArrayPrototype(exec, TypedArrayPrototype::createStructure(d()->objectPrototype), d()->prototypeFunctionStructure.get(), static_cast<AJTypedArray::Type>(i));
+        d()->typedArrayStructures[i] = AJTypedArray::createStructure(typedArrayPrototypes[i]);
+    }
+
     d()->methodCallDummy = constructEmptyObject(exec);
 
     ErrorPrototype* errorPrototype = new (exec) ErrorPrototype(exec, ErrorPrototype::createStructure(d()->objectPrototype), d()->prototypeFunctionStructure.get());
@@ -272,6 +285,8 @@ void AJGlobalObject::reset(AJValue prototype)
     AJCell* numberConstructor = new (exec) NumberConstructor(exec, NumberConstructor::createStructure(d()->functionPrototype), d()->numberPrototype);
     AJCell* dateConstructor = new (exec) DateConstructor(exec, DateConstructor::createStructure(d()->functionPrototype), d()->prototypeFunctionStructure.get(), d()->datePrototype);
 
+    AJCell* arrayBufferConstructor = new (exec) ArrayBufferConstructor(exec, ArrayBufferConstructor::createStructure(d()->functionPrototype), arrayBufferPrototype);
+
     d()->regExpConstructor = new (exec) RegExpConstructor(exec, RegExpConstructor::createStructure(d()->functionPrototype), d()->regExpPrototype);
 
     d()->errorConstructor = new (exec) ErrorConstructor(exec, ErrorConstructor::createStructure(d()->functionPrototype), errorPrototype);
@@ -295,6 +310,7 @@ void AJGlobalObject::reset(AJValue prototype)
     d()->datePrototype->putDirectFunctionWithoutTransition(exec->propertyNames().constructor, dateConstructor, DontEnum);
     d()->regExpPrototype->putDirectFunctionWithoutTransition(exec->propertyNames().constructor, d()->regExpConstructor, DontEnum);
     errorPrototype->putDirectFunctionWithoutTransition(exec->propertyNames().constructor, d()->errorConstructor, DontEnum);
+    arrayBufferPrototype->putDirectFunctionWithoutTransition(exec->propertyNames().constructor, arrayBufferConstructor, DontEnum);
 
     // Set global constructors
 
@@ -315,6 +331,14 @@ void AJGlobalObject::reset(AJValue prototype)
     putDirectFunctionWithoutTransition(Identifier(exec, "SyntaxError"), d()->syntaxErrorConstructor);
     putDirectFunctionWithoutTransition(Identifier(exec, "TypeError"), d()->typeErrorConstructor);
     putDirectFunctionWithoutTransition(Identifier(exec, "URIError"), d()->URIErrorConstructor);
+    putDirectFunctionWithoutTransition(Identifier(exec, "ArrayBuffer"), arrayBufferConstructor, DontEnum);
+
+    for (unsigned i = 0; i < AJTypedArray::TypeCount; ++i) {
+        AJTypedArray::Type type = static_cast<AJTypedArray::Type>(i);
+        AJCell* typedArrayConstructor = new (exec) TypedArrayConstructor(exec, TypedArrayConstructor::createStructure(d()->functionPrototype), typedArrayPrototypes[i], type);
+        typedArrayPrototypes[i]->putDirectFunctionWithoutTransition(exec->propertyNames().constructor, typedArrayConstructor, DontEnum);
+        putDirectFunctionWithoutTransition(Identifier(exec, AJTypedArray::classInfo(type)->className), typedArrayConstructor, DontEnum);
+    }
 
     // Set global values.
     GlobalPropertyInfo staticGlobals[] = {
@@ -397,6 +421,7 @@ void AJGlobalObject::markChildren(MarkStack& markStack)
 
     markIfNeeded(markStack, d()->errorStructure);
     markIfNeeded(markStack, d()->argumentsStructure);
+    markIfNeeded(markStack, d()->arrayBufferStructure);
     markIfNeeded(markStack, d()->arrayStructure);
     markIfNeeded(markStack, d()->booleanObjectStructure);
     markIfNeeded(markStack, d()->callbackConstructorStructure);
@@ -411,6 +436,8 @@ void AJGlobalObject::markChildren(MarkStack& markStack)
     markIfNeeded(markStack, d()->regExpMatchesArrayStructure);
     markIfNeeded(markStack, d()->regExpStructure);
     markIfNeeded(markStack, d()->stringObjectStructure);
+    for (unsigned i = 0; i < AJTypedArray::TypeCount; ++i)
+        markIfNeeded(markStack, d()->typedArrayStructures[i]);
 
     // No need to mark the other structures, because their prototypes are all
     // guaranteed to be referenced elsewhere.
@@ -41,6 +41,7 @@ limitations under the License.
 
 #include "AJArray.h"
 #include "AJGlobalData.h"
+#include "AJTypedArray.h"
 #include "JSVariableObject.h"
 #include "JSWeakObjectMapRefInternal.h"
 #include "NativeFunctionWrapper.h"
@@ -73,6 +74,8 @@ namespace AJ {
     typedef Vector<ExecState*, 16> ExecStateStack;
     
     class AJGlobalObject : public JSVariableObject {
+        friend class JIT;
+
     protected:
         using JSVariableObject::JSVariableObjectData;
         typedef HashSet<RefPtr<OpaqueJSWeakObjectMap> > WeakMapSet;
@@ -153,6 +156,7 @@ namespace AJ {
             AJObject* methodCallDummy;
 
             RefPtr<Structure> argumentsStructure;
+            RefPtr<Structure> arrayBufferStructure;
             RefPtr<Structure> arrayStructure;
             RefPtr<Structure> booleanObjectStructure;
             RefPtr<Structure> callbackConstructorStructure;
@@ -167,6 +171,7 @@ namespace AJ {
             RefPtr<Structure> regExpMatchesArrayStructure;
             RefPtr<Structure> regExpStructure;
             RefPtr<Structure> stringObjectStructure;
+            RefPtr<Structure> typedArrayStructures[AJTypedArray::TypeCount];
 
             SymbolTable symbolTable;
             unsigned profileGroup;
@@ -239,6 +244,7 @@ namespace AJ {
         AJObject* methodCallDummy() const { return d()->methodCallDummy; }
 
         Structure* argumentsStructure() const { return d()->argumentsStructure.get(); }
+        Structure* arrayBufferStructure() const { return d()->arrayBufferStructure.get(); }
         Structure* arrayStructure() const { return d()->arrayStructure.get(); }
         Structure* booleanObjectStructure() const { return d()->booleanObjectStructure.get(); }
         Structure* callbackConstructorStructure() const { return d()->callbackConstructorStructure.get(); }
@@ -253,6 +259,7 @@ namespace AJ {
         Structure* regExpMatchesArrayStructure() const { return d()->regExpMatchesArrayStructure.get(); }
         Structure* regExpStructure() const { return d()->regExpStructure.get(); }
         Structure* stringObjectStructure() const { return d()->stringObjectStructure.get(); }
+        Structure* typedArrayStructure(AJTypedArray::Type type) const { return d()->typedArrayStructures[type].get(); }
 
         void setProfileGroup(unsigned value) { d()->profileGroup = value; }
         unsigned profileGroup() const { return d()->profileGroup; }
@@ -90,16 +90,13 @@ static AJValue encode(ExecState* exec, const ArgList& args, const char* doNotEsc
     return builder.build(exec);
 }
 
-static AJValue decode(ExecState* exec, const ArgList& args, const char* doNotUnescape, bool strict)
+template <typename CharType> static AJValue decode(ExecState* exec, const CharType* d, int len, const char* doNotUnescape, bool strict)
 {
     AJStringBuilder builder;
-    UString str = args.at(0).toString(exec);
     int k = 0;
-    int len = str.size();
-    const UChar* d = str.data();
     UChar u = 0;
     while (k < len) {
-        const UChar* p = d + k;
+        const CharType* p = d + k;
         UChar c = *p;
         if (c == '%') {
             int charLen = 0;
@@ -111,7 +108,7 @@ static AJValue decode(ExecState* exec, const ArgList& args, const char* doNotUne
                     char sequence[5];
                     sequence[0] = b0;
                     for (int i = 1; i < sequenceLen; ++i) {
-                        const UChar* q = p + i * 3;
+                        const CharType* q = p + i * 3;
                         if (q[0] == '%' && isASCIIHexDigit(q[1]) && isASCIIHexDigit(q[2]))
                             sequence[i] = Lexer::convertHex(q[1], q[2]);
                         else {
@@ -156,6 +153,14 @@ static AJValue decode(ExecState* exec, const ArgList& args, const char* doNotUne
     return builder.build(exec);
 }
 
+static AJValue decode(ExecState* exec, const ArgList& args, const char* doNotUnescape, bool strict)
+{
+    UString str = args.at(0).toString(exec);
+    if (str.is8Bit())
+        return decode(exec, str.rep()->characters8(), str.size(), doNotUnescape, strict);
+    return decode(exec, str.data(), str.size(), doNotUnescape, strict);
+}
+
 bool isStrWhiteSpace(UChar c)
 {
     switch (c) {
@@ -212,10 +217,9 @@ double parseIntOverflow(const char* s, int length, int radix)
     return number;
 }
 
-static double parseInt(const UString& s, int radix)
+template <typename CharType> static double parseInt(const UString& s, const CharType* data, int radix)
 {
     int length = s.size();
-    const UChar* data = s.data();
     int p = 0;
 
     while (p < length && isStrWhiteSpace(data[p]))
@@ -271,12 +275,18 @@ static double parseInt(const UString& s, int radix)
     return sign * number;
 }
 
-static double parseFloat(const UString& s)
+static double parseInt(const UString& s, int radix)
+{
+    if (s.is8Bit())
+        return parseInt(s, s.rep()->characters8(), radix);
+    return parseInt(s, s.data(), radix);
+}
+
+template <typename CharType> static double parseFloat(const UString& s, const CharType* data)
 {
     // Check for 0x prefix here, because toDouble allows it, but we must treat it as 0.
     // Need to skip any whitespace and then one + or - sign.
     int length = s.size();
-    const UChar* data = s.data();
     int p = 0;
     while (p < length && isStrWhiteSpace(data[p]))
         ++p;
@@ -292,6 +302,13 @@ static double parseFloat(const UString& s)
     return s.toDouble(true /*tolerant*/, false /* NaN for empty string */);
 }
 
+static double parseFloat(const UString& s)
+{
+    if (s.is8Bit())
+        return parseFloat(s, s.rep()->characters8());
+    return parseFloat(s, s.data());
+}
+
 AJValue JSC_HOST_CALL globalFuncEval(ExecState* exec, AJObject* function, AJValue thisValue, const ArgList& args)
 {
     AJObject* thisObject = thisValue.toThisObject(exec);
@@ -401,15 +418,14 @@ AJValue JSC_HOST_CALL globalFuncEscape(ExecState* exec, AJObject*, AJValue, cons
 
     AJStringBuilder builder;
     UString str = args.at(0).toString(exec);
-    const UChar* c = str.data();
-    for (unsigned k = 0; k < str.size(); k++, c++) {
-        int u = c[0];
+    for (unsigned k = 0; k < str.size(); k++) {
+        UChar u = str[k];
         if (u > 255) {
             char tmp[7];
             snprintf(tmp, sizeof(tmp), "%%u%04X", u);
             builder.append(tmp);
         } else if (u != 0 && strchr(do_not_escape, static_cast<char>(u)))
-            builder.append(c, 1);
+            builder.append(u);
         else {
             char tmp[4];
             snprintf(tmp, sizeof(tmp), "%%%02X", u);
@@ -427,21 +443,18 @@ AJValue JSC_HOST_CALL globalFuncUnescape(ExecState* exec, AJObject*, AJValue, co
     int k = 0;
     int len = str.size();
     while (k < len) {
-        const UChar* c = str.data() + k;
-        UChar u;
-        if (c[0] == '%' && k <= len - 6 && c[1] == 'u') {
-            if (isASCIIHexDigit(c[2]) && isASCIIHexDigit(c[3]) && isASCIIHexDigit(c[4]) && isASCIIHexDigit(c[5])) {
-                u = Lexer::convertUnicode(c[2], c[3], c[4], c[5]);
-                c = &u;
+        UChar u = str[k];
+        if (u == '%' && k <= len - 6 && str[k + 1] == 'u') {
+            if (isASCIIHexDigit(str[k + 2]) && isASCIIHexDigit(str[k + 3]) && isASCIIHexDigit(str[k + 4]) && isASCIIHexDigit(str[k + 5])) {
+                u = Lexer::convertUnicode(str[k + 2], str[k + 3], str[k + 4], str[k + 5]);
                 k += 5;
             }
-        } else if (c[0] == '%' && k <= len - 3 && isASCIIHexDigit(c[1]) && isASCIIHexDigit(c[2])) {
-            u = UChar(Lexer::convertHex(c[1], c[2]));
-            c = &u;
+        } else if (u == '%' && k <= len - 3 && isASCIIHexDigit(str[k + 1]) && isASCIIHexDigit(str[k + 2])) {
+            u = UChar(Lexer::convertHex(str[k + 1], str[k + 2]));
             k += 2;
         }
         k++;
-        builder.append(*c);
+        builder.append(u);
     }
 
     return jsString(exec, builder.build());
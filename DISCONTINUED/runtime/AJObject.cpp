@@ -548,6 +548,21 @@ Structure* AJObject::createInheritorID()
     return m_inheritorID.get();
 }
 
+Structure* AJObject::finishSlackTracking()
+{
+    Structure* structure = m_inheritorID.get();
+    if (!structure->didConstructWhileTrackingSlack())
+        return structure;
+
+    // Objects constructed from now on get as many slots inline as the
+    // largest Structure that the objects constructed so far reached.
+    unsigned capacity = structure->largestTransitionStorageSize();
+    if (capacity <= inlineStorageCapacity)
+        return structure;
+    m_inheritorID = Structure::createWithInlineStorage(structure, capacity);
+    return m_inheritorID.get();
+}
+
 void AJObject::allocatePropertyStorage(size_t oldSize, size_t newSize)
 {
     allocatePropertyStorageInline(oldSize, newSize);
@@ -91,6 +91,7 @@ namespace AJ {
         friend class BatchedTransitionOptimizer;
         friend class JIT;
         friend class AJCell;
+        friend class AJGlobalData; // For storeVPtrs().
 
     public:
         explicit AJObject(NonNullPassRefPtr<Structure>);
@@ -107,6 +108,13 @@ namespace AJ {
         
         void setStructure(NonNullPassRefPtr<Structure>);
         Structure* inheritorID();
+        // The Structure for the objects that constructors whose prototype is
+        // this object create. Counts the construction for slack tracking.
+        Structure* inheritorIDForConstruct();
+
+        // Creates the object a constructor is called with as 'this', with as
+        // many inline storage slots as the Structure says.
+        static AJObject* createForConstruct(AJGlobalData*, Structure*);
 
         virtual UString className() const;
 
@@ -201,7 +209,11 @@ namespace AJ {
 
         // Fast access to known property offsets.
         AJValue getDirectOffset(size_t offset) const { return AJValue::decode(propertyStorage()[offset]); }
-        void putDirectOffset(size_t offset, AJValue value) { propertyStorage()[offset] = AJValue::encode(value); }
+        void putDirectOffset(size_t offset, AJValue value)
+        {
+            propertyStorage()[offset] = AJValue::encode(value);
+            Heap::writeBarrier(this, value);
+        }
 
         void fillGetterPropertySlot(PropertySlot&, AJValue* location);
 
@@ -224,6 +236,14 @@ namespace AJ {
 
         static const unsigned inlineStorageCapacity = sizeof(EncodedAJValue) == 2 * sizeof(void*) ? 4 : 3;
         static const unsigned nonInlineBaseStorageCapacity = 16;
+        // The most inline storage that fits in the largest cell. Only objects
+        // of this class, created by createForConstruct(), have more than
+        // inlineStorageCapacity slots: their storage runs past the end of the
+        // class.
+        static unsigned maxInlineStorageCapacity()
+        {
+            return (LARGEST_CELL_SIZE - OBJECT_OFFSETOF(AJObject, m_inlineStorage)) / sizeof(EncodedAJValue);
+        }
 
         static PassRefPtr<Structure> createStructure(AJValue prototype)
         {
@@ -242,6 +262,7 @@ namespace AJ {
         {
             ASSERT(index < m_structure->anonymousSlotCount());
             *locationForOffset(index) = value;
+            Heap::writeBarrier(this, value);
         }
         AJValue getAnonymousValue(unsigned index) const
         {
@@ -249,7 +270,20 @@ namespace AJ {
             return *locationForOffset(index);
         }
 
+        // For objects that AJGlobalData::storeVPtrs() constructs outside the
+        // heap. The object keeps a reference to the Structure, which the
+        // caller releases after destroying it.
+        enum VPtrStealingHackType { VPtrStealingHack };
+        AJObject(VPtrStealingHackType, NonNullPassRefPtr<Structure> structure)
+            : AJCell(structure.releaseRef())
+        {
+        }
+
     private:
+        // The heap frees Structures no cell uses, so a cell that starts using
+        // one marks it, without counting a reference.
+        void didStartUsingStructure();
+
         // Nobody should ever ask any of these questions on something already known to be a AJObject.
         using AJCell::isAPIValueWrapper;
         using AJCell::isGetterSetter;
@@ -283,13 +317,18 @@ namespace AJ {
 
         const HashEntry* findPropertyHashEntry(ExecState*, const Identifier& propertyName) const;
         Structure* createInheritorID();
+        Structure* finishSlackTracking();
 
+        RefPtr<Structure> m_inheritorID;
+#if USE(JSVALUE32_64)
+        int32_t m_inlineStoragePadding; // Keeps m_inlineStorage 8 byte aligned.
+#endif
+
+        // Last, so that createForConstruct() can allocate more inline storage.
         union {
             PropertyStorage m_externalStorage;
             EncodedAJValue m_inlineStorage[inlineStorageCapacity];
         };
-
-        RefPtr<Structure> m_inheritorID;
     };
     
 inline AJObject* asObject(AJCell* cell)
@@ -303,10 +342,19 @@ inline AJObject* asObject(AJValue value)
     return asObject(value.asCell());
 }
 
+inline void AJObject::didStartUsingStructure()
+{
+    if (UNLIKELY(!m_structure->heap()))
+        Heap::heap(this)->addStructure(m_structure);
+    m_structure->mark();
+    ASSERT(m_structure->heap() == Heap::heap(this));
+}
+
 inline AJObject::AJObject(NonNullPassRefPtr<Structure> structure)
-    : AJCell(structure.releaseRef()) // ~AJObject balances this ref()
+    : AJCell(structure.get())
 {
-    ASSERT(m_structure->propertyStorageCapacity() == inlineStorageCapacity);
+    didStartUsingStructure();
+    ASSERT(m_structure->isUsingInlineStorage());
     ASSERT(m_structure->isEmpty());
     ASSERT(prototype().isNull() || Heap::heap(this) == Heap::heap(prototype()));
 #if USE(JSVALUE64) || USE(JSVALUE32_64)
@@ -317,9 +365,6 @@ inline AJObject::AJObject(NonNullPassRefPtr<Structure> structure)
 inline AJObject::~AJObject()
 {
     ASSERT(m_structure);
-    if (!isUsingInlineStorage())
-        delete [] m_externalStorage;
-    m_structure->deref();
 }
 
 inline AJValue AJObject::prototype() const
@@ -336,8 +381,10 @@ inline void AJObject::setPrototype(AJValue prototype)
 
 inline void AJObject::setStructure(NonNullPassRefPtr<Structure> structure)
 {
-    m_structure->deref();
-    m_structure = structure.releaseRef(); // ~AJObject balances this ref()
+    m_structure = structure.get();
+    didStartUsingStructure();
+    // The new structure's prototype may be younger than this object.
+    Heap::writeBarrier(this);
 }
 
 inline Structure* AJObject::inheritorID()
@@ -347,9 +394,29 @@ inline Structure* AJObject::inheritorID()
     return createInheritorID();
 }
 
+inline Structure* AJObject::inheritorIDForConstruct()
+{
+    Structure* structure = inheritorID();
+    if (UNLIKELY(structure->isTrackingSlack()))
+        return finishSlackTracking();
+    return structure;
+}
+
+inline AJObject* AJObject::createForConstruct(AJGlobalData* globalData, Structure* structure)
+{
+    unsigned capacity = structure->inlineStorageCapacity();
+    globalData->heap.didConstructObject(capacity != inlineStorageCapacity);
+    if (capacity == inlineStorageCapacity)
+        return new (globalData) AJObject(structure);
+
+    ASSERT(capacity <= maxInlineStorageCapacity());
+    void* cell = globalData->heap.allocate(OBJECT_OFFSETOF(AJObject, m_inlineStorage) + capacity * sizeof(EncodedAJValue));
+    return new (cell) AJObject(structure);
+}
+
 inline bool Structure::isUsingInlineStorage() const
 {
-    return (propertyStorageCapacity() == AJObject::inlineStorageCapacity);
+    return (propertyStorageCapacity() == inlineStorageCapacity());
 }
 
 inline bool AJCell::inherits(const ClassInfo* info) const
@@ -715,17 +782,24 @@ ALWAYS_INLINE void AJObject::allocatePropertyStorageInline(size_t oldSize, size_
     ASSERT(newSize > oldSize);
 
     // It's important that this function not rely on m_structure, since
-    // we might be in the middle of a transition.
-    bool wasInline = (oldSize == AJObject::inlineStorageCapacity);
-
-    PropertyStorage oldPropertyStorage = (wasInline ? m_inlineStorage : m_externalStorage);
-    PropertyStorage newPropertyStorage = new EncodedAJValue[newSize];
-
-    for (unsigned i = 0; i < oldSize; ++i)
-       newPropertyStorage[i] = oldPropertyStorage[i];
-
-    if (!wasInline)
-        delete [] oldPropertyStorage;
+    // we might be in the middle of a transition. Only the inline capacity
+    // is safe to read: every transition keeps it.
+    bool wasInline = (oldSize == m_structure->inlineStorageCapacity());
+
+    Heap* heap = Heap::heap(this);
+    void** owner = reinterpret_cast<void**>(&m_externalStorage);
+    PropertyStorage newPropertyStorage;
+    if (wasInline) {
+        heap->didSpillPropertyStorage();
+        newPropertyStorage = static_cast<PropertyStorage>(heap->allocateStorage(newSize * sizeof(EncodedAJValue), owner));
+        for (unsigned i = 0; i < oldSize; ++i)
+            newPropertyStorage[i] = m_inlineStorage[i];
+    } else {
+        // The old storage is reclaimed by the collector.
+        newPropertyStorage = static_cast<PropertyStorage>(heap->tryReallocateStorage(m_externalStorage, oldSize * sizeof(EncodedAJValue), newSize * sizeof(EncodedAJValue), owner));
+        if (!newPropertyStorage)
+            CRASH();
+    }
 
     m_externalStorage = newPropertyStorage;
 }
@@ -741,6 +815,25 @@ ALWAYS_INLINE void AJObject::markChildrenDirect(MarkStack& markStack)
     markStack.appendValues(reinterpret_cast<AJValue*>(storage), storageSize);
 }
 
+ALWAYS_INLINE bool MegamorphicCache::get(AJCell* base, const Identifier& propertyName, AJValue& result)
+{
+    Structure* structure = base->structure();
+    UString::Rep* name = propertyName.ustring().rep();
+    Entry& entry = m_entries[index(structure, name)];
+    if (entry.structure != structure || entry.name != name)
+        return false;
+
+    // Only objects' Structures are ever added.
+    AJObject* holder = asObject(base);
+    if (entry.prototypeStructure) {
+        holder = asObject(structure->storedPrototype());
+        if (holder->structure() != entry.prototypeStructure)
+            return false;
+    }
+    result = holder->getDirectOffset(entry.offset);
+    return true;
+}
+
 // --- AJValue inlines ----------------------------
 
 ALWAYS_INLINE UString AJValue::toThisString(ExecState* exec) const
@@ -48,7 +48,36 @@ limitations under the License.
 
 namespace AJ {
     
-static const unsigned resolveRopeForSubstringCutoff = 4;
+// Substrings of ropes at most this long are copied out rather than made into ropes.
+static const unsigned substringCopyCutoff = 32;
+// Longer patterns than this are searched for in the resolved rope.
+static const unsigned ropeSearchMaxPatternLength = 32;
+
+static inline void copyFiberCharacters(LChar* destination, UStringImpl* string, unsigned offset, unsigned length)
+{
+    UStringImpl::copyChars(destination, string->characters8() + offset, length);
+}
+
+static inline void copyFiberCharacters(UChar* destination, UStringImpl* string, unsigned offset, unsigned length)
+{
+    // Copy 8-bit fibers without widening them in place.
+    if (string->is8Bit())
+        UStringImpl::copyChars(destination, string->characters8() + offset, length);
+    else
+        UStringImpl::copyChars(destination, string->characters16() + offset, length);
+}
+
+static inline bool equalFiberCharacters(UStringImpl* a, unsigned aOffset, UStringImpl* b, unsigned bOffset, unsigned length)
+{
+    if (a->is8Bit()) {
+        if (b->is8Bit())
+            return ::equal(a->characters8() + aOffset, b->characters8() + bOffset, length);
+        return ::equal(a->characters8() + aOffset, b->characters16() + bOffset, length);
+    }
+    if (b->is8Bit())
+        return ::equal(a->characters16() + aOffset, b->characters8() + bOffset, length);
+    return ::equal(a->characters16() + aOffset, b->characters16() + bOffset, length);
+}
 
 // Overview: this methods converts a AJString from holding a string in rope form
 // down to a simple UString representation.  It does so by building up the string
@@ -64,23 +93,38 @@ void AJString::resolveRope(ExecState* exec) const
 {
     ASSERT(isRope());
 
-    // Allocate the buffer to hold the final string, position initially points to the end.
-    UChar* buffer;
-    if (PassRefPtr<UStringImpl> newImpl = UStringImpl::tryCreateUninitialized(m_length, buffer))
-        m_value = newImpl;
-    else {
-        for (unsigned i = 0; i < m_fiberCount; ++i) {
-            RopeImpl::deref(m_other.m_fibers[i]);
-            m_other.m_fibers[i] = 0;
+    // The result can be 8-bit if every fiber is; a RopeImpl fiber knows this for all of its own.
+    bool is8Bit = true;
+    for (unsigned i = 0; i < m_fiberCount; ++i) {
+        if (!m_other.m_fibers[i]->is8Bit()) {
+            is8Bit = false;
+            break;
         }
-        m_fiberCount = 0;
-        ASSERT(!isRope());
-        ASSERT(m_value == UString());
-        if (exec)
-            throwOutOfMemoryError(exec);
+    }
+
+    // Allocate the buffer to hold the final string, then fill it in from the end.
+    if (is8Bit) {
+        LChar* buffer;
+        if (PassRefPtr<UStringImpl> newImpl = UStringImpl::tryCreateUninitialized(m_length, buffer)) {
+            m_value = newImpl;
+            resolveRopeInto(buffer);
+        } else
+            outOfMemory(exec);
         return;
     }
-    UChar* position = buffer + m_length;
+
+    UChar* buffer;
+    if (PassRefPtr<UStringImpl> newImpl = UStringImpl::tryCreateUninitialized(m_length, buffer)) {
+        m_value = newImpl;
+        resolveRopeInto(buffer);
+    } else
+        outOfMemory(exec);
+}
+
+template<typename CharType>
+void AJString::resolveRopeInto(CharType* buffer) const
+{
+    CharType* position = buffer + m_length;
 
     // Start with the current RopeImpl.
     Vector<RopeImpl::Fiber, 32> workQueue;
@@ -99,13 +143,12 @@ void AJString::resolveRope(ExecState* exec) const
             currentFiber = rope->fibers()[fiberCountMinusOne];
         } else {
             UStringImpl* string = static_cast<UStringImpl*>(currentFiber);
-            unsigned length = string->length();
-            position -= length;
-            UStringImpl::copyChars(position, string->characters(), length);
+            position -= string->length();
+            copyFiberCharacters(position, string, 0, string->length());
 
             // Was this the last item in the work queue?
             if (workQueue.isEmpty()) {
-                // Create a string from the UChar buffer, clear the rope RefPtr.
+                // Create a string from the character buffer, clear the rope RefPtr.
                 ASSERT(buffer == position);
                 for (unsigned i = 0; i < m_fiberCount; ++i) {
                     RopeImpl::deref(m_other.m_fibers[i]);
@@ -123,58 +166,292 @@ void AJString::resolveRope(ExecState* exec) const
         }
     }
 }
+
+void AJString::outOfMemory(ExecState* exec) const
+{
+    for (unsigned i = 0; i < m_fiberCount; ++i) {
+        RopeImpl::deref(m_other.m_fibers[i]);
+        m_other.m_fibers[i] = 0;
+    }
+    m_fiberCount = 0;
+    ASSERT(!isRope());
+    ASSERT(m_value == UString());
+    if (exec)
+        throwOutOfMemoryError(exec);
+}
     
-// This function construsts a substring out of a rope without flattening by reusing the existing fibers.
-// This can reduce memory usage substantially. Since traversing ropes is slow the function will revert 
-// back to flattening if the rope turns out to be long.
+namespace {
+
+    // The part of a fiber that a substring of a rope takes its characters from.
+    struct SubstringFiber {
+        SubstringFiber() { }
+        SubstringFiber(RopeImpl::Fiber fiber, unsigned offset, unsigned length)
+            : fiber(fiber)
+            , offset(offset)
+            , length(length)
+        {
+        }
+
+        bool isWholeFiber() const { return !offset && length == fiber->length(); }
+
+        RopeImpl::Fiber fiber;
+        unsigned offset;
+        unsigned length;
+    };
+
+} // namespace
+
+// Appends the parts of the given fibers that overlap [offset, offset + length), last first.
+static void appendOverlappingFibers(Vector<SubstringFiber, 16>& workQueue, RopeImpl::Fiber* fibers, unsigned fiberCount, unsigned fibersLength, unsigned offset, unsigned length)
+{
+    unsigned end = offset + length;
+    unsigned fiberEnd = fibersLength;
+    for (unsigned i = fiberCount; i && fiberEnd > offset; --i) {
+        RopeImpl::Fiber fiber = fibers[i - 1];
+        unsigned fiberStart = fiberEnd - fiber->length();
+        if (fiberStart < end && fiberStart < fiberEnd) {
+            unsigned start = std::max(offset, fiberStart);
+            workQueue.append(SubstringFiber(fiber, start - fiberStart, std::min(end, fiberEnd) - start));
+        }
+        fiberEnd = fiberStart;
+    }
+}
+
+// Finds, in order, the fibers that make up characters [offset, offset + length) of a rope.
+// Fibers inside the range are taken whole, ropes or not, and only the fibers cut by its ends
+// are descended into, so this takes time in the depth of the rope rather than its length.
+static void findSubstringFibers(RopeImpl::Fiber* fibers, unsigned fiberCount, unsigned fibersLength, unsigned offset, unsigned length, Vector<SubstringFiber, 16>& substringFibers)
+{
+    Vector<SubstringFiber, 16> workQueue;
+    appendOverlappingFibers(workQueue, fibers, fiberCount, fibersLength, offset, length);
+    while (!workQueue.isEmpty()) {
+        SubstringFiber item = workQueue.last();
+        workQueue.removeLast();
+        if (item.isWholeFiber() || !RopeImpl::isRope(item.fiber)) {
+            substringFibers.append(item);
+            continue;
+        }
+        RopeImpl* rope = static_cast<RopeImpl*>(item.fiber);
+        appendOverlappingFibers(workQueue, rope->fibers(), rope->fiberCount(), rope->length(), item.offset, item.length);
+    }
+}
+
+template<typename CharType>
+static void copySubstringFibers(CharType* position, const Vector<SubstringFiber, 16>& substringFibers)
+{
+    for (unsigned i = 0; i < substringFibers.size(); ++i) {
+        const SubstringFiber& substringFiber = substringFibers[i];
+        if (!RopeImpl::isRope(substringFiber.fiber)) {
+            copyFiberCharacters(position, static_cast<UStringImpl*>(substringFiber.fiber), substringFiber.offset, substringFiber.length);
+            position += substringFiber.length;
+            continue;
+        }
+
+        RopeImpl* rope = static_cast<RopeImpl*>(substringFiber.fiber);
+        AJString::RopeIterator end;
+        for (AJString::RopeIterator it(rope->fibers(), rope->fiberCount()); it != end; ++it) {
+            UStringImpl* string = *it;
+            copyFiberCharacters(position, string, 0, string->length());
+            position += string->length();
+        }
+    }
+}
+
+// This function constructs a substring out of a rope without flattening it. Short substrings
+// are copied out; longer ones become ropes of the fibers they span, cutting the fibers at either end.
 AJString* AJString::substringFromRope(ExecState* exec, unsigned substringStart, unsigned substringLength)
 {
     ASSERT(isRope());
 
     AJGlobalData* globalData = &exec->globalData();
 
-    UString substringFibers[3];
-    
-    unsigned fiberCount = 0;
-    unsigned substringFiberCount = 0;
-    unsigned substringEnd = substringStart + substringLength;
-    unsigned fiberEnd = 0;
+    if (substringLength == 1)
+        return jsSingleCharacterString(globalData, characterAtInRope(substringStart));
+
+    rebalanceDeepFibers();
+    Vector<SubstringFiber, 16> substringFibers;
+    findSubstringFibers(m_other.m_fibers, m_fiberCount, m_length, substringStart, substringLength, substringFibers);
+    ASSERT(substringFibers.size());
+
+    if (substringFibers.size() == 1) {
+        SubstringFiber& substringFiber = substringFibers[0];
+        if (RopeImpl::isRope(substringFiber.fiber))
+            return new (globalData) AJString(globalData, PassRefPtr<RopeImpl>(static_cast<RopeImpl*>(substringFiber.fiber)));
+        return jsSubstring(globalData, UString(static_cast<UStringImpl*>(substringFiber.fiber)), substringFiber.offset, substringFiber.length);
+    }
+
+    if (substringLength <= substringCopyCutoff) {
+        bool is8Bit = true;
+        for (unsigned i = 0; i < substringFibers.size(); ++i)
+            is8Bit = is8Bit && substringFibers[i].fiber->is8Bit();
+        if (is8Bit) {
+            LChar* buffer;
+            RefPtr<UStringImpl> result = UStringImpl::createUninitialized(substringLength, buffer);
+            copySubstringFibers(buffer, substringFibers);
+            return new (globalData) AJString(globalData, UString(result.release()));
+        }
+        UChar* buffer;
+        RefPtr<UStringImpl> result = UStringImpl::createUninitialized(substringLength, buffer);
+        copySubstringFibers(buffer, substringFibers);
+        return new (globalData) AJString(globalData, UString(result.release()));
+    }
+
+    RopeBuilder builder(substringFibers.size());
+    if (UNLIKELY(builder.isOutOfMemory())) {
+        throwOutOfMemoryError(exec);
+        return jsEmptyString(globalData);
+    }
+    for (unsigned i = 0; i < substringFibers.size(); ++i) {
+        SubstringFiber& substringFiber = substringFibers[i];
+        if (substringFiber.isWholeFiber())
+            builder.append(substringFiber.fiber);
+        else
+            builder.append(UString(UStringImpl::create(static_cast<UStringImpl*>(substringFiber.fiber), substringFiber.offset, substringFiber.length)));
+    }
+    return new (globalData) AJString(globalData, builder.release());
+}
+
+void AJString::rebalanceDeepFibers()
+{
+    ASSERT(isRope());
+    for (unsigned i = 0; i < m_fiberCount; ++i) {
+        RopeImpl::Fiber fiber = m_other.m_fibers[i];
+        if (!RopeImpl::isRope(fiber) || static_cast<RopeImpl*>(fiber)->depth() <= RopeImpl::s_maxDepth)
+            continue;
+        // If there is no memory to rebalance, the deep rope is still good.
+        if (RefPtr<RopeImpl> balanced = static_cast<RopeImpl*>(fiber)->rebalance()) {
+            RopeImpl::deref(fiber);
+            m_other.m_fibers[i] = balanced.release().releaseRef();
+        }
+    }
+}
+
+UChar AJString::characterAtInRope(unsigned index)
+{
+    ASSERT(isRope());
+    ASSERT(index < m_length);
+
+    rebalanceDeepFibers();
+
+    RopeImpl::Fiber* fibers = m_other.m_fibers;
+    while (true) {
+        RopeImpl::Fiber fiber = *fibers;
+        while (index >= fiber->length()) {
+            index -= fiber->length();
+            fiber = *++fibers;
+        }
+        if (!RopeImpl::isRope(fiber))
+            return (*static_cast<UStringImpl*>(fiber))[index];
+        fibers = static_cast<RopeImpl*>(fiber)->fibers();
+    }
+}
 
+unsigned AJString::findInRope(ExecState* exec, const UString& pattern, unsigned start)
+{
+    ASSERT(isRope());
+
+    unsigned patternLength = pattern.size();
+    if (patternLength > ropeSearchMaxPatternLength)
+        return value(exec).find(pattern, start);
+    if (m_length < patternLength)
+        return UString::NotFound;
+    if (!patternLength)
+        return start;
+
+    // Rebalancing merges short strings, which are slow to search one at a time.
+    rebalanceDeepFibers();
+
+    // A match within one fiber is found by searching the fiber. One that spans fibers starts
+    // somewhere in the last patternLength - 1 characters before a fiber, which are kept in overlap.
+    Vector<UChar, ropeSearchMaxPatternLength> patternCharacters(patternLength);
+    for (unsigned i = 0; i < patternLength; ++i)
+        patternCharacters[i] = pattern[i];
+    unsigned overlapLength = patternLength - 1;
+    Vector<UChar, ropeSearchMaxPatternLength> overlap;
+    unsigned fiberStart = 0;
     RopeIterator end;
     for (RopeIterator it(m_other.m_fibers, m_fiberCount); it != end; ++it) {
-        ++fiberCount;
-        UStringImpl* fiberString = *it;
-        unsigned fiberStart = fiberEnd;
-        fiberEnd = fiberStart + fiberString->length();
-        if (fiberEnd <= substringStart)
+        UStringImpl* fiber = *it;
+        unsigned fiberLength = fiber->length();
+        if (fiberStart + fiberLength <= start) {
+            fiberStart += fiberLength;
             continue;
-        unsigned copyStart = std::max(substringStart, fiberStart);
-        unsigned copyEnd = std::min(substringEnd, fiberEnd);
-        if (copyStart == fiberStart && copyEnd == fiberEnd)
-            substringFibers[substringFiberCount++] = UString(fiberString);
-        else
-            substringFibers[substringFiberCount++] = UString(UStringImpl::create(fiberString, copyStart - fiberStart, copyEnd - copyStart));
-        if (fiberEnd >= substringEnd)
-            break;
-        if (fiberCount > resolveRopeForSubstringCutoff || substringFiberCount >= 3) {
-            // This turned out to be a really inefficient rope. Just flatten it.
-            resolveRope(exec);
-            return jsSubstring(&exec->globalData(), m_value, substringStart, substringLength);
         }
+        unsigned searchStart = start > fiberStart ? start - fiberStart : 0;
+
+        for (unsigned i = 0; i < overlap.size(); ++i) {
+            if (overlap[i] != patternCharacters[0])
+                continue;
+            unsigned matched = 1;
+            for (; matched < patternLength; ++matched) {
+                unsigned position = i + matched;
+                if (position >= overlap.size() + fiberLength)
+                    break;
+                UChar c = position < overlap.size() ? overlap[position] : (*fiber)[position - overlap.size()];
+                if (c != patternCharacters[matched])
+                    break;
+            }
+            if (matched == patternLength)
+                return fiberStart - overlap.size() + i;
+        }
+
+        unsigned result = UString(fiber).find(pattern, searchStart);
+        if (result != UString::NotFound)
+            return fiberStart + result;
+
+        unsigned overlapStart = std::max(searchStart, fiberLength > overlapLength ? fiberLength - overlapLength : 0);
+        if (fiberLength - overlapStart == overlapLength)
+            overlap.shrink(0);
+        for (unsigned i = overlapStart; i < fiberLength; ++i)
+            overlap.append((*fiber)[i]);
+        if (overlap.size() > overlapLength)
+            overlap.remove(0, overlap.size() - overlapLength);
+        fiberStart += fiberLength;
     }
-    ASSERT(substringFiberCount && substringFiberCount <= 3);
 
-    if (substringLength == 1) {
-        ASSERT(substringFiberCount == 1);
-        UChar c = substringFibers[0].data()[0];
-        if (c <= 0xFF)
-            return globalData->smallStrings.singleCharacterString(globalData, c);
+    return UString::NotFound;
+}
+
+bool AJString::equalSlowCase(AJString* other)
+{
+    if (this == other)
+        return true;
+    if (m_length != other->m_length)
+        return false;
+
+    if (isRope())
+        rebalanceDeepFibers();
+    if (other->isRope())
+        other->rebalanceDeepFibers();
+
+    // A string that is not a rope is walked as a rope of one fiber.
+    RopeImpl::Fiber value = m_value.rep();
+    RopeImpl::Fiber otherValue = other->m_value.rep();
+    RopeIterator it(isRope() ? m_other.m_fibers : &value, size());
+    RopeIterator otherIt(other->isRope() ? other->m_other.m_fibers : &otherValue, other->size());
+    unsigned offset = 0;
+    unsigned otherOffset = 0;
+    for (unsigned remaining = m_length; remaining; ) {
+        UStringImpl* string = *it;
+        UStringImpl* otherString = *otherIt;
+        if (offset == string->length()) {
+            ++it;
+            offset = 0;
+            continue;
+        }
+        if (otherOffset == otherString->length()) {
+            ++otherIt;
+            otherOffset = 0;
+            continue;
+        }
+        unsigned length = std::min(string->length() - offset, otherString->length() - otherOffset);
+        if (!equalFiberCharacters(string, offset, otherString, otherOffset, length))
+            return false;
+        offset += length;
+        otherOffset += length;
+        remaining -= length;
     }
-    if (substringFiberCount == 1)
-        return new (globalData) AJString(globalData, substringFibers[0]);
-    if (substringFiberCount == 2)
-        return new (globalData) AJString(globalData, substringFibers[0], substringFibers[1]);
-    return new (globalData) AJString(globalData, substringFibers[0], substringFibers[1], substringFibers[2]);
+    return true;
 }
 
 AJValue AJString::replaceCharacter(ExecState* exec, UChar character, const UString& replacement)
@@ -232,13 +509,7 @@ AJValue AJString::replaceCharacter(ExecState* exec, UChar character, const UStri
 AJString* AJString::getIndexSlowCase(ExecState* exec, unsigned i)
 {
     ASSERT(isRope());
-    resolveRope(exec);
-    // Return a safe no-value result, this should never be used, since the excetion will be thrown.
-    if (exec->exception())
-        return jsString(exec, "");
-    ASSERT(!isRope());
-    ASSERT(i < m_value.size());
-    return jsSingleCharacterSubstring(exec, m_value, i);
+    return jsSingleCharacterString(exec, characterAtInRope(i));
 }
 
 AJValue AJString::toPrimitive(ExecState*, PreferredPrimitiveType) const
@@ -352,6 +352,27 @@ namespace AJ {
         }
         unsigned length() { return m_length; }
 
+        // These work on ropes without resolving them.
+        UChar characterAt(unsigned index)
+        {
+            ASSERT(index < m_length);
+            if (isRope())
+                return characterAtInRope(index);
+            return m_value[index];
+        }
+        unsigned find(ExecState* exec, const UString& pattern, unsigned start)
+        {
+            if (isRope())
+                return findInRope(exec, pattern, start);
+            return m_value.find(pattern, start);
+        }
+        bool equal(AJString* other)
+        {
+            if (isRope() || other->isRope())
+                return equalSlowCase(other);
+            return m_value == other->m_value;
+        }
+
         bool getStringPropertySlot(ExecState*, const Identifier& propertyName, PropertySlot&);
         bool getStringPropertySlot(ExecState*, unsigned propertyName, PropertySlot&);
         bool getStringPropertyDescriptor(ExecState*, const Identifier& propertyName, PropertyDescriptor&);
@@ -373,7 +394,13 @@ namespace AJ {
         }
 
         void resolveRope(ExecState*) const;
+        template<typename CharType> void resolveRopeInto(CharType* buffer) const;
+        void outOfMemory(ExecState*) const;
         AJString* substringFromRope(ExecState*, unsigned offset, unsigned length);
+        void rebalanceDeepFibers();
+        UChar characterAtInRope(unsigned index);
+        unsigned findInRope(ExecState*, const UString& pattern, unsigned start);
+        bool equalSlowCase(AJString* other);
 
         void appendStringInConstruct(unsigned& index, const UString& string)
         {
@@ -490,7 +517,7 @@ namespace AJ {
     {
         AJGlobalData* globalData = &exec->globalData();
         ASSERT(offset < static_cast<unsigned>(s.size()));
-        UChar c = s.data()[offset];
+        UChar c = s[offset];
         if (c <= 0xFF)
             return globalData->smallStrings.singleCharacterString(globalData, c);
         return fixupVPtr(globalData, new (globalData) AJString(globalData, UString(UStringImpl::create(s.rep(), offset, 1))));
@@ -525,7 +552,7 @@ namespace AJ {
         if (!size)
             return globalData->smallStrings.emptyString(globalData);
         if (size == 1) {
-            UChar c = s.data()[0];
+            UChar c = s[0];
             if (c <= 0xFF)
                 return globalData->smallStrings.singleCharacterString(globalData, c);
         }
@@ -534,7 +561,7 @@ namespace AJ {
 
     inline AJString* jsStringWithFinalizer(ExecState* exec, const UString& s, AJStringFinalizerCallback callback, void* context)
     {
-        ASSERT(s.size() && (s.size() > 1 || s.data()[0] > 0xFF));
+        ASSERT(s.size() && (s.size() > 1 || s[0] > 0xFF));
         AJGlobalData* globalData = &exec->globalData();
         return fixupVPtr(globalData, new (globalData) AJString(globalData, s, callback, context));
     }
@@ -560,7 +587,7 @@ namespace AJ {
         if (!length)
             return globalData->smallStrings.emptyString(globalData);
         if (length == 1) {
-            UChar c = s.data()[offset];
+            UChar c = s[offset];
             if (c <= 0xFF)
                 return globalData->smallStrings.singleCharacterString(globalData, c);
         }
@@ -573,7 +600,7 @@ namespace AJ {
         if (!size)
             return globalData->smallStrings.emptyString(globalData);
         if (size == 1) {
-            UChar c = s.data()[0];
+            UChar c = s[0];
             if (c <= 0xFF)
                 return globalData->smallStrings.singleCharacterString(globalData, c);
         }
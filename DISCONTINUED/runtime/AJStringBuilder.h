@@ -75,6 +75,15 @@ public:
         }
     }
 
+    void append(const LChar* str, size_t len)
+    {
+        if (!buffer.tryReserveCapacity(buffer.size() + len)) {
+            m_okay = false;
+            return;
+        }
+        buffer.append(str, len);
+    }
+
     void append(const UChar* str, size_t len)
     {
         m_okay &= buffer.tryAppend(str, len);
@@ -82,7 +91,10 @@ public:
 
     void append(const UString& str)
     {
-        m_okay &= buffer.tryAppend(str.data(), str.size());
+        if (str.is8Bit())
+            append(str.rep()->characters8(), str.size());
+        else
+            m_okay &= buffer.tryAppend(str.data(), str.size());
     }
 
     AJValue build(ExecState* exec)
@@ -0,0 +1,267 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "config.h"
+#include "AJTypedArray.h"
+
+#include "AJGlobalObject.h"
+#include "PropertyNameArray.h"
+#include <string.h>
+#include <wtf/Vector.h>
+
+namespace AJ {
+
+ASSERT_CLASS_FITS_IN_CELL(AJTypedArray);
+
+const ClassInfo AJTypedArray::info = { "TypedArray", 0, 0, 0 };
+
+template <> const ClassInfo AJInt8Array::info = { "Int8Array", &AJTypedArray::info, 0, 0 };
+template <> const ClassInfo AJUint8Array::info = { "Uint8Array", &AJTypedArray::info, 0, 0 };
+template <> const ClassInfo AJInt16Array::info = { "Int16Array", &AJTypedArray::info, 0, 0 };
+template <> const ClassInfo AJUint16Array::info = { "Uint16Array", &AJTypedArray::info, 0, 0 };
+template <> const ClassInfo AJInt32Array::info = { "Int32Array", &AJTypedArray::info, 0, 0 };
+template <> const ClassInfo AJUint32Array::info = { "Uint32Array", &AJTypedArray::info, 0, 0 };
+template <> const ClassInfo AJFloat32Array::info = { "Float32Array", &AJTypedArray::info, 0, 0 };
+template <> const ClassInfo AJFloat64Array::info = { "Float64Array", &AJTypedArray::info, 0, 0 };
+
+const ClassInfo* AJTypedArray::classInfo(Type type)
+{
+    switch (type) {
+    case Int8:
+        return &AJInt8Array::info;
+    case Uint8:
+        return &AJUint8Array::info;
+    case Int16:
+        return &AJInt16Array::info;
+    case Uint16:
+        return &AJUint16Array::info;
+    case Int32:
+        return &AJInt32Array::info;
+    case Uint32:
+        return &AJUint32Array::info;
+    case Float32:
+        return &AJFloat32Array::info;
+    case Float64:
+        return &AJFloat64Array::info;
+    }
+    ASSERT_NOT_REACHED();
+    return 0;
+}
+
+AJTypedArray* AJTypedArray::create(ExecState* exec, Type type, AJArrayBuffer* buffer, unsigned byteOffset, unsigned length)
+{
+    Structure* structure = exec->lexicalGlobalObject()->typedArrayStructure(type);
+    switch (type) {
+    case Int8:
+        return new (exec) AJInt8Array(structure, buffer, byteOffset, length);
+    case Uint8:
+        return new (exec) AJUint8Array(structure, buffer, byteOffset, length);
+    case Int16:
+        return new (exec) AJInt16Array(structure, buffer, byteOffset, length);
+    case Uint16:
+        return new (exec) AJUint16Array(structure, buffer, byteOffset, length);
+    case Int32:
+        return new (exec) AJInt32Array(structure, buffer, byteOffset, length);
+    case Uint32:
+        return new (exec) AJUint32Array(structure, buffer, byteOffset, length);
+    case Float32:
+        return new (exec) AJFloat32Array(structure, buffer, byteOffset, length);
+    case Float64:
+        return new (exec) AJFloat64Array(structure, buffer, byteOffset, length);
+    }
+    ASSERT_NOT_REACHED();
+    return 0;
+}
+
+AJTypedArray::AJTypedArray(NonNullPassRefPtr<Structure> structure, Type type, AJArrayBuffer* buffer, unsigned byteOffset, unsigned length)
+    : AJObject(structure)
+    , m_type(type)
+    , m_length(length)
+    , m_byteOffset(byteOffset)
+    , m_data(buffer->data() + byteOffset)
+{
+    ASSERT(!(byteOffset % elementSize(type)));
+    ASSERT(byteOffset <= buffer->byteLength() && length <= (buffer->byteLength() - byteOffset) / elementSize(type));
+    putAnonymousValue(0, buffer);
+}
+
+bool AJTypedArray::getOwnPropertySlot(ExecState* exec, const Identifier& propertyName, PropertySlot& slot)
+{
+    bool isArrayIndex;
+    unsigned i = propertyName.toArrayIndex(&isArrayIndex);
+    if (isArrayIndex)
+        return getOwnPropertySlot(exec, i, slot);
+
+    const CommonIdentifiers& names = exec->propertyNames();
+    if (propertyName == names.length) {
+        slot.setValue(jsNumber(exec, m_length));
+        return true;
+    }
+    if (propertyName == names.byteLength) {
+        slot.setValue(jsNumber(exec, byteLength()));
+        return true;
+    }
+    if (propertyName == names.byteOffset) {
+        slot.setValue(jsNumber(exec, m_byteOffset));
+        return true;
+    }
+    if (propertyName == names.buffer) {
+        slot.setValue(buffer());
+        return true;
+    }
+
+    return AJObject::getOwnPropertySlot(exec, propertyName, slot);
+}
+
+bool AJTypedArray::getOwnPropertySlot(ExecState* exec, unsigned propertyName, PropertySlot& slot)
+{
+    if (canAccessIndex(propertyName)) {
+        slot.setValue(getIndex(exec, propertyName));
+        return true;
+    }
+    return AJObject::getOwnPropertySlot(exec, Identifier::from(exec, propertyName), slot);
+}
+
+bool AJTypedArray::getOwnPropertyDescriptor(ExecState* exec, const Identifier& propertyName, PropertyDescriptor& descriptor)
+{
+    bool isArrayIndex;
+    unsigned i = propertyName.toArrayIndex(&isArrayIndex);
+    if (isArrayIndex && canAccessIndex(i)) {
+        descriptor.setDescriptor(getIndex(exec, i), DontDelete);
+        return true;
+    }
+
+    const CommonIdentifiers& names = exec->propertyNames();
+    if (propertyName == names.length) {
+        descriptor.setDescriptor(jsNumber(exec, m_length), ReadOnly | DontDelete | DontEnum);
+        return true;
+    }
+    if (propertyName == names.byteLength) {
+        descriptor.setDescriptor(jsNumber(exec, byteLength()), ReadOnly | DontDelete | DontEnum);
+        return true;
+    }
+    if (propertyName == names.byteOffset) {
+        descriptor.setDescriptor(jsNumber(exec, m_byteOffset), ReadOnly | DontDelete | DontEnum);
+        return true;
+    }
+    if (propertyName == names.buffer) {
+        descriptor.setDescriptor(buffer(), ReadOnly | DontDelete | DontEnum);
+        return true;
+    }
+
+    return AJObject::getOwnPropertyDescriptor(exec, propertyName, descriptor);
+}
+
+void AJTypedArray::put(ExecState* exec, const Identifier& propertyName, AJValue value, PutPropertySlot& slot)
+{
+    bool isArrayIndex;
+    unsigned i = propertyName.toArrayIndex(&isArrayIndex);
+    if (isArrayIndex) {
+        setIndex(exec, i, value);
+        return;
+    }
+
+    const CommonIdentifiers& names = exec->propertyNames();
+    if (propertyName == names.length || propertyName == names.byteLength || propertyName == names.byteOffset || propertyName == names.buffer)
+        return;
+
+    AJObject::put(exec, propertyName, value, slot);
+}
+
+void AJTypedArray::put(ExecState* exec, unsigned propertyName, AJValue value)
+{
+    setIndex(exec, propertyName, value);
+}
+
+bool AJTypedArray::deleteProperty(ExecState* exec, const Identifier& propertyName)
+{
+    bool isArrayIndex;
+    unsigned i = propertyName.toArrayIndex(&isArrayIndex);
+    if (isArrayIndex)
+        return deleteProperty(exec, i);
+
+    const CommonIdentifiers& names = exec->propertyNames();
+    if (propertyName == names.length || propertyName == names.byteLength || propertyName == names.byteOffset || propertyName == names.buffer)
+        return false;
+
+    return AJObject::deleteProperty(exec, propertyName);
+}
+
+bool AJTypedArray::deleteProperty(ExecState* exec, unsigned propertyName)
+{
+    if (canAccessIndex(propertyName))
+        return false;
+    return AJObject::deleteProperty(exec, Identifier::from(exec, propertyName));
+}
+
+void AJTypedArray::getOwnPropertyNames(ExecState* exec, PropertyNameArray& propertyNames, EnumerationMode mode)
+{
+    for (unsigned i = 0; i < m_length; ++i)
+        propertyNames.add(Identifier::from(exec, i));
+
+    if (mode == IncludeDontEnumProperties) {
+        const CommonIdentifiers& names = exec->propertyNames();
+        propertyNames.add(names.length);
+        propertyNames.add(names.byteLength);
+        propertyNames.add(names.byteOffset);
+        propertyNames.add(names.buffer);
+    }
+
+    AJObject::getOwnPropertyNames(exec, propertyNames, mode);
+}
+
+void AJTypedArray::set(ExecState* exec, AJObject* source, unsigned length, unsigned offset)
+{
+    ASSERT(offset <= m_length && length <= m_length - offset);
+
+    if (!source->inherits(&AJTypedArray::info)) {
+        for (unsigned i = 0; i < length; ++i) {
+            AJValue value = source->get(exec, i);
+            if (exec->hadException())
+                return;
+            setIndex(exec, offset + i, value);
+            if (exec->hadException())
+                return;
+        }
+        return;
+    }
+
+    AJTypedArray* sourceArray = static_cast<AJTypedArray*>(source);
+    ASSERT(length <= sourceArray->m_length);
+    if (sourceArray->m_type == m_type) {
+        unsigned size = elementSize(m_type);
+        memmove(static_cast<char*>(m_data) + offset * size, sourceArray->m_data, length * size);
+        return;
+    }
+
+    // Converting from one type to another goes element by element, which
+    // could overwrite elements of the source before reading them if the two
+    // views overlap in the same buffer.
+    if (sourceArray->buffer() == buffer()) {
+        Vector<double, 64> values(length);
+        for (unsigned i = 0; i < length; ++i)
+            values[i] = sourceArray->getNumber(i);
+        for (unsigned i = 0; i < length; ++i)
+            setIndex(offset + i, values[i]);
+        return;
+    }
+
+    for (unsigned i = 0; i < length; ++i)
+        setIndex(offset + i, sourceArray->getNumber(i));
+}
+
+} // namespace AJ
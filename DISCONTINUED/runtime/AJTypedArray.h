@@ -0,0 +1,281 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef AJTypedArray_h
+#define AJTypedArray_h
+
+#include "AJArrayBuffer.h"
+#include <stdint.h>
+
+namespace AJ {
+
+    // A view of part of an ArrayBuffer as an array of numbers of one type.
+    // Each type of view is its own class, AJTypedArrayOf<type>, so that code
+    // specialized for one of them can tell it apart by vptr, the way it does
+    // AJArray; everything else goes through the accessors here, which work
+    // for all of them.
+    class AJTypedArray : public AJObject {
+        friend class JIT;
+    public:
+        enum Type { Int8, Uint8, Int16, Uint16, Int32, Uint32, Float32, Float64 };
+        static const unsigned TypeCount = Float64 + 1;
+
+        static unsigned elementSize(Type type)
+        {
+            switch (type) {
+            case Int8:
+            case Uint8:
+                return 1;
+            case Int16:
+            case Uint16:
+                return 2;
+            case Int32:
+            case Uint32:
+            case Float32:
+                return 4;
+            case Float64:
+                return 8;
+            }
+            ASSERT_NOT_REACHED();
+            return 1;
+        }
+        static const ClassInfo* classInfo(Type);
+
+        // The caller checks that the view fits in the buffer, and that
+        // byteOffset is a multiple of the element size.
+        static AJTypedArray* create(ExecState*, Type, AJArrayBuffer*, unsigned byteOffset, unsigned length);
+
+        static PassRefPtr<Structure> createStructure(AJValue prototype)
+        {
+            return Structure::create(prototype, TypeInfo(ObjectType, StructureFlags), AnonymousSlotCount);
+        }
+
+        virtual bool getOwnPropertySlot(ExecState*, const Identifier& propertyName, PropertySlot&);
+        virtual bool getOwnPropertySlot(ExecState*, unsigned propertyName, PropertySlot&);
+        virtual bool getOwnPropertyDescriptor(ExecState*, const Identifier&, PropertyDescriptor&);
+        virtual void put(ExecState*, const Identifier& propertyName, AJValue, PutPropertySlot&);
+        virtual void put(ExecState*, unsigned propertyName, AJValue);
+        virtual bool deleteProperty(ExecState*, const Identifier& propertyName);
+        virtual bool deleteProperty(ExecState*, unsigned propertyName);
+        virtual void getOwnPropertyNames(ExecState*, PropertyNameArray&, EnumerationMode mode = ExcludeDontEnumProperties);
+
+        static const ClassInfo info;
+
+        Type type() const { return m_type; }
+        unsigned length() const { return m_length; }
+        unsigned byteOffset() const { return m_byteOffset; }
+        unsigned byteLength() const { return m_length * elementSize(m_type); }
+        AJArrayBuffer* buffer() const { return asArrayBuffer(getAnonymousValue(0)); }
+
+        bool canAccessIndex(unsigned i) const { return i < m_length; }
+
+        // Getting and setting elements cannot throw.
+        AJValue getIndex(ExecState* exec, unsigned i)
+        {
+            ASSERT(canAccessIndex(i));
+            switch (m_type) {
+            case Int8:
+                return jsNumber(exec, static_cast<int>(static_cast<int8_t*>(m_data)[i]));
+            case Uint8:
+                return jsNumber(exec, static_cast<int>(static_cast<uint8_t*>(m_data)[i]));
+            case Int16:
+                return jsNumber(exec, static_cast<int>(static_cast<int16_t*>(m_data)[i]));
+            case Uint16:
+                return jsNumber(exec, static_cast<int>(static_cast<uint16_t*>(m_data)[i]));
+            case Int32:
+                return jsNumber(exec, static_cast<int32_t*>(m_data)[i]);
+            case Uint32:
+                return jsNumber(exec, static_cast<uint32_t*>(m_data)[i]);
+            case Float32:
+                return jsNumber(exec, static_cast<double>(static_cast<float*>(m_data)[i]));
+            case Float64:
+                return jsNumber(exec, static_cast<double*>(m_data)[i]);
+            }
+            ASSERT_NOT_REACHED();
+            return AJValue();
+        }
+
+        double getNumber(unsigned i) const
+        {
+            ASSERT(canAccessIndex(i));
+            switch (m_type) {
+            case Int8:
+                return static_cast<int8_t*>(m_data)[i];
+            case Uint8:
+                return static_cast<uint8_t*>(m_data)[i];
+            case Int16:
+                return static_cast<int16_t*>(m_data)[i];
+            case Uint16:
+                return static_cast<uint16_t*>(m_data)[i];
+            case Int32:
+                return static_cast<int32_t*>(m_data)[i];
+            case Uint32:
+                return static_cast<uint32_t*>(m_data)[i];
+            case Float32:
+                return static_cast<float*>(m_data)[i];
+            case Float64:
+                return static_cast<double*>(m_data)[i];
+            }
+            ASSERT_NOT_REACHED();
+            return 0;
+        }
+
+        // Integer elements take the value modulo their range, as ToInt32
+        // does, rather than clamping it the way ByteArray does.
+        void setIndex(unsigned i, int32_t value)
+        {
+            ASSERT(canAccessIndex(i));
+            switch (m_type) {
+            case Int8:
+                static_cast<int8_t*>(m_data)[i] = static_cast<int8_t>(value);
+                return;
+            case Uint8:
+                static_cast<uint8_t*>(m_data)[i] = static_cast<uint8_t>(value);
+                return;
+            case Int16:
+                static_cast<int16_t*>(m_data)[i] = static_cast<int16_t>(value);
+                return;
+            case Uint16:
+                static_cast<uint16_t*>(m_data)[i] = static_cast<uint16_t>(value);
+                return;
+            case Int32:
+                static_cast<int32_t*>(m_data)[i] = value;
+                return;
+            case Uint32:
+                static_cast<uint32_t*>(m_data)[i] = static_cast<uint32_t>(value);
+                return;
+            case Float32:
+                static_cast<float*>(m_data)[i] = static_cast<float>(value);
+                return;
+            case Float64:
+                static_cast<double*>(m_data)[i] = value;
+                return;
+            }
+            ASSERT_NOT_REACHED();
+        }
+
+        void setIndex(unsigned i, double value)
+        {
+            ASSERT(canAccessIndex(i));
+            switch (m_type) {
+            case Float32:
+                static_cast<float*>(m_data)[i] = static_cast<float>(value);
+                return;
+            case Float64:
+                static_cast<double*>(m_data)[i] = value;
+                return;
+            default:
+                setIndex(i, toInt32(value));
+                return;
+            }
+        }
+
+        // Converting the value may throw; nothing is stored if it does, or if
+        // i is out of bounds.
+        void setIndex(ExecState* exec, unsigned i, AJValue value)
+        {
+            double number = value.toNumber(exec);
+            if (exec->hadException())
+                return;
+            if (canAccessIndex(i))
+                setIndex(i, number);
+        }
+
+        // Sets length elements from offset on to those of source, which is
+        // either another view or array-like. The caller checks that they fit.
+        void set(ExecState*, AJObject* source, unsigned length, unsigned offset);
+
+    protected:
+        static const unsigned StructureFlags = OverridesGetOwnPropertySlot | OverridesGetPropertyNames | AJObject::StructureFlags;
+        static const unsigned AnonymousSlotCount = 1 + AJObject::AnonymousSlotCount;
+
+        AJTypedArray(NonNullPassRefPtr<Structure>, Type, AJArrayBuffer*, unsigned byteOffset, unsigned length);
+
+        enum VPtrStealingHackType { VPtrStealingHack };
+        AJTypedArray(VPtrStealingHackType, Type type)
+            : AJObject(AJObject::VPtrStealingHack, createStructure(jsNull()))
+            , m_type(type)
+            , m_length(0)
+            , m_byteOffset(0)
+            , m_data(0)
+        {
+        }
+
+    private:
+        Type m_type;
+        unsigned m_length;
+        unsigned m_byteOffset;
+        void* m_data; // Points at the first element, in the buffer held in anonymous slot 0.
+    };
+
+    template <AJTypedArray::Type arrayType> class AJTypedArrayOf : public AJTypedArray {
+        friend class AJGlobalData;
+    public:
+        AJTypedArrayOf(NonNullPassRefPtr<Structure> structure, AJArrayBuffer* buffer, unsigned byteOffset, unsigned length)
+            : AJTypedArray(structure, arrayType, buffer, byteOffset, length)
+        {
+        }
+
+        virtual const ClassInfo* classInfo() const { return &info; }
+        static const ClassInfo info;
+
+    private:
+        AJTypedArrayOf(VPtrStealingHackType)
+            : AJTypedArray(VPtrStealingHack, arrayType)
+        {
+        }
+    };
+
+    typedef AJTypedArrayOf<AJTypedArray::Int8> AJInt8Array;
+    typedef AJTypedArrayOf<AJTypedArray::Uint8> AJUint8Array;
+    typedef AJTypedArrayOf<AJTypedArray::Int16> AJInt16Array;
+    typedef AJTypedArrayOf<AJTypedArray::Uint16> AJUint16Array;
+    typedef AJTypedArrayOf<AJTypedArray::Int32> AJInt32Array;
+    typedef AJTypedArrayOf<AJTypedArray::Uint32> AJUint32Array;
+    typedef AJTypedArrayOf<AJTypedArray::Float32> AJFloat32Array;
+    typedef AJTypedArrayOf<AJTypedArray::Float64> AJFloat64Array;
+
+    template <> const ClassInfo AJInt8Array::info;
+    template <> const ClassInfo AJUint8Array::info;
+    template <> const ClassInfo AJInt16Array::info;
+    template <> const ClassInfo AJUint16Array::info;
+    template <> const ClassInfo AJInt32Array::info;
+    template <> const ClassInfo AJUint32Array::info;
+    template <> const ClassInfo AJFloat32Array::info;
+    template <> const ClassInfo AJFloat64Array::info;
+
+    AJTypedArray* asTypedArray(AJValue);
+    inline AJTypedArray* asTypedArray(AJValue value)
+    {
+        return static_cast<AJTypedArray*>(asCell(value));
+    }
+
+    inline bool isAJTypedArray(AJGlobalData* globalData, AJValue v)
+    {
+        if (!v.isCell())
+            return false;
+        void* vptr = v.asCell()->vptr();
+        for (unsigned i = 0; i < AJTypedArray::TypeCount; ++i) {
+            if (vptr == globalData->jsTypedArrayVPtrs[i])
+                return true;
+        }
+        return false;
+    }
+
+} // namespace AJ
+
+#endif // AJTypedArray_h
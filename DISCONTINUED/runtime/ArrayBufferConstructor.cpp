@@ -0,0 +1,67 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "config.h"
+#include "ArrayBufferConstructor.h"
+
+#include "AJArrayBuffer.h"
+#include "AJGlobalObject.h"
+#include "ArrayBufferPrototype.h"
+#include "Error.h"
+#include <limits>
+
+namespace AJ {
+
+ASSERT_CLASS_FITS_IN_CELL(ArrayBufferConstructor);
+
+ArrayBufferConstructor::ArrayBufferConstructor(ExecState* exec, NonNullPassRefPtr<Structure> structure, ArrayBufferPrototype* arrayBufferPrototype)
+    : InternalFunction(&exec->globalData(), structure, Identifier(exec, AJArrayBuffer::info.className))
+{
+    putDirectWithoutTransition(exec->propertyNames().prototype, arrayBufferPrototype, DontEnum | DontDelete | ReadOnly);
+
+    // no. of arguments for constructor
+    putDirectWithoutTransition(exec->propertyNames().length, jsNumber(exec, 1), ReadOnly | DontDelete | DontEnum);
+}
+
+static AJObject* constructWithArrayBufferConstructor(ExecState* exec, AJObject*, const ArgList& args)
+{
+    double byteLength = args.at(0).toInteger(exec);
+    if (exec->hadException())
+        return 0;
+    if (byteLength < 0 || byteLength > std::numeric_limits<int32_t>::max())
+        return throwError(exec, RangeError, "Invalid array buffer length.");
+    return AJArrayBuffer::create(exec, static_cast<unsigned>(byteLength));
+}
+
+ConstructType ArrayBufferConstructor::getConstructData(ConstructData& constructData)
+{
+    constructData.native.function = constructWithArrayBufferConstructor;
+    return ConstructTypeHost;
+}
+
+static AJValue JSC_HOST_CALL callArrayBufferConstructor(ExecState* exec, AJObject*, AJValue, const ArgList&)
+{
+    return throwError(exec, TypeError, "ArrayBuffer constructor requires 'new'.");
+}
+
+CallType ArrayBufferConstructor::getCallData(CallData& callData)
+{
+    callData.native.function = callArrayBufferConstructor;
+    return CallTypeHost;
+}
+
+} // namespace AJ
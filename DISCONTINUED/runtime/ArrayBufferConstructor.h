@@ -0,0 +1,38 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef ArrayBufferConstructor_h
+#define ArrayBufferConstructor_h
+
+#include "InternalFunction.h"
+
+namespace AJ {
+
+    class ArrayBufferPrototype;
+
+    class ArrayBufferConstructor : public InternalFunction {
+    public:
+        ArrayBufferConstructor(ExecState*, NonNullPassRefPtr<Structure>, ArrayBufferPrototype*);
+
+    private:
+        virtual ConstructType getConstructData(ConstructData&);
+        virtual CallType getCallData(CallData&);
+    };
+
+} // namespace AJ
+
+#endif // ArrayBufferConstructor_h
@@ -0,0 +1,74 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "config.h"
+#include "ArrayBufferPrototype.h"
+
+#include "AJArrayBuffer.h"
+#include "AJGlobalObject.h"
+#include "Error.h"
+#include "PrototypeFunction.h"
+#include <algorithm>
+#include <string.h>
+
+namespace AJ {
+
+ASSERT_CLASS_FITS_IN_CELL(ArrayBufferPrototype);
+
+static AJValue JSC_HOST_CALL arrayBufferProtoFuncSlice(ExecState*, AJObject*, AJValue, const ArgList&);
+
+ArrayBufferPrototype::ArrayBufferPrototype(ExecState* exec, NonNullPassRefPtr<Structure> structure, Structure* prototypeFunctionStructure)
+    : AJObject(structure)
+{
+    putDirectFunctionWithoutTransition(exec, new (exec) NativeFunctionWrapper(exec, prototypeFunctionStructure, 2, Identifier(exec, "slice"), arrayBufferProtoFuncSlice), DontEnum);
+}
+
+// ------------------------------ Functions --------------------------
+
+AJValue JSC_HOST_CALL arrayBufferProtoFuncSlice(ExecState* exec, AJObject*, AJValue thisValue, const ArgList& args)
+{
+    if (!thisValue.inherits(&AJArrayBuffer::info))
+        return throwError(exec, TypeError);
+    AJArrayBuffer* buffer = asArrayBuffer(thisValue);
+
+    // Negative positions count back from the end.
+    double length = buffer->byteLength();
+    double begin = args.at(0).toInteger(exec);
+    if (begin < 0)
+        begin = std::max(begin + length, 0.0);
+    else
+        begin = std::min(begin, length);
+    double end = length;
+    if (!args.at(1).isUndefined()) {
+        end = args.at(1).toInteger(exec);
+        if (end < 0)
+            end = std::max(end + length, 0.0);
+        else
+            end = std::min(end, length);
+    }
+    if (exec->hadException())
+        return jsUndefined();
+
+    unsigned sliceLength = end > begin ? static_cast<unsigned>(end - begin) : 0;
+    AJArrayBuffer* slice = AJArrayBuffer::create(exec, sliceLength);
+    if (!slice)
+        return jsUndefined();
+    memcpy(slice->data(), buffer->data() + static_cast<unsigned>(begin), sliceLength);
+    return slice;
+}
+
+} // namespace AJ
@@ -196,7 +196,7 @@ AJValue JSC_HOST_CALL arrayProtoFuncToString(ExecState* exec, AJObject*, AJValue
     for (unsigned k = 0; k < length; k++) {
         AJValue element;
         if (isRealArray && thisObj->canGetIndex(k))
-            element = thisObj->getIndex(k);
+            element = thisObj->getIndex(exec, k);
         else
             element = thisObj->get(exec, k);
         
@@ -305,7 +305,7 @@ AJValue JSC_HOST_CALL arrayProtoFuncJoin(ExecState* exec, AJObject*, AJValue thi
                 else
                     strBuffer.append(separator);
             }
-            AJValue element = array->getIndex(k);
+            AJValue element = array->getIndex(exec, k);
             if (!element.isUndefinedOrNull())
                 strBuffer.append(element.toString(exec));
         }
@@ -358,7 +358,7 @@ AJValue JSC_HOST_CALL arrayProtoFuncConcat(ExecState* exec, AJObject*, AJValue t
 AJValue JSC_HOST_CALL arrayProtoFuncPop(ExecState* exec, AJObject*, AJValue thisValue, const ArgList&)
 {
     if (isAJArray(&exec->globalData(), thisValue))
-        return asArray(thisValue)->pop();
+        return asArray(thisValue)->pop(exec);
 
     AJObject* thisObj = thisValue.toThisObject(exec);
     AJValue result;
@@ -646,7 +646,7 @@ AJValue JSC_HOST_CALL arrayProtoFuncFilter(ExecState* exec, AJObject*, AJValue t
         for (; k < length && !exec->hadException(); ++k) {
             if (!array->canGetIndex(k))
                 break;
-            AJValue v = array->getIndex(k);
+            AJValue v = array->getIndex(exec, k);
             cachedCall.setThis(applyThis);
             cachedCall.setArgument(0, v);
             cachedCall.setArgument(1, jsNumber(exec, k));
@@ -706,7 +706,7 @@ AJValue JSC_HOST_CALL arrayProtoFuncMap(ExecState* exec, AJObject*, AJValue this
                 break;
 
             cachedCall.setThis(applyThis);
-            cachedCall.setArgument(0, array->getIndex(k));
+            cachedCall.setArgument(0, array->getIndex(exec, k));
             cachedCall.setArgument(1, jsNumber(exec, k));
             cachedCall.setArgument(2, thisObj);
 
@@ -763,7 +763,7 @@ AJValue JSC_HOST_CALL arrayProtoFuncEvery(ExecState* exec, AJObject*, AJValue th
                 break;
             
             cachedCall.setThis(applyThis);
-            cachedCall.setArgument(0, array->getIndex(k));
+            cachedCall.setArgument(0, array->getIndex(exec, k));
             cachedCall.setArgument(1, jsNumber(exec, k));
             cachedCall.setArgument(2, thisObj);
             AJValue result = cachedCall.call();
@@ -817,7 +817,7 @@ AJValue JSC_HOST_CALL arrayProtoFuncForEach(ExecState* exec, AJObject*, AJValue
                 break;
 
             cachedCall.setThis(applyThis);
-            cachedCall.setArgument(0, array->getIndex(k));
+            cachedCall.setArgument(0, array->getIndex(exec, k));
             cachedCall.setArgument(1, jsNumber(exec, k));
             cachedCall.setArgument(2, thisObj);
 
@@ -864,7 +864,7 @@ AJValue JSC_HOST_CALL arrayProtoFuncSome(ExecState* exec, AJObject*, AJValue thi
                 break;
             
             cachedCall.setThis(applyThis);
-            cachedCall.setArgument(0, array->getIndex(k));
+            cachedCall.setArgument(0, array->getIndex(exec, k));
             cachedCall.setArgument(1, jsNumber(exec, k));
             cachedCall.setArgument(2, thisObj);
             AJValue result = cachedCall.call();
@@ -914,7 +914,7 @@ AJValue JSC_HOST_CALL arrayProtoFuncReduce(ExecState* exec, AJObject*, AJValue t
     if (args.size() >= 2)
         rv = args.at(1);
     else if (array && array->canGetIndex(0)){
-        rv = array->getIndex(0);
+        rv = array->getIndex(exec, 0);
         i = 1;
     } else {
         for (i = 0; i < length; i++) {
@@ -934,7 +934,7 @@ AJValue JSC_HOST_CALL arrayProtoFuncReduce(ExecState* exec, AJObject*, AJValue t
             cachedCall.setArgument(0, rv);
             AJValue v;
             if (LIKELY(array->canGetIndex(i)))
-                v = array->getIndex(i);
+                v = array->getIndex(exec, i);
             else
                 break; // length has been made unsafe while we enumerate fallback to slow path
             cachedCall.setArgument(1, v);
@@ -984,7 +984,7 @@ AJValue JSC_HOST_CALL arrayProtoFuncReduceRight(ExecState* exec, AJObject*, AJVa
     if (args.size() >= 2)
         rv = args.at(1);
     else if (array && array->canGetIndex(length - 1)){
-        rv = array->getIndex(length - 1);
+        rv = array->getIndex(exec, length - 1);
         i = 1;
     } else {
         for (i = 0; i < length; i++) {
@@ -1005,7 +1005,7 @@ AJValue JSC_HOST_CALL arrayProtoFuncReduceRight(ExecState* exec, AJObject*, AJVa
             cachedCall.setArgument(0, rv);
             if (UNLIKELY(!array->canGetIndex(idx)))
                 break; // length has been made unsafe while we enumerate fallback to slow path
-            cachedCall.setArgument(1, array->getIndex(idx));
+            cachedCall.setArgument(1, array->getIndex(exec, idx));
             cachedCall.setArgument(2, jsNumber(exec, idx));
             cachedCall.setArgument(3, array);
             rv = cachedCall.call();
@@ -42,6 +42,7 @@ limitations under the License.
 #include "CallFrame.h"
 #include "CodeBlock.h"
 #include "CollectorHeapIterator.h"
+#include "HeapSnapshot.h"
 #include "Interpreter.h"
 #include "AJArray.h"
 #include "AJGlobalObject.h"
@@ -52,11 +53,15 @@ limitations under the License.
 #include "JSZombie.h"
 #include "MarkStack.h"
 #include "Nodes.h"
+#include "ParallelMarker.h"
 #include "Tracing.h"
+#include "WeakGCMap.h"
 #include <algorithm>
 #include <limits.h>
 #include <setjmp.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <wtf/CurrentTime.h>
 #include <wtf/FastMalloc.h>
 #include <wtf/HashCountedSet.h>
 #include <wtf/UnusedParam.h>
@@ -106,8 +111,6 @@ limitations under the License.
 
 #endif
 
-#define COLLECT_ON_EVERY_ALLOCATION 0
-
 using std::max;
 
 namespace AJ {
@@ -121,6 +124,20 @@ const size_t ALLOCATIONS_PER_COLLECTION = 3600;
 // a PIC branch in Mach-O binaries, see <rdar://problem/5971391>.
 #define MIN_ARRAY_SIZE (static_cast<size_t>(14))
 
+COMPILE_ASSERT(sizeof(CollectorBlock) == BLOCK_SIZE, CollectorBlock_fills_a_block);
+COMPILE_ASSERT(sizeof(AJCell) + sizeof(AJCell*) + sizeof(size_t) <= SMALLEST_CELL_SIZE, free_cell_fits_in_smallest_cell);
+
+static void initializeHeaps(CollectorHeap* heaps)
+{
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        CollectorHeap& heap = heaps[sizeClass];
+        memset(&heap, 0, sizeof(CollectorHeap));
+        heap.cellSize = Heap::cellSizeForSizeClass(sizeClass);
+        heap.cellsPerBlock = BLOCK_PAYLOAD_SIZE / heap.cellSize;
+        ASSERT(heap.cellsPerBlock <= MAX_CELLS_PER_BLOCK);
+    }
+}
+
 #if ENABLE(JSC_MULTIPLE_THREADS)
 
 #if OS(DARWIN)
@@ -147,7 +164,26 @@ public:
 #endif
 
 Heap::Heap(AJGlobalData* globalData)
-    : m_markListSet(0)
+    : m_copiedSpace(this)
+    , m_weakMaps(0)
+    , m_structures(0)
+    , m_structureCount(0)
+    , m_freedStructures(0)
+    , m_shouldSweepStructures(false)
+    , m_markListSet(0)
+    , m_liveCellsAfterCollection(0)
+    , m_liveCellsAfterMajorCollection(0)
+    , m_shouldCollectOldGeneration(false)
+    , m_minorCollections(0)
+    , m_majorCollections(0)
+    , m_constructedObjects(0)
+    , m_presizedObjects(0)
+    , m_propertyStorageSpills(0)
+    , m_markerThreadCount(1)
+    , m_collectionCount(0)
+    , m_blocksFreed(0)
+    , m_incrementalMarkingBudget(0)
+    , m_isMarkingIncrementally(false)
 #if ENABLE(JSC_MULTIPLE_THREADS)
     , m_registeredThreads(0)
     , m_currentThreadRegistrar(0)
@@ -158,8 +194,16 @@ Heap::Heap(AJGlobalData* globalData)
     , m_globalData(globalData)
 {
     ASSERT(globalData);
-    memset(&m_heap, 0, sizeof(CollectorHeap));
-    allocateBlock();
+    initializeHeaps(m_heaps);
+    memset(&m_allocationBuffer, 0, sizeof(m_allocationBuffer));
+    memset(m_pauseHistogram, 0, sizeof(m_pauseHistogram));
+    m_extraCost = 0;
+    m_didShrink = false;
+    m_softLimit = 0;
+    m_hardLimit = 0;
+    m_isOverHardLimit = false;
+    m_isUnderMemoryPressure = false;
+    m_operationInProgress = NoOperation;
 }
 
 Heap::~Heap()
@@ -177,6 +221,9 @@ void Heap::destroy()
 
     ASSERT(!m_globalData->dynamicGlobalObject);
     ASSERT(!isBusy());
+
+    if (m_isMarkingIncrementally)
+        abortIncrementalMarking();
     
     // The global object is not GC protected at this point, so sweeping may delete it
     // (and thus the global data) before other objects that may use the global data.
@@ -185,8 +232,32 @@ void Heap::destroy()
     delete m_markListSet;
     m_markListSet = 0;
 
+#if ENABLE(PARALLEL_MARKING)
+    m_parallelMarker.clear();
+#endif
+
     freeBlocks();
 
+    // Weak maps that outlive the heap must not unregister from it.
+    for (WeakGCMapBase* map = m_weakMaps; map; map = map->m_next)
+        map->m_heap = 0;
+    m_weakMaps = 0;
+
+    // Structures still referred to from outside the heap free themselves
+    // once they no longer are; the rest can go now.
+    Vector<Structure*> unreferencedStructures;
+    for (Structure* structure = m_structures; structure; structure = structure->m_nextInHeap) {
+        if (!structure->refCount()) {
+            structure->ref();
+            unreferencedStructures.append(structure);
+        }
+        structure->m_heap = 0;
+    }
+    m_structures = 0;
+    m_structureCount = 0;
+    for (size_t i = 0; i < unreferencedStructures.size(); ++i)
+        unreferencedStructures[i]->deref();
+
 #if ENABLE(JSC_MULTIPLE_THREADS)
     if (m_currentThreadRegistrar) {
         int error = pthread_key_delete(m_currentThreadRegistrar);
@@ -206,7 +277,7 @@ void Heap::destroy()
     m_globalData = 0;
 }
 
-NEVER_INLINE CollectorBlock* Heap::allocateBlock()
+NEVER_INLINE void* Heap::allocateBlockMemory()
 {
 #if OS(DARWIN)
     vm_address_t address = 0;
@@ -254,54 +325,65 @@ NEVER_INLINE CollectorBlock* Heap::allocateBlock()
     address += adjust;
 #endif
 
-    // Initialize block.
+    return reinterpret_cast<void*>(address);
+}
 
-    CollectorBlock* block = reinterpret_cast<CollectorBlock*>(address);
+NEVER_INLINE CollectorBlock* Heap::allocateBlock(CollectorHeap& heap)
+{
+    CollectorBlock* block = static_cast<CollectorBlock*>(allocateBlockMemory());
     block->heap = this;
+    block->cellSize = heap.cellSize;
+    block->cellSizeReciprocal = static_cast<uint32_t>((static_cast<uint64_t>(1) << 32) / heap.cellSize + 1);
+    block->cellsPerBlock = heap.cellsPerBlock;
     clearMarkBits(block);
+    memset(block->cards, 0, sizeof(block->cards));
 
     Structure* dummyMarkableCellStructure = m_globalData->dummyMarkableCellStructure.get();
-    for (size_t i = 0; i < HeapConstants::cellsPerBlock; ++i)
-        new (block->cells + i) AJCell(dummyMarkableCellStructure);
+    for (size_t i = 0; i < heap.cellsPerBlock; ++i)
+        new (block->cellAt(i)) AJCell(dummyMarkableCellStructure);
     
     // Add block to blocks vector.
 
-    size_t numBlocks = m_heap.numBlocks;
-    if (m_heap.usedBlocks == numBlocks) {
+    size_t numBlocks = heap.numBlocks;
+    if (heap.usedBlocks == numBlocks) {
         static const size_t maxNumBlocks = ULONG_MAX / sizeof(CollectorBlock*) / GROWTH_FACTOR;
         if (numBlocks > maxNumBlocks)
             CRASH();
         numBlocks = max(MIN_ARRAY_SIZE, numBlocks * GROWTH_FACTOR);
-        m_heap.numBlocks = numBlocks;
-        m_heap.blocks = static_cast<CollectorBlock**>(fastRealloc(m_heap.blocks, numBlocks * sizeof(CollectorBlock*)));
+        heap.numBlocks = numBlocks;
+        heap.blocks = static_cast<CollectorBlock**>(fastRealloc(heap.blocks, numBlocks * sizeof(CollectorBlock*)));
     }
-    m_heap.blocks[m_heap.usedBlocks++] = block;
+    heap.blocks[heap.usedBlocks++] = block;
+    m_blockSet.add(block);
+    updateHeapLimitState();
 
     return block;
 }
 
-NEVER_INLINE void Heap::freeBlock(size_t block)
+NEVER_INLINE void Heap::freeBlock(CollectorHeap& heap, size_t block)
 {
-    m_heap.didShrink = true;
+    m_didShrink = true;
 
-    ObjectIterator it(m_heap, block);
-    ObjectIterator end(m_heap, block + 1);
+    ObjectIterator it(heap, block);
+    ObjectIterator end(heap, block + 1);
     for ( ; it != end; ++it)
         (*it)->~AJCell();
-    freeBlockPtr(m_heap.blocks[block]);
+    m_blockSet.remove(heap.blocks[block]);
+    freeBlockPtr(heap.blocks[block]);
 
     // swap with the last block so we compact as we go
-    m_heap.blocks[block] = m_heap.blocks[m_heap.usedBlocks - 1];
-    m_heap.usedBlocks--;
+    heap.blocks[block] = heap.blocks[heap.usedBlocks - 1];
+    heap.usedBlocks--;
 
-    if (m_heap.numBlocks > MIN_ARRAY_SIZE && m_heap.usedBlocks < m_heap.numBlocks / LOW_WATER_FACTOR) {
-        m_heap.numBlocks = m_heap.numBlocks / GROWTH_FACTOR; 
-        m_heap.blocks = static_cast<CollectorBlock**>(fastRealloc(m_heap.blocks, m_heap.numBlocks * sizeof(CollectorBlock*)));
+    if (heap.numBlocks > MIN_ARRAY_SIZE && heap.usedBlocks < heap.numBlocks / LOW_WATER_FACTOR) {
+        heap.numBlocks = heap.numBlocks / GROWTH_FACTOR; 
+        heap.blocks = static_cast<CollectorBlock**>(fastRealloc(heap.blocks, heap.numBlocks * sizeof(CollectorBlock*)));
     }
 }
 
-NEVER_INLINE void Heap::freeBlockPtr(CollectorBlock* block)
+NEVER_INLINE void Heap::freeBlockPtr(void* block)
 {
+    ++m_blocksFreed;
 #if OS(DARWIN)    
     vm_deallocate(current_task(), reinterpret_cast<vm_address_t>(block), BLOCK_SIZE);
 #elif OS(SYMBIAN)
@@ -330,12 +412,13 @@ void Heap::freeBlocks()
     for (ProtectCountSet::iterator it = protectedValuesCopy.begin(); it != protectedValuesEnd; ++it)
         markCell(it->first);
 
-    m_heap.nextCell = 0;
-    m_heap.nextBlock = 0;
-    DeadObjectIterator it(m_heap, m_heap.nextBlock, m_heap.nextCell);
-    DeadObjectIterator end(m_heap, m_heap.usedBlocks);
-    for ( ; it != end; ++it)
-        (*it)->~AJCell();
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        CollectorHeap& heap = m_heaps[sizeClass];
+        DeadObjectIterator it(heap, 0);
+        DeadObjectIterator end(heap, heap.usedBlocks);
+        for ( ; it != end; ++it)
+            (*it)->~AJCell();
+    }
 
     ASSERT(!protectedObjectCount());
 
@@ -343,12 +426,20 @@ void Heap::freeBlocks()
     for (ProtectCountSet::iterator it = protectedValuesCopy.begin(); it != protectedValuesEnd; ++it)
         it->first->~AJCell();
 
-    for (size_t block = 0; block < m_heap.usedBlocks; ++block)
-        freeBlockPtr(m_heap.blocks[block]);
-
-    fastFree(m_heap.blocks);
-
-    memset(&m_heap, 0, sizeof(CollectorHeap));
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        CollectorHeap& heap = m_heaps[sizeClass];
+        for (size_t block = 0; block < heap.usedBlocks; ++block)
+            freeBlockPtr(heap.blocks[block]);
+        fastFree(heap.blocks);
+    }
+    m_blockSet.clear();
+    m_rememberedCells.clear();
+    m_copiedSpace.freeAll();
+
+    initializeHeaps(m_heaps);
+    memset(&m_allocationBuffer, 0, sizeof(m_allocationBuffer));
+    m_extraCost = 0;
+    m_didShrink = false;
 }
 
 void Heap::recordExtraCost(size_t cost)
@@ -364,105 +455,235 @@ void Heap::recordExtraCost(size_t cost)
     // if a large value survives one garbage collection, there is not much point to
     // collecting more frequently as long as it stays alive.
 
-    if (m_heap.extraCost > maxExtraCost && m_heap.extraCost > m_heap.usedBlocks * BLOCK_SIZE / 2) {
-        // If the last iteration through the heap deallocated blocks, we need
-        // to clean up remaining garbage before marking. Otherwise, the conservative
-        // marking mechanism might follow a pointer to unmapped memory.
-        if (m_heap.didShrink)
-            sweep();
-        reset();
+    if (m_extraCost > maxExtraCost && m_extraCost > usedBlockCount() * BLOCK_SIZE / 2) {
+        if (m_isMarkingIncrementally) {
+            double startTime = currentTimeMS();
+            finishIncrementalMarking();
+            recordPause(startTime);
+        } else
+            reset(ExtraCostTrigger);
     }
-    m_heap.extraCost += cost;
+    m_extraCost += cost;
+    updateHeapLimitState();
 }
 
-void* Heap::allocate(size_t s)
+void* Heap::allocateSlowCase(size_t s)
 {
-    typedef HeapConstants::Block Block;
-    typedef HeapConstants::Cell Cell;
-    
     ASSERT(AJLock::lockCount() > 0);
     ASSERT(AJLock::currentThreadIsHoldingLock());
-    ASSERT_UNUSED(s, s <= HeapConstants::cellSize);
+    ASSERT(s <= LARGEST_CELL_SIZE);
 
-    ASSERT(m_heap.operationInProgress == NoOperation);
+    ASSERT(m_operationInProgress == NoOperation);
 
 #if COLLECT_ON_EVERY_ALLOCATION
     collectAllGarbage();
-    ASSERT(m_heap.operationInProgress == NoOperation);
+    ASSERT(m_operationInProgress == NoOperation);
 #endif
 
+    size_t sizeClass = sizeClassFor(s);
+    CollectorHeap& heap = m_heaps[sizeClass];
+    AJCell*& freeList = m_allocationBuffer.freeLists[sizeClass];
+
 allocate:
 
-    // Fast case: find the next garbage cell and recycle it.
+    if (AJCell* cell = freeList) {
+        freeList = nextFreeCell(cell);
+        return cell;
+    }
 
-    do {
-        ASSERT(m_heap.nextBlock < m_heap.usedBlocks);
-        Block* block = reinterpret_cast<Block*>(m_heap.blocks[m_heap.nextBlock]);
-        do {
-            ASSERT(m_heap.nextCell < HeapConstants::cellsPerBlock);
-            if (!block->marked.get(m_heap.nextCell)) { // Always false for the last cell in the block
-                Cell* cell = block->cells + m_heap.nextCell;
+    // Refill the allocation buffer by lazily sweeping the next block.
 
-                m_heap.operationInProgress = Allocation;
-                AJCell* imp = reinterpret_cast<AJCell*>(cell);
-                imp->~AJCell();
-                m_heap.operationInProgress = NoOperation;
+    while (heap.nextBlock < heap.usedBlocks) {
+        m_operationInProgress = Allocation;
+        sweepBlock(sizeClass, heap.blocks[heap.nextBlock++]);
+        m_operationInProgress = NoOperation;
+        if (freeList)
+            goto allocate;
+    }
 
-                ++m_heap.nextCell;
-                return cell;
-            }
-        } while (++m_heap.nextCell != HeapConstants::cellsPerBlock);
-        m_heap.nextCell = 0;
-    } while (++m_heap.nextBlock != m_heap.usedBlocks);
+    // While marking incrementally, take a new block, and advance the mark by
+    // a step for each one. When marking finishes, blocks are swept again.
+    // Without a budget, marking was started by collectIfIdle(), and the rest
+    // of it is done at once.
+    if (m_isMarkingIncrementally) {
+        double startTime = currentTimeMS();
+        if (!m_incrementalMarkingBudget)
+            finishIncrementalMarking();
+        else if (!markIncrementally(startTime + m_incrementalMarkingBudget))
+            allocateBlock(heap);
+        recordPause(startTime);
+        goto allocate;
+    }
 
-    // Slow case: reached the end of the heap. Mark live objects and start over.
+    // A size class gets its first block without a collection, since there
+    // is nothing in it to reclaim.
+    if (!heap.usedBlocks) {
+        allocateBlock(heap);
+        goto allocate;
+    }
 
-    reset();
+    // Slow case: reached the end of this size class. Mark live objects and start over.
+
+    reset(AllocationTrigger);
     goto allocate;
 }
 
 void Heap::resizeBlocks()
 {
-    m_heap.didShrink = false;
+    m_didShrink = false;
+
+    // Halfway to the soft limit, leave less room between collections so the
+    // heap collects more often instead of growing. Past it, leave just enough
+    // room to reach the next collection and give the rest back.
+    size_t bytes = size();
+    HeapGrowth growth = NormalHeapGrowth;
+    if (m_isUnderMemoryPressure || (m_softLimit && bytes > m_softLimit))
+        growth = MinimalHeapGrowth;
+    else if (m_softLimit && bytes > m_softLimit / 2)
+        growth = SlowHeapGrowth;
+
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass)
+        resizeBlocks(m_heaps[sizeClass], growth);
+
+    if (growth == MinimalHeapGrowth) {
+        // Dead old cells are only reclaimed by a major collection.
+        m_shouldCollectOldGeneration = true;
+        // Dead cells hold on to their malloc memory until they are swept.
+        sweep();
+        ATF::releaseFastMallocFreeMemory();
+    }
 
-    size_t usedCellCount = markedCells();
-    size_t minCellCount = usedCellCount + max(ALLOCATIONS_PER_COLLECTION, usedCellCount);
-    size_t minBlockCount = (minCellCount + HeapConstants::cellsPerBlock - 1) / HeapConstants::cellsPerBlock;
+    updateHeapLimitState();
+}
 
-    size_t maxCellCount = 1.25f * minCellCount;
-    size_t maxBlockCount = (maxCellCount + HeapConstants::cellsPerBlock - 1) / HeapConstants::cellsPerBlock;
+void Heap::resizeBlocks(CollectorHeap& heap, HeapGrowth growth)
+{
+    // Size classes that have never been used stay empty.
+    if (!heap.usedBlocks)
+        return;
 
-    if (m_heap.usedBlocks < minBlockCount)
-        growBlocks(minBlockCount);
-    else if (m_heap.usedBlocks > maxBlockCount)
-        shrinkBlocks(maxBlockCount);
+    size_t usedCellCount = markedCells(heap);
+    size_t headroom = ALLOCATIONS_PER_COLLECTION;
+    if (growth == NormalHeapGrowth)
+        headroom = max(headroom, usedCellCount);
+    else if (growth == SlowHeapGrowth)
+        headroom = max(headroom, usedCellCount / 4);
+    size_t minCellCount = usedCellCount + headroom;
+    size_t minBlockCount = (minCellCount + heap.cellsPerBlock - 1) / heap.cellsPerBlock;
+
+    size_t maxCellCount = growth == MinimalHeapGrowth ? minCellCount : 1.25f * minCellCount;
+    size_t maxBlockCount = (maxCellCount + heap.cellsPerBlock - 1) / heap.cellsPerBlock;
+
+    if (heap.usedBlocks < minBlockCount)
+        growBlocks(heap, minBlockCount);
+    else if (heap.usedBlocks > maxBlockCount)
+        shrinkBlocks(heap, maxBlockCount);
 }
 
-void Heap::growBlocks(size_t neededBlocks)
+void Heap::growBlocks(CollectorHeap& heap, size_t neededBlocks)
 {
-    ASSERT(m_heap.usedBlocks < neededBlocks);
-    while (m_heap.usedBlocks < neededBlocks)
-        allocateBlock();
+    ASSERT(heap.usedBlocks < neededBlocks);
+    while (heap.usedBlocks < neededBlocks)
+        allocateBlock(heap);
 }
 
-void Heap::shrinkBlocks(size_t neededBlocks)
+void Heap::shrinkBlocks(CollectorHeap& heap, size_t neededBlocks)
 {
-    ASSERT(m_heap.usedBlocks > neededBlocks);
+    ASSERT(heap.usedBlocks > neededBlocks);
     
     // Clear the always-on last bit, so isEmpty() isn't fooled by it.
-    for (size_t i = 0; i < m_heap.usedBlocks; ++i)
-        m_heap.blocks[i]->marked.clear(HeapConstants::cellsPerBlock - 1);
+    for (size_t i = 0; i < heap.usedBlocks; ++i)
+        heap.blocks[i]->marked.clear(heap.cellsPerBlock - 1);
 
-    for (size_t i = 0; i != m_heap.usedBlocks && m_heap.usedBlocks != neededBlocks; ) {
-        if (m_heap.blocks[i]->marked.isEmpty()) {
-            freeBlock(i);
+    for (size_t i = 0; i != heap.usedBlocks && heap.usedBlocks != neededBlocks; ) {
+        if (heap.blocks[i]->marked.isEmpty()) {
+            freeBlock(heap, i);
         } else
             ++i;
     }
 
     // Reset the always-on last bit.
-    for (size_t i = 0; i < m_heap.usedBlocks; ++i)
-        m_heap.blocks[i]->marked.set(HeapConstants::cellsPerBlock - 1);
+    for (size_t i = 0; i < heap.usedBlocks; ++i)
+        heap.blocks[i]->marked.set(heap.cellsPerBlock - 1);
+}
+
+void Heap::setHeapLimits(size_t softLimit, size_t hardLimit)
+{
+    ASSERT(!hardLimit || softLimit <= hardLimit);
+    m_softLimit = softLimit;
+    m_hardLimit = hardLimit;
+    updateHeapLimitState();
+}
+
+size_t Heap::size() const
+{
+    return usedBlockCount() * BLOCK_SIZE + m_copiedSpace.size() + m_extraCost;
+}
+
+void Heap::updateHeapLimitState()
+{
+    m_isOverHardLimit = m_hardLimit && size() > m_hardLimit;
+}
+
+bool Heap::wouldExceedHardLimit(size_t bytes) const
+{
+    if (!m_hardLimit)
+        return false;
+    size_t currentSize = size();
+    return currentSize > m_hardLimit || bytes > m_hardLimit - currentSize;
+}
+
+bool Heap::shouldThrowOutOfMemoryError()
+{
+    ASSERT(m_isOverHardLimit);
+
+    // Garbage, or blocks kept for allocation, may be all that is over the limit.
+    if (!isBusy())
+        lowMemoryNotification();
+    return m_isOverHardLimit;
+}
+
+void Heap::lowMemoryNotification()
+{
+    ASSERT(!isBusy());
+
+    m_isUnderMemoryPressure = true;
+    collectAllGarbage();
+    m_isUnderMemoryPressure = false;
+}
+
+bool Heap::collectIfIdle(double milliseconds)
+{
+    ASSERT(!isBusy());
+    double deadline = currentTimeMS() + milliseconds;
+
+    // Finish the collection in progress before considering another. The final
+    // marking step scans the stacks, and may overrun the deadline.
+    if (m_isMarkingIncrementally && !markIncrementally(deadline))
+        return false;
+    if (!sweepUntil(deadline))
+        return false;
+
+    // A new collection is worth starting once as much has been allocated as
+    // a quarter of what survived the last one. Idle time is the cheapest time
+    // to trace the old generation as well.
+    if (objectCount() <= m_liveCellsAfterCollection + max(ALLOCATIONS_PER_COLLECTION, m_liveCellsAfterCollection / 4))
+        return true;
+
+    JAVASCRIPTCORE_GC_BEGIN();
+    beginCollectionRecord(IdleTrigger, true);
+    startIncrementalMarking();
+    if (!markIncrementally(deadline))
+        return false;
+    return sweepUntil(deadline);
+}
+
+size_t Heap::usedBlockCount() const
+{
+    size_t count = 0;
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass)
+        count += m_heaps[sizeClass].usedBlocks;
+    return count;
 }
 
 #if OS(WINCE)
@@ -715,33 +936,19 @@ inline bool isPointerAligned(void* p)
     return (((intptr_t)(p) & (sizeof(char*) - 1)) == 0);
 }
 
-// Cell size needs to be a power of two for isPossibleCell to be valid.
-COMPILE_ASSERT(sizeof(CollectorCell) % 2 == 0, Collector_cell_size_is_power_of_two);
+// The granule needs to be a power of two for isPossibleCell to be valid.
+COMPILE_ASSERT(!(CELL_GRANULE & CELL_GRANULE_MASK), Collector_cell_granule_is_power_of_two);
 
-#if USE(JSVALUE32)
-static bool isHalfCellAligned(void *p)
+static inline bool isGranuleAligned(void* p)
 {
-    return (((intptr_t)(p) & (CELL_MASK >> 1)) == 0);
+    return (((intptr_t)(p) & CELL_GRANULE_MASK) == 0);
 }
 
 static inline bool isPossibleCell(void* p)
 {
-    return isHalfCellAligned(p) && p;
-}
-
-#else
-
-static inline bool isCellAligned(void *p)
-{
-    return (((intptr_t)(p) & CELL_MASK) == 0);
+    return isGranuleAligned(p) && p;
 }
 
-static inline bool isPossibleCell(void* p)
-{
-    return isCellAligned(p) && p;
-}
-#endif // USE(JSVALUE32)
-
 void Heap::markConservatively(MarkStack& markStack, void* start, void* end)
 {
     if (start > end) {
@@ -757,27 +964,28 @@ void Heap::markConservatively(MarkStack& markStack, void* start, void* end)
     char** p = static_cast<char**>(start);
     char** e = static_cast<char**>(end);
 
-    CollectorBlock** blocks = m_heap.blocks;
     while (p != e) {
         char* x = *p++;
+        // Storage that a root points into must stay where it is.
+        if (m_copiedSpace.mayContain(x))
+            m_copiedSpace.pin(x);
         if (isPossibleCell(x)) {
-            size_t usedBlocks;
             uintptr_t xAsBits = reinterpret_cast<uintptr_t>(x);
-            xAsBits &= CELL_ALIGN_MASK;
+            CollectorBlock* blockAddr = reinterpret_cast<CollectorBlock*>(xAsBits & BLOCK_MASK);
+            if (!m_blockSet.contains(blockAddr))
+                continue;
 
-            uintptr_t offset = xAsBits & BLOCK_OFFSET_MASK;
-            const size_t lastCellOffset = sizeof(CollectorCell) * (CELLS_PER_BLOCK - 1);
-            if (offset > lastCellOffset)
+            // Only pointers to the start of a cell in this block's size class count.
+            size_t cellIndex = blockAddr->cellIndex(x);
+            if (cellIndex >= blockAddr->cellsPerBlock)
+                continue;
+            AJCell* cell = blockAddr->cellAt(cellIndex);
+            if (reinterpret_cast<char*>(cell) != x)
                 continue;
 
-            CollectorBlock* blockAddr = reinterpret_cast<CollectorBlock*>(xAsBits - offset);
-            usedBlocks = m_heap.usedBlocks;
-            for (size_t block = 0; block < usedBlocks; block++) {
-                if (blocks[block] != blockAddr)
-                    continue;
-                markStack.append(reinterpret_cast<AJCell*>(xAsBits));
-                markStack.drain();
-            }
+            // Not drained here: the global object marks its registers with
+            // this, and incremental marking must stay in control of draining.
+            markStack.append(cell);
         }
     }
 }
@@ -1017,6 +1225,63 @@ void Heap::markProtectedObjects(MarkStack& markStack)
         markStack.append(it->first);
         markStack.drain();
     }
+
+    m_handleHeap.markRoots(markStack);
+    markStack.drain();
+}
+
+void Heap::markEphemerons(MarkStack& markStack)
+{
+    // A value marked here may be the key of another entry, so repeat until
+    // nothing new is marked.
+    bool didMark;
+    do {
+        didMark = false;
+        for (WeakGCMapBase* map = m_weakMaps; map; map = map->m_next)
+            didMark |= map->markEphemerons(markStack);
+        markStack.drain();
+    } while (didMark);
+}
+
+void Heap::clearWeakReferences()
+{
+    m_weakHandleHeap.clearUnmarkedValues();
+    for (WeakGCMapBase* map = m_weakMaps; map; map = map->m_next)
+        map->clearDeadEntries();
+    m_globalData->megamorphicCache.clear();
+}
+
+void Heap::addStructure(Structure* structure)
+{
+    ASSERT(!structure->m_heap);
+    structure->m_heap = this;
+    structure->m_nextInHeap = m_structures;
+    m_structures = structure;
+    ++m_structureCount;
+}
+
+void Heap::sweepStructures()
+{
+    ASSERT(m_shouldSweepStructures);
+    m_shouldSweepStructures = false;
+
+    // Every cell that was live when the last major marking started, or has
+    // been created since, has marked its Structure, and every dead cell has
+    // been destroyed. Freeing a Structure removes it from its predecessor's
+    // transition table, and releases the predecessor, which is further down
+    // the list if it was added first, as it usually is.
+    Structure** link = &m_structures;
+    while (Structure* structure = *link) {
+        if (structure->m_isMarked || structure->refCount()) {
+            link = &structure->m_nextInHeap;
+            continue;
+        }
+        *link = structure->m_nextInHeap;
+        structure->m_heap = 0;
+        delete structure;
+        --m_structureCount;
+        ++m_freedStructures;
+    }
 }
 
 void Heap::pushTempSortVector(Vector<ValueStringPair>* tempVector)
@@ -1048,68 +1313,149 @@ void Heap::markTempSortVectors(MarkStack& markStack)
     
 void Heap::clearMarkBits()
 {
-    for (size_t i = 0; i < m_heap.usedBlocks; ++i)
-        clearMarkBits(m_heap.blocks[i]);
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        CollectorHeap& heap = m_heaps[sizeClass];
+        for (size_t i = 0; i < heap.usedBlocks; ++i)
+            clearMarkBits(heap.blocks[i]);
+    }
+    for (Structure* structure = m_structures; structure; structure = structure->m_nextInHeap)
+        structure->m_isMarked = false;
 }
 
 void Heap::clearMarkBits(CollectorBlock* block)
 {
     // allocate assumes that the last cell in every block is marked.
     block->marked.clearAll();
-    block->marked.set(HeapConstants::cellsPerBlock - 1);
+    block->marked.set(block->cellsPerBlock - 1);
+}
+
+void Heap::sweepBlock(size_t sizeClass, CollectorBlock* block)
+{
+    CollectorHeap& heap = m_heaps[sizeClass];
+    AJCell*& freeList = m_allocationBuffer.freeLists[sizeClass];
+    Structure* dummyMarkableCellStructure = m_globalData->dummyMarkableCellStructure.get();
+    double startTime = currentTimeMS();
+
+    // Cells allocated from this block from now on are young.
+    block->oldCells = block->marked;
+
+    // Walk backwards so the free list hands out cells in address order. The
+    // last cell is the always-marked sentinel.
+    for (size_t i = heap.cellsPerBlock - 1; i--; ) {
+        if (block->marked.get(i))
+            continue;
+
+        AJCell* cell = block->cellAt(i);
+#if ENABLE(JSC_ZOMBIES)
+        // Cells too small to hold a zombie are swept normally.
+        if (heap.cellSize >= sizeof(JSZombie) && !cell->isZombie()) {
+            const ClassInfo* info = cell->classInfo();
+            cell->~AJCell();
+            new (cell) JSZombie(info, JSZombie::leakedZombieStructure());
+            Heap::markCell(cell);
+            continue;
+        }
+#endif
+        cell->~AJCell();
+        // Conservative marking may still find a free cell, so it must stay markable.
+        new (cell) AJCell(dummyMarkableCellStructure);
+        // New cells are born marked, so until the next collection everything
+        // marked is live. Marking them here keeps allocate() to a pop.
+        block->marked.set(i);
+        freeCellsFrom(cell) = freeList ? freeCellsFrom(freeList) + 1 : 1;
+        nextFreeCell(cell) = freeList;
+        freeList = cell;
+    }
+
+    // Blocks are swept for the collection that last marked them.
+    if (m_collectionCount)
+        currentCollectionRecord().sweepTime += currentTimeMS() - startTime;
 }
 
-size_t Heap::markedCells(size_t startBlock, size_t startCell) const
+void Heap::destroyDeadCell(AJCell* cell)
 {
-    ASSERT(startBlock <= m_heap.usedBlocks);
-    ASSERT(startCell < HeapConstants::cellsPerBlock);
+    ASSERT(!isCellMarked(cell));
+    cell->~AJCell();
+    new (cell) AJCell(m_globalData->dummyMarkableCellStructure.get());
+}
+
+void Heap::releaseAllocationBuffer()
+{
+    // Unmark the cells the allocator has not handed out yet, so nothing that
+    // walks the marked cells mistakes them for live ones. They are reclaimed
+    // by the next collection.
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        AJCell*& freeList = m_allocationBuffer.freeLists[sizeClass];
+        for (AJCell* cell = freeList; cell; cell = nextFreeCell(cell))
+            cellBlock(cell)->marked.clear(cellOffset(cell));
+        freeList = 0;
+    }
+}
 
-    if (startBlock >= m_heap.usedBlocks)
+size_t Heap::markedCells(const CollectorHeap& heap, size_t startBlock, size_t startCell) const
+{
+    ASSERT(startBlock <= heap.usedBlocks);
+    ASSERT(startCell < heap.cellsPerBlock);
+
+    if (startBlock >= heap.usedBlocks)
         return 0;
 
     size_t result = 0;
-    result += m_heap.blocks[startBlock]->marked.count(startCell);
-    for (size_t i = startBlock + 1; i < m_heap.usedBlocks; ++i)
-        result += m_heap.blocks[i]->marked.count();
+    result += heap.blocks[startBlock]->marked.count(startCell);
+    for (size_t i = startBlock + 1; i < heap.usedBlocks; ++i)
+        result += heap.blocks[i]->marked.count();
 
     return result;
 }
 
 void Heap::sweep()
 {
-    ASSERT(m_heap.operationInProgress == NoOperation);
-    if (m_heap.operationInProgress != NoOperation)
+    ASSERT(m_operationInProgress == NoOperation);
+    if (m_operationInProgress != NoOperation)
         CRASH();
-    m_heap.operationInProgress = Collection;
-    
-#if !ENABLE(JSC_ZOMBIES)
-    Structure* dummyMarkableCellStructure = m_globalData->dummyMarkableCellStructure.get();
-#endif
+    m_operationInProgress = Collection;
 
-    DeadObjectIterator it(m_heap, m_heap.nextBlock, m_heap.nextCell);
-    DeadObjectIterator end(m_heap, m_heap.usedBlocks);
-    for ( ; it != end; ++it) {
-        AJCell* cell = *it;
-#if ENABLE(JSC_ZOMBIES)
-        if (!cell->isZombie()) {
-            const ClassInfo* info = cell->classInfo();
-            cell->~AJCell();
-            new (cell) JSZombie(info, JSZombie::leakedZombieStructure());
-            Heap::markCell(cell);
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        CollectorHeap& heap = m_heaps[sizeClass];
+        while (heap.nextBlock < heap.usedBlocks)
+            sweepBlock(sizeClass, heap.blocks[heap.nextBlock++]);
+    }
+
+    // No dead cell is left holding pointers into blocks we have freed.
+    m_didShrink = false;
+
+    if (m_shouldSweepStructures)
+        sweepStructures();
+
+    m_operationInProgress = NoOperation;
+}
+
+bool Heap::sweepUntil(double deadline)
+{
+    ASSERT(m_operationInProgress == NoOperation);
+    m_operationInProgress = Collection;
+
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        CollectorHeap& heap = m_heaps[sizeClass];
+        while (heap.nextBlock < heap.usedBlocks) {
+            if (currentTimeMS() >= deadline) {
+                m_operationInProgress = NoOperation;
+                return false;
+            }
+            sweepBlock(sizeClass, heap.blocks[heap.nextBlock++]);
         }
-#else
-        cell->~AJCell();
-        // Callers of sweep assume it's safe to mark any cell in the heap.
-        new (cell) AJCell(dummyMarkableCellStructure);
-#endif
     }
 
-    m_heap.operationInProgress = NoOperation;
+    m_didShrink = false;
+    if (m_shouldSweepStructures)
+        sweepStructures();
+    m_operationInProgress = NoOperation;
+    return true;
 }
 	
 	unsigned Heap::s_mark_id = 0;
 
-void Heap::markRoots()
+void Heap::markRoots(CollectionType collectionType)
 {
 #ifndef NDEBUG
     if (m_globalData->isSharedInstance()) {
@@ -1122,28 +1468,89 @@ void Heap::markRoots()
 	if (s_mark_id == 0)
 		s_mark_id++;
 
-    ASSERT(m_heap.operationInProgress == NoOperation);
-    if (m_heap.operationInProgress != NoOperation)
+    ASSERT(m_operationInProgress == NoOperation);
+    if (m_operationInProgress != NoOperation)
         CRASH();
 
-    m_heap.operationInProgress = Collection;
+    m_operationInProgress = Collection;
+    double startTime = currentTimeMS();
 
     MarkStack& markStack = m_globalData->markStack;
 
-    // Reset mark bits.
-    clearMarkBits();
+    if (collectionType == MajorCollection) {
+        // Reset mark bits.
+        clearMarkBits();
+        ++m_majorCollections;
+    } else {
+        // Forget the marks of young cells, but keep those of old ones.
+        for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+            CollectorHeap& heap = m_heaps[sizeClass];
+            for (size_t i = 0; i < heap.nextBlock; ++i)
+                heap.blocks[i]->marked = heap.blocks[i]->oldCells;
+        }
+        ++m_minorCollections;
+    }
+
+#if ENABLE(PARALLEL_MARKING)
+    // Roots are found on this thread. Whenever a helper is idle, the work
+    // they lead to is donated from the main mark stack and stolen by it.
+    if (m_markerThreadCount > 1 && !m_parallelMarker)
+        m_parallelMarker.set(new ParallelMarker(m_markerThreadCount - 1, m_globalData->jsArrayVPtr));
+    if (m_parallelMarker)
+        m_parallelMarker->begin(markStack);
+#endif
+
+    // Old cells that may point to young ones.
+    if (collectionType == MinorCollection)
+        markRememberedSet(markStack);
+
+    markAllRoots(markStack);
+
+#if ENABLE(PARALLEL_MARKING)
+    // Wait for the helpers to run out of work, so the small strings see
+    // every mark.
+    if (m_parallelMarker)
+        m_parallelMarker->end(markStack);
+#endif
+
+    markStack.drain();
+    markEphemerons(markStack);
+
+    // Mark the small strings cache last, since it will clear itself if nothing
+    // else has marked it.
+    m_globalData->smallStrings.markChildren(markStack);
+
+    markStack.drain();
+    markStack.compact();
+
+    clearWeakReferences();
+    if (collectionType == MajorCollection)
+        m_shouldSweepStructures = true;
+    m_copiedSpace.collect(collectionType == MajorCollection);
+    promoteYoungCells(collectionType);
 
+    currentCollectionRecord().markTime += currentTimeMS() - startTime;
+    m_operationInProgress = NoOperation;
+}
+
+void Heap::markAllRoots(MarkStack& markStack)
+{
     // Mark stack roots.
+    markStack.beginRoots("Machine stacks");
     markStackObjectsConservatively(markStack);
+    markStack.beginRoots("Register file");
     m_globalData->interpreter->registerFile().markCallFrames(markStack, this);
 
     // Mark explicitly registered roots.
+    markStack.beginRoots("Protected values");
     markProtectedObjects(markStack);
     
     // Mark temporary vector for Array sorting
+    markStack.beginRoots("Sort vectors");
     markTempSortVectors(markStack);
 
     // Mark misc. other roots.
+    markStack.beginRoots("Other roots");
     if (m_markListSet && m_markListSet->size())
         MarkedArgumentBuffer::markLists(markStack, *m_markListSet);
     if (m_globalData->exception)
@@ -1152,34 +1559,282 @@ void Heap::markRoots()
         m_globalData->functionCodeBlockBeingReparsed->markAggregate(markStack);
     if (m_globalData->firstStringifierToMark)
         JSONObject::markStringifiers(markStack, m_globalData->firstStringifierToMark);
+}
+
+void Heap::startIncrementalMarking()
+{
+    ASSERT(m_operationInProgress == NoOperation);
+    m_operationInProgress = Collection;
+    double startTime = currentTimeMS();
+
+    // Everything that exists now is traced from the roots. Only the cells
+    // that mark their own children, and the cells allocated from here on,
+    // can change without the write barrier noticing.
+    rememberYoungCells();
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        CollectorHeap& heap = m_heaps[sizeClass];
+        for (size_t i = 0; i < heap.usedBlocks; ++i) {
+            CollectorBlock* block = heap.blocks[i];
+            memset(block->cards, 0, sizeof(block->cards));
+            block->oldCells.setAll();
+        }
+    }
+
+    clearMarkBits();
+    ++m_majorCollections;
+
+    // Unmarked cells may still be live, so nothing can be swept until
+    // marking finishes. Allocation continues in new blocks.
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        CollectorHeap& heap = m_heaps[sizeClass];
+        heap.nextBlock = heap.usedBlocks;
+        m_allocationBuffer.freeLists[sizeClass] = 0;
+        m_blocksBeforeMarking[sizeClass] = heap.usedBlocks;
+    }
+
+    // The stacks change too quickly to be worth scanning now. The final step
+    // scans them, along with every other root.
+    MarkStack& markStack = m_globalData->markStack;
+    ProtectCountSet::iterator end = m_protectedValues.end();
+    for (ProtectCountSet::iterator it = m_protectedValues.begin(); it != end; ++it)
+        markStack.append(it->first);
+    m_handleHeap.markRoots(markStack);
+    if (AJGlobalObject* head = m_globalData->head) {
+        AJGlobalObject* globalObject = head;
+        do {
+            markStack.append(globalObject);
+            globalObject = globalObject->next();
+        } while (globalObject != head);
+    }
+
+    m_isMarkingIncrementally = true;
+    currentCollectionRecord().markTime += currentTimeMS() - startTime;
+    m_operationInProgress = NoOperation;
+}
+
+bool Heap::markIncrementally(double deadline)
+{
+    ASSERT(m_isMarkingIncrementally);
+    ASSERT(m_operationInProgress == NoOperation);
+    m_operationInProgress = Collection;
+
+    // Checking the time after every cell would cost more than the marking.
+    static const size_t cellsBetweenTimeChecks = 256;
+
+    MarkStack& markStack = m_globalData->markStack;
+    double startTime = currentTimeMS();
+    bool isDone;
+    do {
+        isDone = markStack.drain(cellsBetweenTimeChecks);
+    } while (!isDone && currentTimeMS() < deadline);
+
+    currentCollectionRecord().markTime += currentTimeMS() - startTime;
+    m_operationInProgress = NoOperation;
+
+    if (!isDone)
+        return false;
+    finishIncrementalMarking();
+    return true;
+}
+
+void Heap::finishIncrementalMarking()
+{
+    ASSERT(m_isMarkingIncrementally);
+    ASSERT(m_operationInProgress == NoOperation);
+    m_operationInProgress = Collection;
+    double startTime = currentTimeMS();
+
+    MarkStack& markStack = m_globalData->markStack;
+
+    // Rescan the marked cells the mutator may have stored into since they
+    // were scanned.
+    markRememberedSet(markStack);
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        CollectorHeap& heap = m_heaps[sizeClass];
+        for (size_t i = m_blocksBeforeMarking[sizeClass]; i < heap.usedBlocks; ++i) {
+            CollectorBlock* block = heap.blocks[i];
+            for (size_t cell = 0; cell < heap.cellsPerBlock - 1; ++cell) {
+                if (block->marked.get(cell))
+                    markStack.appendChildren(block->cellAt(cell));
+            }
+        }
+    }
+
+    markAllRoots(markStack);
+    markStack.drain();
+    markEphemerons(markStack);
 
-    // Mark the small strings cache last, since it will clear itself if nothing
-    // else has marked it.
     m_globalData->smallStrings.markChildren(markStack);
 
     markStack.drain();
     markStack.compact();
 
-    m_heap.operationInProgress = NoOperation;
+    clearWeakReferences();
+    m_shouldSweepStructures = true;
+    m_copiedSpace.collect(true);
+    promoteYoungCells(MajorCollection);
+
+    currentCollectionRecord().markTime += currentTimeMS() - startTime;
+    m_isMarkingIncrementally = false;
+    m_operationInProgress = NoOperation;
+
+    JAVASCRIPTCORE_GC_MARKED();
+
+    resetAllocator();
+    resizeBlocks();
+    endCollectionRecord();
+
+    JAVASCRIPTCORE_GC_END();
+}
+
+void Heap::abortIncrementalMarking()
+{
+    ASSERT(m_isMarkingIncrementally);
+
+    MarkStack& markStack = m_globalData->markStack;
+    markStack.drain();
+    markStack.compact();
+
+    m_isMarkingIncrementally = false;
+    resetAllocator();
+}
+
+void Heap::markRememberedSet(MarkStack& markStack)
+{
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        CollectorHeap& heap = m_heaps[sizeClass];
+        for (size_t i = 0; i < heap.usedBlocks; ++i) {
+            CollectorBlock* block = heap.blocks[i];
+            for (size_t card = 0; card < CARDS_PER_BLOCK; ++card) {
+                if (!block->cards[card])
+                    continue;
+
+                // The barrier dirties the card holding the start of the cell.
+                size_t cardStart = card * CARD_SIZE;
+                size_t cardEnd = cardStart + CARD_SIZE;
+                for (size_t cell = (cardStart + heap.cellSize - 1) / heap.cellSize; cell < heap.cellsPerBlock && cell * heap.cellSize < cardEnd; ++cell) {
+                    if (block->marked.get(cell))
+                        markStack.appendChildren(block->cellAt(cell));
+                }
+            }
+        }
+    }
+
+    // Cells on the list are always marked, except during incremental marking.
+    size_t size = m_rememberedCells.size();
+    for (size_t i = 0; i < size; ++i) {
+        if (isCellMarked(m_rememberedCells[i]))
+            markStack.appendChildren(m_rememberedCells[i]);
+    }
+}
+
+void Heap::rememberYoungCells()
+{
+    void* jsArrayVPtr = m_globalData->jsArrayVPtr;
+
+    // Young survivors live in the blocks allocated from since the last
+    // collection. The write barrier cannot see stores into cells that mark
+    // their children themselves, so those are rescanned from now on.
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        CollectorHeap& heap = m_heaps[sizeClass];
+        for (size_t i = 0; i < heap.nextBlock; ++i) {
+            CollectorBlock* block = heap.blocks[i];
+            for (size_t word = 0; word < BITMAP_WORDS; ++word) {
+                uint32_t youngCells = block->marked.bits[word] & ~block->oldCells.bits[word];
+                for (size_t bit = 0; youngCells; ++bit, youngCells >>= 1) {
+                    if (!(youngCells & 1))
+                        continue;
+                    AJCell* cell = block->cellAt(word * 32 + bit);
+                    if (cell->structure()->typeInfo().overridesMarkChildren() && cell->vptr() != jsArrayVPtr)
+                        m_rememberedCells.append(cell);
+                }
+            }
+        }
+    }
+}
+
+void Heap::promoteYoungCells(CollectionType collectionType)
+{
+    if (collectionType == MajorCollection) {
+        size_t liveCount = 0;
+        for (size_t i = 0; i < m_rememberedCells.size(); ++i) {
+            if (isCellMarked(m_rememberedCells[i]))
+                m_rememberedCells[liveCount++] = m_rememberedCells[i];
+        }
+        m_rememberedCells.shrink(liveCount);
+    }
+
+    rememberYoungCells();
+
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        CollectorHeap& heap = m_heaps[sizeClass];
+        for (size_t i = 0; i < heap.usedBlocks; ++i)
+            memset(heap.blocks[i]->cards, 0, sizeof(heap.blocks[i]->cards));
+    }
+
+    // Dead old cells stay marked until the next major collection. Do one once
+    // the old generation has doubled.
+    size_t liveCells = objectCount();
+    m_liveCellsAfterCollection = liveCells;
+    if (collectionType == MajorCollection)
+        m_liveCellsAfterMajorCollection = liveCells;
+    m_shouldCollectOldGeneration = liveCells > 2 * m_liveCellsAfterMajorCollection + ALLOCATIONS_PER_COLLECTION;
+}
+
+size_t Heap::objectCount(const CollectorHeap& heap) const
+{
+    if (!heap.usedBlocks)
+        return 0;
+
+    // Survivors of the last collection and cells allocated since are marked,
+    // and so are the free cells waiting in the allocation buffer.
+    AJCell* freeList = m_allocationBuffer.freeLists[&heap - m_heaps];
+    size_t bufferedCells = freeList ? freeCellsFrom(freeList) : 0;
+    return markedCells(heap) - heap.usedBlocks - bufferedCells; // 1 cell per block is a dummy sentinel
 }
 
 size_t Heap::objectCount() const
 {
-    return m_heap.nextBlock * HeapConstants::cellsPerBlock // allocated full blocks
-           + m_heap.nextCell // allocated cells in current block
-           + markedCells(m_heap.nextBlock, m_heap.nextCell) // marked cells in remainder of m_heap
-           - m_heap.usedBlocks; // 1 cell per block is a dummy sentinel
+    size_t count = 0;
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass)
+        count += objectCount(m_heaps[sizeClass]);
+    return count;
+}
+
+void Heap::setMarkerThreadCount(unsigned count)
+{
+    ASSERT(!isBusy());
+#if ENABLE(PARALLEL_MARKING)
+    m_markerThreadCount = max(count, 1u);
+    // Helper threads are started by the next collection that needs them.
+    if (m_parallelMarker && m_parallelMarker->helperCount() != m_markerThreadCount - 1)
+        m_parallelMarker.clear();
+#else
+    UNUSED_PARAM(count);
+#endif
+}
+
+void Heap::setIncrementalMarkingBudget(double milliseconds)
+{
+    ASSERT(!isBusy());
+    m_incrementalMarkingBudget = max(milliseconds, 0.0);
+    if (!m_incrementalMarkingBudget && m_isMarkingIncrementally)
+        finishIncrementalMarking();
 }
 
 void Heap::addToStatistics(Heap::Statistics& statistics) const
 {
-    statistics.size += m_heap.usedBlocks * BLOCK_SIZE;
-    statistics.free += m_heap.usedBlocks * BLOCK_SIZE - (objectCount() * HeapConstants::cellSize);
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        const CollectorHeap& heap = m_heaps[sizeClass];
+        statistics.size += heap.usedBlocks * BLOCK_SIZE;
+        statistics.free += heap.usedBlocks * BLOCK_SIZE - (objectCount(heap) * heap.cellSize);
+        statistics.unsweptBlocks += heap.usedBlocks - heap.nextBlock;
+    }
 }
 
 Heap::Statistics Heap::statistics() const
 {
-    Statistics statistics = { 0, 0 };
+    Statistics statistics = { 0, 0, 0, m_minorCollections, m_majorCollections, m_constructedObjects, m_presizedObjects, m_propertyStorageSpills, m_structureCount, m_freedStructures };
     addToStatistics(statistics);
     return statistics;
 }
@@ -1252,71 +1907,219 @@ HashCountedSet<const char*>* Heap::objectTypeCounts()
 {
     HashCountedSet<const char*>* counts = new HashCountedSet<const char*>;
 
-    LiveObjectIterator it = primaryHeapBegin();
-    LiveObjectIterator heapEnd = primaryHeapEnd();
-    for ( ; it != heapEnd; ++it)
-        counts->add(typeName(*it));
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        LiveObjectIterator it = liveObjectsBegin(sizeClass);
+        LiveObjectIterator heapEnd = liveObjectsEnd(sizeClass);
+        for ( ; it != heapEnd; ++it)
+            counts->add(typeName(*it));
+    }
 
     return counts;
 }
 
+static void addStorageToTypeStatistics(AJCell* owner, size_t bytes, void* statistics)
+{
+    static_cast<Heap::TypeStatisticsMap*>(statistics)->add(typeName(owner), Heap::TypeStatistics()).first->second.bytes += bytes;
+}
+
+Heap::TypeStatisticsMap* Heap::objectTypeStatistics()
+{
+    TypeStatisticsMap* statistics = new TypeStatisticsMap;
+
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        size_t cellSize = m_heaps[sizeClass].cellSize;
+        LiveObjectIterator it = liveObjectsBegin(sizeClass);
+        LiveObjectIterator heapEnd = liveObjectsEnd(sizeClass);
+        for ( ; it != heapEnd; ++it) {
+            TypeStatistics& entry = statistics->add(typeName(*it), TypeStatistics()).first->second;
+            ++entry.count;
+            entry.bytes += cellSize;
+        }
+    }
+    m_copiedSpace.forEachLiveStorage(addStorageToTypeStatistics, statistics);
+
+    return statistics;
+}
+
+static void addStorageToSnapshot(AJCell* owner, size_t bytes, void* writer)
+{
+    static_cast<HeapSnapshotWriter*>(writer)->addStorage(owner, bytes);
+}
+
+bool Heap::writeSnapshot(const char* path)
+{
+    collectAllGarbage();
+
+    FILE* file = fopen(path, "wb");
+    if (!file)
+        return false;
+
+    // Leaves only the live cells marked.
+    releaseAllocationBuffer();
+
+    ASSERT(m_operationInProgress == NoOperation);
+    m_operationInProgress = Collection;
+
+    MarkStack& markStack = m_globalData->markStack;
+    HeapSnapshotWriter writer(file, markStack);
+    markAllRoots(markStack);
+
+    // Conservative roots may have marked free cells.
+    Structure* dummyMarkableCellStructure = m_globalData->dummyMarkableCellStructure.get();
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        size_t cellSize = m_heaps[sizeClass].cellSize;
+        LiveObjectIterator it(m_heaps[sizeClass], 0);
+        LiveObjectIterator heapEnd = liveObjectsEnd(sizeClass);
+        for ( ; it != heapEnd; ++it) {
+            if ((*it)->structure() != dummyMarkableCellStructure)
+                writer.addCell(*it, typeName(*it), cellSize);
+        }
+    }
+    m_copiedSpace.forEachLiveStorage(addStorageToSnapshot, &writer);
+
+    m_operationInProgress = NoOperation;
+
+    bool succeeded = writer.finish();
+    return !fclose(file) && succeeded;
+}
+
 bool Heap::isBusy()
 {
-    return m_heap.operationInProgress != NoOperation;
+    return m_operationInProgress != NoOperation;
 }
 
-void Heap::reset()
+void Heap::reset(CollectionTrigger trigger)
 {
+    double startTime = currentTimeMS();
+
     JAVASCRIPTCORE_GC_BEGIN();
 
-    markRoots();
+    // If the last collection deallocated blocks, unswept garbage may still
+    // point into them. Sweep it before marking. Otherwise, the conservative
+    // marking mechanism might follow a pointer to unmapped memory. Major
+    // marking forgets which Structures are used, so the last one's must be
+    // swept first.
+    if (m_didShrink || (m_shouldCollectOldGeneration && m_shouldSweepStructures))
+        sweep();
+
+    beginCollectionRecord(trigger, m_shouldCollectOldGeneration);
+
+    if (m_shouldCollectOldGeneration && m_incrementalMarkingBudget) {
+        // allocate() does the rest of the collection a step at a time.
+        startIncrementalMarking();
+        recordPause(startTime);
+        return;
+    }
+
+    markRoots(m_shouldCollectOldGeneration ? MajorCollection : MinorCollection);
 
     JAVASCRIPTCORE_GC_MARKED();
 
-    m_heap.nextCell = 0;
-    m_heap.nextBlock = 0;
-    m_heap.nextNumber = 0;
-    m_heap.extraCost = 0;
+    // Dead cells are swept lazily, a block at a time, by allocate().
+    resetAllocator();
+    resizeBlocks();
 #if ENABLE(JSC_ZOMBIES)
     sweep();
 #endif
-    resizeBlocks();
+    endCollectionRecord();
+    recordPause(startTime);
 
     JAVASCRIPTCORE_GC_END();
 }
 
 void Heap::collectAllGarbage()
 {
+    double startTime = currentTimeMS();
+
+    if (m_isMarkingIncrementally)
+        finishIncrementalMarking();
+
     JAVASCRIPTCORE_GC_BEGIN();
 
-    // If the last iteration through the heap deallocated blocks, we need
-    // to clean up remaining garbage before marking. Otherwise, the conservative
-    // marking mechanism might follow a pointer to unmapped memory.
-    if (m_heap.didShrink)
+    if (m_didShrink || m_shouldSweepStructures)
         sweep();
 
-    markRoots();
+    beginCollectionRecord(m_isUnderMemoryPressure ? MemoryPressureTrigger : ExplicitTrigger, true);
+    markRoots(MajorCollection);
 
     JAVASCRIPTCORE_GC_MARKED();
 
-    m_heap.nextCell = 0;
-    m_heap.nextBlock = 0;
-    m_heap.nextNumber = 0;
-    m_heap.extraCost = 0;
-    sweep();
+    // Resize first: shrinking frees empty blocks, which must not be on a free list.
+    resetAllocator();
     resizeBlocks();
+    sweep();
+    endCollectionRecord();
+    recordPause(startTime);
 
     JAVASCRIPTCORE_GC_END();
 }
 
-LiveObjectIterator Heap::primaryHeapBegin()
+void Heap::beginCollectionRecord(CollectionTrigger trigger, bool isMajor)
+{
+    CollectionRecord& record = m_collectionRecords[m_collectionCount++ % COLLECTION_RECORD_COUNT];
+    record.startTime = currentTime();
+    record.markTime = 0;
+    record.sweepTime = 0;
+    record.liveBytesBefore = liveBytes();
+    record.liveBytesAfter = 0;
+    record.blocksFreed = m_blocksFreed; // Until the collection ends.
+    record.trigger = trigger;
+    record.isMajor = isMajor;
+}
+
+void Heap::endCollectionRecord()
+{
+    CollectionRecord& record = currentCollectionRecord();
+    record.liveBytesAfter = liveBytes();
+    record.blocksFreed = m_blocksFreed - record.blocksFreed;
+}
+
+void Heap::recordPause(double startTime)
+{
+    double milliseconds = currentTimeMS() - startTime;
+    size_t bucket = 0;
+    for (double limit = 0.25; bucket < PAUSE_HISTOGRAM_SIZE - 1 && milliseconds >= limit; limit *= 2)
+        ++bucket;
+    ++m_pauseHistogram[bucket];
+}
+
+size_t Heap::liveBytes() const
+{
+    size_t bytes = m_copiedSpace.size();
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass)
+        bytes += objectCount(m_heaps[sizeClass]) * m_heaps[sizeClass].cellSize;
+    return bytes;
+}
+
+size_t Heap::copyCollectionRecords(CollectionRecord* records, size_t maxCount) const
+{
+    size_t count = std::min(maxCount, std::min(m_collectionCount, COLLECTION_RECORD_COUNT));
+    for (size_t i = 0; i < count; ++i)
+        records[i] = m_collectionRecords[(m_collectionCount - count + i) % COLLECTION_RECORD_COUNT];
+    return count;
+}
+
+void Heap::resetAllocator()
+{
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        m_heaps[sizeClass].nextBlock = 0;
+        m_allocationBuffer.freeLists[sizeClass] = 0;
+    }
+    m_extraCost = 0;
+}
+
+LiveObjectIterator Heap::liveObjectsBegin(size_t sizeClass)
 {
-    return LiveObjectIterator(m_heap, 0);
+    // Live cells are only all marked once marking has finished.
+    if (m_isMarkingIncrementally)
+        finishIncrementalMarking();
+    releaseAllocationBuffer();
+    return LiveObjectIterator(m_heaps[sizeClass], 0);
 }
 
-LiveObjectIterator Heap::primaryHeapEnd()
+LiveObjectIterator Heap::liveObjectsEnd(size_t sizeClass)
 {
-    return LiveObjectIterator(m_heap, m_heap.usedBlocks);
+    return LiveObjectIterator(m_heaps[sizeClass], m_heaps[sizeClass].usedBlocks);
 }
 
 } // namespace AJ
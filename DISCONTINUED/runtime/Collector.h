@@ -40,9 +40,15 @@ limitations under the License.
 #define Collector_h
 
 #include "AJValue.h"
+#include "CopiedSpace.h"
+#include "HandleHeap.h"
+#include <algorithm>
+#include <limits>
 #include <stddef.h>
 #include <string.h>
+#include <wtf/Atomics.h>
 #include <wtf/HashCountedSet.h>
+#include <wtf/HashMap.h>
 #include <wtf/HashSet.h>
 #include <wtf/Noncopyable.h>
 #include <wtf/OwnPtr.h>
@@ -57,35 +63,196 @@ limitations under the License.
 #include <wtf/symbian/BlockAllocatorSymbian.h>
 #endif
 
-#define ASSERT_CLASS_FITS_IN_CELL(class) COMPILE_ASSERT(sizeof(class) <= CELL_SIZE, class_fits_in_cell)
+#define ASSERT_CLASS_FITS_IN_CELL(class) COMPILE_ASSERT(sizeof(class) <= LARGEST_CELL_SIZE, class_fits_in_cell)
+
+#define COLLECT_ON_EVERY_ALLOCATION 0
 
 namespace AJ {
 
     class CollectorBlock;
+    class Heap;
     class AJCell;
     class AJGlobalData;
     class AJValue;
     class MarkedArgumentBuffer;
     class MarkStack;
+    class ParallelMarker;
+    class Structure;
+    class WeakGCMapBase;
 
     enum OperationInProgress { NoOperation, Allocation, Collection };
 
+    // tunable parameters
+    template<size_t bytesPerWord> struct CellSize;
+
+    // cell size needs to be a power of two for certain optimizations in collector.cpp
+#if USE(JSVALUE32)
+    template<> struct CellSize<sizeof(uint32_t)> { static const size_t m_value = 32; };
+#else
+    template<> struct CellSize<sizeof(uint32_t)> { static const size_t m_value = 64; };
+#endif
+    template<> struct CellSize<sizeof(uint64_t)> { static const size_t m_value = 64; };
+
+    const size_t BLOCK_SIZE = 64 * 1024; // 64k
+
+    // derived constants
+    const size_t BLOCK_OFFSET_MASK = BLOCK_SIZE - 1;
+    const size_t BLOCK_MASK = ~BLOCK_OFFSET_MASK;
+    const size_t MINIMUM_CELL_SIZE = CellSize<sizeof(void*)>::m_value;
+    const size_t CELL_ARRAY_LENGTH = (MINIMUM_CELL_SIZE / sizeof(double)) + (MINIMUM_CELL_SIZE % sizeof(double) != 0 ? sizeof(double) : 0);
+    const size_t CELL_SIZE = CELL_ARRAY_LENGTH * sizeof(double);
+
+    // Cells are allocated from size-segregated blocks. Every size class is a
+    // multiple of CELL_GRANULE, so every cell address is granule aligned.
+    // Classes run from half to twice the standard CELL_SIZE.
+    const size_t CELL_GRANULE = CELL_SIZE / 4;
+    const size_t NUM_SIZE_CLASSES = 5;
+    const size_t SMALLEST_CELL_SIZE = 2 * CELL_GRANULE;
+    const size_t LARGEST_CELL_SIZE = 8 * CELL_GRANULE;
+    const size_t CELL_GRANULE_MASK = CELL_GRANULE - 1;
+
+    // Storage large enough for a cell of any size class.
+    struct CollectorCell {
+        double memory[LARGEST_CELL_SIZE / sizeof(double)];
+    };
+
+    // The bitmap is sized for the smallest class, which has the most cells per block.
+    const size_t MAX_CELLS_PER_BLOCK = BLOCK_SIZE / SMALLEST_CELL_SIZE;
+    const size_t BITMAP_WORDS = (MAX_CELLS_PER_BLOCK + 31) / 32;
+
+    struct CollectorBitmap {
+        uint32_t bits[BITMAP_WORDS];
+        bool get(size_t n) const { return !!(bits[n >> 5] & (1 << (n & 0x1F))); } 
+        void set(size_t n) { bits[n >> 5] |= (1 << (n & 0x1F)); } 
+#if ENABLE(PARALLEL_MARKING)
+        // Returns false if the bit was already set, possibly by another thread.
+        bool testAndSetAtomically(size_t n)
+        {
+            unsigned volatile* word = &bits[n >> 5];
+            uint32_t mask = 1 << (n & 0x1F);
+            for (;;) {
+                uint32_t oldBits = *word;
+                if (oldBits & mask)
+                    return false;
+                if (ATF::weakCompareAndSwap(word, oldBits, oldBits | mask))
+                    return true;
+            }
+        }
+#endif
+        void clear(size_t n) { bits[n >> 5] &= ~(1 << (n & 0x1F)); } 
+        void clearAll() { memset(bits, 0, sizeof(bits)); }
+        void setAll() { memset(bits, 0xFF, sizeof(bits)); }
+        size_t count(size_t startCell = 0)
+        {
+            size_t result = 0;
+            for ( ; (startCell & 0x1F) != 0; ++startCell) {
+                if (get(startCell))
+                    ++result;
+            }
+            for (size_t i = startCell >> 5; i < BITMAP_WORDS; ++i)
+                result += ATF::bitCount(bits[i]);
+            return result;
+        }
+        size_t isEmpty() // Much more efficient than testing count() == 0.
+        {
+            for (size_t i = 0; i < BITMAP_WORDS; ++i)
+                if (bits[i] != 0)
+                    return false;
+            return true;
+        }
+    };
+
+    // Heaps keep a record of each of their latest collections.
+    const size_t COLLECTION_RECORD_COUNT = 64;
+    // Pause durations run from under 0.25ms to 256ms and over, doubling per bucket.
+    const size_t PAUSE_HISTOGRAM_SIZE = 12;
+
+    // The write barrier dirties the card holding the start of the cell that was
+    // written to. Minor collections rescan the old cells in dirty cards.
+    const size_t CARD_SHIFT = 9;
+    const size_t CARD_SIZE = 1 << CARD_SHIFT;
+    const size_t CARDS_PER_BLOCK = BLOCK_SIZE / CARD_SIZE;
+
+    // Cells start at the block's base address and the per-block metadata sits
+    // after them, so a cell's index is its offset divided by the block's cell size.
+    const size_t BLOCK_METADATA_SIZE = 2 * sizeof(CollectorBitmap) + CARDS_PER_BLOCK * sizeof(uint32_t) + sizeof(Heap*) + 2 * sizeof(uint32_t) + sizeof(size_t);
+    const size_t BLOCK_PAYLOAD_SIZE = BLOCK_SIZE - BLOCK_METADATA_SIZE;
+
+    class CollectorBlock {
+    public:
+        char cells[BLOCK_PAYLOAD_SIZE];
+        CollectorBitmap marked;
+        // The cells that were already live when the allocator claimed this
+        // block. Everything marked since then is young.
+        CollectorBitmap oldCells;
+        uint32_t cards[CARDS_PER_BLOCK]; // Non-zero if dirty. Words, so the JIT can store to them.
+        Heap* heap;
+        uint32_t cellSize;
+        uint32_t cellSizeReciprocal; // 2^32 / cellSize, rounded up
+        size_t cellsPerBlock;
+
+        AJCell* cellAt(size_t index)
+        {
+            return reinterpret_cast<AJCell*>(cells + index * cellSize);
+        }
+
+        // Exact for every offset in the block since cellSize is at most
+        // LARGEST_CELL_SIZE and offsets are below 2^16.
+        size_t cellIndex(const void* p) const
+        {
+            uint64_t offset = reinterpret_cast<uintptr_t>(p) & BLOCK_OFFSET_MASK;
+            return static_cast<size_t>((offset * cellSizeReciprocal) >> 32);
+        }
+    };
+
+
     class LiveObjectIterator;
 
+    // Index of the blocks owned by a heap. Conservative scanning asks whether an
+    // arbitrary word points into one of our blocks; the address range check
+    // rejects most non-pointers before we hash.
+    class CollectorBlockSet : public Noncopyable {
+    public:
+        CollectorBlockSet()
+            : m_minAddress(std::numeric_limits<uintptr_t>::max())
+            , m_maxAddress(0)
+        {
+        }
+
+        void add(CollectorBlock*);
+        void remove(CollectorBlock*);
+        void clear();
+
+        bool contains(CollectorBlock*) const;
+        size_t size() const { return m_blocks.size(); }
+
+    private:
+        // The range only ever grows between clear()s, which keeps it a valid
+        // (if looser) filter after blocks are freed.
+        uintptr_t m_minAddress;
+        uintptr_t m_maxAddress;
+        HashSet<CollectorBlock*> m_blocks;
+    };
+
+    // The blocks of one size class. Blocks before nextBlock have been swept
+    // since the last collection and their free cells handed to the allocator.
     struct CollectorHeap {
         size_t nextBlock;
-        size_t nextCell;
         CollectorBlock** blocks;
-        
-        void* nextNumber;
 
         size_t numBlocks;
         size_t usedBlocks;
 
-        size_t extraCost;
-        bool didShrink;
+        size_t cellSize;
+        size_t cellsPerBlock;
+    };
 
-        OperationInProgress operationInProgress;
+    // The free cells the allocator hands out, one list per size class. A heap
+    // is only used by the thread holding its lock, so the lists need no
+    // synchronization. Cells on them are already marked, which makes an
+    // allocation a single pop.
+    struct AllocationBuffer {
+        AJCell* freeLists[NUM_SIZE_CLASSES];
     };
 
     class Heap : public Noncopyable {
@@ -94,7 +261,6 @@ namespace AJ {
 
         void destroy();
 
-        void* allocateNumber(size_t);
         void* allocate(size_t);
 
         bool isBusy(); // true if an allocation or collection is in progress
@@ -107,18 +273,110 @@ namespace AJ {
 
         void reportExtraMemoryCost(size_t cost);
 
+        // Property and array storage. owner is the field in the calling cell
+        // that will point to the storage; the collector moves the storage and
+        // updates that field. The try variants return 0 if out of memory.
+        void* allocateStorage(size_t, void** owner);
+        void* tryAllocateStorage(size_t bytes, void** owner) { return m_copiedSpace.tryAllocate(bytes, owner); }
+        void* tryReallocateStorage(void* storage, size_t oldSize, size_t newSize, void** owner) { return m_copiedSpace.tryReallocate(storage, oldSize, newSize, owner); }
+
         size_t objectCount() const;
+
+        enum CollectionTrigger { AllocationTrigger, ExtraCostTrigger, ExplicitTrigger, IdleTrigger, MemoryPressureTrigger };
+        struct CollectionRecord {
+            double startTime; // currentTime() when the collection started
+            double markTime; // milliseconds, over every step of an incremental mark
+            double sweepTime; // milliseconds, including lazy sweeping up to the next collection
+            size_t liveBytesBefore; // cells and storage
+            size_t liveBytesAfter;
+            size_t blocksFreed; // cell and storage blocks
+            CollectionTrigger trigger;
+            bool isMajor;
+        };
+        // Copies the records of up to maxCount of the latest collections,
+        // oldest first, and returns how many it copied.
+        size_t copyCollectionRecords(CollectionRecord*, size_t maxCount) const;
+        size_t collectionCount() const { return m_collectionCount; }
+        // Every pause of the program for collection work, by duration. Bucket
+        // i counts pauses under 2^i / 4 milliseconds that fit no earlier bucket.
+        const size_t* pauseHistogram() const { return m_pauseHistogram; }
+
+        struct TypeStatistics {
+            size_t count;
+            size_t bytes; // the cells and the storage they own
+        };
+        typedef HashMap<const char*, TypeStatistics> TypeStatisticsMap;
+
         struct Statistics {
             size_t size;
             size_t free;
+            size_t unsweptBlocks; // blocks whose dead cells have not been reclaimed yet
+            size_t minorCollections;
+            size_t majorCollections;
+            size_t constructedObjects; // by JS constructors
+            size_t presizedObjects; // constructed with more inline storage than usual
+            size_t propertyStorageSpills; // objects whose properties outgrew their inline storage
+            size_t structures; // used by cells, and not freed yet
+            size_t freedStructures;
         };
         Statistics statistics() const;
+        void didConstructObject(bool presized)
+        {
+            ++m_constructedObjects;
+            if (presized)
+                ++m_presizedObjects;
+        }
+        void didSpillPropertyStorage() { ++m_propertyStorageSpills; }
+
+        // The number of threads that mark the heap during a collection,
+        // including the collecting thread. 1 marks on the collecting thread only.
+        void setMarkerThreadCount(unsigned);
+        unsigned markerThreadCount() const { return m_markerThreadCount; }
+
+        // Major collections mark in steps of about this many milliseconds,
+        // interleaved with allocation. 0 marks the whole heap in one pause.
+        void setIncrementalMarkingBudget(double milliseconds);
+        double incrementalMarkingBudget() const { return m_incrementalMarkingBudget; }
+
+        // Limits on size(), in bytes; 0 means no limit. Past the soft limit the
+        // heap collects more often and gives free memory back to the system.
+        // Past the hard limit, running scripts throw an out of memory error.
+        void setHeapLimits(size_t softLimit, size_t hardLimit);
+        // Cell blocks and storage, plus the extra cost reported since the last collection.
+        size_t size() const;
+        bool isOverHardLimit() const { return m_isOverHardLimit; }
+        // Whether memory of the given size, allocated outside the heap and
+        // reported as extra cost, would take size() past the hard limit.
+        bool wouldExceedHardLimit(size_t bytes) const;
+        // Called at a safe point once isOverHardLimit(). Collects, and returns
+        // true if the heap is still over its hard limit.
+        bool shouldThrowOutOfMemoryError();
+        // Collects everything and gives back as much memory as it can.
+        void lowMemoryNotification();
+
+        // Does collection work for up to about the given time, marking
+        // incrementally and sweeping. Allocation picks up where it left off.
+        // Returns true once no work is left: the last collection has finished
+        // and every block is swept.
+        bool collectIfIdle(double milliseconds);
 
         void protect(AJValue);
         // Returns true if the value is no longer protected by any protect pointers
         // (though it may still be alive due to heap/stack references).
         bool unprotect(AJValue);
 
+        // Slots for values held by native code, which are cheaper to create and
+        // destroy than protect() and unprotect().
+        HandleHeap& handleHeap() { return m_handleHeap; }
+        // Slots that hold their values weakly: a collection that finds a
+        // value unreachable empties the slots holding it.
+        HandleHeap& weakHandleHeap() { return m_weakHandleHeap; }
+
+        // Called when a cell first uses a Structure. From then on the heap
+        // frees it, once nothing outside the heap refers to it and no cell
+        // uses it.
+        void addStructure(Structure*);
+
         static Heap* heap(AJValue); // 0 for immediate values
         static Heap* heap(AJCell*);
 
@@ -127,12 +385,25 @@ namespace AJ {
         size_t protectedGlobalObjectCount();
         HashCountedSet<const char*>* protectedObjectTypeCounts();
         HashCountedSet<const char*>* objectTypeCounts();
+        TypeStatisticsMap* objectTypeStatistics();
+        // Collects, then streams every live cell, its size and the cells it
+        // points to, and the roots, to a file for offline analysis (see
+        // analyze-heap-snapshot). Returns false if the file could not be written.
+        bool writeSnapshot(const char* path);
 
         void registerThread(); // Only needs to be called by clients that can use the same heap from multiple threads.
 
         static bool isCellMarked(const AJCell*);
         static void markCell(AJCell*);
 
+        // Must be called after storing a pointer into a cell, so that minor
+        // collections can find old cells that point to young ones.
+        static void writeBarrier(const AJCell* owner);
+        static void writeBarrier(const AJCell* owner, AJValue);
+#if ENABLE(PARALLEL_MARKING)
+        static bool testAndSetMarkedAtomically(AJCell*);
+#endif
+
         void markConservatively(MarkStack&, void* start, void* end);
 
         void pushTempSortVector(ATF::Vector<ValueStringPair>*);
@@ -143,51 +414,148 @@ namespace AJ {
         AJGlobalData* globalData() const { return m_globalData; }
         static bool isNumber(AJCell*);
         
-        LiveObjectIterator primaryHeapBegin();
-        LiveObjectIterator primaryHeapEnd();
+        // Live cells are enumerated one size class at a time.
+        LiveObjectIterator liveObjectsBegin(size_t sizeClass);
+        LiveObjectIterator liveObjectsEnd(size_t sizeClass);
+
+        static size_t sizeClassFor(size_t);
+        static size_t cellSizeForSizeClass(size_t sizeClass);
 
     private:
-        void reset();
+        void reset(CollectionTrigger);
+        void resetAllocator();
         void sweep();
+        bool sweepUntil(double deadline);
+        void sweepBlock(size_t sizeClass, CollectorBlock*);
+        void destroyDeadCell(AJCell*);
+        void releaseAllocationBuffer();
+        static AJCell*& nextFreeCell(AJCell*);
+        static size_t& freeCellsFrom(AJCell*);
         static CollectorBlock* cellBlock(const AJCell*);
         static size_t cellOffset(const AJCell*);
+        size_t usedBlockCount() const;
 
         friend class AJGlobalData;
+        friend class CopiedSpace;
+        friend class JIT;
+        friend class WeakGCMapBase;
         Heap(AJGlobalData*);
         ~Heap();
 
-        NEVER_INLINE CollectorBlock* allocateBlock();
-        NEVER_INLINE void freeBlock(size_t);
-        NEVER_INLINE void freeBlockPtr(CollectorBlock*);
+        NEVER_INLINE void* allocateSlowCase(size_t);
+        NEVER_INLINE void* allocateBlockMemory(); // BLOCK_SIZE bytes, BLOCK_SIZE aligned
+        NEVER_INLINE CollectorBlock* allocateBlock(CollectorHeap&);
+        NEVER_INLINE void freeBlock(CollectorHeap&, size_t);
+        NEVER_INLINE void freeBlockPtr(void*);
         void freeBlocks();
+        // How much room for new cells resizeBlocks() leaves after a collection.
+        enum HeapGrowth { NormalHeapGrowth, SlowHeapGrowth, MinimalHeapGrowth };
+
         void resizeBlocks();
-        void growBlocks(size_t neededBlocks);
-        void shrinkBlocks(size_t neededBlocks);
+        void resizeBlocks(CollectorHeap&, HeapGrowth);
+        void growBlocks(CollectorHeap&, size_t neededBlocks);
+        void shrinkBlocks(CollectorHeap&, size_t neededBlocks);
         void clearMarkBits();
         void clearMarkBits(CollectorBlock*);
-        size_t markedCells(size_t startBlock = 0, size_t startCell = 0) const;
+        size_t markedCells(const CollectorHeap&, size_t startBlock = 0, size_t startCell = 0) const;
+        size_t objectCount(const CollectorHeap&) const;
 
         void recordExtraCost(size_t);
+        void updateHeapLimitState();
 
         void addToStatistics(Statistics&) const;
 
-        void markRoots();
+        void beginCollectionRecord(CollectionTrigger, bool isMajor);
+        void endCollectionRecord();
+        CollectionRecord& currentCollectionRecord();
+        void recordPause(double startTime);
+        size_t liveBytes() const;
+
+        // A minor collection only traces cells allocated since the last
+        // collection; everything older stays marked. A major one traces the heap.
+        enum CollectionType { MinorCollection, MajorCollection };
+
+        void markRoots(CollectionType);
+        void markRememberedSet(MarkStack&);
+        void markAllRoots(MarkStack&);
+        void rememberYoungCells();
+        void promoteYoungCells(CollectionType);
+
+        void startIncrementalMarking();
+        bool markIncrementally(double deadline);
+        void finishIncrementalMarking();
+        void abortIncrementalMarking();
         void markProtectedObjects(MarkStack&);
         void markTempSortVectors(MarkStack&);
         void markCurrentThreadConservatively(MarkStack&);
         void markCurrentThreadConservativelyInternal(MarkStack&);
         void markOtherThreadConservatively(MarkStack&, Thread*);
         void markStackObjectsConservatively(MarkStack&);
+        // Run once the roots have been traced: marks what the weak maps keep
+        // alive, then empties weak slots and removes dead weak map entries.
+        void markEphemerons(MarkStack&);
+        void clearWeakReferences();
+        // Run once every block has been swept since the last major marking:
+        // frees the Structures no cell was found using.
+        void sweepStructures();
 
         typedef HashCountedSet<AJCell*> ProtectCountSet;
 
-        CollectorHeap m_heap;
+        CollectorHeap m_heaps[NUM_SIZE_CLASSES];
+        AllocationBuffer m_allocationBuffer;
+        CollectorBlockSet m_blockSet;
+        CopiedSpace m_copiedSpace;
+        HandleHeap m_handleHeap;
+        HandleHeap m_weakHandleHeap;
+        WeakGCMapBase* m_weakMaps;
+        Structure* m_structures;
+        size_t m_structureCount;
+        size_t m_freedStructures;
+        // Set by major marking, until sweepStructures() has run.
+        bool m_shouldSweepStructures;
+
+        size_t m_extraCost;
+        bool m_didShrink;
+
+        size_t m_softLimit;
+        size_t m_hardLimit;
+        bool m_isOverHardLimit;
+        bool m_isUnderMemoryPressure;
+        OperationInProgress m_operationInProgress;
 
         ProtectCountSet m_protectedValues;
         ATF::Vector<ATF::Vector<ValueStringPair>* > m_tempSortingVectors;
 
         HashSet<MarkedArgumentBuffer*>* m_markListSet;
 
+        // Old cells whose children the write barrier does not track, rescanned
+        // by every minor collection.
+        ATF::Vector<AJCell*> m_rememberedCells;
+        size_t m_liveCellsAfterCollection;
+        size_t m_liveCellsAfterMajorCollection;
+        bool m_shouldCollectOldGeneration;
+        size_t m_minorCollections;
+        size_t m_majorCollections;
+        size_t m_constructedObjects;
+        size_t m_presizedObjects;
+        size_t m_propertyStorageSpills;
+
+        unsigned m_markerThreadCount;
+
+        CollectionRecord m_collectionRecords[COLLECTION_RECORD_COUNT];
+        size_t m_collectionCount;
+        size_t m_blocksFreed; // by freeBlockPtr(), ever
+        size_t m_pauseHistogram[PAUSE_HISTOGRAM_SIZE];
+
+        double m_incrementalMarkingBudget;
+        bool m_isMarkingIncrementally;
+        // Blocks that existed when incremental marking started. Cells in later
+        // blocks were allocated during marking and are rescanned by the final step.
+        size_t m_blocksBeforeMarking[NUM_SIZE_CLASSES];
+#if ENABLE(PARALLEL_MARKING)
+        OwnPtr<ParallelMarker> m_parallelMarker;
+#endif
+
 #if ENABLE(JSC_MULTIPLE_THREADS)
         void makeUsableFromMultipleThreads();
 
@@ -207,77 +575,39 @@ namespace AJ {
         AJGlobalData* m_globalData;
     };
 
-    // tunable parameters
-    template<size_t bytesPerWord> struct CellSize;
-
-    // cell size needs to be a power of two for certain optimizations in collector.cpp
-#if USE(JSVALUE32)
-    template<> struct CellSize<sizeof(uint32_t)> { static const size_t m_value = 32; };
-#else
-    template<> struct CellSize<sizeof(uint32_t)> { static const size_t m_value = 64; };
-#endif
-    template<> struct CellSize<sizeof(uint64_t)> { static const size_t m_value = 64; };
-
-    const size_t BLOCK_SIZE = 64 * 1024; // 64k
-
-    // derived constants
-    const size_t BLOCK_OFFSET_MASK = BLOCK_SIZE - 1;
-    const size_t BLOCK_MASK = ~BLOCK_OFFSET_MASK;
-    const size_t MINIMUM_CELL_SIZE = CellSize<sizeof(void*)>::m_value;
-    const size_t CELL_ARRAY_LENGTH = (MINIMUM_CELL_SIZE / sizeof(double)) + (MINIMUM_CELL_SIZE % sizeof(double) != 0 ? sizeof(double) : 0);
-    const size_t CELL_SIZE = CELL_ARRAY_LENGTH * sizeof(double);
+    inline void CollectorBlockSet::add(CollectorBlock* block)
+    {
+        uintptr_t address = reinterpret_cast<uintptr_t>(block);
+        m_minAddress = std::min(m_minAddress, address);
+        m_maxAddress = std::max(m_maxAddress, address);
+        m_blocks.add(block);
+    }
 
-    const size_t SMALL_CELL_SIZE = CELL_SIZE / 2;
-    const size_t CELL_MASK = CELL_SIZE - 1;
-    const size_t CELL_ALIGN_MASK = ~CELL_MASK;
-    const size_t CELLS_PER_BLOCK = (BLOCK_SIZE - sizeof(Heap*)) * 8 * CELL_SIZE / (8 * CELL_SIZE + 1) / CELL_SIZE; // one bitmap byte can represent 8 cells.
-    
-    const size_t BITMAP_SIZE = (CELLS_PER_BLOCK + 7) / 8;
-    const size_t BITMAP_WORDS = (BITMAP_SIZE + 3) / sizeof(uint32_t);
+    inline void CollectorBlockSet::remove(CollectorBlock* block)
+    {
+        m_blocks.remove(block);
+    }
 
-    struct CollectorBitmap {
-        uint32_t bits[BITMAP_WORDS];
-        bool get(size_t n) const { return !!(bits[n >> 5] & (1 << (n & 0x1F))); } 
-        void set(size_t n) { bits[n >> 5] |= (1 << (n & 0x1F)); } 
-        void clear(size_t n) { bits[n >> 5] &= ~(1 << (n & 0x1F)); } 
-        void clearAll() { memset(bits, 0, sizeof(bits)); }
-        size_t count(size_t startCell = 0)
-        {
-            size_t result = 0;
-            for ( ; (startCell & 0x1F) != 0; ++startCell) {
-                if (get(startCell))
-                    ++result;
-            }
-            for (size_t i = startCell >> 5; i < BITMAP_WORDS; ++i)
-                result += ATF::bitCount(bits[i]);
-            return result;
-        }
-        size_t isEmpty() // Much more efficient than testing count() == 0.
-        {
-            for (size_t i = 0; i < BITMAP_WORDS; ++i)
-                if (bits[i] != 0)
-                    return false;
-            return true;
-        }
-    };
-  
-    struct CollectorCell {
-        double memory[CELL_ARRAY_LENGTH];
-    };
+    inline void CollectorBlockSet::clear()
+    {
+        m_minAddress = std::numeric_limits<uintptr_t>::max();
+        m_maxAddress = 0;
+        m_blocks.clear();
+    }
 
-    class CollectorBlock {
-    public:
-        CollectorCell cells[CELLS_PER_BLOCK];
-        CollectorBitmap marked;
-        Heap* heap;
-    };
+    inline bool CollectorBlockSet::contains(CollectorBlock* block) const
+    {
+        uintptr_t address = reinterpret_cast<uintptr_t>(block);
+        if (address < m_minAddress || address > m_maxAddress)
+            return false;
+        return m_blocks.contains(block);
+    }
 
-    struct HeapConstants {
-        static const size_t cellSize = CELL_SIZE;
-        static const size_t cellsPerBlock = CELLS_PER_BLOCK;
-        typedef CollectorCell Cell;
-        typedef CollectorBlock Block;
-    };
+    inline Heap::CollectionRecord& Heap::currentCollectionRecord()
+    {
+        ASSERT(m_collectionCount);
+        return m_collectionRecords[(m_collectionCount - 1) % COLLECTION_RECORD_COUNT];
+    }
 
     inline CollectorBlock* Heap::cellBlock(const AJCell* cell)
     {
@@ -286,7 +616,23 @@ namespace AJ {
 
     inline size_t Heap::cellOffset(const AJCell* cell)
     {
-        return (reinterpret_cast<uintptr_t>(cell) & BLOCK_OFFSET_MASK) / CELL_SIZE;
+        return cellBlock(cell)->cellIndex(cell);
+    }
+
+    inline size_t Heap::cellSizeForSizeClass(size_t sizeClass)
+    {
+        static const size_t granules[NUM_SIZE_CLASSES] = { 2, 3, 4, 6, 8 };
+        ASSERT(sizeClass < NUM_SIZE_CLASSES);
+        return granules[sizeClass] * CELL_GRANULE;
+    }
+
+    inline size_t Heap::sizeClassFor(size_t bytes)
+    {
+        // Indexed by the number of granules the request needs.
+        static const unsigned char sizeClasses[9] = { 0, 0, 0, 1, 2, 3, 3, 4, 4 };
+        size_t granules = (bytes + CELL_GRANULE_MASK) / CELL_GRANULE;
+        ASSERT(granules < sizeof(sizeClasses));
+        return sizeClasses[granules];
     }
 
     inline bool Heap::isCellMarked(const AJCell* cell)
@@ -299,24 +645,38 @@ namespace AJ {
         cellBlock(cell)->marked.set(cellOffset(cell));
     }
 
+    inline void Heap::writeBarrier(const AJCell* owner)
+    {
+        cellBlock(owner)->cards[(reinterpret_cast<uintptr_t>(owner) & BLOCK_OFFSET_MASK) >> CARD_SHIFT] = 1;
+    }
+
+    inline void Heap::writeBarrier(const AJCell* owner, AJValue value)
+    {
+        if (value.isCell())
+            writeBarrier(owner);
+    }
+
+#if ENABLE(PARALLEL_MARKING)
+    inline bool Heap::testAndSetMarkedAtomically(AJCell* cell)
+    {
+        return cellBlock(cell)->marked.testAndSetAtomically(cellOffset(cell));
+    }
+#endif
+
     inline void Heap::reportExtraMemoryCost(size_t cost)
     {
         if (cost > minExtraCost) 
             recordExtraCost(cost);
     }
-    
-    inline void* Heap::allocateNumber(size_t s)
-    {
-        if (void* result = m_heap.nextNumber) {
-            m_heap.nextNumber = 0;
-            return result;
-        }
 
-        void* result = allocate(s);
-        m_heap.nextNumber = static_cast<char*>(result) + (CELL_SIZE / 2);
-        return result;
+    inline void* Heap::allocateStorage(size_t bytes, void** owner)
+    {
+        void* storage = m_copiedSpace.tryAllocate(bytes, owner);
+        if (!storage)
+            CRASH();
+        return storage;
     }
-
+    
 } // namespace AJ
 
 #endif /* Collector_h */
@@ -94,7 +94,7 @@ namespace AJ {
 
     inline AJCell* CollectorHeapIterator::operator*() const
     {
-        return reinterpret_cast<AJCell*>(m_heap.blocks[m_block]->cells + m_cell);
+        return m_heap.blocks[m_block]->cellAt(m_cell);
     }
     
     // Iterators advance up to the next-to-last -- and not the last -- cell in a
@@ -116,12 +116,10 @@ namespace AJ {
 
     inline LiveObjectIterator& LiveObjectIterator::operator++()
     {
-        advance(HeapConstants::cellsPerBlock - 1);
-        if (m_block < m_heap.nextBlock || (m_block == m_heap.nextBlock && m_cell < m_heap.nextCell))
-            return *this;
-
+        advance(m_heap.cellsPerBlock - 1);
+        // Cells allocated since the last collection are born marked.
         while (m_block < m_heap.usedBlocks && !m_heap.blocks[m_block]->marked.get(m_cell))
-            advance(HeapConstants::cellsPerBlock - 1);
+            advance(m_heap.cellsPerBlock - 1);
         return *this;
     }
 
@@ -134,8 +132,7 @@ namespace AJ {
     inline DeadObjectIterator& DeadObjectIterator::operator++()
     {
         do {
-            advance(HeapConstants::cellsPerBlock - 1);
-            ASSERT(m_block > m_heap.nextBlock || (m_block == m_heap.nextBlock && m_cell >= m_heap.nextCell));
+            advance(m_heap.cellsPerBlock - 1);
         } while (m_block < m_heap.usedBlocks && m_heap.blocks[m_block]->marked.get(m_cell));
         return *this;
     }
@@ -148,7 +145,7 @@ namespace AJ {
 
     inline ObjectIterator& ObjectIterator::operator++()
     {
-        advance(HeapConstants::cellsPerBlock - 1);
+        advance(m_heap.cellsPerBlock - 1);
         return *this;
     }
 
@@ -50,6 +50,10 @@ limitations under the License.
     macro(__lookupSetter__) \
     macro(apply) \
     macro(arguments) \
+    macro(buffer) \
+    macro(byteLength) \
+    macro(byteOffset) \
+    macro(BYTES_PER_ELEMENT) \
     macro(call) \
     macro(callee) \
     macro(caller) \
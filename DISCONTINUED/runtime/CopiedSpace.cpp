@@ -0,0 +1,295 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "config.h"
+#include "CopiedSpace.h"
+
+#include "Collector.h"
+#include <wtf/FastMalloc.h>
+
+namespace AJ {
+
+struct CopiedBlock {
+    char* top; // Where the next buffer goes.
+    bool isPinned;
+
+    char* payload();
+    char* end() { return reinterpret_cast<char*>(this) + BLOCK_SIZE; }
+};
+
+static const size_t PAYLOAD_OFFSET = (sizeof(CopiedBlock) + 7) & ~static_cast<size_t>(7);
+
+inline char* CopiedBlock::payload()
+{
+    return reinterpret_cast<char*>(this) + PAYLOAD_OFFSET;
+}
+
+// Copying a buffer bigger than this would cost more than the fragmentation
+// it saves.
+static const size_t LARGE_ALLOCATION_SIZE = (BLOCK_SIZE - PAYLOAD_OFFSET) / 4;
+
+static inline size_t roundUpToMultipleOf8(size_t bytes)
+{
+    return (bytes + 7) & ~static_cast<size_t>(7);
+}
+
+// The owner field of a buffer may be anywhere inside its cell.
+static inline AJCell* ownerCell(void** owner)
+{
+    CollectorBlock* block = reinterpret_cast<CollectorBlock*>(reinterpret_cast<uintptr_t>(owner) & BLOCK_MASK);
+    return block->cellAt(block->cellIndex(owner));
+}
+
+CopiedSpace::CopiedSpace(Heap* heap)
+    : m_heap(heap)
+    , m_currentBlock(0)
+    , m_minAddress(std::numeric_limits<uintptr_t>::max())
+    , m_maxAddress(0)
+    , m_largeAllocationBytes(0)
+{
+    // Keeps every buffer 8 byte aligned, for doubles.
+    COMPILE_ASSERT(!(sizeof(Header) % 8), CopiedSpace_header_keeps_alignment);
+}
+
+CopiedSpace::~CopiedSpace()
+{
+    ASSERT(m_blocks.isEmpty());
+    ASSERT(m_largeAllocations.isEmpty());
+}
+
+size_t CopiedSpace::offsetOfBlockTop()
+{
+    return OBJECT_OFFSETOF(CopiedBlock, top);
+}
+
+CopiedBlock* CopiedSpace::tryAllocateBlock()
+{
+    CopiedBlock* block = static_cast<CopiedBlock*>(m_heap->allocateBlockMemory());
+    if (!block)
+        return 0;
+
+    block->top = block->payload();
+    block->isPinned = false;
+
+    m_blocks.add(block);
+    m_minAddress = std::min(m_minAddress, reinterpret_cast<uintptr_t>(block));
+    m_maxAddress = std::max(m_maxAddress, reinterpret_cast<uintptr_t>(block) + BLOCK_SIZE);
+    m_heap->updateHeapLimitState();
+    return block;
+}
+
+void CopiedSpace::freeBlock(CopiedBlock* block)
+{
+    m_blocks.remove(block);
+    m_heap->freeBlockPtr(block);
+}
+
+CopiedSpace::Header* CopiedSpace::tryAllocateIn(CopiedBlock*& block, Vector<CopiedBlock*>& blocks, size_t size)
+{
+    size_t bytes = sizeof(Header) + size;
+    if (!block || static_cast<size_t>(block->end() - block->top) < bytes) {
+        block = tryAllocateBlock();
+        if (!block)
+            return 0;
+        blocks.append(block);
+    }
+
+    Header* header = reinterpret_cast<Header*>(block->top);
+    block->top += bytes;
+    header->size = size;
+    return header;
+}
+
+void* CopiedSpace::tryAllocateLarge(size_t size, void** owner)
+{
+    void* memory;
+    if (!tryFastMalloc(sizeof(Header) + size).getValue(memory))
+        return 0;
+
+    Header* header = static_cast<Header*>(memory);
+    header->owner = owner;
+    header->size = size;
+    m_largeAllocations.append(header);
+    m_largeAllocationBytes += size;
+    m_heap->updateHeapLimitState();
+    return header + 1;
+}
+
+void* CopiedSpace::tryAllocate(size_t bytes, void** owner)
+{
+    ASSERT(owner);
+    if (bytes > std::numeric_limits<size_t>::max() - sizeof(Header) - 7)
+        return 0;
+
+    size_t size = roundUpToMultipleOf8(bytes);
+    if (size > LARGE_ALLOCATION_SIZE)
+        return tryAllocateLarge(size, owner);
+
+    Header* header = tryAllocateIn(m_currentBlock, m_youngBlocks, size);
+    if (!header)
+        return 0;
+    header->owner = owner;
+    return header + 1;
+}
+
+void* CopiedSpace::tryReallocate(void* storage, size_t oldSize, size_t newSize, void** owner)
+{
+    // Growing the last buffer in the current block is just a bump.
+    Header* header = static_cast<Header*>(storage) - 1;
+    char* payload = static_cast<char*>(storage);
+    if (m_currentBlock && payload + header->size == m_currentBlock->top && header->owner == owner) {
+        size_t size = roundUpToMultipleOf8(newSize);
+        if (size >= header->size && size <= LARGE_ALLOCATION_SIZE && size <= static_cast<size_t>(m_currentBlock->end() - payload)) {
+            m_currentBlock->top = payload + size;
+            header->size = size;
+            return storage;
+        }
+    }
+
+    void* newStorage = tryAllocate(newSize, owner);
+    if (newStorage)
+        memcpy(newStorage, storage, std::min(oldSize, newSize));
+    return newStorage;
+}
+
+void CopiedSpace::pin(const void* p)
+{
+    ASSERT(mayContain(p));
+    CopiedBlock* block = reinterpret_cast<CopiedBlock*>(reinterpret_cast<uintptr_t>(p) & BLOCK_MASK);
+    if (m_blocks.contains(block))
+        block->isPinned = true;
+}
+
+bool CopiedSpace::isLive(const Header* header)
+{
+    // A cell that replaced its storage leaves the old buffer behind.
+    if (!header->owner || *header->owner != header + 1)
+        return false;
+    return Heap::isCellMarked(ownerCell(header->owner));
+}
+
+void CopiedSpace::collect(bool isMajorCollection)
+{
+    Vector<CopiedBlock*> fromBlocks;
+    fromBlocks.swap(m_youngBlocks);
+    if (isMajorCollection) {
+        fromBlocks.append(m_oldBlocks.data(), m_oldBlocks.size());
+        m_oldBlocks.clear();
+    }
+    m_currentBlock = 0;
+
+    // Survivors are copied into blocks that will only be collected again by
+    // a major collection.
+    CopiedBlock* toBlock = 0;
+    for (size_t i = 0; i < fromBlocks.size(); ++i) {
+        CopiedBlock* block = fromBlocks[i];
+        bool keepBlock = block->isPinned;
+        block->isPinned = false;
+
+        for (char* p = block->payload(); p < block->top; ) {
+            Header* header = reinterpret_cast<Header*>(p);
+            p += sizeof(Header) + header->size;
+
+            if (!isLive(header)) {
+                if (header->owner && *header->owner == header + 1) {
+                    // The owner is dead. It may not be swept until after the
+                    // next collection, and conservative marking must not find
+                    // it pointing at storage that is gone, so destroy it now.
+                    m_heap->destroyDeadCell(ownerCell(header->owner));
+                }
+                header->owner = 0;
+                continue;
+            }
+
+            if (keepBlock)
+                continue;
+
+            Header* copy = tryAllocateIn(toBlock, m_oldBlocks, header->size);
+            if (!copy) {
+                keepBlock = true;
+                continue;
+            }
+            copy->owner = header->owner;
+            memcpy(copy + 1, header + 1, header->size);
+            *header->owner = copy + 1;
+        }
+
+        if (keepBlock)
+            m_oldBlocks.append(block);
+        else
+            freeBlock(block);
+    }
+
+    for (size_t i = 0; i < m_largeAllocations.size(); ) {
+        Header* header = m_largeAllocations[i];
+        if (isLive(header)) {
+            ++i;
+            continue;
+        }
+        if (*header->owner == header + 1)
+            m_heap->destroyDeadCell(ownerCell(header->owner));
+        m_largeAllocationBytes -= header->size;
+        fastFree(header);
+        m_largeAllocations[i] = m_largeAllocations.last();
+        m_largeAllocations.removeLast();
+    }
+}
+
+void CopiedSpace::freeAll()
+{
+    HashSet<CopiedBlock*>::iterator end = m_blocks.end();
+    for (HashSet<CopiedBlock*>::iterator it = m_blocks.begin(); it != end; ++it)
+        m_heap->freeBlockPtr(*it);
+    m_blocks.clear();
+    m_youngBlocks.clear();
+    m_oldBlocks.clear();
+    m_currentBlock = 0;
+    m_minAddress = std::numeric_limits<uintptr_t>::max();
+    m_maxAddress = 0;
+
+    for (size_t i = 0; i < m_largeAllocations.size(); ++i)
+        fastFree(m_largeAllocations[i]);
+    m_largeAllocations.clear();
+    m_largeAllocationBytes = 0;
+}
+
+void CopiedSpace::forEachLiveStorage(StorageFunction function, void* context) const
+{
+    HashSet<CopiedBlock*>::const_iterator end = m_blocks.end();
+    for (HashSet<CopiedBlock*>::const_iterator it = m_blocks.begin(); it != end; ++it) {
+        CopiedBlock* block = *it;
+        for (char* p = block->payload(); p < block->top; ) {
+            Header* header = reinterpret_cast<Header*>(p);
+            p += sizeof(Header) + header->size;
+            if (isLive(header))
+                function(ownerCell(header->owner), header->size, context);
+        }
+    }
+
+    for (size_t i = 0; i < m_largeAllocations.size(); ++i) {
+        Header* header = m_largeAllocations[i];
+        if (isLive(header))
+            function(ownerCell(header->owner), header->size, context);
+    }
+}
+
+size_t CopiedSpace::size() const
+{
+    return m_blocks.size() * BLOCK_SIZE + m_largeAllocationBytes;
+}
+
+} // namespace AJ
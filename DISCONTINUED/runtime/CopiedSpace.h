@@ -0,0 +1,108 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef CopiedSpace_h
+#define CopiedSpace_h
+
+#include <limits>
+#include <wtf/HashSet.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/Vector.h>
+
+namespace AJ {
+
+    class AJCell;
+    class Heap;
+    struct CopiedBlock;
+
+    // Backing stores for cells: object property storage and array storage.
+    // Storage is bump allocated in blocks and never freed one buffer at a
+    // time. After marking, the collector copies the storage of live cells out
+    // of the blocks it is collecting and frees those blocks whole, so a cell
+    // that dies needs no finalizer to release its storage.
+    //
+    // Each buffer starts with a header naming the field that points to it.
+    // A buffer is live if the cell holding that field is marked and the field
+    // still points to it. A block that a conservative root points into is
+    // pinned, and kept where it is for that collection.
+    class CopiedSpace : public Noncopyable {
+        friend class JIT;
+
+    public:
+        CopiedSpace(Heap*);
+        ~CopiedSpace();
+
+        // owner is the field, inside a cell, that the caller will point at
+        // the new storage. Returns 0 if out of memory.
+        void* tryAllocate(size_t, void** owner);
+        // The old storage is left for the collector; its contents up to
+        // oldSize are copied.
+        void* tryReallocate(void* storage, size_t oldSize, size_t newSize, void** owner);
+
+        // Filters conservative roots before pin() looks the block up.
+        bool mayContain(const void* p) const
+        {
+            uintptr_t address = reinterpret_cast<uintptr_t>(p);
+            return address >= m_minAddress && address < m_maxAddress;
+        }
+        void pin(const void*);
+
+        // Called once marking has finished. A minor collection only copies out
+        // of the blocks allocated from since the last collection.
+        void collect(bool isMajorCollection);
+        void freeAll();
+
+        size_t size() const; // bytes held, live or not
+
+        // Calls the function with each buffer whose owner is marked, for heap
+        // censuses. Marking must have finished.
+        typedef void (*StorageFunction)(AJCell* owner, size_t bytes, void* context);
+        void forEachLiveStorage(StorageFunction, void* context) const;
+
+    private:
+        struct Header {
+            void** owner; // 0 once the buffer is known to be dead
+            size_t size; // payload bytes, a multiple of 8
+        };
+
+        // Where the next buffer in a block goes, for the JIT's inline allocation.
+        static size_t offsetOfBlockTop();
+
+        CopiedBlock* tryAllocateBlock();
+        void freeBlock(CopiedBlock*);
+        void* tryAllocateLarge(size_t, void** owner);
+        Header* tryAllocateIn(CopiedBlock*&, Vector<CopiedBlock*>&, size_t);
+        static bool isLive(const Header*);
+
+        Heap* m_heap;
+
+        CopiedBlock* m_currentBlock;
+        Vector<CopiedBlock*> m_youngBlocks; // allocated from since the last collection
+        Vector<CopiedBlock*> m_oldBlocks;
+        HashSet<CopiedBlock*> m_blocks;
+        // Like CollectorBlockSet, the range only grows until freeAll().
+        uintptr_t m_minAddress;
+        uintptr_t m_maxAddress;
+
+        // Buffers too big to be worth copying. They never move.
+        Vector<Header*> m_largeAllocations;
+        size_t m_largeAllocationBytes;
+    };
+
+} // namespace AJ
+
+#endif // CopiedSpace_h
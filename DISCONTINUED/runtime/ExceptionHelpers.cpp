@@ -100,6 +100,11 @@ AJValue createStackOverflowError(ExecState* exec)
     return createError(exec, RangeError, "Maximum call stack size exceeded.");
 }
 
+AJValue createOutOfMemoryError(ExecState* exec)
+{
+    return createError(exec, GeneralError, "Out of memory");
+}
+
 AJValue createTypeError(ExecState* exec, const char* message)
 {
     return createError(exec, TypeError, message);
@@ -118,6 +123,15 @@ AJValue createUndefinedVariableError(ExecState* exec, const Identifier& ident, u
     return exception;
 }
     
+// Reads Latin-1 source as it is held, so that an error message does not
+// leave a UTF-16 copy of the whole source behind.
+static inline UChar sourceCharacter(SourceProvider* source, int index)
+{
+    if (source->is8Bit())
+        return source->data8()[index];
+    return source->data()[index];
+}
+
 static UString createErrorMessage(ExecState* exec, CodeBlock* codeBlock, int, int expressionStart, int expressionStop, AJValue value, UString error)
 {
     if (!expressionStop || expressionStart > codeBlock->source()->length())
@@ -126,21 +140,21 @@ static UString createErrorMessage(ExecState* exec, CodeBlock* codeBlock, int, in
         return makeString("Result of expression '", codeBlock->source()->getRange(expressionStart, expressionStop), "' [", value.toString(exec), "] is ", error, ".");
 
     // No range information, so give a few characters of context
-    const UChar* data = codeBlock->source()->data();
-    int dataLength = codeBlock->source()->length();
+    SourceProvider* source = codeBlock->source();
+    int dataLength = source->length();
     int start = expressionStart;
     int stop = expressionStart;
     // Get up to 20 characters of context to the left and right of the divot, clamping to the line.
     // then strip whitespace.
-    while (start > 0 && (expressionStart - start < 20) && data[start - 1] != '\n')
+    while (start > 0 && (expressionStart - start < 20) && sourceCharacter(source, start - 1) != '\n')
         start--;
-    while (start < (expressionStart - 1) && isStrWhiteSpace(data[start]))
+    while (start < (expressionStart - 1) && isStrWhiteSpace(sourceCharacter(source, start)))
         start++;
-    while (stop < dataLength && (stop - expressionStart < 20) && data[stop] != '\n')
+    while (stop < dataLength && (stop - expressionStart < 20) && sourceCharacter(source, stop) != '\n')
         stop++;
-    while (stop > expressionStart && isStrWhiteSpace(data[stop]))
+    while (stop > expressionStart && isStrWhiteSpace(sourceCharacter(source, stop)))
         stop--;
-    return makeString("Result of expression near '...", codeBlock->source()->getRange(start, stop), "...' [", value.toString(exec), "] is ", error, ".");
+    return makeString("Result of expression near '...", source->getRange(start, stop), "...' [", value.toString(exec), "] is ", error, ".");
 }
 
 AJObject* createInvalidParamError(ExecState* exec, const char* op, AJValue value, unsigned bytecodeOffset, CodeBlock* codeBlock)
@@ -166,8 +180,7 @@ AJObject* createNotAConstructorError(ExecState* exec, AJValue value, unsigned by
 
     // We're in a "new" expression, so we need to skip over the "new.." part
     int startPoint = divotPoint - (startOffset ? startOffset - 4 : 0); // -4 for "new "
-    const UChar* data = codeBlock->source()->data();
-    while (startPoint < divotPoint && isStrWhiteSpace(data[startPoint]))
+    while (startPoint < divotPoint && isStrWhiteSpace(sourceCharacter(codeBlock->source(), startPoint)))
         startPoint++;
     
     UString errorMessage = createErrorMessage(exec, codeBlock, line, startPoint, divotPoint, value, "not a constructor");
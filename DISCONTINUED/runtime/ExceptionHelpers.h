@@ -62,6 +62,7 @@ namespace AJ {
     AJValue createInterruptedExecutionException(AJGlobalData*);
     AJValue createTerminatedExecutionException(AJGlobalData*);
     AJValue createStackOverflowError(ExecState*);
+    AJValue createOutOfMemoryError(ExecState*);
     AJValue createTypeError(ExecState*, const char* message);
     AJValue createUndefinedVariableError(ExecState*, const Identifier&, unsigned bytecodeOffset, CodeBlock*);
     JSNotAnObjectErrorStub* createNotAnObjectErrorStub(ExecState*, bool isNull);
@@ -0,0 +1,104 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "config.h"
+#include "HandleHeap.h"
+
+#include "AJCell.h"
+#include "Collector.h"
+#include "MarkStack.h"
+#include <wtf/FastMalloc.h>
+
+namespace AJ {
+
+static const size_t HANDLE_BLOCK_SIZE = 4096;
+
+struct HandleHeap::Block {
+    Block* next;
+    Node nodes[(HANDLE_BLOCK_SIZE - sizeof(Block*)) / sizeof(Node)];
+};
+
+HandleHeap::HandleHeap()
+    : m_blocks(0)
+    , m_freeList(0)
+    , m_handleCount(0)
+{
+}
+
+HandleHeap::~HandleHeap()
+{
+    while (m_blocks) {
+        Block* next = m_blocks->next;
+        fastFree(m_blocks);
+        m_blocks = next;
+    }
+}
+
+void HandleHeap::grow()
+{
+    COMPILE_ASSERT(sizeof(Block) <= HANDLE_BLOCK_SIZE, HandleHeap_block_fits);
+
+    Block* block = static_cast<Block*>(fastMalloc(sizeof(Block)));
+    block->next = m_blocks;
+    m_blocks = block;
+
+    // Thread the free list so that slots are handed out in address order.
+    const size_t count = sizeof(block->nodes) / sizeof(Node);
+    for (size_t i = count; i--; ) {
+        new (&block->nodes[i].value) AJValue();
+        block->nodes[i].nextFree = m_freeList;
+        m_freeList = &block->nodes[i];
+    }
+}
+
+void HandleHeap::markRoots(MarkStack& markStack)
+{
+    const size_t count = sizeof(m_blocks->nodes) / sizeof(Node);
+    for (Block* block = m_blocks; block; block = block->next) {
+        for (size_t i = 0; i < count; ++i) {
+            if (AJValue value = block->nodes[i].value)
+                markStack.append(value);
+        }
+    }
+
+    size_t temporaryCount = m_temporaries.size();
+    for (size_t i = 0; i < temporaryCount; ++i) {
+        if (AJValue value = m_temporaries.at(i))
+            markStack.append(value);
+    }
+}
+
+void HandleHeap::clearUnmarkedValues()
+{
+    const size_t count = sizeof(m_blocks->nodes) / sizeof(Node);
+    for (Block* block = m_blocks; block; block = block->next) {
+        for (size_t i = 0; i < count; ++i) {
+            AJValue& value = block->nodes[i].value;
+            if (value && value.isCell() && !Heap::isCellMarked(value.asCell()))
+                value = AJValue();
+        }
+    }
+
+    size_t temporaryCount = m_temporaries.size();
+    for (size_t i = 0; i < temporaryCount; ++i) {
+        AJValue& value = m_temporaries.at(i);
+        if (value && value.isCell() && !Heap::isCellMarked(value.asCell()))
+            value = AJValue();
+    }
+}
+
+} // namespace AJ
@@ -0,0 +1,117 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef HandleHeap_h
+#define HandleHeap_h
+
+#include "AJValue.h"
+#include <wtf/Noncopyable.h>
+#include <wtf/SegmentedVector.h>
+
+namespace AJ {
+
+    class MarkStack;
+
+    // A slot for a value that native code holds on to. The value is a root of
+    // the heap until the slot is deallocated.
+    typedef AJValue* HandleSlot;
+
+    // Unlike Heap::protect(), which counts protections in a hash table,
+    // allocating or deallocating a slot is a free list pop or push, and
+    // marking walks the slots in order.
+    //
+    // Temporary slots are allocated in frames, like a stack: popping a frame
+    // deallocates every temporary slot allocated since it was pushed.
+    class HandleHeap : public Noncopyable {
+    public:
+        HandleHeap();
+        ~HandleHeap();
+
+        HandleSlot allocate();
+        static void deallocate(HandleSlot);
+
+        typedef size_t Frame;
+        Frame pushFrame() { return m_temporaries.size(); }
+        void popFrame(Frame);
+        HandleSlot allocateTemporary();
+
+        void markRoots(MarkStack&);
+        // For slots that hold their values weakly: empties the slots holding
+        // cells that were not marked.
+        void clearUnmarkedValues();
+
+        size_t handleCount() const { return m_handleCount; }
+        size_t temporaryCount() const { return m_temporaries.size(); }
+
+    private:
+        struct Node {
+            AJValue value; // First, so that a slot is its node.
+            union {
+                Node* nextFree;
+                HandleHeap* heap; // While the slot is allocated.
+            };
+        };
+
+        // Blocks are never freed: the number of slots in use at once is
+        // bounded by what native code holds, not by the heap size.
+        struct Block;
+
+        NEVER_INLINE void grow();
+
+        Block* m_blocks;
+        Node* m_freeList;
+        size_t m_handleCount;
+        SegmentedVector<AJValue, 256> m_temporaries;
+    };
+
+    inline HandleSlot HandleHeap::allocate()
+    {
+        if (!m_freeList)
+            grow();
+        Node* node = m_freeList;
+        m_freeList = node->nextFree;
+        node->heap = this;
+        ++m_handleCount;
+        return &node->value;
+    }
+
+    inline void HandleHeap::deallocate(HandleSlot slot)
+    {
+        Node* node = reinterpret_cast<Node*>(slot);
+        HandleHeap* heap = node->heap;
+        node->value = AJValue();
+        node->nextFree = heap->m_freeList;
+        heap->m_freeList = node;
+        --heap->m_handleCount;
+    }
+
+    inline HandleSlot HandleHeap::allocateTemporary()
+    {
+        m_temporaries.append(AJValue());
+        return &m_temporaries.last();
+    }
+
+    inline void HandleHeap::popFrame(Frame frame)
+    {
+        ASSERT(frame <= m_temporaries.size());
+        while (m_temporaries.size() > frame)
+            m_temporaries.removeLast();
+    }
+
+} // namespace AJ
+
+#endif // HandleHeap_h
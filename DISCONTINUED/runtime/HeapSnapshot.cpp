@@ -0,0 +1,136 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "config.h"
+#include "HeapSnapshot.h"
+
+#include "AJArray.h"
+#include "MarkStack.h"
+#include <string.h>
+
+namespace AJ {
+
+void MarkStack::recordSnapshotEdge(AJCell* cell)
+{
+    m_heapSnapshot->addEdge(cell);
+}
+
+void MarkStack::recordSnapshotRoots(const char* name)
+{
+    m_heapSnapshot->beginRoots(name);
+}
+
+HeapSnapshotWriter::HeapSnapshotWriter(FILE* file, MarkStack& markStack)
+    : m_file(file)
+    , m_markStack(markStack)
+    , m_rootName(0)
+{
+    ASSERT(!markStack.m_heapSnapshot);
+    markStack.m_heapSnapshot = this;
+
+    write("AJHS", 4);
+    write32(version);
+}
+
+HeapSnapshotWriter::~HeapSnapshotWriter()
+{
+    ASSERT(m_markStack.m_heapSnapshot == this);
+    m_markStack.m_heapSnapshot = 0;
+}
+
+uint32_t HeapSnapshotWriter::nameIndex(const char* name)
+{
+    pair<HashMap<const char*, uint32_t>::iterator, bool> result = m_nameIndices.add(name, m_nameIndices.size());
+    if (result.second) {
+        size_t length = strlen(name);
+        writeTag('S');
+        write32(result.first->second);
+        write32(length);
+        write(name, length);
+    }
+    return result.first->second;
+}
+
+// Values appended as ranges, and any cell that was not marked yet, are still
+// on the stack.
+void HeapSnapshotWriter::takeEdgesFromMarkStack()
+{
+    while (!m_markStack.m_markSets.isEmpty()) {
+        MarkStack::MarkSet set = m_markStack.m_markSets.removeLast();
+        for (AJValue* value = set.m_values; value != set.m_end; ++value) {
+            if (*value && value->isCell())
+                addEdge(value->asCell());
+        }
+    }
+    while (!m_markStack.m_values.isEmpty())
+        addEdge(m_markStack.m_values.removeLast());
+}
+
+void HeapSnapshotWriter::writeEdges()
+{
+    takeEdgesFromMarkStack();
+    write32(m_edges.size());
+    for (size_t i = 0; i < m_edges.size(); ++i)
+        write64(reinterpret_cast<uintptr_t>(m_edges[i]));
+    m_edges.shrink(0);
+}
+
+void HeapSnapshotWriter::beginRoots(const char* name)
+{
+    endRoots();
+    m_rootName = name;
+}
+
+void HeapSnapshotWriter::endRoots()
+{
+    if (!m_rootName)
+        return;
+    uint32_t index = nameIndex(m_rootName);
+    writeTag('R');
+    write32(index);
+    writeEdges();
+    m_rootName = 0;
+}
+
+void HeapSnapshotWriter::addCell(AJCell* cell, const char* name, size_t size)
+{
+    endRoots();
+    uint32_t index = nameIndex(name);
+    if (cell->structure()->typeInfo().type() >= CompoundType)
+        m_markStack.markChildren(cell);
+    writeTag('N');
+    write64(reinterpret_cast<uintptr_t>(cell));
+    write32(index);
+    write64(size);
+    writeEdges();
+}
+
+void HeapSnapshotWriter::addStorage(AJCell* owner, size_t size)
+{
+    writeTag('B');
+    write64(reinterpret_cast<uintptr_t>(owner));
+    write64(size);
+}
+
+bool HeapSnapshotWriter::finish()
+{
+    endRoots();
+    writeTag('E');
+    return !ferror(m_file);
+}
+
+} // namespace AJ
@@ -0,0 +1,87 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef HeapSnapshot_h
+#define HeapSnapshot_h
+
+#include <stdint.h>
+#include <stdio.h>
+#include <wtf/HashMap.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/Vector.h>
+
+namespace AJ {
+
+    class AJCell;
+    class MarkStack;
+
+    // Streams a heap snapshot to a file. Nothing is kept in memory but the
+    // edges of the cell being written and the table of names, so the heap can
+    // be written however big it is.
+    //
+    // The file starts with the magic "AJHS" and a 32 bit version, followed by
+    // records, each starting with a one byte tag. Integers are in the byte
+    // order of the machine that wrote the file; ids are cell addresses.
+    //
+    //   'S' u32 index, u32 length, name bytes    defines a name, once, before its first use
+    //   'R' u32 name, u32 count, u64 ids[count]  cells pointed to by a set of roots
+    //   'N' u64 id, u32 name, u64 size, u32 count, u64 ids[count]
+    //                                            a live cell and the cells it points to
+    //   'B' u64 id, u64 size                     storage owned by a cell, after the cells
+    //   'E'                                      end of the snapshot
+    //
+    // Every live cell must be marked, and the mark stack empty, while the
+    // snapshot is written. The writer borrows the mark stack: marking a cell's
+    // children then records edges instead of marking.
+    class HeapSnapshotWriter : public Noncopyable {
+    public:
+        static const uint32_t version = 1;
+
+        HeapSnapshotWriter(FILE*, MarkStack&);
+        ~HeapSnapshotWriter();
+
+        // Roots appended to the mark stack after this belong to the named set.
+        void beginRoots(const char* name);
+        void addCell(AJCell*, const char* name, size_t size);
+        void addStorage(AJCell* owner, size_t size);
+        // Returns false if anything could not be written.
+        bool finish();
+
+    private:
+        friend class MarkStack;
+
+        void addEdge(AJCell* cell) { m_edges.append(cell); }
+        void takeEdgesFromMarkStack();
+        void endRoots();
+
+        uint32_t nameIndex(const char*);
+        void writeEdges();
+        void write(const void* data, size_t size) { fwrite(data, size, 1, m_file); }
+        void writeTag(char tag) { write(&tag, 1); }
+        void write32(uint32_t value) { write(&value, sizeof(value)); }
+        void write64(uint64_t value) { write(&value, sizeof(value)); }
+
+        FILE* m_file;
+        MarkStack& m_markStack;
+        const char* m_rootName; // 0 once the roots are written
+        Vector<AJCell*> m_edges;
+        HashMap<const char*, uint32_t> m_nameIndices;
+    };
+
+} // namespace AJ
+
+#endif // HeapSnapshot_h
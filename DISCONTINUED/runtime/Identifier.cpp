@@ -84,23 +84,17 @@ void deleteIdentifierTable(IdentifierTable* table)
 
 bool Identifier::equal(const UString::Rep* r, const char* s)
 {
-    int length = r->length();
-    const UChar* d = r->characters();
-    for (int i = 0; i != length; ++i)
-        if (d[i] != (unsigned char)s[i])
-            return false;
-    return s[length] == 0;
+    return ::equal(r, s);
 }
 
 bool Identifier::equal(const UString::Rep* r, const UChar* s, unsigned length)
 {
-    if (r->length() != length)
-        return false;
-    const UChar* d = r->characters();
-    for (unsigned i = 0; i != length; ++i)
-        if (d[i] != s[i])
-            return false;
-    return true;
+    return ::equal(r, s, length);
+}
+
+bool Identifier::equal(const UString::Rep* r, const LChar* s, unsigned length)
+{
+    return ::equal(r, s, length);
 }
 
 struct IdentifierCStringTranslator {
@@ -117,10 +111,9 @@ struct IdentifierCStringTranslator {
     static void translate(UString::Rep*& location, const char* c, unsigned hash)
     {
         size_t length = strlen(c);
-        UChar* d;
+        LChar* d;
         UString::Rep* r = UString::Rep::createUninitialized(length, d).releaseRef();
-        for (size_t i = 0; i != length; i++)
-            d[i] = static_cast<unsigned char>(c[i]); // use unsigned char to zero-extend instead of sign-extend
+        memcpy(d, c, length);
         r->setHash(hash);
         location = r;
     }
@@ -176,10 +169,7 @@ struct IdentifierUCharBufferTranslator {
 
     static void translate(UString::Rep*& location, const UCharBuffer& buf, unsigned hash)
     {
-        UChar* d;
-        UString::Rep* r = UString::Rep::createUninitialized(buf.length, d).releaseRef();
-        for (unsigned i = 0; i != buf.length; i++)
-            d[i] = buf.s[i];
+        UString::Rep* r = UString::Rep::create8BitIfPossible(buf.s, buf.length).releaseRef();
         r->setHash(hash);
         location = r; 
     }
@@ -207,6 +197,44 @@ PassRefPtr<UString::Rep> Identifier::add(ExecState* exec, const UChar* s, int le
     return add(&exec->globalData(), s, length);
 }
 
+struct LCharBuffer {
+    const LChar* s;
+    unsigned int length;
+};
+
+struct IdentifierLCharBufferTranslator {
+    static unsigned hash(const LCharBuffer& buf)
+    {
+        return UString::Rep::computeHash(buf.s, buf.length);
+    }
+
+    static bool equal(UString::Rep* str, const LCharBuffer& buf)
+    {
+        return Identifier::equal(str, buf.s, buf.length);
+    }
+
+    static void translate(UString::Rep*& location, const LCharBuffer& buf, unsigned hash)
+    {
+        UString::Rep* r = UString::Rep::create(buf.s, buf.length).releaseRef();
+        r->setHash(hash);
+        location = r; 
+    }
+};
+
+PassRefPtr<UString::Rep> Identifier::add(AJGlobalData* globalData, const LChar* s, int length)
+{
+    if (length == 1)
+        return add(globalData, globalData->smallStrings.singleCharacterStringRep(s[0]));
+    if (!length)
+        return UString::Rep::empty();
+    LCharBuffer buf = {s, length}; 
+    pair<HashSet<UString::Rep*>::iterator, bool> addResult = globalData->identifierTable->add<LCharBuffer, IdentifierLCharBufferTranslator>(buf);
+
+    // If the string is newly-translated, then we need to adopt it.
+    // The boolean in the pair tells us if that is so.
+    return addResult.second ? adoptRef(*addResult.first) : *addResult.first;
+}
+
 PassRefPtr<UString::Rep> Identifier::addSlowCase(AJGlobalData* globalData, UString::Rep* r)
 {
     ASSERT(!r->isIdentifier());
@@ -215,7 +243,7 @@ PassRefPtr<UString::Rep> Identifier::addSlowCase(AJGlobalData* globalData, UStri
     ASSERT(r->length());
 
     if (r->length() == 1) {
-        UChar c = r->characters()[0];
+        UChar c = (*r)[0];
         if (c <= 0xFF)
             r = globalData->smallStrings.singleCharacterStringRep(c);
             if (r->isIdentifier())
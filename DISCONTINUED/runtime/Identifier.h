@@ -58,6 +58,7 @@ namespace AJ {
 
         Identifier(AJGlobalData* globalData, const char* s) : _ustring(add(globalData, s)) { } // Only to be used with string literals.
         Identifier(AJGlobalData* globalData, const UChar* s, int length) : _ustring(add(globalData, s, length)) { }
+        Identifier(AJGlobalData* globalData, const LChar* s, int length) : _ustring(add(globalData, s, length)) { }
         Identifier(AJGlobalData* globalData, UString::Rep* rep) : _ustring(add(globalData, rep)) { } 
         Identifier(AJGlobalData* globalData, const UString& s) : _ustring(add(globalData, s.rep())) { }
 
@@ -92,6 +93,7 @@ namespace AJ {
     
         static bool equal(const UString::Rep*, const char*);
         static bool equal(const UString::Rep*, const UChar*, unsigned length);
+        static bool equal(const UString::Rep*, const LChar*, unsigned length);
         static bool equal(const UString::Rep* a, const UString::Rep* b) { return ::equal(a, b); }
 
         static PassRefPtr<UString::Rep> add(ExecState*, const char*); // Only to be used with string literals.
@@ -105,6 +107,7 @@ namespace AJ {
 
         static PassRefPtr<UString::Rep> add(ExecState*, const UChar*, int length);
         static PassRefPtr<UString::Rep> add(AJGlobalData*, const UChar*, int length);
+        static PassRefPtr<UString::Rep> add(AJGlobalData*, const LChar*, int length);
 
         static PassRefPtr<UString::Rep> add(ExecState* exec, UString::Rep* r)
         {
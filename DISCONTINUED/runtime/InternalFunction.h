@@ -65,7 +65,7 @@ namespace AJ {
     protected:
         static const unsigned StructureFlags = ImplementsHasInstance | AJObject::StructureFlags;
 
-        InternalFunction(NonNullPassRefPtr<Structure> structure) : AJObject(structure) { }
+        InternalFunction(VPtrStealingHackType, NonNullPassRefPtr<Structure> structure) : AJObject(VPtrStealingHack, structure) { }
         InternalFunction(AJGlobalData*, NonNullPassRefPtr<Structure>, const Identifier&);
 
     private:
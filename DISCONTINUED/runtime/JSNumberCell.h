@@ -82,16 +82,6 @@ namespace AJ {
         virtual AJObject* toThisObject(ExecState*) const;
         virtual AJValue getJSNumber();
 
-        void* operator new(size_t size, ExecState* exec)
-        {
-            return exec->heap()->allocateNumber(size);
-        }
-
-        void* operator new(size_t size, AJGlobalData* globalData)
-        {
-            return globalData->heap.allocateNumber(size);
-        }
-
         static PassRefPtr<Structure> createStructure(AJValue proto) { return Structure::create(proto, TypeInfo(NumberType, OverridesGetOwnPropertySlot | NeedsThisConversion), AnonymousSlotCount); }
 
     private:
@@ -290,16 +290,8 @@ AJValue Stringifier::stringify(AJValue value)
     return jsString(m_exec, result.build());
 }
 
-void Stringifier::appendQuotedString(StringBuilder& builder, const UString& value)
+template <typename CharType> static void appendQuotedCharacters(StringBuilder& builder, const CharType* data, int length)
 {
-    int length = value.size();
-
-    // String length plus 2 for quote marks plus 8 so we can accomodate a few escaped characters.
-    builder.reserveCapacity(builder.size() + length + 2 + 8);
-
-    builder.append('"');
-
-    const UChar* data = value.data();
     for (int i = 0; i < length; ++i) {
         int start = i;
         while (i < length && (data[i] > 0x1F && data[i] != '"' && data[i] != '\\'))
@@ -344,7 +336,20 @@ void Stringifier::appendQuotedString(StringBuilder& builder, const UString& valu
                 break;
         }
     }
+}
 
+void Stringifier::appendQuotedString(StringBuilder& builder, const UString& value)
+{
+    int length = value.size();
+
+    // String length plus 2 for quote marks plus 8 so we can accomodate a few escaped characters.
+    builder.reserveCapacity(builder.size() + length + 2 + 8);
+
+    builder.append('"');
+    if (value.is8Bit())
+        appendQuotedCharacters(builder, value.rep()->characters8(), length);
+    else
+        appendQuotedCharacters(builder, value.data(), length);
     builder.append('"');
 }
 
@@ -546,7 +551,7 @@ bool Stringifier::Holder::appendNextProperty(Stringifier& stringifier, StringBui
         // Get the value.
         AJValue value;
         if (m_isAJArray && asArray(m_object)->canGetIndex(index))
-            value = asArray(m_object)->getIndex(index);
+            value = asArray(m_object)->getIndex(exec, index);
         else {
             PropertySlot slot(m_object);
             if (!m_object->getOwnPropertySlot(exec, index, slot))
@@ -721,7 +726,7 @@ NEVER_INLINE AJValue Walker::walk(AJValue unfiltered)
                     break;
                 }
                 if (isAJArray(&m_exec->globalData(), array) && array->canGetIndex(index))
-                    inValue = array->getIndex(index);
+                    inValue = array->getIndex(m_exec, index);
                 else {
                     PropertySlot slot;
                     if (array->getOwnPropertySlot(m_exec, index, slot))
@@ -744,7 +749,7 @@ NEVER_INLINE AJValue Walker::walk(AJValue unfiltered)
                     array->deleteProperty(m_exec, indexStack.last());
                 else {
                     if (isAJArray(&m_exec->globalData(), array) && array->canSetIndex(indexStack.last()))
-                        array->setIndex(indexStack.last(), filteredValue);
+                        array->setIndex(m_exec, indexStack.last(), filteredValue);
                     else
                         array->put(m_exec, indexStack.last(), filteredValue);
                 }
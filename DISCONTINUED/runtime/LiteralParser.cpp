@@ -52,7 +52,25 @@ limitations under the License.
 
 namespace AJ {
 
-LiteralParser::TokenType LiteralParser::Lexer::lex(LiteralParserToken& token)
+AJValue LiteralParser::tryLiteralParse()
+{
+    // Lex 8-bit source as it is held rather than widening it.
+    if (m_string.is8Bit())
+        return tryLiteralParse(m_string.rep()->characters8());
+    return tryLiteralParse(m_string.data());
+}
+
+template <typename CharType> AJValue LiteralParser::tryLiteralParse(const CharType* characters)
+{
+    Lexer<CharType> lexer(characters, m_string.size(), m_mode);
+    lexer.next();
+    AJValue result = parse(lexer, m_mode == StrictJSON ? StartParseExpression : StartParseStatement);
+    if (lexer.currentToken().type != TokEnd)
+        return AJValue();
+    return result;
+}
+
+template <typename CharType> LiteralParser::TokenType LiteralParser::Lexer<CharType>::lex(LiteralParserToken& token)
 {
     while (m_ptr < m_end && isASCIISpace(*m_ptr))
         ++m_ptr;
@@ -147,11 +165,34 @@ template <LiteralParser::ParserMode mode> static inline bool isSafeStringCharact
     return (c >= ' ' && (mode == LiteralParser::StrictJSON || c <= 0xff) && c != '\\' && c != '"') || c == '\t';
 }
 
+static inline PassRefPtr<UStringImpl> createStringFromSource(const LChar* characters, unsigned length)
+{
+    return UStringImpl::create(characters, length);
+}
+
+static inline PassRefPtr<UStringImpl> createStringFromSource(const UChar* characters, unsigned length)
+{
+    return UStringImpl::create8BitIfPossible(characters, length);
+}
+
 // "inline" is required here to help WINSCW compiler resolve specialized argument in templated functions.
-template <LiteralParser::ParserMode mode> inline LiteralParser::TokenType LiteralParser::Lexer::lexString(LiteralParserToken& token)
+template <typename CharType> template <LiteralParser::ParserMode mode> inline LiteralParser::TokenType LiteralParser::Lexer<CharType>::lexString(LiteralParserToken& token)
 {
     ++m_ptr;
-    const UChar* runStart;
+    const CharType* runStart = m_ptr;
+
+    // Most strings have no escapes; make those straight from the source,
+    // as 8-bit strings where they can be.
+    while (m_ptr < m_end && isSafeStringCharacter<mode>(*m_ptr))
+        ++m_ptr;
+    if (LIKELY(m_ptr < m_end && *m_ptr == '"')) {
+        token.stringToken = createStringFromSource(runStart, m_ptr - runStart);
+        token.type = TokString;
+        token.end = ++m_ptr;
+        return TokString;
+    }
+    m_ptr = runStart;
+
     StringBuilder builder;
     do {
         runStart = m_ptr;
@@ -223,7 +264,7 @@ template <LiteralParser::ParserMode mode> inline LiteralParser::TokenType Litera
     return TokString;
 }
 
-LiteralParser::TokenType LiteralParser::Lexer::lexNumber(LiteralParserToken& token)
+template <typename CharType> LiteralParser::TokenType LiteralParser::Lexer<CharType>::lexNumber(LiteralParserToken& token)
 {
     // ES5 and json.org define numbers as
     // number
@@ -297,7 +338,7 @@ LiteralParser::TokenType LiteralParser::Lexer::lexNumber(LiteralParserToken& tok
     return TokNumber;
 }
 
-AJValue LiteralParser::parse(ParserState initialState)
+template <typename CharType> AJValue LiteralParser::parse(Lexer<CharType>& lexer, ParserState initialState)
 {
     ParserState state = initialState;
     MarkedArgumentBuffer objectStack;
@@ -314,11 +355,11 @@ AJValue LiteralParser::parse(ParserState initialState)
             }
             doParseArrayStartExpression:
             case DoParseArrayStartExpression: {
-                TokenType lastToken = m_lexer.currentToken().type;
-                if (m_lexer.next() == TokRBracket) {
+                TokenType lastToken = lexer.currentToken().type;
+                if (lexer.next() == TokRBracket) {
                     if (lastToken == TokComma)
                         return AJValue();
-                    m_lexer.next();
+                    lexer.next();
                     lastValue = objectStack.last();
                     objectStack.removeLast();
                     break;
@@ -330,13 +371,13 @@ AJValue LiteralParser::parse(ParserState initialState)
             case DoParseArrayEndExpression: {
                  asArray(objectStack.last())->push(m_exec, lastValue);
                 
-                if (m_lexer.currentToken().type == TokComma)
+                if (lexer.currentToken().type == TokComma)
                     goto doParseArrayStartExpression;
 
-                if (m_lexer.currentToken().type != TokRBracket)
+                if (lexer.currentToken().type != TokRBracket)
                     return AJValue();
                 
-                m_lexer.next();
+                lexer.next();
                 lastValue = objectStack.last();
                 objectStack.removeLast();
                 break;
@@ -346,37 +387,37 @@ AJValue LiteralParser::parse(ParserState initialState)
                 AJObject* object = constructEmptyObject(m_exec);
                 objectStack.append(object);
 
-                TokenType type = m_lexer.next();
+                TokenType type = lexer.next();
                 if (type == TokString) {
-                    Lexer::LiteralParserToken identifierToken = m_lexer.currentToken();
+                    typename Lexer<CharType>::LiteralParserToken identifierToken = lexer.currentToken();
 
                     // Check for colon
-                    if (m_lexer.next() != TokColon)
+                    if (lexer.next() != TokColon)
                         return AJValue();
                     
-                    m_lexer.next();
+                    lexer.next();
                     identifierStack.append(Identifier(m_exec, identifierToken.stringToken));
                     stateStack.append(DoParseObjectEndExpression);
                     goto startParseExpression;
                 } else if (type != TokRBrace) 
                     return AJValue();
-                m_lexer.next();
+                lexer.next();
                 lastValue = objectStack.last();
                 objectStack.removeLast();
                 break;
             }
             doParseObjectStartExpression:
             case DoParseObjectStartExpression: {
-                TokenType type = m_lexer.next();
+                TokenType type = lexer.next();
                 if (type != TokString)
                     return AJValue();
-                Lexer::LiteralParserToken identifierToken = m_lexer.currentToken();
+                typename Lexer<CharType>::LiteralParserToken identifierToken = lexer.currentToken();
 
                 // Check for colon
-                if (m_lexer.next() != TokColon)
+                if (lexer.next() != TokColon)
                     return AJValue();
 
-                m_lexer.next();
+                lexer.next();
                 identifierStack.append(Identifier(m_exec, identifierToken.stringToken));
                 stateStack.append(DoParseObjectEndExpression);
                 goto startParseExpression;
@@ -385,46 +426,46 @@ AJValue LiteralParser::parse(ParserState initialState)
             {
                 asObject(objectStack.last())->putDirect(identifierStack.last(), lastValue);
                 identifierStack.removeLast();
-                if (m_lexer.currentToken().type == TokComma)
+                if (lexer.currentToken().type == TokComma)
                     goto doParseObjectStartExpression;
-                if (m_lexer.currentToken().type != TokRBrace)
+                if (lexer.currentToken().type != TokRBrace)
                     return AJValue();
-                m_lexer.next();
+                lexer.next();
                 lastValue = objectStack.last();
                 objectStack.removeLast();
                 break;
             }
             startParseExpression:
             case StartParseExpression: {
-                switch (m_lexer.currentToken().type) {
+                switch (lexer.currentToken().type) {
                     case TokLBracket:
                         goto startParseArray;
                     case TokLBrace:
                         goto startParseObject;
                     case TokString: {
-                        Lexer::LiteralParserToken stringToken = m_lexer.currentToken();
-                        m_lexer.next();
+                        typename Lexer<CharType>::LiteralParserToken stringToken = lexer.currentToken();
+                        lexer.next();
                         lastValue = jsString(m_exec, stringToken.stringToken);
                         break;
                     }
                     case TokNumber: {
-                        Lexer::LiteralParserToken numberToken = m_lexer.currentToken();
-                        m_lexer.next();
+                        typename Lexer<CharType>::LiteralParserToken numberToken = lexer.currentToken();
+                        lexer.next();
                         lastValue = jsNumber(m_exec, numberToken.numberToken);
                         break;
                     }
                     case TokNull:
-                        m_lexer.next();
+                        lexer.next();
                         lastValue = jsNull();
                         break;
 
                     case TokTrue:
-                        m_lexer.next();
+                        lexer.next();
                         lastValue = jsBoolean(true);
                         break;
 
                     case TokFalse:
-                        m_lexer.next();
+                        lexer.next();
                         lastValue = jsBoolean(false);
                         break;
 
@@ -435,14 +476,14 @@ AJValue LiteralParser::parse(ParserState initialState)
                 break;
             }
             case StartParseStatement: {
-                switch (m_lexer.currentToken().type) {
+                switch (lexer.currentToken().type) {
                     case TokLBracket:
                     case TokNumber:
                     case TokString:
                         goto startParseExpression;
 
                     case TokLParen: {
-                        m_lexer.next();
+                        lexer.next();
                         stateStack.append(StartParseStatementEndStatement);
                         goto startParseExpression;
                     }
@@ -452,9 +493,9 @@ AJValue LiteralParser::parse(ParserState initialState)
             }
             case StartParseStatementEndStatement: {
                 ASSERT(stateStack.isEmpty());
-                if (m_lexer.currentToken().type != TokRParen)
+                if (lexer.currentToken().type != TokRParen)
                     return AJValue();
-                if (m_lexer.next() == TokEnd)
+                if (lexer.next() == TokEnd)
                     return lastValue;
                 return AJValue();
             }
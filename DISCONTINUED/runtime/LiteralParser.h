@@ -54,19 +54,12 @@ namespace AJ {
         typedef enum { StrictJSON, NonStrictJSON } ParserMode;
         LiteralParser(ExecState* exec, const UString& s, ParserMode mode)
             : m_exec(exec)
-            , m_lexer(s, mode)
+            , m_string(s)
             , m_mode(mode)
         {
         }
         
-        AJValue tryLiteralParse()
-        {
-            m_lexer.next();
-            AJValue result = parse(m_mode == StrictJSON ? StartParseExpression : StartParseStatement);
-            if (m_lexer.currentToken().type != TokEnd)
-                return AJValue();
-            return result;
-        }
+        AJValue tryLiteralParse();
     private:
         enum ParserState { StartParseObject, StartParseArray, StartParseExpression, 
                            StartParseStatement, StartParseStatementEndStatement, 
@@ -77,20 +70,19 @@ namespace AJ {
                          TokLParen, TokRParen, TokComma, TokTrue, TokFalse,
                          TokNull, TokEnd, TokError };
 
-        class Lexer {
+        template <typename CharType> class Lexer {
         public:
             struct LiteralParserToken {
                 TokenType type;
-                const UChar* start;
-                const UChar* end;
+                const CharType* start;
+                const CharType* end;
                 UString stringToken;
                 double numberToken;
             };
-            Lexer(const UString& s, ParserMode mode)
-                : m_string(s)
-                , m_mode(mode)
-                , m_ptr(s.data())
-                , m_end(s.data() + s.size())
+            Lexer(const CharType* characters, unsigned length, ParserMode mode)
+                : m_mode(mode)
+                , m_ptr(characters)
+                , m_end(characters + length)
             {
             }
             
@@ -109,17 +101,17 @@ namespace AJ {
             template <ParserMode mode> TokenType lexString(LiteralParserToken&);
             TokenType lexNumber(LiteralParserToken&);
             LiteralParserToken m_currentToken;
-            UString m_string;
             ParserMode m_mode;
-            const UChar* m_ptr;
-            const UChar* m_end;
+            const CharType* m_ptr;
+            const CharType* m_end;
         };
         
         class StackGuard;
-        AJValue parse(ParserState);
+        template <typename CharType> AJValue tryLiteralParse(const CharType*);
+        template <typename CharType> AJValue parse(Lexer<CharType>&, ParserState);
 
         ExecState* m_exec;
-        LiteralParser::Lexer m_lexer;
+        UString m_string;
         ParserMode m_mode;
     };
 }
@@ -50,8 +50,8 @@ size_t MarkStack::s_pageSize = 0;
 void MarkStack::compact()
 {
     ASSERT(s_pageSize);
-    m_values.shrinkAllocation(s_pageSize);
-    m_markSets.shrinkAllocation(s_pageSize);
+    m_values.releaseSpareSegment();
+    m_markSets.releaseSpareSegment();
 }
 
 }
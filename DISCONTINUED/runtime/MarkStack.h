@@ -49,6 +49,8 @@ limitations under the License.
 namespace AJ {
 
     class AJGlobalData;
+    class HeapSnapshotWriter;
+    class ParallelMarker;
     class Register;
     
     enum MarkSetProperties { MayContainNullValues, NoNullValues };
@@ -57,6 +59,10 @@ namespace AJ {
     public:
         MarkStack(void* jsArrayVPtr)
             : m_jsArrayVPtr(jsArrayVPtr)
+            , m_heapSnapshot(0)
+#if ENABLE(PARALLEL_MARKING)
+            , m_parallelMarker(0)
+#endif
 #ifndef NDEBUG
             , m_isCheckingForDefaultMarkViolation(false)
 #endif
@@ -65,6 +71,9 @@ namespace AJ {
 
         ALWAYS_INLINE void append(AJValue);
         void append(AJCell*);
+        // Visits the children of a cell that is already marked, such as an old
+        // cell that a minor collection has to rescan.
+        void appendChildren(AJCell*);
         
         ALWAYS_INLINE void appendValues(Register* values, size_t count, MarkSetProperties properties = NoNullValues)
         {
@@ -77,7 +86,18 @@ namespace AJ {
                 m_markSets.append(MarkSet(values, values + count, properties));
         }
 
+        // Names the roots appended from here on, for heap snapshots.
+        void beginRoots(const char* name)
+        {
+            if (UNLIKELY(m_heapSnapshot != 0))
+                recordSnapshotRoots(name);
+        }
+
         inline void drain();
+        // Marks the children of about cellLimit cells, then returns true if
+        // the stack is empty. Never leaves ranges of values on the stack, since
+        // the mutator may reallocate the storage they point into.
+        inline bool drain(size_t cellLimit);
         void compact();
 
         ~MarkStack()
@@ -87,8 +107,19 @@ namespace AJ {
         }
 
     private:
+        friend class HeapSnapshotWriter;
+        friend class ParallelMarker;
+
         void markChildren(AJCell*);
 
+        // While a heap snapshot is being written every live cell is already
+        // marked, and each append of a marked cell is an edge of the snapshot.
+        void recordSnapshotEdge(AJCell*);
+        void recordSnapshotRoots(const char* name);
+
+        // Sets the cell's mark bit. Returns false if the cell was already marked.
+        ALWAYS_INLINE bool testAndSetMarked(AJCell*);
+
         struct MarkSet {
             MarkSet(AJValue* values, AJValue* end, MarkSetProperties properties)
                 : m_values(values)
@@ -113,48 +144,76 @@ namespace AJ {
             return s_pageSize;
         }
 
+        // A stack of page-sized segments. Growing never copies, and whole
+        // segments can be handed from one marker thread to another.
         template <typename T> struct MarkStackArray {
+            struct Segment {
+                Segment* m_previous;
+                size_t m_size; // Only kept up to date while the segment is detached.
+
+                T* data() { return reinterpret_cast<T*>(this + 1); }
+            };
+
             MarkStackArray()
                 : m_top(0)
-                , m_allocated(MarkStack::pageSize())
-                , m_capacity(m_allocated / sizeof(T))
+                , m_segmentCapacity((MarkStack::pageSize() - sizeof(Segment)) / sizeof(T))
+                , m_previousSegmentCount(0)
+                , m_spareSegment(0)
             {
-                m_data = reinterpret_cast<T*>(allocateStack(m_allocated));
+                m_topSegment = allocateSegment();
             }
 
             ~MarkStackArray()
             {
-                releaseStack(m_data, m_allocated);
+                while (m_topSegment) {
+                    Segment* previous = m_topSegment->m_previous;
+                    releaseSegment(m_topSegment);
+                    m_topSegment = previous;
+                }
+                releaseSpareSegment();
             }
 
             void expand()
             {
-                size_t oldAllocation = m_allocated;
-                m_allocated *= 2;
-                m_capacity = m_allocated / sizeof(T);
-                void* newData = allocateStack(m_allocated);
-                memcpy(newData, m_data, oldAllocation);
-                releaseStack(m_data, oldAllocation);
-                m_data = reinterpret_cast<T*>(newData);
+                Segment* segment = m_spareSegment ? m_spareSegment : allocateSegment();
+                m_spareSegment = 0;
+                segment->m_previous = m_topSegment;
+                m_topSegment = segment;
+                m_top = 0;
+                ++m_previousSegmentCount;
+            }
+
+            // The top segment is only ever empty when it is the last one.
+            void popSegment()
+            {
+                ASSERT(!m_top && m_topSegment->m_previous);
+                releaseSpareSegment();
+                m_spareSegment = m_topSegment;
+                m_topSegment = m_topSegment->m_previous;
+                m_top = m_segmentCapacity;
+                --m_previousSegmentCount;
             }
 
             inline void append(const T& v)
             {
-                if (m_top == m_capacity)
+                if (m_top == m_segmentCapacity)
                     expand();
-                m_data[m_top++] = v;
+                m_topSegment->data()[m_top++] = v;
             }
 
             inline T removeLast()
             {
                 ASSERT(m_top);
-                return m_data[--m_top];
+                T result = m_topSegment->data()[--m_top];
+                if (!m_top && m_topSegment->m_previous)
+                    popSegment();
+                return result;
             }
             
             inline T& last()
             {
                 ASSERT(m_top);
-                return m_data[m_top - 1];
+                return m_topSegment->data()[m_top - 1];
             }
 
             inline bool isEmpty()
@@ -162,38 +221,82 @@ namespace AJ {
                 return m_top == 0;
             }
 
-            inline size_t size() { return m_top; }
+            inline size_t size() { return m_previousSegmentCount * m_segmentCapacity + m_top; }
 
-            inline void shrinkAllocation(size_t size)
+            // Detaches work for another marker: a full segment if there is
+            // one below the top, otherwise half of the top segment.
+            Segment* donateSegment(size_t minimumToKeep)
             {
-                ASSERT(size <= m_allocated);
-                ASSERT(0 == (size % MarkStack::pageSize()));
-                if (size == m_allocated)
-                    return;
-#if OS(WINDOWS) || OS(SYMBIAN) || PLATFORM(BREWMP)
-                // We cannot release a part of a region with VirtualFree.  To get around this,
-                // we'll release the entire region and reallocate the size that we want.
-                releaseStack(m_data, m_allocated);
-                m_data = reinterpret_cast<T*>(allocateStack(size));
-#else
-                releaseStack(reinterpret_cast<char*>(m_data) + size, m_allocated - size);
-#endif
-                m_allocated = size;
-                m_capacity = m_allocated / sizeof(T);
+                if (Segment* segment = m_topSegment->m_previous) {
+                    m_topSegment->m_previous = segment->m_previous;
+                    --m_previousSegmentCount;
+                    segment->m_size = m_segmentCapacity;
+                    return segment;
+                }
+                if (m_top < 2 * minimumToKeep)
+                    return 0;
+                size_t count = m_top / 2;
+                Segment* segment = allocateSegment();
+                m_top -= count;
+                memcpy(segment->data(), m_topSegment->data() + m_top, count * sizeof(T));
+                segment->m_size = count;
+                return segment;
+            }
+
+            // Takes ownership of a donated segment. The stack must be empty.
+            void adoptSegment(Segment* segment)
+            {
+                ASSERT(isEmpty() && !m_topSegment->m_previous);
+                ASSERT(segment->m_size);
+                releaseSpareSegment();
+                m_spareSegment = m_topSegment;
+                m_topSegment = segment;
+                m_topSegment->m_previous = 0;
+                m_top = segment->m_size;
+            }
+
+            void releaseSpareSegment()
+            {
+                if (m_spareSegment)
+                    releaseSegment(m_spareSegment);
+                m_spareSegment = 0;
+            }
+
+            static Segment* allocateSegment()
+            {
+                Segment* segment = reinterpret_cast<Segment*>(allocateStack(MarkStack::pageSize()));
+                segment->m_previous = 0;
+                segment->m_size = 0;
+                return segment;
+            }
+
+            static void releaseSegment(Segment* segment)
+            {
+                releaseStack(segment, MarkStack::pageSize());
             }
 
         private:
             size_t m_top;
-            size_t m_allocated;
-            size_t m_capacity;
-            T* m_data;
+            size_t m_segmentCapacity;
+            size_t m_previousSegmentCount;
+            Segment* m_topSegment;
+            Segment* m_spareSegment;
         };
 
+        typedef MarkStackArray<AJCell*>::Segment CellSegment;
+
         void* m_jsArrayVPtr;
         MarkStackArray<MarkSet> m_markSets;
         MarkStackArray<AJCell*> m_values;
         static size_t s_pageSize;
 
+        HeapSnapshotWriter* m_heapSnapshot;
+
+#if ENABLE(PARALLEL_MARKING)
+        // Non-null while this stack shares a collection with helper threads.
+        ParallelMarker* m_parallelMarker;
+#endif
+
 #ifndef NDEBUG
     public:
         bool m_isCheckingForDefaultMarkViolation;
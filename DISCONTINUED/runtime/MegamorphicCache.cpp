@@ -0,0 +1,66 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "config.h"
+#include "MegamorphicCache.h"
+
+#include "AJObject.h"
+#include <string.h>
+
+namespace AJ {
+
+COMPILE_ASSERT(sizeof(MegamorphicCache::Entry) == 1 << MegamorphicCache::entrySizeShift, MegamorphicCache_entry_size_is_a_power_of_2);
+
+void MegamorphicCache::clear()
+{
+    memset(m_entries, 0, sizeof(m_entries));
+}
+
+void MegamorphicCache::add(AJValue base, const Identifier& propertyName, const PropertySlot& slot)
+{
+    // Getters and custom properties are left to the generic path.
+    if (!base.isCell() || !slot.isCacheableValue())
+        return;
+
+    // A dictionary's Structure changes in place, so the same Structure does
+    // not mean the same offsets, and the prototype's Structure is only known
+    // to be the same one when the object's is not a dictionary.
+    AJCell* cell = base.asCell();
+    Structure* structure = cell->structure();
+    if (!cell->isObject() || structure->isDictionary())
+        return;
+
+    Structure* prototypeStructure = 0;
+    if (slot.slotBase() != base) {
+        // An object that finds some of its own properties itself may not
+        // miss the property the next time.
+        if (slot.slotBase() != structure->storedPrototype() || structure->typeInfo().overridesGetOwnPropertySlot())
+            return;
+        prototypeStructure = asObject(slot.slotBase())->structure();
+        if (prototypeStructure->isDictionary())
+            return;
+    }
+
+    UString::Rep* name = propertyName.ustring().rep();
+    Entry& entry = m_entries[index(structure, name)];
+    entry.structure = structure;
+    entry.name = name;
+    entry.prototypeStructure = prototypeStructure;
+    entry.offset = slot.cachedOffset();
+}
+
+} // namespace AJ
@@ -0,0 +1,76 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef MegamorphicCache_h
+#define MegamorphicCache_h
+
+#include "UString.h"
+#include <stdint.h>
+#include <wtf/Noncopyable.h>
+
+namespace AJ {
+
+    class AJCell;
+    class AJValue;
+    class Identifier;
+    class PropertySlot;
+    class Structure;
+
+    // Caches where get_by_id found properties, for the sites that have seen
+    // too many Structures to cache in their instructions or stubs. It is
+    // shared by every site, and keyed by (Structure, property name): the value
+    // is the offset of the property in the object, or in the object's
+    // prototype together with the prototype's Structure.
+    //
+    // Entries hold no references. The cache is cleared after every marking,
+    // before any cell or Structure it mentions can be freed.
+    class MegamorphicCache : public Noncopyable {
+    public:
+        static const unsigned size = 1024;
+        static const unsigned structureShift = 5; // Structures are at least 32 bytes apart.
+
+        struct Entry {
+            Structure* structure;
+            UString::Rep* name;
+            Structure* prototypeStructure; // 0 if the property is the object's own
+            uintptr_t offset;
+        };
+        static const unsigned entrySizeShift = sizeof(void*) == 8 ? 5 : 4;
+
+        MegamorphicCache() { clear(); }
+
+        void clear();
+
+        // Leaves result alone and returns false on a miss.
+        bool get(AJCell* base, const Identifier& propertyName, AJValue& result);
+        // Records where a get of the property from base found it, if that
+        // will be where it is for every cell with base's Structure.
+        void add(AJValue base, const Identifier& propertyName, const PropertySlot&);
+
+        static unsigned index(Structure* structure, UString::Rep* name)
+        {
+            return ((static_cast<unsigned>(reinterpret_cast<uintptr_t>(structure)) >> structureShift) ^ name->existingHash()) & (size - 1);
+        }
+        Entry* entries() { return m_entries; }
+
+    private:
+        Entry m_entries[size];
+    };
+
+} // namespace AJ
+
+#endif // MegamorphicCache_h
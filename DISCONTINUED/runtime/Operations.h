@@ -271,7 +271,7 @@ namespace AJ {
             bool s1 = v1.isString();
             bool s2 = v2.isString();
             if (s1 && s2)
-                return asString(v1)->value(exec) == asString(v2)->value(exec);
+                return asString(v1)->equal(asString(v2));
 
             if (v1.isUndefinedOrNull()) {
                 if (v2.isUndefinedOrNull())
@@ -333,7 +333,7 @@ namespace AJ {
         ASSERT(v1.isCell() && v2.isCell());
 
         if (v1.asCell()->isString() && v2.asCell()->isString())
-            return asString(v1)->value(exec) == asString(v2)->value(exec);
+            return asString(v1)->equal(asString(v2));
 
         return v1 == v2;
     }
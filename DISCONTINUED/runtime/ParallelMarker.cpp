@@ -0,0 +1,167 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "config.h"
+#include "ParallelMarker.h"
+
+#if ENABLE(PARALLEL_MARKING)
+
+#include "AJArray.h"
+
+namespace AJ {
+
+// A donating marker always keeps at least this many cells for itself.
+static const size_t minimumCellsToKeep = 32;
+
+ParallelMarker::ParallelMarker(unsigned helperCount, void* jsArrayVPtr)
+    : m_jsArrayVPtr(jsArrayVPtr)
+    , m_sharedSegments(0)
+    , m_activeMarkers(0)
+    , m_idleMarkers(0)
+    , m_finishedHelpers(0)
+    , m_cycle(0)
+    , m_markingDone(true)
+    , m_shouldExit(false)
+{
+    for (unsigned i = 0; i < helperCount; ++i) {
+        ThreadIdentifier thread = createThread(helperThreadMain, this, "AJCore::ParallelMarker");
+        if (thread)
+            m_helpers.append(thread);
+    }
+}
+
+ParallelMarker::~ParallelMarker()
+{
+    {
+        MutexLocker locker(m_lock);
+        m_shouldExit = true;
+        m_helperCondition.broadcast();
+    }
+
+    for (size_t i = 0; i < m_helpers.size(); ++i)
+        waitForThreadCompletion(m_helpers[i], 0);
+
+    ASSERT(!m_sharedSegments);
+}
+
+void ParallelMarker::begin(MarkStack& markStack)
+{
+    ASSERT(!markStack.m_parallelMarker);
+    markStack.m_parallelMarker = this;
+
+    MutexLocker locker(m_lock);
+    ASSERT(m_markingDone && !m_sharedSegments);
+    m_activeMarkers = 1; // The collecting thread, which is marking roots.
+    m_finishedHelpers = 0;
+    m_markingDone = false;
+    ++m_cycle;
+    m_helperCondition.broadcast();
+}
+
+void ParallelMarker::end(MarkStack& markStack)
+{
+    ASSERT(markStack.m_parallelMarker == this);
+    drainFromShared(markStack, true);
+
+    // Helpers must not touch the heap once the collector moves on.
+    MutexLocker locker(m_lock);
+    while (m_finishedHelpers < m_helpers.size())
+        m_helperCondition.wait(m_lock);
+
+    markStack.m_parallelMarker = 0;
+}
+
+void ParallelMarker::donateWork(MarkStack& markStack)
+{
+    MarkStack::CellSegment* segment = markStack.m_values.donateSegment(minimumCellsToKeep);
+    if (!segment)
+        return;
+
+    MutexLocker locker(m_lock);
+    segment->m_previous = m_sharedSegments;
+    m_sharedSegments = segment;
+    m_markingCondition.signal();
+}
+
+void ParallelMarker::drainFromShared(MarkStack& markStack, bool isActive)
+{
+    for (;;) {
+        if (isActive)
+            markStack.drain();
+
+        MutexLocker locker(m_lock);
+        if (isActive) {
+            isActive = false;
+            if (!--m_activeMarkers && !m_sharedSegments) {
+                // Nobody holds any work and nobody can create more.
+                m_markingDone = true;
+                m_markingCondition.broadcast();
+                return;
+            }
+        }
+
+        ++m_idleMarkers;
+        while (!m_sharedSegments && !m_markingDone)
+            m_markingCondition.wait(m_lock);
+        --m_idleMarkers;
+
+        if (m_markingDone)
+            return;
+
+        MarkStack::CellSegment* segment = m_sharedSegments;
+        m_sharedSegments = segment->m_previous;
+        markStack.m_values.adoptSegment(segment);
+        ++m_activeMarkers;
+        isActive = true;
+    }
+}
+
+void* ParallelMarker::helperThreadMain(void* parallelMarker)
+{
+    static_cast<ParallelMarker*>(parallelMarker)->helperLoop();
+    return 0;
+}
+
+void ParallelMarker::helperLoop()
+{
+    MarkStack markStack(m_jsArrayVPtr);
+    markStack.m_parallelMarker = this;
+
+    unsigned lastCycle = 0;
+    MutexLocker locker(m_lock);
+    for (;;) {
+        while (m_cycle == lastCycle && !m_shouldExit)
+            m_helperCondition.wait(m_lock);
+        if (m_shouldExit)
+            break;
+        lastCycle = m_cycle;
+
+        m_lock.unlock();
+        drainFromShared(markStack, false);
+        markStack.compact();
+        m_lock.lock();
+
+        ++m_finishedHelpers;
+        m_helperCondition.broadcast();
+    }
+
+    markStack.m_parallelMarker = 0;
+}
+
+} // namespace AJ
+
+#endif // ENABLE(PARALLEL_MARKING)
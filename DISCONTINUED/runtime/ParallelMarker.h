@@ -0,0 +1,75 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef ParallelMarker_h
+#define ParallelMarker_h
+
+#include "MarkStack.h"
+
+#if ENABLE(PARALLEL_MARKING)
+
+#include <wtf/Noncopyable.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+
+namespace AJ {
+
+    // Shares the mark phase between the collecting thread and a set of helper
+    // threads. Every marker drains its own MarkStack; when a marker is idle the
+    // busy ones donate segments of their stacks to a shared pool, from which the
+    // idle ones steal. Marking ends when no marker is busy and the pool is empty.
+    class ParallelMarker : public Noncopyable {
+    public:
+        ParallelMarker(unsigned helperCount, void* jsArrayVPtr);
+        ~ParallelMarker();
+
+        unsigned helperCount() const { return m_helpers.size(); }
+
+        // Called on the collecting thread around root marking. Until end()
+        // returns, drain() on the main stack donates work to the helpers.
+        void begin(MarkStack&);
+        void end(MarkStack&);
+
+        bool hasIdleMarkers() const { return m_idleMarkers && !m_sharedSegments; }
+        void donateWork(MarkStack&);
+
+    private:
+        static void* helperThreadMain(void*);
+        void helperLoop();
+        void drainFromShared(MarkStack&, bool isActive);
+
+        void* m_jsArrayVPtr;
+        Vector<ThreadIdentifier> m_helpers;
+
+        Mutex m_lock;
+        ThreadCondition m_markingCondition; // Signalled when work is donated or marking ends.
+        ThreadCondition m_helperCondition; // Signalled when a cycle starts or a helper finishes one.
+
+        MarkStack::CellSegment* m_sharedSegments;
+        unsigned m_activeMarkers;
+        volatile unsigned m_idleMarkers;
+        unsigned m_finishedHelpers;
+        unsigned m_cycle;
+        bool m_markingDone;
+        bool m_shouldExit;
+    };
+
+} // namespace AJ
+
+#endif // ENABLE(PARALLEL_MARKING)
+
+#endif // ParallelMarker_h
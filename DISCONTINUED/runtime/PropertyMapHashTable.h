@@ -39,8 +39,18 @@ limitations under the License.
 #define PropertyMapHashTable_h
 
 #include "UString.h"
+#include <stdint.h>
+#include <string.h>
+#include <wtf/FastMalloc.h>
 #include <wtf/Vector.h>
 
+#if CPU(X86_64) || (CPU(X86) && defined(__SSE2__))
+#define PROPERTY_MAP_SSE2_PROBING 1
+#include <emmintrin.h>
+#else
+#define PROPERTY_MAP_SSE2_PROBING 0
+#endif
+
 namespace AJ {
 
     struct PropertyMapEntry {
@@ -48,60 +58,163 @@ namespace AJ {
         unsigned offset;
         unsigned attributes;
         AJCell* specificValue;
-        unsigned index;
 
         PropertyMapEntry(UString::Rep* key, unsigned attributes, AJCell* specificValue)
             : key(key)
             , offset(0)
             , attributes(attributes)
             , specificValue(specificValue)
-            , index(0)
         {
         }
 
-        PropertyMapEntry(UString::Rep* key, unsigned offset, unsigned attributes, AJCell* specificValue, unsigned index)
+        PropertyMapEntry(UString::Rep* key, unsigned offset, unsigned attributes, AJCell* specificValue)
             : key(key)
             , offset(offset)
             , attributes(attributes)
             , specificValue(specificValue)
-            , index(index)
         {
         }
     };
 
-    // lastIndexUsed is an ever-increasing index used to identify the order items
-    // were inserted into the property map. It's required that getEnumerablePropertyNames
-    // return the properties in the order they were added for compatibility with other
-    // browsers' AJ implementations.
+    // An open addressing table of indices into an array of entries. Slots are
+    // probed a group at a time. Each slot has a control byte: empty, deleted,
+    // or the low 7 bits of the key's hash. A lookup compares the control bytes
+    // of a whole group with the hash bits (with one SSE2 compare where there
+    // is SSE2), and only reads the entries of the slots that match, so most
+    // collisions and misses never touch an entry.
+    //
+    // Entries are appended in the order their properties were added, which is
+    // the order getEnumerablePropertyNames must return them in for
+    // compatibility with other browsers' AJ implementations. Removing a
+    // property leaves a hole in the entries and a deleted slot; rehashing
+    // squeezes both out. The 0th entry is not used.
     struct PropertyMapHashTable {
+        static const unsigned groupSize = 16;
+        static const uint8_t emptyControl = 0x80;
+        static const uint8_t deletedControl = 0xFE;
+        static const unsigned notFound = ~0u;
+
         unsigned sizeMask;
-        unsigned size;
+        unsigned size; // slots, a power of 2 no smaller than groupSize
         unsigned keyCount;
-        unsigned deletedSentinelCount;
-        unsigned lastIndexUsed;
+        unsigned deletedSentinelCount; // deleted slots, and holes in the entries
         Vector<unsigned>* deletedOffsets;
-        unsigned entryIndices[1];
 
-        PropertyMapEntry* entries()
-        {
-            // The entries vector comes after the indices vector.
-            // The 0th item in the entries vector is not really used; it has to
-            // have a 0 in its key to allow the hash table lookup to handle deleted
-            // sentinels without any special-case code, but the other fields are unused.
-            return reinterpret_cast<PropertyMapEntry*>(&entryIndices[size]);
-        }
+        uint8_t* control() { return reinterpret_cast<uint8_t*>(this + 1); }
+        unsigned* entryIndices() { return reinterpret_cast<unsigned*>(control() + size); }
+        PropertyMapEntry* entries() { return reinterpret_cast<PropertyMapEntry*>(entryIndices() + size); }
+        // Entries 1 to entryCount() are in use or holes.
+        unsigned entryCount() const { return keyCount + deletedSentinelCount; }
 
         static size_t allocationSize(unsigned size)
         {
-            // We never let a hash table get more than half full,
-            // So the number of indices we need is the size of the hash table.
-            // But the number of entries is half that (plus one for the deleted sentinel).
+            // We never let a hash table get more than half full, so there are
+            // half as many entries as slots, plus the unused 0th one.
             return sizeof(PropertyMapHashTable)
-                + (size - 1) * sizeof(unsigned)
+                + size * (sizeof(uint8_t) + sizeof(unsigned))
                 + (1 + size / 2) * sizeof(PropertyMapEntry);
         }
+
+        static PropertyMapHashTable* create(unsigned size)
+        {
+            ASSERT(size >= groupSize && !(size & (size - 1)));
+            PropertyMapHashTable* table = static_cast<PropertyMapHashTable*>(fastZeroedMalloc(allocationSize(size)));
+            table->size = size;
+            table->sizeMask = size - 1;
+            memset(table->control(), emptyControl, size);
+            return table;
+        }
+
+        // Returns the slot holding the key, or notFound.
+        unsigned findSlot(const UString::Rep*);
+        // The entry for the key, or 0.
+        PropertyMapEntry* find(const UString::Rep* rep)
+        {
+            unsigned slot = findSlot(rep);
+            return slot == notFound ? 0 : &entries()[entryIndices()[slot]];
+        }
+        // Points an empty slot at the entry. The key must not be in the table.
+        void insert(unsigned hash, unsigned entryIndex);
+        void removeSlot(unsigned slot)
+        {
+            control()[slot] = deletedControl;
+            entryIndices()[slot] = 0;
+        }
+
+    private:
+        static uint8_t hashTag(unsigned hash) { return hash & 0x7F; }
+        unsigned firstGroup(unsigned hash) const { return (hash >> 7) & (sizeMask / groupSize); }
+        // Triangular steps visit every group, since the number of groups is a power of 2.
+        unsigned nextGroup(unsigned group, unsigned step) const { return (group + step) & (sizeMask / groupSize); }
+        // A bit for each slot in the group whose control byte is the given one.
+        static unsigned matchGroup(const uint8_t* group, uint8_t control);
+        static unsigned firstMatch(unsigned matches);
     };
 
+    inline unsigned PropertyMapHashTable::matchGroup(const uint8_t* group, uint8_t control)
+    {
+#if PROPERTY_MAP_SSE2_PROBING
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(control))));
+#else
+        unsigned matches = 0;
+        for (unsigned i = 0; i < groupSize; ++i)
+            matches |= static_cast<unsigned>(group[i] == control) << i;
+        return matches;
+#endif
+    }
+
+    inline unsigned PropertyMapHashTable::firstMatch(unsigned matches)
+    {
+        ASSERT(matches);
+#if COMPILER(GCC)
+        return __builtin_ctz(matches);
+#else
+        unsigned i = 0;
+        while (!(matches & 1)) {
+            matches >>= 1;
+            ++i;
+        }
+        return i;
+#endif
+    }
+
+    inline unsigned PropertyMapHashTable::findSlot(const UString::Rep* rep)
+    {
+        unsigned hash = rep->existingHash();
+        uint8_t tag = hashTag(hash);
+        unsigned group = firstGroup(hash);
+        for (unsigned step = 1; ; ++step) {
+            const uint8_t* groupControl = control() + group * groupSize;
+            for (unsigned matches = matchGroup(groupControl, tag); matches; matches &= matches - 1) {
+                unsigned slot = group * groupSize + firstMatch(matches);
+                if (entries()[entryIndices()[slot]].key == rep)
+                    return slot;
+            }
+            // The table is never full, so every probe ends at an empty slot.
+            if (matchGroup(groupControl, emptyControl))
+                return notFound;
+            group = nextGroup(group, step);
+        }
+    }
+
+    inline void PropertyMapHashTable::insert(unsigned hash, unsigned entryIndex)
+    {
+        // Deleted slots are not reused, so that they stay as many as the
+        // holes in the entries, which the entries cannot reuse without
+        // losing their order.
+        unsigned group = firstGroup(hash);
+        for (unsigned step = 1; ; ++step) {
+            if (unsigned empties = matchGroup(control() + group * groupSize, emptyControl)) {
+                unsigned slot = group * groupSize + firstMatch(empties);
+                control()[slot] = hashTag(hash);
+                entryIndices()[slot] = entryIndex;
+                return;
+            }
+            group = nextGroup(group, step);
+        }
+    }
+
 } // namespace AJ
 
 #endif // PropertyMapHashTable_h
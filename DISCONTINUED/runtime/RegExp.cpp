@@ -109,6 +109,24 @@ PassRefPtr<RegExp> RegExp::create(AJGlobalData* globalData, const UString& patte
     return adoptRef(new RegExp(globalData, pattern, flags));
 }
 
+// The matchers read 16-bit characters. An 8-bit subject is widened into a
+// buffer the RegExp owns, rather than into a copy the string would keep for
+// as long as it lives. A global match or replace calls match() again and
+// again on one subject, so the buffer is kept until the next subject.
+const UChar* RegExp::subjectCharacters(const UString& s)
+{
+    if (!s.is8Bit() || !s.size())
+        return s.data();
+
+    if (s.rep() != m_widenedSubject.rep()) {
+        m_widenedCharacters.clear();
+        m_widenedCharacters.resize(s.size());
+        UStringImpl::copyChars(m_widenedCharacters.data(), s.rep()->characters8(), s.size());
+        m_widenedSubject = s;
+    }
+    return m_widenedCharacters.data();
+}
+
 #if ENABLE(YARR)
 
 void RegExp::compile(AJGlobalData* globalData)
@@ -169,9 +187,9 @@ int RegExp::match(const UString& s, int startOffset, Vector<int, 32>* ovector)
 
 
 #if ENABLE(YARR_JIT)
-        int result = Yarr::executeRegex(m_regExpJITCode, s.data(), startOffset, s.size(), offsetVector, offsetVectorSize);
+        int result = Yarr::executeRegex(m_regExpJITCode, subjectCharacters(s), startOffset, s.size(), offsetVector, offsetVectorSize);
 #else
-        int result = Yarr::interpretRegex(m_regExpBytecode.get(), s.data(), startOffset, s.size(), offsetVector);
+        int result = Yarr::interpretRegex(m_regExpBytecode.get(), subjectCharacters(s), startOffset, s.size(), offsetVector);
 #endif
 
         if (result < 0) {
@@ -237,7 +255,7 @@ int RegExp::match(const UString& s, int startOffset, Vector<int, 32>* ovector)
             offsetVector = ovector->data();
         }
 
-        int numMatches = jsRegExpExecute(m_regExp, reinterpret_cast<const UChar*>(s.data()), s.size(), startOffset, offsetVector, offsetVectorSize);
+        int numMatches = jsRegExpExecute(m_regExp, reinterpret_cast<const UChar*>(subjectCharacters(s)), s.size(), startOffset, offsetVector, offsetVectorSize);
     
         if (numMatches < 0) {
 #ifndef NDEBUG
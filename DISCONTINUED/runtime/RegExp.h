@@ -77,6 +77,7 @@ namespace AJ {
         RegExp(AJGlobalData* globalData, const UString& pattern, const UString& flags);
 
         void compile(AJGlobalData*);
+        const UChar* subjectCharacters(const UString&);
 
         enum FlagBits { Global = 1, IgnoreCase = 2, Multiline = 4 };
 
@@ -87,6 +88,8 @@ namespace AJ {
         UString m_lastMatchString;
         int m_lastMatchStart;
         Vector<int, 32> m_lastOVector;
+        UString m_widenedSubject;
+        Vector<UChar> m_widenedCharacters;
 
 #if ENABLE(YARR_JIT)
         Yarr::RegexCodeBlock m_regExpJITCode;
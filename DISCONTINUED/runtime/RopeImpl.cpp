@@ -45,6 +45,199 @@ limitations under the License.
 
 namespace AJ {
 
+// The fewest strings a balanced rope of each depth holds: Fibonacci numbers from F(2).
+static const unsigned minimumBalancedStringCount[] = {
+    1, 2, 3, 5, 8, 13, 21, 34, 55, 89, 144, 233, 377, 610, 987, 1597, 2584, 4181, 6765, 10946, 17711, 28657, 46368,
+    75025, 121393, 196418, 317811, 514229, 832040, 1346269, 2178309, 3524578, 5702887, 9227465, 14930352, 24157817,
+    39088169, 63245986, 102334155, 165580141, 267914296, 433494437, 701408733, 1134903170, 1836311903, 2971215073U
+};
+static const unsigned maxBalancedDepth = sizeof(minimumBalancedStringCount) / sizeof(minimumBalancedStringCount[0]) - 1;
+
+static inline unsigned stringCount(RopeImpl::Fiber fiber)
+{
+    return RopeImpl::isRope(fiber) ? static_cast<RopeImpl*>(fiber)->stringCount() : 1;
+}
+
+static inline void appendCharacters(LChar*& position, UStringImpl* string)
+{
+    UStringImpl::copyChars(position, string->characters8(), string->length());
+    position += string->length();
+}
+
+static inline void appendCharacters(UChar*& position, UStringImpl* string)
+{
+    if (string->is8Bit())
+        UStringImpl::copyChars(position, string->characters8(), string->length());
+    else
+        UStringImpl::copyChars(position, string->characters16(), string->length());
+    position += string->length();
+}
+
+template<typename CharType>
+static PassRefPtr<UStringImpl> mergeStrings(const Vector<UStringImpl*, 32>& strings, unsigned length)
+{
+    CharType* position;
+    RefPtr<UStringImpl> result = UStringImpl::tryCreateUninitialized(length, position);
+    if (!result)
+        return 0;
+    for (unsigned i = 0; i < strings.size(); ++i)
+        appendCharacters(position, strings[i]);
+    return result.release();
+}
+
+namespace {
+
+    // Builds a balanced rope from fibers added in order, as described in
+    // Boehm, Atkinson and Plass, "Ropes: an Alternative to Strings". Slot i
+    // of the forest holds a balanced rope of at least minimumBalancedStringCount[i]
+    // strings, and concatenated from the highest slot down they make up all
+    // the fibers added so far. Runs of short strings are merged before they
+    // are added. Everything it creates is kept alive until it is destroyed.
+    class RopeRebalancer {
+    public:
+        RopeRebalancer()
+            : m_shortLength(0)
+            , m_shortIs8Bit(true)
+        {
+            for (unsigned i = 0; i <= maxBalancedDepth; ++i)
+                m_forest[i] = 0;
+        }
+
+        bool append(RopeImpl::Fiber fiber)
+        {
+            if (RopeImpl::isRope(fiber) || fiber->length() >= RopeImpl::s_minBalancedFiberLength)
+                return flushShortStrings() && addToForest(fiber);
+            m_shortStrings.append(static_cast<UStringImpl*>(fiber));
+            m_shortLength += fiber->length();
+            m_shortIs8Bit = m_shortIs8Bit && fiber->is8Bit();
+            return m_shortLength < RopeImpl::s_minBalancedFiberLength || flushShortStrings();
+        }
+
+        PassRefPtr<RopeImpl> finish()
+        {
+            if (!flushShortStrings())
+                return 0;
+            RopeImpl::Fiber result = 0;
+            for (unsigned i = 0; i <= maxBalancedDepth; ++i) {
+                if (m_forest[i] && !(result = concatenate(m_forest[i], result)))
+                    return 0;
+            }
+            if (RopeImpl::isRope(result))
+                return static_cast<RopeImpl*>(result);
+
+            // A rope of one string still has to be a rope.
+            RefPtr<RopeImpl> rope = RopeImpl::tryCreateUninitialized(1);
+            if (rope) {
+                unsigned index = 0;
+                rope->initializeFiber(index, result);
+            }
+            return rope.release();
+        }
+
+    private:
+        bool flushShortStrings()
+        {
+            UStringImpl* string = 0;
+            if (m_shortStrings.size() == 1)
+                string = m_shortStrings[0];
+            else if (m_shortStrings.size()) {
+                RefPtr<UStringImpl> merged = m_shortIs8Bit ? mergeStrings<LChar>(m_shortStrings, m_shortLength) : mergeStrings<UChar>(m_shortStrings, m_shortLength);
+                if (!merged)
+                    return false;
+                string = merged.get();
+                m_mergedStrings.append(merged.release());
+            }
+            m_shortStrings.shrink(0);
+            m_shortLength = 0;
+            m_shortIs8Bit = true;
+            return !string || addToForest(string);
+        }
+
+        bool addToForest(RopeImpl::Fiber fiber)
+        {
+            unsigned count = stringCount(fiber);
+
+            // Gather up everything in the slots too small to take the new fiber.
+            RopeImpl::Fiber tooSmall = 0;
+            unsigned i = 0;
+            for (; i < maxBalancedDepth && count >= minimumBalancedStringCount[i + 1]; ++i) {
+                if (m_forest[i]) {
+                    if (!(tooSmall = concatenate(m_forest[i], tooSmall)))
+                        return false;
+                    m_forest[i] = 0;
+                }
+            }
+            RopeImpl::Fiber insertee = tooSmall ? concatenate(tooSmall, fiber) : fiber;
+            if (!insertee)
+                return false;
+
+            // Then carry it up until it finds an empty slot it is small enough for.
+            for (;; ++i) {
+                if (m_forest[i]) {
+                    if (!(insertee = concatenate(m_forest[i], insertee)))
+                        return false;
+                    m_forest[i] = 0;
+                }
+                if (i == maxBalancedDepth || stringCount(insertee) < minimumBalancedStringCount[i + 1]) {
+                    m_forest[i] = insertee;
+                    return true;
+                }
+            }
+        }
+
+        RopeImpl::Fiber concatenate(RopeImpl::Fiber left, RopeImpl::Fiber right)
+        {
+            if (!right)
+                return left;
+            RefPtr<RopeImpl> rope = RopeImpl::tryCreateUninitialized(2);
+            if (!rope)
+                return 0;
+            unsigned index = 0;
+            rope->initializeFiber(index, left);
+            rope->initializeFiber(index, right);
+            m_ropes.append(rope);
+            return rope.get();
+        }
+
+        RopeImpl::Fiber m_forest[maxBalancedDepth + 1];
+        Vector<RefPtr<RopeImpl>, 32> m_ropes;
+        Vector<RefPtr<UStringImpl>, 32> m_mergedStrings;
+        Vector<UStringImpl*, 32> m_shortStrings;
+        unsigned m_shortLength;
+        bool m_shortIs8Bit;
+    };
+
+} // namespace
+
+bool RopeImpl::isBalanced()
+{
+    return m_depth <= maxBalancedDepth && m_stringCount >= minimumBalancedStringCount[m_depth];
+}
+
+PassRefPtr<RopeImpl> RopeImpl::rebalance()
+{
+    // Add the fibers in order, descending only into ropes that are not
+    // balanced already.
+    RopeRebalancer rebalancer;
+    Vector<Fiber, 32> workQueue;
+    for (unsigned i = m_size; i; --i)
+        workQueue.append(m_fibers[i - 1]);
+    while (!workQueue.isEmpty()) {
+        Fiber fiber = workQueue.last();
+        workQueue.removeLast();
+        if (isRope(fiber) && !static_cast<RopeImpl*>(fiber)->isBalanced()) {
+            RopeImpl* rope = static_cast<RopeImpl*>(fiber);
+            for (unsigned i = rope->fiberCount(); i; --i)
+                workQueue.append(rope->fibers()[i - 1]);
+        } else if (!rebalancer.append(fiber))
+            return 0;
+    }
+
+    RefPtr<RopeImpl> result = rebalancer.finish();
+    ASSERT(!result || result->length() == length());
+    return result.release();
+}
+
 void RopeImpl::derefFibersNonRecursive(Vector<RopeImpl*, 32>& workQueue)
 {
     unsigned fiberCount = this->fiberCount();
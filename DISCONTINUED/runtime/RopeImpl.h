@@ -81,11 +81,41 @@ public:
         m_fibers[index++] = fiber;
         fiber->ref();
         m_length += fiber->length();
+        if (!fiber->is8Bit())
+            m_refCountAndFlags &= ~s_refCountFlagIs8Bit;
+        if (isRope(fiber)) {
+            RopeImpl* rope = static_cast<RopeImpl*>(fiber);
+            m_stringCount += rope->m_stringCount;
+            if (rope->m_depth >= m_depth)
+                m_depth = rope->m_depth + 1;
+        } else
+            ++m_stringCount;
     }
 
     unsigned fiberCount() { return m_size; }
     Fiber* fibers() { return m_fibers; }
 
+    // The number of RopeImpls on the longest path from this one down to a
+    // UStringImpl, counting this one.
+    unsigned depth() { return m_depth; }
+    // The number of UStringImpls under this rope.
+    unsigned stringCount() { return m_stringCount; }
+
+    // Appending to a string one piece at a time nests a new RopeImpl around
+    // the old one every few pieces, so the depth grows with the number of
+    // appends, and so does the cost of finding a character. Ropes deeper
+    // than this are rebuilt by rebalance() before characters are looked up
+    // in them.
+    static const unsigned s_maxDepth = 32;
+    // Strings shorter than this are merged with their neighbours when rebalancing.
+    static const unsigned s_minBalancedFiberLength = 1024;
+
+    // Returns a rope with the same characters whose depth is logarithmic in
+    // its number of strings, or 0 if out of memory. Runs of short strings are
+    // merged on the way, and balanced ropes within this one are reused whole,
+    // so the work is mostly in what has been added since the last rebalance.
+    PassRefPtr<RopeImpl> rebalance();
+
     ALWAYS_INLINE void deref()
     {
         m_refCountAndFlags -= s_refCountIncrement;
@@ -97,7 +127,11 @@ private:
     RopeImpl(unsigned fiberCount)
         : StringImplBase(ConstructNonStringImpl)
         , m_size(fiberCount)
+        , m_depth(1)
+        , m_stringCount(0)
     {
+        // Stays set only while every fiber is 8-bit.
+        m_refCountAndFlags |= s_refCountFlagIs8Bit;
     }
 
     void destructNonRecursive();
@@ -105,7 +139,11 @@ private:
 
     bool hasOneRef() { return (m_refCountAndFlags & s_refCountMask) == s_refCountIncrement; }
 
+    bool isBalanced();
+
     unsigned m_size;
+    unsigned m_depth;
+    unsigned m_stringCount;
     Fiber m_fibers[1];
 };
 
@@ -66,6 +66,11 @@ public:
             buffer.append(static_cast<unsigned char>(str[i]));
     }
 
+    void append(const LChar* str, size_t len)
+    {
+        buffer.append(str, len);
+    }
+
     void append(const UChar* str, size_t len)
     {
         buffer.append(str, len);
@@ -73,7 +78,10 @@ public:
 
     void append(const UString& str)
     {
-        buffer.append(str.data(), str.size());
+        if (str.is8Bit())
+            buffer.append(str.rep()->characters8(), str.size());
+        else
+            buffer.append(str.data(), str.size());
     }
 
     bool isEmpty() { return buffer.isEmpty(); }
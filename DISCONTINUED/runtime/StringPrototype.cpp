@@ -263,6 +263,39 @@ public:
     int length;
 };
 
+static inline void copyStringCharacters(LChar* destination, const UString& string, int offset, int length)
+{
+    if (length)
+        UStringImpl::copyChars(destination, string.rep()->characters8() + offset, length);
+}
+
+static inline void copyStringCharacters(UChar* destination, const UString& string, int offset, int length)
+{
+    if (!length)
+        return;
+    if (string.is8Bit())
+        UStringImpl::copyChars(destination, string.rep()->characters8() + offset, length);
+    else
+        UStringImpl::copyChars(destination, string.rep()->characters16() + offset, length);
+}
+
+template<typename CharType>
+static inline void spliceSubstringsWithSeparators(CharType* buffer, const UString& source, const StringRange* substringRanges, int rangeCount, const UString* separators, int separatorCount)
+{
+    int maxCount = max(rangeCount, separatorCount);
+    int bufferPos = 0;
+    for (int i = 0; i < maxCount; i++) {
+        if (i < rangeCount) {
+            copyStringCharacters(buffer + bufferPos, source, substringRanges[i].position, substringRanges[i].length);
+            bufferPos += substringRanges[i].length;
+        }
+        if (i < separatorCount) {
+            copyStringCharacters(buffer + bufferPos, separators[i], 0, separators[i].size());
+            bufferPos += separators[i].size();
+        }
+    }
+}
+
 AJValue jsSpliceSubstringsWithSeparators(ExecState* exec, AJString* sourceVal, const UString& source, const StringRange* substringRanges, int rangeCount, const UString* separators, int separatorCount);
 AJValue jsSpliceSubstringsWithSeparators(ExecState* exec, AJString* sourceVal, const UString& source, const StringRange* substringRanges, int rangeCount, const UString* separators, int separatorCount)
 {
@@ -285,24 +318,24 @@ AJValue jsSpliceSubstringsWithSeparators(ExecState* exec, AJString* sourceVal, c
     if (totalLength == 0)
         return jsString(exec, "");
 
+    bool is8Bit = source.is8Bit();
+    for (int i = 0; i < separatorCount && is8Bit; i++)
+        is8Bit = separators[i].isEmpty() || separators[i].is8Bit();
+
+    if (is8Bit) {
+        LChar* buffer;
+        PassRefPtr<UStringImpl> impl = UStringImpl::tryCreateUninitialized(totalLength, buffer);
+        if (!impl)
+            return throwOutOfMemoryError(exec);
+        spliceSubstringsWithSeparators(buffer, source, substringRanges, rangeCount, separators, separatorCount);
+        return jsString(exec, impl);
+    }
+
     UChar* buffer;
     PassRefPtr<UStringImpl> impl = UStringImpl::tryCreateUninitialized(totalLength, buffer);
     if (!impl)
         return throwOutOfMemoryError(exec);
-
-    int maxCount = max(rangeCount, separatorCount);
-    int bufferPos = 0;
-    for (int i = 0; i < maxCount; i++) {
-        if (i < rangeCount) {
-            UStringImpl::copyChars(buffer + bufferPos, source.data() + substringRanges[i].position, substringRanges[i].length);
-            bufferPos += substringRanges[i].length;
-        }
-        if (i < separatorCount) {
-            UStringImpl::copyChars(buffer + bufferPos, separators[i].data(), separators[i].size());
-            bufferPos += separators[i].size();
-        }
-    }
-
+    spliceSubstringsWithSeparators(buffer, source, substringRanges, rangeCount, separators, separatorCount);
     return jsString(exec, impl);
 }
 
@@ -479,35 +512,35 @@ AJValue JSC_HOST_CALL stringProtoFuncToString(ExecState* exec, AJObject*, AJValu
 
 AJValue JSC_HOST_CALL stringProtoFuncCharAt(ExecState* exec, AJObject*, AJValue thisValue, const ArgList& args)
 {
-    UString s = thisValue.toThisString(exec);
-    unsigned len = s.size();
+    AJString* s = thisValue.toThisAJString(exec);
+    unsigned len = s->length();
     AJValue a0 = args.at(0);
     if (a0.isUInt32()) {
         uint32_t i = a0.asUInt32();
         if (i < len)
-            return jsSingleCharacterSubstring(exec, s, i);
+            return s->getIndex(exec, i);
         return jsEmptyString(exec);
     }
     double dpos = a0.toInteger(exec);
     if (dpos >= 0 && dpos < len)
-        return jsSingleCharacterSubstring(exec, s, static_cast<unsigned>(dpos));
+        return s->getIndex(exec, static_cast<unsigned>(dpos));
     return jsEmptyString(exec);
 }
 
 AJValue JSC_HOST_CALL stringProtoFuncCharCodeAt(ExecState* exec, AJObject*, AJValue thisValue, const ArgList& args)
 {
-    UString s = thisValue.toThisString(exec);
-    unsigned len = s.size();
+    AJString* s = thisValue.toThisAJString(exec);
+    unsigned len = s->length();
     AJValue a0 = args.at(0);
     if (a0.isUInt32()) {
         uint32_t i = a0.asUInt32();
         if (i < len)
-            return jsNumber(exec, s.data()[i]);
+            return jsNumber(exec, s->characterAt(i));
         return jsNaN(exec);
     }
     double dpos = a0.toInteger(exec);
     if (dpos >= 0 && dpos < len)
-        return jsNumber(exec, s[static_cast<int>(dpos)]);
+        return jsNumber(exec, s->characterAt(static_cast<unsigned>(dpos)));
     return jsNaN(exec);
 }
 
@@ -525,8 +558,8 @@ AJValue JSC_HOST_CALL stringProtoFuncConcat(ExecState* exec, AJObject*, AJValue
 
 AJValue JSC_HOST_CALL stringProtoFuncIndexOf(ExecState* exec, AJObject*, AJValue thisValue, const ArgList& args)
 {
-    UString s = thisValue.toThisString(exec);
-    int len = s.size();
+    AJString* s = thisValue.toThisAJString(exec);
+    int len = s->length();
 
     AJValue a0 = args.at(0);
     AJValue a1 = args.at(1);
@@ -545,7 +578,7 @@ AJValue JSC_HOST_CALL stringProtoFuncIndexOf(ExecState* exec, AJObject*, AJValue
         pos = static_cast<int>(dpos);
     }
 
-    unsigned result = s.find(u2, pos);
+    unsigned result = s->find(exec, u2, pos);
     if (result == UString::NotFound)
         return jsNumber(exec, -1);
     return jsNumber(exec, result);
@@ -655,8 +688,8 @@ AJValue JSC_HOST_CALL stringProtoFuncSearch(ExecState* exec, AJObject*, AJValue
 
 AJValue JSC_HOST_CALL stringProtoFuncSlice(ExecState* exec, AJObject*, AJValue thisValue, const ArgList& args)
 {
-    UString s = thisValue.toThisString(exec);
-    int len = s.size();
+    AJString* s = thisValue.toThisAJString(exec);
+    int len = s->length();
 
     AJValue a0 = args.at(0);
     AJValue a1 = args.at(1);
@@ -819,6 +852,17 @@ AJValue JSC_HOST_CALL stringProtoFuncSubstring(ExecState* exec, AJObject*, AJVal
     return jsSubstring(exec, uString, substringStart, substringLength);
 }
 
+static inline LChar latin1ToLower(LChar c)
+{
+    return isASCII(c) ? toASCIILower(c) : static_cast<LChar>(Unicode::toLower(c));
+}
+
+// Sharp s is its own simple uppercase; callers check for it.
+static inline UChar latin1ToUpper(LChar c)
+{
+    return isASCII(c) ? toASCIIUpper(c) : static_cast<UChar>(Unicode::toUpper(c));
+}
+
 AJValue JSC_HOST_CALL stringProtoFuncToLowerCase(ExecState* exec, AJObject*, AJValue thisValue, const ArgList&)
 {
     AJString* sVal = thisValue.toThisAJString(exec);
@@ -828,6 +872,22 @@ AJValue JSC_HOST_CALL stringProtoFuncToLowerCase(ExecState* exec, AJObject*, AJV
     if (!sSize)
         return sVal;
 
+    if (s.is8Bit()) {
+        // Latin-1 lowercases within Latin-1, so 8-bit strings stay 8-bit.
+        const LChar* sData8 = s.rep()->characters8();
+        int i = 0;
+        while (i < sSize && sData8[i] == latin1ToLower(sData8[i]))
+            ++i;
+        if (i == sSize)
+            return sVal;
+        LChar* buffer8;
+        RefPtr<UStringImpl> result = UStringImpl::createUninitialized(sSize, buffer8);
+        UStringImpl::copyChars(buffer8, sData8, i);
+        for (; i < sSize; ++i)
+            buffer8[i] = latin1ToLower(sData8[i]);
+        return jsString(exec, UString(result.release()));
+    }
+
     const UChar* sData = s.data();
     Vector<UChar> buffer(sSize);
 
@@ -865,7 +925,33 @@ AJValue JSC_HOST_CALL stringProtoFuncToUpperCase(ExecState* exec, AJObject*, AJV
     if (!sSize)
         return sVal;
 
-    const UChar* sData = s.data();
+    // Latin-1 uppercases within Latin-1 except for the micro sign and y with
+    // diaeresis, which map outside it, and sharp s, which becomes "SS". Those
+    // go the general way, widened into a scratch buffer.
+    Vector<UChar> widened;
+    const UChar* sData;
+    if (s.is8Bit()) {
+        const LChar* sData8 = s.rep()->characters8();
+        int i = 0;
+        while (i < sSize && sData8[i] != 0xDF && sData8[i] == latin1ToUpper(sData8[i]))
+            ++i;
+        if (i == sSize)
+            return sVal;
+        LChar* buffer8;
+        RefPtr<UStringImpl> result = UStringImpl::createUninitialized(sSize, buffer8);
+        UStringImpl::copyChars(buffer8, sData8, i);
+        for (; i < sSize; ++i) {
+            UChar c = latin1ToUpper(sData8[i]);
+            if (c > 0xFF || sData8[i] == 0xDF)
+                break;
+            buffer8[i] = c;
+        }
+        if (i == sSize)
+            return jsString(exec, UString(result.release()));
+        widened.append(sData8, sSize);
+        sData = widened.data();
+    } else
+        sData = s.data();
     Vector<UChar> buffer(sSize);
 
     UChar ored = 0;
@@ -964,6 +1050,14 @@ AJValue JSC_HOST_CALL stringProtoFuncFontcolor(ExecState* exec, AJObject*, AJVal
     return jsMakeNontrivialString(exec, "<font color=\"", a0.toString(exec), "\">", s, "</font>");
 }
 
+static inline void copyCharacters(UChar* destination, const UString& string)
+{
+    if (string.is8Bit())
+        UStringImpl::copyChars(destination, string.rep()->characters8(), string.size());
+    else
+        UStringImpl::copyChars(destination, string.data(), string.size());
+}
+
 AJValue JSC_HOST_CALL stringProtoFuncFontsize(ExecState* exec, AJObject*, AJValue thisValue, const ArgList& args)
 {
     UString s = thisValue.toThisString(exec);
@@ -992,7 +1086,7 @@ AJValue JSC_HOST_CALL stringProtoFuncFontsize(ExecState* exec, AJObject*, AJValu
         buffer[12] = '0' + smallInteger;
         buffer[13] = '"';
         buffer[14] = '>';
-        memcpy(&buffer[15], s.data(), stringSize * sizeof(UChar));
+        copyCharacters(&buffer[15], s);
         buffer[15 + stringSize] = '<';
         buffer[16 + stringSize] = '/';
         buffer[17 + stringSize] = 'f';
@@ -1035,10 +1129,10 @@ AJValue JSC_HOST_CALL stringProtoFuncLink(ExecState* exec, AJObject*, AJValue th
     buffer[6] = 'f';
     buffer[7] = '=';
     buffer[8] = '"';
-    memcpy(&buffer[9], linkText.data(), linkTextSize * sizeof(UChar));
+    copyCharacters(&buffer[9], linkText);
     buffer[9 + linkTextSize] = '"';
     buffer[10 + linkTextSize] = '>';
-    memcpy(&buffer[11 + linkTextSize], s.data(), stringSize * sizeof(UChar));
+    copyCharacters(&buffer[11 + linkTextSize], s);
     buffer[11 + linkTextSize + stringSize] = '<';
     buffer[12 + linkTextSize + stringSize] = '/';
     buffer[13 + linkTextSize + stringSize] = 'a';
@@ -69,14 +69,6 @@ using namespace ATF;
 
 namespace AJ {
 
-// Choose a number for the following so that most property maps are smaller,
-// but it's not going to blow out the stack to allocate this number of pointers.
-static const int smallMapThreshold = 1024;
-
-// The point at which the function call overhead of the qsort implementation
-// becomes small compared to the inefficiency of insertion sort.
-static const unsigned tinyMapThreshold = 20;
-
 static const unsigned newTableSize = 16;
 
 #ifndef NDEBUG
@@ -94,8 +86,6 @@ static HashSet<Structure*>& ignoreSet = *(new HashSet<Structure*>);
 static HashSet<Structure*>& liveStructureSet = *(new HashSet<Structure*>);
 #endif
 
-static int comparePropertyMapEntryIndices(const void* a, const void* b);
-
 inline void Structure::setTransitionTable(TransitionTable* table)
 {
     ASSERT(m_isUsingSingleSlot);
@@ -241,12 +231,17 @@ void Structure::dumpStatistics()
 }
 
 Structure::Structure(AJValue prototype, const TypeInfo& typeInfo, unsigned anonymousSlotCount)
-    : m_typeInfo(typeInfo)
+    : m_refCount(1)
+    , m_heap(0)
+    , m_nextInHeap(0)
+    , m_typeInfo(typeInfo)
     , m_prototype(prototype)
     , m_specificValueInPrevious(0)
     , m_propertyTable(0)
     , m_propertyStorageCapacity(AJObject::inlineStorageCapacity)
+    , m_inlineStorageCapacity(AJObject::inlineStorageCapacity)
     , m_offset(noOffset)
+    , m_largestTransitionStorageSize(0)
     , m_dictionaryKind(NoneDictionaryKind)
     , m_isPinnedPropertyTable(false)
     , m_hasGetterSetterProperties(false)
@@ -254,6 +249,8 @@ Structure::Structure(AJValue prototype, const TypeInfo& typeInfo, unsigned anony
     , m_specificFunctionThrashCount(0)
     , m_anonymousSlotCount(anonymousSlotCount)
     , m_isUsingSingleSlot(true)
+    , m_slackTrackingCountdown(slackTrackingConstructionCount)
+    , m_isMarked(false)
 {
     m_transitions.m_singleTransition = 0;
 
@@ -277,6 +274,9 @@ Structure::Structure(AJValue prototype, const TypeInfo& typeInfo, unsigned anony
 
 Structure::~Structure()
 {
+    // The heap unlinks a Structure before freeing it.
+    ASSERT(!m_heap);
+
     if (m_previous) {
         ASSERT(m_nameInPrevious);
         m_previous->transitionTableRemove(make_pair(m_nameInPrevious.get(), m_attributesInPrevious), m_specificValueInPrevious);
@@ -285,7 +285,7 @@ Structure::~Structure()
     ASSERT(!m_enumerationCache.hasDeadObject());
 
     if (m_propertyTable) {
-        unsigned entryCount = m_propertyTable->keyCount + m_propertyTable->deletedSentinelCount;
+        unsigned entryCount = m_propertyTable->entryCount();
         for (unsigned i = 1; i <= entryCount; i++) {
             if (UString::Rep* key = m_propertyTable->entries()[i].key)
                 key->deref();
@@ -397,15 +397,15 @@ void Structure::materializePropertyMap()
     for (ptrdiff_t i = structures.size() - 2; i >= 0; --i) {
         structure = structures[i];
         structure->m_nameInPrevious->ref();
-        PropertyMapEntry entry(structure->m_nameInPrevious.get(), m_anonymousSlotCount + structure->m_offset, structure->m_attributesInPrevious, structure->m_specificValueInPrevious, ++m_propertyTable->lastIndexUsed);
+        PropertyMapEntry entry(structure->m_nameInPrevious.get(), m_anonymousSlotCount + structure->m_offset, structure->m_attributesInPrevious, structure->m_specificValueInPrevious);
         insertIntoPropertyMapHashTable(entry);
     }
 }
 
 void Structure::growPropertyStorageCapacity()
 {
-    if (m_propertyStorageCapacity == AJObject::inlineStorageCapacity)
-        m_propertyStorageCapacity = AJObject::nonInlineBaseStorageCapacity;
+    if (m_propertyStorageCapacity == m_inlineStorageCapacity)
+        m_propertyStorageCapacity = max(AJObject::nonInlineBaseStorageCapacity, 2 * m_inlineStorageCapacity);
     else
         m_propertyStorageCapacity *= 2;
 }
@@ -419,41 +419,13 @@ void Structure::despecifyDictionaryFunction(const Identifier& propertyName)
     ASSERT(isDictionary());
     ASSERT(m_propertyTable);
 
-    unsigned i = rep->existingHash();
-
 #if DUMP_PROPERTYMAP_STATS
     ++numProbes;
 #endif
 
-    unsigned entryIndex = m_propertyTable->entryIndices[i & m_propertyTable->sizeMask];
-    ASSERT(entryIndex != emptyEntryIndex);
-
-    if (rep == m_propertyTable->entries()[entryIndex - 1].key) {
-        m_propertyTable->entries()[entryIndex - 1].specificValue = 0;
-        return;
-    }
-
-#if DUMP_PROPERTYMAP_STATS
-    ++numCollisions;
-#endif
-
-    unsigned k = 1 | doubleHash(rep->existingHash());
-
-    while (1) {
-        i += k;
-
-#if DUMP_PROPERTYMAP_STATS
-        ++numRehashes;
-#endif
-
-        entryIndex = m_propertyTable->entryIndices[i & m_propertyTable->sizeMask];
-        ASSERT(entryIndex != emptyEntryIndex);
-
-        if (rep == m_propertyTable->entries()[entryIndex - 1].key) {
-            m_propertyTable->entries()[entryIndex - 1].specificValue = 0;
-            return;
-        }
-    }
+    PropertyMapEntry* entry = m_propertyTable->find(rep);
+    ASSERT(entry);
+    entry->specificValue = 0;
 }
 
 PassRefPtr<Structure> Structure::addPropertyTransitionToExistingStructure(Structure* structure, const Identifier& propertyName, unsigned attributes, AJCell* specificValue, size_t& offset)
@@ -500,6 +472,7 @@ PassRefPtr<Structure> Structure::addPropertyTransition(Structure* structure, con
     transition->m_attributesInPrevious = attributes;
     transition->m_specificValueInPrevious = specificValue;
     transition->m_propertyStorageCapacity = structure->m_propertyStorageCapacity;
+    transition->m_inlineStorageCapacity = structure->m_inlineStorageCapacity;
     transition->m_hasGetterSetterProperties = structure->m_hasGetterSetterProperties;
     transition->m_hasNonEnumerableProperties = structure->m_hasNonEnumerableProperties;
     transition->m_specificFunctionThrashCount = structure->m_specificFunctionThrashCount;
@@ -527,9 +500,31 @@ PassRefPtr<Structure> Structure::addPropertyTransition(Structure* structure, con
     transition->m_offset = offset - structure->m_anonymousSlotCount;
     ASSERT(structure->anonymousSlotCount() == transition->anonymousSlotCount());
     structure->transitionTableAdd(make_pair(propertyName.ustring().rep(), attributes), transition.get(), specificValue);
+
+    // Record the size on the Structure the chain of transitions started
+    // from, for slack tracking.
+    Structure* root = structure;
+    while (root->m_previous)
+        root = root->m_previous.get();
+    unsigned storageSize = min(transition->propertyStorageSize(), AJObject::maxInlineStorageCapacity());
+    if (storageSize > root->m_largestTransitionStorageSize)
+        root->m_largestTransitionStorageSize = storageSize;
+
     return transition.release();
 }
 
+PassRefPtr<Structure> Structure::createWithInlineStorage(Structure* structure, unsigned inlineStorageCapacity)
+{
+    ASSERT(structure->isEmpty());
+    ASSERT(inlineStorageCapacity <= AJObject::maxInlineStorageCapacity());
+
+    RefPtr<Structure> sized = create(structure->m_prototype, structure->typeInfo(), structure->anonymousSlotCount());
+    sized->m_propertyStorageCapacity = inlineStorageCapacity;
+    sized->m_inlineStorageCapacity = inlineStorageCapacity;
+    sized->m_slackTrackingCountdown = 0;
+    return sized.release();
+}
+
 PassRefPtr<Structure> Structure::removePropertyTransition(Structure* structure, const Identifier& propertyName, size_t& offset)
 {
     ASSERT(!structure->isUncacheableDictionary());
@@ -548,6 +543,7 @@ PassRefPtr<Structure> Structure::changePrototypeTransition(Structure* structure,
     RefPtr<Structure> transition = create(prototype, structure->typeInfo(), structure->anonymousSlotCount());
 
     transition->m_propertyStorageCapacity = structure->m_propertyStorageCapacity;
+    transition->m_inlineStorageCapacity = structure->m_inlineStorageCapacity;
     transition->m_hasGetterSetterProperties = structure->m_hasGetterSetterProperties;
     transition->m_hasNonEnumerableProperties = structure->m_hasNonEnumerableProperties;
     transition->m_specificFunctionThrashCount = structure->m_specificFunctionThrashCount;
@@ -568,6 +564,7 @@ PassRefPtr<Structure> Structure::despecifyFunctionTransition(Structure* structur
     RefPtr<Structure> transition = create(structure->storedPrototype(), structure->typeInfo(), structure->anonymousSlotCount());
 
     transition->m_propertyStorageCapacity = structure->m_propertyStorageCapacity;
+    transition->m_inlineStorageCapacity = structure->m_inlineStorageCapacity;
     transition->m_hasGetterSetterProperties = structure->m_hasGetterSetterProperties;
     transition->m_hasNonEnumerableProperties = structure->m_hasNonEnumerableProperties;
     transition->m_specificFunctionThrashCount = structure->m_specificFunctionThrashCount + 1;
@@ -593,6 +590,7 @@ PassRefPtr<Structure> Structure::getterSetterTransition(Structure* structure)
 {
     RefPtr<Structure> transition = create(structure->storedPrototype(), structure->typeInfo(), structure->anonymousSlotCount());
     transition->m_propertyStorageCapacity = structure->m_propertyStorageCapacity;
+    transition->m_inlineStorageCapacity = structure->m_inlineStorageCapacity;
     transition->m_hasGetterSetterProperties = transition->m_hasGetterSetterProperties;
     transition->m_hasNonEnumerableProperties = structure->m_hasNonEnumerableProperties;
     transition->m_specificFunctionThrashCount = structure->m_specificFunctionThrashCount;
@@ -614,6 +612,7 @@ PassRefPtr<Structure> Structure::toDictionaryTransition(Structure* structure, Di
     RefPtr<Structure> transition = create(structure->m_prototype, structure->typeInfo(), structure->anonymousSlotCount());
     transition->m_dictionaryKind = kind;
     transition->m_propertyStorageCapacity = structure->m_propertyStorageCapacity;
+    transition->m_inlineStorageCapacity = structure->m_inlineStorageCapacity;
     transition->m_hasGetterSetterProperties = structure->m_hasGetterSetterProperties;
     transition->m_hasNonEnumerableProperties = structure->m_hasNonEnumerableProperties;
     transition->m_specificFunctionThrashCount = structure->m_specificFunctionThrashCount;
@@ -641,29 +640,21 @@ PassRefPtr<Structure> Structure::flattenDictionaryStructure(AJObject* object)
     ASSERT(isDictionary());
     if (isUncacheableDictionary()) {
         ASSERT(m_propertyTable);
-        Vector<PropertyMapEntry*> sortedPropertyEntries(m_propertyTable->keyCount);
-        PropertyMapEntry** p = sortedPropertyEntries.data();
-        unsigned entryCount = m_propertyTable->keyCount + m_propertyTable->deletedSentinelCount;
-        for (unsigned i = 1; i <= entryCount; i++) {
-            if (m_propertyTable->entries()[i].key)
-                *p++ = &m_propertyTable->entries()[i];
-        }
-        size_t propertyCount = p - sortedPropertyEntries.data();
-        qsort(sortedPropertyEntries.data(), propertyCount, sizeof(PropertyMapEntry*), comparePropertyMapEntryIndices);
-        sortedPropertyEntries.resize(propertyCount);
-
-        // We now have the properties currently defined on this object
-        // in the order that they are expected to be in, but we need to
-        // reorder the storage, so we have to copy the current values out
-        Vector<AJValue> values(propertyCount);
+        // The entries are in the order the properties were added, which is
+        // the order their storage should be in. Copy the current values out,
+        // and give the entries their new offsets.
+        Vector<AJValue> values(m_propertyTable->keyCount);
         unsigned anonymousSlotCount = m_anonymousSlotCount;
-        for (unsigned i = 0; i < propertyCount; i++) {
-            PropertyMapEntry* entry = sortedPropertyEntries[i];
-            values[i] = object->getDirectOffset(entry->offset);
-            // Update property table to have the new property offsets
-            entry->offset = anonymousSlotCount + i;
-            entry->index = i;
+        unsigned propertyCount = 0;
+        unsigned entryCount = m_propertyTable->entryCount();
+        for (unsigned i = 1; i <= entryCount; i++) {
+            PropertyMapEntry& entry = m_propertyTable->entries()[i];
+            if (!entry.key)
+                continue;
+            values[propertyCount] = object->getDirectOffset(entry.offset);
+            entry.offset = anonymousSlotCount + propertyCount++;
         }
+        ASSERT(propertyCount == m_propertyTable->keyCount);
         
         // Copy the original property values into their final locations
         for (unsigned i = 0; i < propertyCount; i++)
@@ -713,8 +704,6 @@ size_t Structure::removePropertyWithoutTransition(const Identifier& propertyName
 #if DUMP_PROPERTYMAP_STATS
 
 static int numProbes;
-static int numCollisions;
-static int numRehashes;
 static int numRemoves;
 
 struct PropertyMapStatisticsExitLogger {
@@ -727,15 +716,11 @@ PropertyMapStatisticsExitLogger::~PropertyMapStatisticsExitLogger()
 {
     printf("\nAJ::PropertyMap statistics\n\n");
     printf("%d probes\n", numProbes);
-    printf("%d collisions (%.1f%%)\n", numCollisions, 100.0 * numCollisions / numProbes);
-    printf("%d rehashes\n", numRehashes);
     printf("%d removes\n", numRemoves);
 }
 
 #endif
 
-static const unsigned deletedSentinelIndex = 1;
-
 #if !DO_PROPERTYMAP_CONSTENCY_CHECK
 
 inline void Structure::checkConsistency()
@@ -753,7 +738,7 @@ PropertyMapHashTable* Structure::copyPropertyTable()
     PropertyMapHashTable* newTable = static_cast<PropertyMapHashTable*>(fastMalloc(tableSize));
     memcpy(newTable, m_propertyTable, tableSize);
 
-    unsigned entryCount = m_propertyTable->keyCount + m_propertyTable->deletedSentinelCount;
+    unsigned entryCount = m_propertyTable->entryCount();
     for (unsigned i = 1; i <= entryCount; ++i) {
         if (UString::Rep* key = newTable->entries()[i].key)
             key->ref();
@@ -772,47 +757,18 @@ size_t Structure::get(const UString::Rep* rep, unsigned& attributes, AJCell*& sp
     if (!m_propertyTable)
         return notFound;
 
-    unsigned i = rep->existingHash();
-
 #if DUMP_PROPERTYMAP_STATS
     ++numProbes;
 #endif
 
-    unsigned entryIndex = m_propertyTable->entryIndices[i & m_propertyTable->sizeMask];
-    if (entryIndex == emptyEntryIndex)
+    PropertyMapEntry* entry = m_propertyTable->find(rep);
+    if (!entry)
         return notFound;
 
-    if (rep == m_propertyTable->entries()[entryIndex - 1].key) {
-        attributes = m_propertyTable->entries()[entryIndex - 1].attributes;
-        specificValue = m_propertyTable->entries()[entryIndex - 1].specificValue;
-        ASSERT(m_propertyTable->entries()[entryIndex - 1].offset >= m_anonymousSlotCount);
-        return m_propertyTable->entries()[entryIndex - 1].offset;
-    }
-
-#if DUMP_PROPERTYMAP_STATS
-    ++numCollisions;
-#endif
-
-    unsigned k = 1 | doubleHash(rep->existingHash());
-
-    while (1) {
-        i += k;
-
-#if DUMP_PROPERTYMAP_STATS
-        ++numRehashes;
-#endif
-
-        entryIndex = m_propertyTable->entryIndices[i & m_propertyTable->sizeMask];
-        if (entryIndex == emptyEntryIndex)
-            return notFound;
-
-        if (rep == m_propertyTable->entries()[entryIndex - 1].key) {
-            attributes = m_propertyTable->entries()[entryIndex - 1].attributes;
-            specificValue = m_propertyTable->entries()[entryIndex - 1].specificValue;
-            ASSERT(m_propertyTable->entries()[entryIndex - 1].offset >= m_anonymousSlotCount);
-            return m_propertyTable->entries()[entryIndex - 1].offset;
-        }
-    }
+    attributes = entry->attributes;
+    specificValue = entry->specificValue;
+    ASSERT(entry->offset >= m_anonymousSlotCount);
+    return entry->offset;
 }
 
 bool Structure::despecifyFunction(const Identifier& propertyName)
@@ -823,47 +779,17 @@ bool Structure::despecifyFunction(const Identifier& propertyName)
     if (!m_propertyTable)
         return false;
 
-    UString::Rep* rep = propertyName._ustring.rep();
-
-    unsigned i = rep->existingHash();
-
 #if DUMP_PROPERTYMAP_STATS
     ++numProbes;
 #endif
 
-    unsigned entryIndex = m_propertyTable->entryIndices[i & m_propertyTable->sizeMask];
-    if (entryIndex == emptyEntryIndex)
+    PropertyMapEntry* entry = m_propertyTable->find(propertyName._ustring.rep());
+    if (!entry)
         return false;
 
-    if (rep == m_propertyTable->entries()[entryIndex - 1].key) {
-        ASSERT(m_propertyTable->entries()[entryIndex - 1].specificValue);
-        m_propertyTable->entries()[entryIndex - 1].specificValue = 0;
-        return true;
-    }
-
-#if DUMP_PROPERTYMAP_STATS
-    ++numCollisions;
-#endif
-
-    unsigned k = 1 | doubleHash(rep->existingHash());
-
-    while (1) {
-        i += k;
-
-#if DUMP_PROPERTYMAP_STATS
-        ++numRehashes;
-#endif
-
-        entryIndex = m_propertyTable->entryIndices[i & m_propertyTable->sizeMask];
-        if (entryIndex == emptyEntryIndex)
-            return false;
-
-        if (rep == m_propertyTable->entries()[entryIndex - 1].key) {
-            ASSERT(m_propertyTable->entries()[entryIndex - 1].specificValue);
-            m_propertyTable->entries()[entryIndex - 1].specificValue = 0;
-            return true;
-        }
-    }
+    ASSERT(entry->specificValue);
+    entry->specificValue = 0;
+    return true;
 }
 
 void Structure::despecifyAllFunctions()
@@ -872,7 +798,7 @@ void Structure::despecifyAllFunctions()
     if (!m_propertyTable)
         return;
     
-    unsigned entryCount = m_propertyTable->keyCount + m_propertyTable->deletedSentinelCount;
+    unsigned entryCount = m_propertyTable->entryCount();
     for (unsigned i = 1; i <= entryCount; ++i)
         m_propertyTable->entries()[i].specificValue = 0;
 }
@@ -892,66 +818,14 @@ size_t Structure::put(const Identifier& propertyName, unsigned attributes, AJCel
     if (!m_propertyTable)
         createPropertyMapHashTable();
 
-    // FIXME: Consider a fast case for tables with no deleted sentinels.
-
-    unsigned i = rep->existingHash();
-    unsigned k = 0;
-    bool foundDeletedElement = false;
-    unsigned deletedElementIndex = 0; // initialize to make the compiler happy
-
 #if DUMP_PROPERTYMAP_STATS
     ++numProbes;
 #endif
 
-    while (1) {
-        unsigned entryIndex = m_propertyTable->entryIndices[i & m_propertyTable->sizeMask];
-        if (entryIndex == emptyEntryIndex)
-            break;
-
-        if (entryIndex == deletedSentinelIndex) {
-            // If we find a deleted-element sentinel, remember it for use later.
-            if (!foundDeletedElement) {
-                foundDeletedElement = true;
-                deletedElementIndex = i;
-            }
-        }
-
-        if (k == 0) {
-            k = 1 | doubleHash(rep->existingHash());
-#if DUMP_PROPERTYMAP_STATS
-            ++numCollisions;
-#endif
-        }
-
-        i += k;
-
-#if DUMP_PROPERTYMAP_STATS
-        ++numRehashes;
-#endif
-    }
-
-    // Figure out which entry to use.
-    unsigned entryIndex = m_propertyTable->keyCount + m_propertyTable->deletedSentinelCount + 2;
-    if (foundDeletedElement) {
-        i = deletedElementIndex;
-        --m_propertyTable->deletedSentinelCount;
-
-        // Since we're not making the table bigger, we can't use the entry one past
-        // the end that we were planning on using, so search backwards for the empty
-        // slot that we can use. We know it will be there because we did at least one
-        // deletion in the past that left an entry empty.
-        while (m_propertyTable->entries()[--entryIndex - 1].key) { }
-    }
-
-    // Create a new hash table entry.
-    m_propertyTable->entryIndices[i & m_propertyTable->sizeMask] = entryIndex;
-
-    // Create a new hash table entry.
-    rep->ref();
-    m_propertyTable->entries()[entryIndex - 1].key = rep;
-    m_propertyTable->entries()[entryIndex - 1].attributes = attributes;
-    m_propertyTable->entries()[entryIndex - 1].specificValue = specificValue;
-    m_propertyTable->entries()[entryIndex - 1].index = ++m_propertyTable->lastIndexUsed;
+    // New entries always go at the end, so the entries stay in the order
+    // their properties were added.
+    unsigned entryIndex = m_propertyTable->entryCount() + 1;
+    m_propertyTable->insert(rep->existingHash(), entryIndex);
 
     unsigned newOffset;
     if (m_propertyTable->deletedOffsets && !m_propertyTable->deletedOffsets->isEmpty()) {
@@ -959,13 +833,15 @@ size_t Structure::put(const Identifier& propertyName, unsigned attributes, AJCel
         m_propertyTable->deletedOffsets->removeLast();
     } else
         newOffset = m_propertyTable->keyCount + m_anonymousSlotCount;
-    m_propertyTable->entries()[entryIndex - 1].offset = newOffset;
-    
     ASSERT(newOffset >= m_anonymousSlotCount);
+
+    rep->ref();
+    m_propertyTable->entries()[entryIndex] = PropertyMapEntry(rep, newOffset, attributes, specificValue);
     ++m_propertyTable->keyCount;
 
-    if ((m_propertyTable->keyCount + m_propertyTable->deletedSentinelCount) * 2 >= m_propertyTable->size)
-        expandPropertyMapHashTable();
+    // Rehashing at the same size is enough if most of the used slots are deleted.
+    if (m_propertyTable->entryCount() * 2 >= m_propertyTable->size)
+        rehashPropertyMapHashTable(m_propertyTable->keyCount * 4 >= m_propertyTable->size ? m_propertyTable->size * 2 : m_propertyTable->size);
 
     checkConsistency();
     return newOffset;
@@ -992,46 +868,19 @@ size_t Structure::remove(const Identifier& propertyName)
     ++numRemoves;
 #endif
 
-    // Find the thing to remove.
-    unsigned i = rep->existingHash();
-    unsigned k = 0;
-    unsigned entryIndex;
-    UString::Rep* key = 0;
-    while (1) {
-        entryIndex = m_propertyTable->entryIndices[i & m_propertyTable->sizeMask];
-        if (entryIndex == emptyEntryIndex)
-            return notFound;
-
-        key = m_propertyTable->entries()[entryIndex - 1].key;
-        if (rep == key)
-            break;
-
-        if (k == 0) {
-            k = 1 | doubleHash(rep->existingHash());
-#if DUMP_PROPERTYMAP_STATS
-            ++numCollisions;
-#endif
-        }
-
-        i += k;
-
-#if DUMP_PROPERTYMAP_STATS
-        ++numRehashes;
-#endif
-    }
+    unsigned slot = m_propertyTable->findSlot(rep);
+    if (slot == PropertyMapHashTable::notFound)
+        return notFound;
 
-    // Replace this one element with the deleted sentinel. Also clear out
-    // the entry so we can iterate all the entries as needed.
-    m_propertyTable->entryIndices[i & m_propertyTable->sizeMask] = deletedSentinelIndex;
+    // Leave a hole in the entries, so the rest keep their order.
+    PropertyMapEntry& entry = m_propertyTable->entries()[m_propertyTable->entryIndices()[slot]];
+    m_propertyTable->removeSlot(slot);
 
-    size_t offset = m_propertyTable->entries()[entryIndex - 1].offset;
+    size_t offset = entry.offset;
     ASSERT(offset >= m_anonymousSlotCount);
 
-    key->deref();
-    m_propertyTable->entries()[entryIndex - 1].key = 0;
-    m_propertyTable->entries()[entryIndex - 1].attributes = 0;
-    m_propertyTable->entries()[entryIndex - 1].specificValue = 0;
-    m_propertyTable->entries()[entryIndex - 1].offset = 0;
+    rep->deref();
+    entry = PropertyMapEntry(0, 0, 0);
 
     if (!m_propertyTable->deletedOffsets)
         m_propertyTable->deletedOffsets = new Vector<unsigned>;
@@ -1052,35 +901,14 @@ void Structure::insertIntoPropertyMapHashTable(const PropertyMapEntry& entry)
 {
     ASSERT(m_propertyTable);
     ASSERT(entry.offset >= m_anonymousSlotCount);
-    unsigned i = entry.key->existingHash();
-    unsigned k = 0;
 
 #if DUMP_PROPERTYMAP_STATS
     ++numProbes;
 #endif
 
-    while (1) {
-        unsigned entryIndex = m_propertyTable->entryIndices[i & m_propertyTable->sizeMask];
-        if (entryIndex == emptyEntryIndex)
-            break;
-
-        if (k == 0) {
-            k = 1 | doubleHash(entry.key->existingHash());
-#if DUMP_PROPERTYMAP_STATS
-            ++numCollisions;
-#endif
-        }
-
-        i += k;
-
-#if DUMP_PROPERTYMAP_STATS
-        ++numRehashes;
-#endif
-    }
-
-    unsigned entryIndex = m_propertyTable->keyCount + 2;
-    m_propertyTable->entryIndices[i & m_propertyTable->sizeMask] = entryIndex;
-    m_propertyTable->entries()[entryIndex - 1] = entry;
+    unsigned entryIndex = m_propertyTable->entryCount() + 1;
+    m_propertyTable->insert(entry.key->existingHash(), entryIndex);
+    m_propertyTable->entries()[entryIndex] = entry;
 
     ++m_propertyTable->keyCount;
 }
@@ -1098,9 +926,7 @@ void Structure::createPropertyMapHashTable(unsigned newTableSize)
 
     checkConsistency();
 
-    m_propertyTable = static_cast<PropertyMapHashTable*>(fastZeroedMalloc(PropertyMapHashTable::allocationSize(newTableSize)));
-    m_propertyTable->size = newTableSize;
-    m_propertyTable->sizeMask = newTableSize - 1;
+    m_propertyTable = PropertyMapHashTable::create(newTableSize);
 
     checkConsistency();
 }
@@ -1127,19 +953,13 @@ void Structure::rehashPropertyMapHashTable(unsigned newTableSize)
 
     PropertyMapHashTable* oldTable = m_propertyTable;
 
-    m_propertyTable = static_cast<PropertyMapHashTable*>(fastZeroedMalloc(PropertyMapHashTable::allocationSize(newTableSize)));
-    m_propertyTable->size = newTableSize;
-    m_propertyTable->sizeMask = newTableSize - 1;
+    m_propertyTable = PropertyMapHashTable::create(newTableSize);
 
-    unsigned lastIndexUsed = 0;
-    unsigned entryCount = oldTable->keyCount + oldTable->deletedSentinelCount;
+    unsigned entryCount = oldTable->entryCount();
     for (unsigned i = 1; i <= entryCount; ++i) {
-        if (oldTable->entries()[i].key) {
-            lastIndexUsed = max(oldTable->entries()[i].index, lastIndexUsed);
+        if (oldTable->entries()[i].key)
             insertIntoPropertyMapHashTable(oldTable->entries()[i]);
-        }
     }
-    m_propertyTable->lastIndexUsed = lastIndexUsed;
     m_propertyTable->deletedOffsets = oldTable->deletedOffsets;
 
     fastFree(oldTable);
@@ -1147,16 +967,6 @@ void Structure::rehashPropertyMapHashTable(unsigned newTableSize)
     checkConsistency();
 }
 
-int comparePropertyMapEntryIndices(const void* a, const void* b)
-{
-    unsigned ia = static_cast<PropertyMapEntry* const*>(a)[0]->index;
-    unsigned ib = static_cast<PropertyMapEntry* const*>(b)[0]->index;
-    if (ia < ib)
-        return -1;
-    if (ia > ib)
-        return +1;
-    return 0;
-}
 
 void Structure::getPropertyNames(PropertyNameArray& propertyNames, EnumerationMode mode)
 {
@@ -1164,55 +974,18 @@ void Structure::getPropertyNames(PropertyNameArray& propertyNames, EnumerationMo
     if (!m_propertyTable)
         return;
 
-    if (m_propertyTable->keyCount < tinyMapThreshold) {
-        PropertyMapEntry* a[tinyMapThreshold];
-        int i = 0;
-        unsigned entryCount = m_propertyTable->keyCount + m_propertyTable->deletedSentinelCount;
-        for (unsigned k = 1; k <= entryCount; k++) {
-            ASSERT(m_hasNonEnumerableProperties || !(m_propertyTable->entries()[k].attributes & DontEnum));
-            if (m_propertyTable->entries()[k].key && (!(m_propertyTable->entries()[k].attributes & DontEnum) || (mode == IncludeDontEnumProperties))) {
-                PropertyMapEntry* value = &m_propertyTable->entries()[k];
-                int j;
-                for (j = i - 1; j >= 0 && a[j]->index > value->index; --j)
-                    a[j + 1] = a[j];
-                a[j + 1] = value;
-                ++i;
-            }
-        }
-        if (!propertyNames.size()) {
-            for (int k = 0; k < i; ++k)
-                propertyNames.addKnownUnique(a[k]->key);
-        } else {
-            for (int k = 0; k < i; ++k)
-                propertyNames.add(a[k]->key);
-        }
-
-        return;
-    }
-
-    // Allocate a buffer to use to sort the keys.
-    Vector<PropertyMapEntry*, smallMapThreshold> sortedEnumerables(m_propertyTable->keyCount);
-
-    // Get pointers to the enumerable entries in the buffer.
-    PropertyMapEntry** p = sortedEnumerables.data();
-    unsigned entryCount = m_propertyTable->keyCount + m_propertyTable->deletedSentinelCount;
-    for (unsigned i = 1; i <= entryCount; i++) {
-        if (m_propertyTable->entries()[i].key && (!(m_propertyTable->entries()[i].attributes & DontEnum) || (mode == IncludeDontEnumProperties)))
-            *p++ = &m_propertyTable->entries()[i];
-    }
-
-    size_t enumerableCount = p - sortedEnumerables.data();
-    // Sort the entries by index.
-    qsort(sortedEnumerables.data(), enumerableCount, sizeof(PropertyMapEntry*), comparePropertyMapEntryIndices);
-    sortedEnumerables.resize(enumerableCount);
-
-    // Put the keys of the sorted entries into the list.
-    if (!propertyNames.size()) {
-        for (size_t i = 0; i < sortedEnumerables.size(); ++i)
-            propertyNames.addKnownUnique(sortedEnumerables[i]->key);
-    } else {
-        for (size_t i = 0; i < sortedEnumerables.size(); ++i)
-            propertyNames.add(sortedEnumerables[i]->key);
+    // The entries are already in the order their properties were added.
+    bool isFirst = !propertyNames.size();
+    unsigned entryCount = m_propertyTable->entryCount();
+    for (unsigned i = 1; i <= entryCount; ++i) {
+        PropertyMapEntry& entry = m_propertyTable->entries()[i];
+        ASSERT(m_hasNonEnumerableProperties || !(entry.attributes & DontEnum));
+        if (!entry.key || ((entry.attributes & DontEnum) && mode != IncludeDontEnumProperties))
+            continue;
+        if (isFirst)
+            propertyNames.addKnownUnique(entry.key);
+        else
+            propertyNames.add(entry.key);
     }
 }
 
@@ -1231,24 +1004,25 @@ void Structure::checkConsistency()
     ASSERT(m_propertyTable->keyCount <= m_propertyTable->size / 2);
     ASSERT(m_propertyTable->deletedSentinelCount <= m_propertyTable->size / 4);
 
-    ASSERT(m_propertyTable->keyCount + m_propertyTable->deletedSentinelCount <= m_propertyTable->size / 2);
+    ASSERT(m_propertyTable->entryCount() <= m_propertyTable->size / 2);
 
     unsigned indexCount = 0;
     unsigned deletedIndexCount = 0;
     for (unsigned a = 0; a != m_propertyTable->size; ++a) {
-        unsigned entryIndex = m_propertyTable->entryIndices[a];
-        if (entryIndex == emptyEntryIndex)
+        uint8_t control = m_propertyTable->control()[a];
+        if (control == PropertyMapHashTable::emptyControl)
             continue;
-        if (entryIndex == deletedSentinelIndex) {
+        if (control == PropertyMapHashTable::deletedControl) {
             ++deletedIndexCount;
             continue;
         }
-        ASSERT(entryIndex > deletedSentinelIndex);
-        ASSERT(entryIndex - 1 <= m_propertyTable->keyCount + m_propertyTable->deletedSentinelCount);
+        unsigned entryIndex = m_propertyTable->entryIndices()[a];
+        ASSERT(entryIndex && entryIndex <= m_propertyTable->entryCount());
+        ASSERT(control == (m_propertyTable->entries()[entryIndex].key->existingHash() & 0x7F));
         ++indexCount;
 
         for (unsigned b = a + 1; b != m_propertyTable->size; ++b)
-            ASSERT(m_propertyTable->entryIndices[b] != entryIndex);
+            ASSERT(m_propertyTable->control()[b] & 0x80 || m_propertyTable->entryIndices()[b] != entryIndex);
     }
     ASSERT(indexCount == m_propertyTable->keyCount);
     ASSERT(deletedIndexCount == m_propertyTable->deletedSentinelCount);
@@ -1256,26 +1030,16 @@ void Structure::checkConsistency()
     ASSERT(m_propertyTable->entries()[0].key == 0);
 
     unsigned nonEmptyEntryCount = 0;
-    for (unsigned c = 1; c <= m_propertyTable->keyCount + m_propertyTable->deletedSentinelCount; ++c) {
+    for (unsigned c = 1; c <= m_propertyTable->entryCount(); ++c) {
         ASSERT(m_hasNonEnumerableProperties || !(m_propertyTable->entries()[c].attributes & DontEnum));
         UString::Rep* rep = m_propertyTable->entries()[c].key;
-        ASSERT(m_propertyTable->entries()[c].offset >= m_anonymousSlotCount);
         if (!rep)
             continue;
+        ASSERT(m_propertyTable->entries()[c].offset >= m_anonymousSlotCount);
         ++nonEmptyEntryCount;
-        unsigned i = rep->existingHash();
-        unsigned k = 0;
-        unsigned entryIndex;
-        while (1) {
-            entryIndex = m_propertyTable->entryIndices[i & m_propertyTable->sizeMask];
-            ASSERT(entryIndex != emptyEntryIndex);
-            if (rep == m_propertyTable->entries()[entryIndex - 1].key)
-                break;
-            if (k == 0)
-                k = 1 | doubleHash(rep->existingHash());
-            i += k;
-        }
-        ASSERT(entryIndex == c + 1);
+        unsigned slot = m_propertyTable->findSlot(rep);
+        ASSERT(slot != PropertyMapHashTable::notFound);
+        ASSERT(m_propertyTable->entryIndices()[slot] == c);
     }
 
     ASSERT(nonEmptyEntryCount == m_propertyTable->keyCount);
@@ -54,8 +54,8 @@ limitations under the License.
 #include "AJTypeInfo.h"
 #include "UString.h"
 #include "WeakGCPtr.h"
+#include <wtf/Noncopyable.h>
 #include <wtf/PassRefPtr.h>
-#include <wtf/RefCounted.h>
 
 #ifndef NDEBUG
 #define DUMP_PROPERTYMAP_STATS 0
@@ -65,6 +65,7 @@ limitations under the License.
 
 namespace AJ {
 
+    class Heap;
     class MarkStack;
     class PropertyNameArray;
     class PropertyNameArrayData;
@@ -74,8 +75,13 @@ namespace AJ {
         IncludeDontEnumProperties
     };
 
-    class Structure : public RefCounted<Structure> {
+    // A Structure used by a cell belongs to that cell's heap. Cells do not
+    // count their references to it; only references from outside the heap
+    // do. Once those are gone, the collector frees the Structure when it
+    // finds no cell using it (see Heap::sweepStructures).
+    class Structure : public Noncopyable {
     public:
+        friend class Heap;
         friend class JIT;
         friend class StructureTransitionTable;
         static PassRefPtr<Structure> create(AJValue prototype, const TypeInfo& typeInfo, unsigned anonymousSlotCount)
@@ -101,6 +107,23 @@ namespace AJ {
 
         ~Structure();
 
+        void ref() { ++m_refCount; }
+        void deref()
+        {
+            ASSERT(m_refCount > 0);
+            if (!--m_refCount && !m_heap)
+                delete this;
+        }
+        bool hasOneRef() const { return m_refCount == 1; }
+        int refCount() const { return m_refCount; }
+
+        // 0 until a cell uses this Structure.
+        Heap* heap() const { return m_heap; }
+        // Called for every cell found to use this Structure, and every cell
+        // that starts using it, between major collections.
+        void mark() { m_isMarked = true; }
+        bool isMarked() const { return m_isMarked; }
+
         // These should be used with caution.  
         size_t addPropertyWithoutTransition(const Identifier& propertyName, unsigned attributes, AJCell* specificValue);
         size_t removePropertyWithoutTransition(const Identifier& propertyName);
@@ -119,6 +142,9 @@ namespace AJ {
 
         void growPropertyStorageCapacity();
         unsigned propertyStorageCapacity() const { return m_propertyStorageCapacity; }
+        // How many slots objects with this Structure have inline. Kept by
+        // every transition.
+        unsigned inlineStorageCapacity() const { return m_inlineStorageCapacity; }
         unsigned propertyStorageSize() const { return m_anonymousSlotCount + (m_propertyTable ? m_propertyTable->keyCount + (m_propertyTable->deletedOffsets ? m_propertyTable->deletedOffsets->size() : 0) : static_cast<unsigned>(m_offset + 1)); }
         bool isUsingInlineStorage() const;
 
@@ -156,7 +182,22 @@ namespace AJ {
         void clearEnumerationCache(AJPropertyNameIterator* enumerationCache); // Defined in AJPropertyNameIterator.h.
         AJPropertyNameIterator* enumerationCache(); // Defined in AJPropertyNameIterator.h.
         void getPropertyNames(PropertyNameArray&, EnumerationMode mode);
-        
+
+        // Slack tracking. Constructors start their objects with the prototype's
+        // inheritorID Structure, which counts down the first few constructions.
+        // Meanwhile, it records the most storage any Structure transitioned
+        // to from it has needed. Afterwards, the prototype switches to a
+        // Structure with that many slots inline.
+        bool isTrackingSlack() const { return m_slackTrackingCountdown; }
+        // Returns true once the countdown has finished.
+        bool didConstructWhileTrackingSlack()
+        {
+            ASSERT(isTrackingSlack());
+            return !--m_slackTrackingCountdown;
+        }
+        unsigned largestTransitionStorageSize() const { return m_largestTransitionStorageSize; }
+        static PassRefPtr<Structure> createWithInlineStorage(Structure*, unsigned inlineStorageCapacity);
+
     private:
 
         Structure(AJValue prototype, const TypeInfo&, unsigned anonymousSlotCount);
@@ -213,14 +254,18 @@ namespace AJ {
         
         bool isValid(ExecState*, StructureChain* cachedPrototypeChain) const;
 
-        static const unsigned emptyEntryIndex = 0;
-    
         static const signed char s_maxTransitionLength = 64;
 
         static const signed char noOffset = -1;
 
         static const unsigned maxSpecificFunctionThrashCount = 3;
 
+        static const unsigned slackTrackingConstructionCount = 8;
+
+        int m_refCount;
+        Heap* m_heap;
+        Structure* m_nextInHeap;
+
         TypeInfo m_typeInfo;
 
         AJValue m_prototype;
@@ -241,10 +286,14 @@ namespace AJ {
         PropertyMapHashTable* m_propertyTable;
 
         uint32_t m_propertyStorageCapacity;
+        uint32_t m_inlineStorageCapacity;
 
         // m_offset does not account for anonymous slots
         signed char m_offset;
 
+        // At most AJObject::maxInlineStorageCapacity().
+        unsigned char m_largestTransitionStorageSize;
+
         unsigned m_dictionaryKind : 2;
         bool m_isPinnedPropertyTable : 1;
         bool m_hasGetterSetterProperties : 1;
@@ -260,7 +309,10 @@ namespace AJ {
         unsigned m_specificFunctionThrashCount : 2;
         unsigned m_anonymousSlotCount : 5;
         unsigned m_isUsingSingleSlot : 1;
-        // 4 free bits
+        unsigned m_slackTrackingCountdown : 4;
+        // A whole word, since parallel markers set it without synchronizing,
+        // and JIT code stores to it.
+        uint32_t m_isMarked;
     };
 
     inline size_t Structure::get(const Identifier& propertyName)
@@ -271,41 +323,8 @@ namespace AJ {
         if (!m_propertyTable)
             return ATF::notFound;
 
-        UString::Rep* rep = propertyName._ustring.rep();
-
-        unsigned i = rep->existingHash();
-
-#if DUMP_PROPERTYMAP_STATS
-        ++numProbes;
-#endif
-
-        unsigned entryIndex = m_propertyTable->entryIndices[i & m_propertyTable->sizeMask];
-        if (entryIndex == emptyEntryIndex)
-            return ATF::notFound;
-
-        if (rep == m_propertyTable->entries()[entryIndex - 1].key)
-            return m_propertyTable->entries()[entryIndex - 1].offset;
-
-#if DUMP_PROPERTYMAP_STATS
-        ++numCollisions;
-#endif
-
-        unsigned k = 1 | ATF::doubleHash(rep->existingHash());
-
-        while (1) {
-            i += k;
-
-#if DUMP_PROPERTYMAP_STATS
-            ++numRehashes;
-#endif
-
-            entryIndex = m_propertyTable->entryIndices[i & m_propertyTable->sizeMask];
-            if (entryIndex == emptyEntryIndex)
-                return ATF::notFound;
-
-            if (rep == m_propertyTable->entries()[entryIndex - 1].key)
-                return m_propertyTable->entries()[entryIndex - 1].offset;
-        }
+        PropertyMapEntry* entry = m_propertyTable->find(propertyName._ustring.rep());
+        return entry ? entry->offset : ATF::notFound;
     }
 
 } // namespace AJ
@@ -0,0 +1,131 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "config.h"
+#include "TypedArrayConstructor.h"
+
+#include "AJGlobalObject.h"
+#include "Error.h"
+#include "TypedArrayPrototype.h"
+#include <limits>
+
+namespace AJ {
+
+ASSERT_CLASS_FITS_IN_CELL(TypedArrayConstructor);
+
+TypedArrayConstructor::TypedArrayConstructor(ExecState* exec, NonNullPassRefPtr<Structure> structure, TypedArrayPrototype* typedArrayPrototype, AJTypedArray::Type type)
+    : InternalFunction(&exec->globalData(), structure, Identifier(exec, AJTypedArray::classInfo(type)->className))
+    , m_type(type)
+{
+    putDirectWithoutTransition(exec->propertyNames().prototype, typedArrayPrototype, DontEnum | DontDelete | ReadOnly);
+    putDirectWithoutTransition(exec->propertyNames().BYTES_PER_ELEMENT, jsNumber(exec, AJTypedArray::elementSize(type)), ReadOnly | DontDelete | DontEnum);
+
+    // no. of arguments for constructor
+    putDirectWithoutTransition(exec->propertyNames().length, jsNumber(exec, 3), ReadOnly | DontDelete | DontEnum);
+}
+
+// new XArray(length), new XArray(array or other view), or
+// new XArray(buffer [, byteOffset [, length]]).
+static AJObject* constructTypedArray(ExecState* exec, AJTypedArray::Type type, const ArgList& args)
+{
+    const unsigned elementSize = AJTypedArray::elementSize(type);
+    const double maxByteLength = std::numeric_limits<int32_t>::max();
+    AJValue first = args.at(0);
+
+    if (first.inherits(&AJArrayBuffer::info)) {
+        AJArrayBuffer* buffer = asArrayBuffer(first);
+        double byteOffset = args.at(1).toInteger(exec);
+        if (exec->hadException())
+            return 0;
+        if (byteOffset < 0 || byteOffset > buffer->byteLength())
+            return throwError(exec, RangeError, "Start offset is outside the bounds of the buffer.");
+        if (static_cast<unsigned>(byteOffset) % elementSize)
+            return throwError(exec, RangeError, "Start offset is not a multiple of the element size.");
+
+        unsigned available = buffer->byteLength() - static_cast<unsigned>(byteOffset);
+        unsigned length;
+        if (args.at(2).isUndefined()) {
+            if (available % elementSize)
+                return throwError(exec, RangeError, "Buffer length minus the start offset is not a multiple of the element size.");
+            length = available / elementSize;
+        } else {
+            double requestedLength = args.at(2).toInteger(exec);
+            if (exec->hadException())
+                return 0;
+            if (requestedLength < 0 || requestedLength > available / elementSize)
+                return throwError(exec, RangeError, "Length is outside the bounds of the buffer.");
+            length = static_cast<unsigned>(requestedLength);
+        }
+        return AJTypedArray::create(exec, type, buffer, static_cast<unsigned>(byteOffset), length);
+    }
+
+    if (first.isObject()) {
+        AJObject* source = asObject(first);
+        unsigned length;
+        if (source->inherits(&AJTypedArray::info))
+            length = asTypedArray(source)->length();
+        else {
+            length = source->get(exec, exec->propertyNames().length).toUInt32(exec);
+            if (exec->hadException())
+                return 0;
+        }
+        if (length > maxByteLength / elementSize)
+            return throwError(exec, RangeError, "Invalid typed array length.");
+        AJArrayBuffer* buffer = AJArrayBuffer::create(exec, length * elementSize);
+        if (!buffer)
+            return 0;
+        AJTypedArray* array = AJTypedArray::create(exec, type, buffer, 0, length);
+        array->set(exec, source, length, 0);
+        if (exec->hadException())
+            return 0;
+        return array;
+    }
+
+    double length = first.toInteger(exec);
+    if (exec->hadException())
+        return 0;
+    if (length < 0 || length > maxByteLength / elementSize)
+        return throwError(exec, RangeError, "Invalid typed array length.");
+    AJArrayBuffer* buffer = AJArrayBuffer::create(exec, static_cast<unsigned>(length) * elementSize);
+    if (!buffer)
+        return 0;
+    return AJTypedArray::create(exec, type, buffer, 0, static_cast<unsigned>(length));
+}
+
+static AJObject* constructWithTypedArrayConstructor(ExecState* exec, AJObject* constructor, const ArgList& args)
+{
+    return constructTypedArray(exec, static_cast<TypedArrayConstructor*>(constructor)->arrayType(), args);
+}
+
+ConstructType TypedArrayConstructor::getConstructData(ConstructData& constructData)
+{
+    constructData.native.function = constructWithTypedArrayConstructor;
+    return ConstructTypeHost;
+}
+
+static AJValue JSC_HOST_CALL callTypedArrayConstructor(ExecState* exec, AJObject*, AJValue, const ArgList&)
+{
+    return throwError(exec, TypeError, "Typed array constructors require 'new'.");
+}
+
+CallType TypedArrayConstructor::getCallData(CallData& callData)
+{
+    callData.native.function = callTypedArrayConstructor;
+    return CallTypeHost;
+}
+
+} // namespace AJ
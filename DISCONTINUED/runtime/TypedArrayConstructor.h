@@ -0,0 +1,44 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef TypedArrayConstructor_h
+#define TypedArrayConstructor_h
+
+#include "AJTypedArray.h"
+#include "InternalFunction.h"
+
+namespace AJ {
+
+    class TypedArrayPrototype;
+
+    // The constructor for one type of view: Int8Array, Float32Array, etc.
+    class TypedArrayConstructor : public InternalFunction {
+    public:
+        TypedArrayConstructor(ExecState*, NonNullPassRefPtr<Structure>, TypedArrayPrototype*, AJTypedArray::Type);
+
+        AJTypedArray::Type arrayType() const { return m_type; }
+
+    private:
+        virtual ConstructType getConstructData(ConstructData&);
+        virtual CallType getCallData(CallData&);
+
+        AJTypedArray::Type m_type;
+    };
+
+} // namespace AJ
+
+#endif // TypedArrayConstructor_h
@@ -0,0 +1,104 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "config.h"
+#include "TypedArrayPrototype.h"
+
+#include "AJGlobalObject.h"
+#include "Error.h"
+#include "PrototypeFunction.h"
+#include <algorithm>
+
+namespace AJ {
+
+ASSERT_CLASS_FITS_IN_CELL(TypedArrayPrototype);
+
+static AJValue JSC_HOST_CALL typedArrayProtoFuncSet(ExecState*, AJObject*, AJValue, const ArgList&);
+static AJValue JSC_HOST_CALL typedArrayProtoFuncSubarray(ExecState*, AJObject*, AJValue, const ArgList&);
+
+TypedArrayPrototype::TypedArrayPrototype(ExecState* exec, NonNullPassRefPtr<Structure> structure, Structure* prototypeFunctionStructure, AJTypedArray::Type type)
+    : AJObject(structure)
+{
+    putDirectWithoutTransition(exec->propertyNames().BYTES_PER_ELEMENT, jsNumber(exec, AJTypedArray::elementSize(type)), ReadOnly | DontDelete | DontEnum);
+
+    putDirectFunctionWithoutTransition(exec, new (exec) NativeFunctionWrapper(exec, prototypeFunctionStructure, 2, exec->propertyNames().set, typedArrayProtoFuncSet), DontEnum);
+    putDirectFunctionWithoutTransition(exec, new (exec) NativeFunctionWrapper(exec, prototypeFunctionStructure, 2, Identifier(exec, "subarray"), typedArrayProtoFuncSubarray), DontEnum);
+}
+
+// ------------------------------ Functions --------------------------
+
+AJValue JSC_HOST_CALL typedArrayProtoFuncSet(ExecState* exec, AJObject*, AJValue thisValue, const ArgList& args)
+{
+    if (!thisValue.inherits(&AJTypedArray::info))
+        return throwError(exec, TypeError);
+    AJTypedArray* array = asTypedArray(thisValue);
+
+    if (!args.at(0).isObject())
+        return throwError(exec, TypeError, "The source of a typed array set must be an array or a typed array.");
+    AJObject* source = asObject(args.at(0));
+
+    double offset = args.at(1).toInteger(exec);
+    if (exec->hadException())
+        return jsUndefined();
+    if (offset < 0 || offset > array->length())
+        return throwError(exec, RangeError, "Offset is outside the bounds of the array.");
+
+    unsigned length;
+    if (source->inherits(&AJTypedArray::info))
+        length = asTypedArray(source)->length();
+    else {
+        length = source->get(exec, exec->propertyNames().length).toUInt32(exec);
+        if (exec->hadException())
+            return jsUndefined();
+    }
+    if (length > array->length() - static_cast<unsigned>(offset))
+        return throwError(exec, RangeError, "Source is too large.");
+
+    array->set(exec, source, length, static_cast<unsigned>(offset));
+    return jsUndefined();
+}
+
+AJValue JSC_HOST_CALL typedArrayProtoFuncSubarray(ExecState* exec, AJObject*, AJValue thisValue, const ArgList& args)
+{
+    if (!thisValue.inherits(&AJTypedArray::info))
+        return throwError(exec, TypeError);
+    AJTypedArray* array = asTypedArray(thisValue);
+
+    // Negative positions count back from the end.
+    double length = array->length();
+    double begin = args.at(0).toInteger(exec);
+    if (begin < 0)
+        begin = std::max(begin + length, 0.0);
+    else
+        begin = std::min(begin, length);
+    double end = length;
+    if (!args.at(1).isUndefined()) {
+        end = args.at(1).toInteger(exec);
+        if (end < 0)
+            end = std::max(end + length, 0.0);
+        else
+            end = std::min(end, length);
+    }
+    if (exec->hadException())
+        return jsUndefined();
+
+    unsigned subarrayLength = end > begin ? static_cast<unsigned>(end - begin) : 0;
+    unsigned byteOffset = array->byteOffset() + static_cast<unsigned>(begin) * AJTypedArray::elementSize(array->type());
+    return AJTypedArray::create(exec, array->type(), array->buffer(), byteOffset, subarrayLength);
+}
+
+} // namespace AJ
@@ -0,0 +1,34 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef TypedArrayPrototype_h
+#define TypedArrayPrototype_h
+
+#include "AJTypedArray.h"
+
+namespace AJ {
+
+    // The prototype for one type of view. The functions on it work on views
+    // of any type.
+    class TypedArrayPrototype : public AJObject {
+    public:
+        TypedArrayPrototype(ExecState*, NonNullPassRefPtr<Structure>, Structure* prototypeFunctionStructure, AJTypedArray::Type);
+    };
+
+} // namespace AJ
+
+#endif // TypedArrayPrototype_h
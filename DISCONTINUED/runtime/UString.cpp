@@ -58,6 +58,7 @@ limitations under the License.
 #include <wtf/MathExtras.h>
 #include <wtf/StringExtras.h>
 #include <wtf/Vector.h>
+#include <wtf/text/StringSearch.h>
 #include <wtf/unicode/UTF8.h>
 #include <wtf/StringExtras.h>
 
@@ -103,9 +104,9 @@ UString::UString(const UChar* c, unsigned length)
 
 UString UString::from(int i)
 {
-    UChar buf[1 + sizeof(i) * 3];
-    UChar* end = buf + sizeof(buf) / sizeof(UChar);
-    UChar* p = end;
+    char buf[1 + sizeof(i) * 3];
+    char* end = buf + sizeof(buf);
+    char* p = end;
 
     if (i == 0)
         *--p = '0';
@@ -120,7 +121,7 @@ UString UString::from(int i)
             i = -i;
         }
         while (i) {
-            *--p = static_cast<unsigned short>((i % 10) + '0');
+            *--p = static_cast<char>((i % 10) + '0');
             i /= 10;
         }
         if (negative)
@@ -132,9 +133,9 @@ UString UString::from(int i)
 
 UString UString::from(long long i)
 {
-    UChar buf[1 + sizeof(i) * 3];
-    UChar* end = buf + sizeof(buf) / sizeof(UChar);
-    UChar* p = end;
+    char buf[1 + sizeof(i) * 3];
+    char* end = buf + sizeof(buf);
+    char* p = end;
 
     if (i == 0)
         *--p = '0';
@@ -149,7 +150,7 @@ UString UString::from(long long i)
             i = -i;
         }
         while (i) {
-            *--p = static_cast<unsigned short>((i % 10) + '0');
+            *--p = static_cast<char>((i % 10) + '0');
             i /= 10;
         }
         if (negative)
@@ -161,15 +162,15 @@ UString UString::from(long long i)
 
 UString UString::from(unsigned u)
 {
-    UChar buf[sizeof(u) * 3];
-    UChar* end = buf + sizeof(buf) / sizeof(UChar);
-    UChar* p = end;
+    char buf[sizeof(u) * 3];
+    char* end = buf + sizeof(buf);
+    char* p = end;
 
     if (u == 0)
         *--p = '0';
     else {
         while (u) {
-            *--p = static_cast<unsigned short>((u % 10) + '0');
+            *--p = static_cast<char>((u % 10) + '0');
             u /= 10;
         }
     }
@@ -179,9 +180,9 @@ UString UString::from(unsigned u)
 
 UString UString::from(long l)
 {
-    UChar buf[1 + sizeof(l) * 3];
-    UChar* end = buf + sizeof(buf) / sizeof(UChar);
-    UChar* p = end;
+    char buf[1 + sizeof(l) * 3];
+    char* end = buf + sizeof(buf);
+    char* p = end;
 
     if (l == 0)
         *--p = '0';
@@ -196,7 +197,7 @@ UString UString::from(long l)
             l = -l;
         }
         while (l) {
-            *--p = static_cast<unsigned short>((l % 10) + '0');
+            *--p = static_cast<char>((l % 10) + '0');
             l /= 10;
         }
         if (negative)
@@ -236,30 +237,17 @@ char* UString::ascii() const
     return asciiBuffer;
 }
 
-bool UString::is8Bit() const
-{
-    const UChar* u = data();
-    const UChar* limit = u + size();
-    while (u < limit) {
-        if (u[0] > 0xFF)
-            return false;
-        ++u;
-    }
-
-    return true;
-}
-
 UChar UString::operator[](unsigned pos) const
 {
     if (pos >= size())
         return '\0';
-    return data()[pos];
+    return (*m_rep)[pos];
 }
 
 double UString::toDouble(bool tolerateTrailingJunk, bool tolerateEmptyString) const
 {
     if (size() == 1) {
-        UChar c = data()[0];
+        UChar c = (*m_rep)[0];
         if (isASCIIDigit(c))
             return c - '0';
         if (isASCIISpace(c) && tolerateEmptyString)
@@ -388,16 +376,15 @@ uint32_t UString::toUInt32(bool* ok, bool tolerateEmptyString) const
     return static_cast<uint32_t>(d);
 }
 
-uint32_t UString::toStrictUInt32(bool* ok) const
+template<typename CharType>
+static inline uint32_t toStrictUInt32(const CharType* p, unsigned len, bool* ok)
 {
     if (ok)
         *ok = false;
 
     // Empty string is not OK.
-    unsigned len = m_rep->length();
     if (len == 0)
         return 0;
-    const UChar* p = m_rep->characters();
     unsigned short c = p[0];
 
     // If the first digit is 0, only 0 itself is OK.
@@ -438,47 +425,78 @@ uint32_t UString::toStrictUInt32(bool* ok) const
     }
 }
 
+uint32_t UString::toStrictUInt32(bool* ok) const
+{
+    if (m_rep->is8Bit())
+        return AJ::toStrictUInt32(m_rep->characters8(), m_rep->length(), ok);
+    return AJ::toStrictUInt32(m_rep->characters16(), m_rep->length(), ok);
+}
+
+static inline unsigned toUStringPosition(size_t position)
+{
+    return position == notFound ? UString::NotFound : static_cast<unsigned>(position);
+}
+
+// Brings the characters to match to the width of the characters searched,
+// which fails when 16-bit ones cannot occur in an 8-bit string.
+static inline bool narrowMatch(const UString& match, Vector<LChar, 64>& buffer)
+{
+    const UChar* characters = match.rep()->characters16();
+    unsigned length = match.size();
+    buffer.resize(length);
+    for (unsigned i = 0; i < length; ++i) {
+        if (characters[i] > 0xFF)
+            return false;
+        buffer[i] = static_cast<LChar>(characters[i]);
+    }
+    return true;
+}
+
+static inline void widenMatch(const UString& match, Vector<UChar, 64>& buffer)
+{
+    const LChar* characters = match.rep()->characters8();
+    unsigned length = match.size();
+    buffer.resize(length);
+    for (unsigned i = 0; i < length; ++i)
+        buffer[i] = characters[i];
+}
+
 unsigned UString::find(const UString& f, unsigned pos) const
 {
     unsigned fsz = f.size();
 
-    if (fsz == 1) {
-        UChar ch = f[0];
-        const UChar* end = data() + size();
-        for (const UChar* c = data() + pos; c < end; c++) {
-            if (*c == ch)
-                return static_cast<unsigned>(c - data());
-        }
-        return NotFound;
-    }
+    if (fsz == 1)
+        return find(f[0], pos);
 
     unsigned sz = size();
     if (sz < fsz)
         return NotFound;
     if (fsz == 0)
         return pos;
-    const UChar* end = data() + sz - fsz;
-    unsigned fsizeminusone = (fsz - 1) * sizeof(UChar);
-    const UChar* fdata = f.data();
-    unsigned short fchar = fdata[0];
-    ++fdata;
-    for (const UChar* c = data() + pos; c <= end; c++) {
-        if (c[0] == fchar && !memcmp(c + 1, fdata, fsizeminusone))
-            return static_cast<unsigned>(c - data());
+    if (is8Bit()) {
+        if (f.is8Bit())
+            return toUStringPosition(findSubstring(m_rep->characters8(), sz, f.rep()->characters8(), fsz, pos));
+        Vector<LChar, 64> match;
+        if (!narrowMatch(f, match))
+            return NotFound;
+        return toUStringPosition(findSubstring(m_rep->characters8(), sz, match.data(), fsz, pos));
     }
-
-    return NotFound;
+    if (f.is8Bit()) {
+        Vector<UChar, 64> match;
+        widenMatch(f, match);
+        return toUStringPosition(findSubstring(m_rep->characters16(), sz, match.data(), fsz, pos));
+    }
+    return toUStringPosition(findSubstring(m_rep->characters16(), sz, f.rep()->characters16(), fsz, pos));
 }
 
 unsigned UString::find(UChar ch, unsigned pos) const
 {
-    const UChar* end = data() + size();
-    for (const UChar* c = data() + pos; c < end; c++) {
-        if (*c == ch)
-            return static_cast<unsigned>(c - data());
+    if (is8Bit()) {
+        if (ch > 0xFF)
+            return NotFound;
+        return toUStringPosition(findCharacter(m_rep->characters8(), size(), static_cast<LChar>(ch), pos));
     }
-
-    return NotFound;
+    return toUStringPosition(findCharacter(m_rep->characters16(), size(), ch, pos));
 }
 
 unsigned UString::rfind(const UString& f, unsigned pos) const
@@ -491,14 +509,22 @@ unsigned UString::rfind(const UString& f, unsigned pos) const
         pos = sz - fsz;
     if (fsz == 0)
         return pos;
-    unsigned fsizeminusone = (fsz - 1) * sizeof(UChar);
-    const UChar* fdata = f.data();
-    for (const UChar* c = data() + pos; c >= data(); c--) {
-        if (*c == *fdata && !memcmp(c + 1, fdata + 1, fsizeminusone))
-            return static_cast<unsigned>(c - data());
+    if (fsz == 1)
+        return rfind(f[0], pos);
+    if (is8Bit()) {
+        if (f.is8Bit())
+            return toUStringPosition(reverseFindSubstring(m_rep->characters8(), f.rep()->characters8(), fsz, pos));
+        Vector<LChar, 64> match;
+        if (!narrowMatch(f, match))
+            return NotFound;
+        return toUStringPosition(reverseFindSubstring(m_rep->characters8(), match.data(), fsz, pos));
     }
-
-    return NotFound;
+    if (f.is8Bit()) {
+        Vector<UChar, 64> match;
+        widenMatch(f, match);
+        return toUStringPosition(reverseFindSubstring(m_rep->characters16(), match.data(), fsz, pos));
+    }
+    return toUStringPosition(reverseFindSubstring(m_rep->characters16(), f.rep()->characters16(), fsz, pos));
 }
 
 unsigned UString::rfind(UChar ch, unsigned pos) const
@@ -507,12 +533,12 @@ unsigned UString::rfind(UChar ch, unsigned pos) const
         return NotFound;
     if (pos + 1 >= size())
         pos = size() - 1;
-    for (const UChar* c = data() + pos; c >= data(); c--) {
-        if (*c == ch)
-            return static_cast<unsigned>(c - data());
+    if (is8Bit()) {
+        if (ch > 0xFF)
+            return NotFound;
+        return toUStringPosition(reverseFindCharacter(m_rep->characters8(), static_cast<LChar>(ch), pos));
     }
-
-    return NotFound;
+    return toUStringPosition(reverseFindCharacter(m_rep->characters16(), ch, pos));
 }
 
 UString UString::substr(unsigned pos, unsigned len) const
@@ -535,78 +561,52 @@ bool operator==(const UString& s1, const char *s2)
 {
     if (s2 == 0)
         return s1.isEmpty();
+    if (s1.isNull())
+        return !*s2;
 
-    const UChar* u = s1.data();
-    const UChar* uend = u + s1.size();
-    while (u != uend && *s2) {
-        if (u[0] != (unsigned char)*s2)
-            return false;
-        s2++;
-        u++;
-    }
-
-    return u == uend && *s2 == 0;
+    return ::equal(s1.rep(), s2);
 }
 
-bool operator<(const UString& s1, const UString& s2)
+template<typename CharType1, typename CharType2>
+static inline int compareCharacters(const CharType1* c1, unsigned l1, const CharType2* c2, unsigned l2)
 {
-    const unsigned l1 = s1.size();
-    const unsigned l2 = s2.size();
     const unsigned lmin = l1 < l2 ? l1 : l2;
-    const UChar* c1 = s1.data();
-    const UChar* c2 = s2.data();
     unsigned l = 0;
     while (l < lmin && *c1 == *c2) {
         c1++;
         c2++;
         l++;
     }
-    if (l < lmin)
-        return (c1[0] < c2[0]);
 
-    return (l1 < l2);
-}
-
-bool operator>(const UString& s1, const UString& s2)
-{
-    const unsigned l1 = s1.size();
-    const unsigned l2 = s2.size();
-    const unsigned lmin = l1 < l2 ? l1 : l2;
-    const UChar* c1 = s1.data();
-    const UChar* c2 = s2.data();
-    unsigned l = 0;
-    while (l < lmin && *c1 == *c2) {
-        c1++;
-        c2++;
-        l++;
-    }
     if (l < lmin)
-        return (c1[0] > c2[0]);
+        return (c1[0] > c2[0]) ? 1 : -1;
+
+    if (l1 == l2)
+        return 0;
 
-    return (l1 > l2);
+    return (l1 > l2) ? 1 : -1;
 }
 
 int compare(const UString& s1, const UString& s2)
 {
-    const unsigned l1 = s1.size();
-    const unsigned l2 = s2.size();
-    const unsigned lmin = l1 < l2 ? l1 : l2;
-    const UChar* c1 = s1.data();
-    const UChar* c2 = s2.data();
-    unsigned l = 0;
-    while (l < lmin && *c1 == *c2) {
-        c1++;
-        c2++;
-        l++;
+    if (s1.is8Bit()) {
+        if (s2.is8Bit())
+            return compareCharacters(s1.rep()->characters8(), s1.size(), s2.rep()->characters8(), s2.size());
+        return compareCharacters(s1.rep()->characters8(), s1.size(), s2.data(), s2.size());
     }
+    if (s2.is8Bit())
+        return compareCharacters(s1.data(), s1.size(), s2.rep()->characters8(), s2.size());
+    return compareCharacters(s1.data(), s1.size(), s2.data(), s2.size());
+}
 
-    if (l < lmin)
-        return (c1[0] > c2[0]) ? 1 : -1;
-
-    if (l1 == l2)
-        return 0;
+bool operator<(const UString& s1, const UString& s2)
+{
+    return compare(s1, s2) < 0;
+}
 
-    return (l1 > l2) ? 1 : -1;
+bool operator>(const UString& s1, const UString& s2)
+{
+    return compare(s1, s2) > 0;
 }
 
 CString UString::UTF8String(bool strict) const
@@ -619,6 +619,19 @@ CString UString::UTF8String(bool strict) const
 
     // Convert to runs of 8-bit characters.
     char* p = buffer.data();
+    if (is8Bit()) {
+        const LChar* characters = m_rep->characters8();
+        for (unsigned i = 0; i < length; ++i) {
+            LChar c = characters[i];
+            if (c < 0x80)
+                *p++ = c;
+            else {
+                *p++ = static_cast<char>(0xC0 | (c >> 6));
+                *p++ = static_cast<char>(0x80 | (c & 0x3F));
+            }
+        }
+        return CString(buffer.data(), p - buffer.data());
+    }
     const UChar* d = reinterpret_cast<const UChar*>(&data()[0]);
     ConversionResult result = convertUTF16ToUTF8(&d, d + length, &p, p + buffer.size(), strict);
     if (result != conversionOK)
@@ -125,7 +125,8 @@ namespace AJ {
         bool isNull() const { return !m_rep; }
         bool isEmpty() const { return !m_rep || !m_rep->length(); }
 
-        bool is8Bit() const;
+        // True if the characters are held as Latin-1; see characters8().
+        bool is8Bit() const { return m_rep && m_rep->is8Bit(); }
 
         UChar operator[](unsigned pos) const;
 
@@ -172,6 +173,23 @@ namespace AJ {
         friend bool operator==(const UString&, const UString&);
     };
 
+    template<typename CharType>
+    ALWAYS_INLINE bool equalCharacters(const CharType* d1, const CharType* d2, unsigned size)
+    {
+        if (d1 == d2) // Check to see if the data pointers are the same.
+            return true;
+        
+        // Do quick checks for sizes 1 and 2.
+        switch (size) {
+        case 1:
+            return d1[0] == d2[0];
+        case 2:
+            return (d1[0] == d2[0]) & (d1[1] == d2[1]);
+        default:
+            return memcmp(d1, d2, size * sizeof(CharType)) == 0;
+        }
+    }
+
     ALWAYS_INLINE bool operator==(const UString& s1, const UString& s2)
     {
         UString::Rep* rep1 = s1.rep();
@@ -197,21 +215,11 @@ namespace AJ {
         // At this point we know 
         //   (a) that the strings are the same length and
         //   (b) that they are greater than zero length.
-        const UChar* d1 = rep1->characters();
-        const UChar* d2 = rep2->characters();
-        
-        if (d1 == d2) // Check to see if the data pointers are the same.
-            return true;
-        
-        // Do quick checks for sizes 1 and 2.
-        switch (size1) {
-        case 1:
-            return d1[0] == d2[0];
-        case 2:
-            return (d1[0] == d2[0]) & (d1[1] == d2[1]);
-        default:
-            return memcmp(d1, d2, size1 * sizeof(UChar)) == 0;
-        }
+        if (rep1->is8Bit() != rep2->is8Bit())
+            return ::equal(rep1, rep2);
+        if (rep1->is8Bit())
+            return equalCharacters(rep1->characters8(), rep2->characters8(), size1);
+        return equalCharacters(rep1->characters16(), rep2->characters16(), size1);
     }
 
 
@@ -279,6 +287,13 @@ namespace AJ {
 
         unsigned length() { return m_length; }
 
+        bool is8Bit() { return true; }
+
+        void writeTo(LChar* destination)
+        {
+            memcpy(destination, m_buffer, m_length);
+        }
+
         void writeTo(UChar* destination)
         {
             for (unsigned i = 0; i < m_length; ++i)
@@ -301,6 +316,13 @@ namespace AJ {
 
         unsigned length() { return m_length; }
 
+        bool is8Bit() { return true; }
+
+        void writeTo(LChar* destination)
+        {
+            memcpy(destination, m_buffer, m_length);
+        }
+
         void writeTo(UChar* destination)
         {
             for (unsigned i = 0; i < m_length; ++i)
@@ -316,21 +338,33 @@ namespace AJ {
     class StringTypeAdapter<UString> {
     public:
         StringTypeAdapter<UString>(UString& string)
-            : m_data(string.data())
+            : m_string(string)
             , m_length(string.size())
         {
         }
 
         unsigned length() { return m_length; }
 
+        bool is8Bit() { return !m_length || m_string.is8Bit(); }
+
+        void writeTo(LChar* destination)
+        {
+            if (m_length)
+                UStringImpl::copyChars(destination, m_string.rep()->characters8(), m_length);
+        }
+
         void writeTo(UChar* destination)
         {
-            for (unsigned i = 0; i < m_length; ++i)
-                destination[i] = m_data[i];
+            if (!m_length)
+                return;
+            if (m_string.is8Bit())
+                UStringImpl::copyChars(destination, m_string.rep()->characters8(), m_length);
+            else
+                UStringImpl::copyChars(destination, m_string.rep()->characters16(), m_length);
         }
 
     private:
-        const UChar* m_data;
+        const UString& m_string;
         unsigned m_length;
     };
 
@@ -354,6 +388,21 @@ namespace AJ {
         sumWithOverflow(length, adapter2.length(), overflow);
         if (overflow)
             return 0;
+
+        if (adapter1.is8Bit() && adapter2.is8Bit()) {
+            LChar* buffer8;
+            PassRefPtr<UStringImpl> resultImpl = UStringImpl::tryCreateUninitialized(length, buffer8);
+            if (!resultImpl)
+                return 0;
+
+            LChar* result = buffer8;
+            adapter1.writeTo(result);
+            result += adapter1.length();
+            adapter2.writeTo(result);
+
+            return resultImpl;
+        }
+
         PassRefPtr<UStringImpl> resultImpl = UStringImpl::tryCreateUninitialized(length, buffer);
         if (!resultImpl)
             return 0;
@@ -380,6 +429,23 @@ namespace AJ {
         sumWithOverflow(length, adapter3.length(), overflow);
         if (overflow)
             return 0;
+
+        if (adapter1.is8Bit() && adapter2.is8Bit() && adapter3.is8Bit()) {
+            LChar* buffer8;
+            PassRefPtr<UStringImpl> resultImpl = UStringImpl::tryCreateUninitialized(length, buffer8);
+            if (!resultImpl)
+                return 0;
+
+            LChar* result = buffer8;
+            adapter1.writeTo(result);
+            result += adapter1.length();
+            adapter2.writeTo(result);
+            result += adapter2.length();
+            adapter3.writeTo(result);
+
+            return resultImpl;
+        }
+
         PassRefPtr<UStringImpl> resultImpl = UStringImpl::tryCreateUninitialized(length, buffer);
         if (!resultImpl)
             return 0;
@@ -410,6 +476,25 @@ namespace AJ {
         sumWithOverflow(length, adapter4.length(), overflow);
         if (overflow)
             return 0;
+
+        if (adapter1.is8Bit() && adapter2.is8Bit() && adapter3.is8Bit() && adapter4.is8Bit()) {
+            LChar* buffer8;
+            PassRefPtr<UStringImpl> resultImpl = UStringImpl::tryCreateUninitialized(length, buffer8);
+            if (!resultImpl)
+                return 0;
+
+            LChar* result = buffer8;
+            adapter1.writeTo(result);
+            result += adapter1.length();
+            adapter2.writeTo(result);
+            result += adapter2.length();
+            adapter3.writeTo(result);
+            result += adapter3.length();
+            adapter4.writeTo(result);
+
+            return resultImpl;
+        }
+
         PassRefPtr<UStringImpl> resultImpl = UStringImpl::tryCreateUninitialized(length, buffer);
         if (!resultImpl)
             return 0;
@@ -444,6 +529,27 @@ namespace AJ {
         sumWithOverflow(length, adapter5.length(), overflow);
         if (overflow)
             return 0;
+
+        if (adapter1.is8Bit() && adapter2.is8Bit() && adapter3.is8Bit() && adapter4.is8Bit() && adapter5.is8Bit()) {
+            LChar* buffer8;
+            PassRefPtr<UStringImpl> resultImpl = UStringImpl::tryCreateUninitialized(length, buffer8);
+            if (!resultImpl)
+                return 0;
+
+            LChar* result = buffer8;
+            adapter1.writeTo(result);
+            result += adapter1.length();
+            adapter2.writeTo(result);
+            result += adapter2.length();
+            adapter3.writeTo(result);
+            result += adapter3.length();
+            adapter4.writeTo(result);
+            result += adapter4.length();
+            adapter5.writeTo(result);
+
+            return resultImpl;
+        }
+
         PassRefPtr<UStringImpl> resultImpl = UStringImpl::tryCreateUninitialized(length, buffer);
         if (!resultImpl)
             return 0;
@@ -482,6 +588,29 @@ namespace AJ {
         sumWithOverflow(length, adapter6.length(), overflow);
         if (overflow)
             return 0;
+
+        if (adapter1.is8Bit() && adapter2.is8Bit() && adapter3.is8Bit() && adapter4.is8Bit() && adapter5.is8Bit() && adapter6.is8Bit()) {
+            LChar* buffer8;
+            PassRefPtr<UStringImpl> resultImpl = UStringImpl::tryCreateUninitialized(length, buffer8);
+            if (!resultImpl)
+                return 0;
+
+            LChar* result = buffer8;
+            adapter1.writeTo(result);
+            result += adapter1.length();
+            adapter2.writeTo(result);
+            result += adapter2.length();
+            adapter3.writeTo(result);
+            result += adapter3.length();
+            adapter4.writeTo(result);
+            result += adapter4.length();
+            adapter5.writeTo(result);
+            result += adapter5.length();
+            adapter6.writeTo(result);
+
+            return resultImpl;
+        }
+
         PassRefPtr<UStringImpl> resultImpl = UStringImpl::tryCreateUninitialized(length, buffer);
         if (!resultImpl)
             return 0;
@@ -524,6 +653,31 @@ namespace AJ {
         sumWithOverflow(length, adapter7.length(), overflow);
         if (overflow)
             return 0;
+
+        if (adapter1.is8Bit() && adapter2.is8Bit() && adapter3.is8Bit() && adapter4.is8Bit() && adapter5.is8Bit() && adapter6.is8Bit() && adapter7.is8Bit()) {
+            LChar* buffer8;
+            PassRefPtr<UStringImpl> resultImpl = UStringImpl::tryCreateUninitialized(length, buffer8);
+            if (!resultImpl)
+                return 0;
+
+            LChar* result = buffer8;
+            adapter1.writeTo(result);
+            result += adapter1.length();
+            adapter2.writeTo(result);
+            result += adapter2.length();
+            adapter3.writeTo(result);
+            result += adapter3.length();
+            adapter4.writeTo(result);
+            result += adapter4.length();
+            adapter5.writeTo(result);
+            result += adapter5.length();
+            adapter6.writeTo(result);
+            result += adapter6.length();
+            adapter7.writeTo(result);
+
+            return resultImpl;
+        }
+
         PassRefPtr<UStringImpl> resultImpl = UStringImpl::tryCreateUninitialized(length, buffer);
         if (!resultImpl)
             return 0;
@@ -570,6 +724,33 @@ namespace AJ {
         sumWithOverflow(length, adapter8.length(), overflow);
         if (overflow)
             return 0;
+
+        if (adapter1.is8Bit() && adapter2.is8Bit() && adapter3.is8Bit() && adapter4.is8Bit() && adapter5.is8Bit() && adapter6.is8Bit() && adapter7.is8Bit() && adapter8.is8Bit()) {
+            LChar* buffer8;
+            PassRefPtr<UStringImpl> resultImpl = UStringImpl::tryCreateUninitialized(length, buffer8);
+            if (!resultImpl)
+                return 0;
+
+            LChar* result = buffer8;
+            adapter1.writeTo(result);
+            result += adapter1.length();
+            adapter2.writeTo(result);
+            result += adapter2.length();
+            adapter3.writeTo(result);
+            result += adapter3.length();
+            adapter4.writeTo(result);
+            result += adapter4.length();
+            adapter5.writeTo(result);
+            result += adapter5.length();
+            adapter6.writeTo(result);
+            result += adapter6.length();
+            adapter7.writeTo(result);
+            result += adapter7.length();
+            adapter8.writeTo(result);
+
+            return resultImpl;
+        }
+
         PassRefPtr<UStringImpl> resultImpl = UStringImpl::tryCreateUninitialized(length, buffer);
         if (!resultImpl)
             return 0;
@@ -45,37 +45,83 @@ limitations under the License.
 
 #include "Collector.h"
 #include <wtf/HashMap.h>
+#include <wtf/Vector.h>
 
 namespace AJ {
 
 class AJCell;
+class MarkStack;
 
-// A HashMap whose get() function returns emptyValue() for cells awaiting destruction.
-template<typename KeyType, typename MappedType>
-class WeakGCMap : public FastAllocBase {
-    /*
-    Invariants:
-        * A value enters the WeakGCMap marked. (Guaranteed by set().)
-        * A value that becomes unmarked leaves the WeakGCMap before being recycled. (Guaranteed by the value's destructor removing it from the WeakGCMap.)
-        * A value that becomes unmarked leaves the WeakGCMap before becoming marked again. (Guaranteed by all destructors running before the mark phase begins.)
-        * During the mark phase, all values in the WeakGCMap are valid. (Guaranteed by all destructors running before the mark phase begins.)
-    */
+// A table that holds some of its cells weakly. After marking, the collector
+// removes the entries whose weakly held cells were not marked from every
+// table in one pass, so lookups never check mark bits and dead entries do not
+// stay in the table until they are overwritten.
+class WeakGCMapBase : public Noncopyable {
+public:
+    virtual ~WeakGCMapBase()
+    {
+        if (!m_heap)
+            return;
+        if (m_previous)
+            m_previous->m_next = m_next;
+        else
+            m_heap->m_weakMaps = m_next;
+        if (m_next)
+            m_next->m_previous = m_previous;
+    }
+
+protected:
+    WeakGCMapBase(Heap* heap)
+        : m_heap(heap)
+        , m_previous(0)
+        , m_next(heap->m_weakMaps)
+    {
+        if (m_next)
+            m_next->m_previous = this;
+        heap->m_weakMaps = this;
+    }
+
+    static bool isLive(AJValue value)
+    {
+        return !value || !value.isCell() || Heap::isCellMarked(value.asCell());
+    }
 
+private:
+    friend class Heap;
+
+    // Marks the cells that are only reachable through marked cells in the
+    // table. Returns true if it marked any.
+    virtual bool markEphemerons(MarkStack&) { return false; }
+    // Removes the entries that hold cells that were not marked.
+    virtual void clearDeadEntries() = 0;
+
+    Heap* m_heap; // 0 once the heap is destroyed
+    WeakGCMapBase* m_previous;
+    WeakGCMapBase* m_next;
+};
+
+// A HashMap whose values are held weakly: an entry is removed by the
+// collection that finds its value unreachable.
+template<typename KeyType, typename MappedType>
+class WeakGCMap : public WeakGCMapBase {
 public:
     typedef typename HashMap<KeyType, MappedType>::iterator iterator;
     typedef typename HashMap<KeyType, MappedType>::const_iterator const_iterator;
+
+    WeakGCMap(Heap* heap)
+        : WeakGCMapBase(heap)
+    {
+    }
     
     bool isEmpty() { return m_map.isEmpty(); }
+    size_t size() const { return m_map.size(); }
 
-    MappedType get(const KeyType& key) const;
+    MappedType get(const KeyType& key) const { return m_map.get(key); }
     pair<iterator, bool> set(const KeyType&, const MappedType&); 
-    MappedType take(const KeyType& key);
+    MappedType take(const KeyType& key) { return m_map.take(key); }
 
-    // These unchecked functions provide access to a value even if the value's
-    // mark bit is not set. This is used, among other things, to retrieve values
-    // during the GC mark phase, which begins by clearing all mark bits.
-
-    MappedType uncheckedGet(const KeyType& key) const { return m_map.get(key); }
+    // Removes the entry only if it still maps the key to the value, for
+    // finalizers of values that a collection may already have removed.
     bool uncheckedRemove(const KeyType&, const MappedType&);
 
     iterator uncheckedBegin() { return m_map.begin(); }
@@ -85,40 +131,17 @@ public:
     const_iterator uncheckedEnd() const { return m_map.end(); }
 
 private:
+    virtual void clearDeadEntries();
+
     HashMap<KeyType, MappedType> m_map;
 };
 
-template<typename KeyType, typename MappedType>
-inline MappedType WeakGCMap<KeyType, MappedType>::get(const KeyType& key) const
-{
-    MappedType result = m_map.get(key);
-    if (result == HashTraits<MappedType>::emptyValue())
-        return result;
-    if (!Heap::isCellMarked(result))
-        return HashTraits<MappedType>::emptyValue();
-    return result;
-}
-
-template<typename KeyType, typename MappedType>
-MappedType WeakGCMap<KeyType, MappedType>::take(const KeyType& key)
-{
-    MappedType result = m_map.take(key);
-    if (result == HashTraits<MappedType>::emptyValue())
-        return result;
-    if (!Heap::isCellMarked(result))
-        return HashTraits<MappedType>::emptyValue();
-    return result;
-}
-
 template<typename KeyType, typename MappedType>
 pair<typename HashMap<KeyType, MappedType>::iterator, bool> WeakGCMap<KeyType, MappedType>::set(const KeyType& key, const MappedType& value)
 {
-    Heap::markCell(value); // If value is newly allocated, it's not marked, so mark it now.
     pair<iterator, bool> result = m_map.add(key, value);
-    if (!result.second) { // pre-existing entry
-        result.second = !Heap::isCellMarked(result.first->second);
+    if (!result.second)
         result.first->second = value;
-    }
     return result;
 }
 
@@ -134,6 +157,82 @@ bool WeakGCMap<KeyType, MappedType>::uncheckedRemove(const KeyType& key, const M
     return true;
 }
 
+template<typename KeyType, typename MappedType>
+void WeakGCMap<KeyType, MappedType>::clearDeadEntries()
+{
+    Vector<KeyType> deadKeys;
+    iterator end = m_map.end();
+    for (iterator it = m_map.begin(); it != end; ++it) {
+        if (!isLive(it->second))
+            deadKeys.append(it->first);
+    }
+    // Removing shrinks the table as it empties.
+    for (size_t i = 0; i < deadKeys.size(); ++i)
+        m_map.remove(deadKeys[i]);
+}
+
+// A HashMap with ephemeron entries: the key is held weakly, and the value is
+// only kept alive while the key is. A value that refers back to its own key
+// does not keep the entry alive.
+template<typename KeyType, typename MappedType>
+class EphemeronGCMap : public WeakGCMapBase {
+public:
+    typedef typename HashMap<KeyType, MappedType>::iterator iterator;
+
+    EphemeronGCMap(Heap* heap)
+        : WeakGCMapBase(heap)
+    {
+    }
+
+    bool isEmpty() { return m_map.isEmpty(); }
+    size_t size() const { return m_map.size(); }
+
+    MappedType get(const KeyType& key) const { return m_map.get(key); }
+    bool contains(const KeyType& key) const { return m_map.contains(key); }
+    void set(const KeyType& key, const MappedType& value) { m_map.set(key, value); }
+    bool remove(const KeyType& key)
+    {
+        iterator it = m_map.find(key);
+        if (it == m_map.end())
+            return false;
+        m_map.remove(it);
+        return true;
+    }
+
+private:
+    virtual bool markEphemerons(MarkStack&);
+    virtual void clearDeadEntries();
+
+    HashMap<KeyType, MappedType> m_map;
+};
+
+template<typename KeyType, typename MappedType>
+bool EphemeronGCMap<KeyType, MappedType>::markEphemerons(MarkStack& markStack)
+{
+    bool didMark = false;
+    iterator end = m_map.end();
+    for (iterator it = m_map.begin(); it != end; ++it) {
+        if (!Heap::isCellMarked(it->first) || isLive(it->second))
+            continue;
+        markStack.append(AJValue(it->second));
+        didMark = true;
+    }
+    return didMark;
+}
+
+template<typename KeyType, typename MappedType>
+void EphemeronGCMap<KeyType, MappedType>::clearDeadEntries()
+{
+    Vector<KeyType> deadKeys;
+    iterator end = m_map.end();
+    for (iterator it = m_map.begin(); it != end; ++it) {
+        if (!Heap::isCellMarked(it->first))
+            deadKeys.append(it->first);
+    }
+    for (size_t i = 0; i < deadKeys.size(); ++i)
+        m_map.remove(deadKeys[i]);
+}
+
 } // namespace AJ
 
 #endif // WeakGCMap_h
@@ -0,0 +1,128 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+/*
+ * String to number conversion takes a fast path for short significands,
+ * exact when both the significand and the power of ten are exact doubles
+ * and otherwise rounded from a 128-bit product, and gives up to the bignum
+ * strtod on ties, denormals, overflow and long significands. Checks inputs
+ * on each side of those limits against doubles built from their binary
+ * significand and exponent, through every entry point that reads numbers.
+ */
+
+test();
+
+function test()
+{
+    printStatus ("String to number conversion test.");
+
+    function zeros(n)
+    {
+        var s = "";
+        while (n--)
+            s += "0";
+        return s;
+    }
+
+    // significand * 2^exponent, without going through the conversion.
+    function exact(significand, exponent)
+    {
+        var x = significand;
+        for (; exponent > 0; --exponent)
+            x *= 2;
+        for (; exponent < 0; ++exponent)
+            x /= 2;
+        return x;
+    }
+
+    var cases = [
+        // Significand and power of ten both exact.
+        ["1", exact(1, 0), "exact integer"],
+        ["123456789e-5", exact(5429687001335527, -42), "exact quotient"],
+        ["9007199254740992", exact(1, 53), "2^53"],
+        ["4.5e15", exact(274658203125, 14), "exact product"],
+        ["123e25", exact(4474713932722807, 38), "digits moved from the exponent"],
+        ["1e22", exact(2384185791015625, 22), "largest exact power of ten"],
+        ["0.1", exact(3602879701896397, -55), "0.1"],
+        ["3.14159", exact(3537115888337719, -50), "short fraction"],
+
+        // Rounded from the 128-bit product.
+        ["1e23", exact(2980232238769531, 25), "1e23"],
+        ["2.2250738585072014e-308", exact(1, -1022), "smallest normal"],
+        ["1.7976931348623157e308", exact(9007199254740991, 971), "largest double"],
+        ["7.0064923216240861e-46", exact(1, -150), "2^-150"],
+        ["8.98846567431158e307", exact(1, 1023), "2^1023"],
+        ["9007199254740993e10", exact(5242880000000001, 34), "2^53 + 1 scaled"],
+
+        // Halfway between two doubles, rounded to even.
+        ["9007199254740993", exact(1, 53), "tie above 2^53, to even below"],
+        ["9007199254740995", exact(2251799813685249, 2), "tie above 2^53 + 2, to even above"],
+        ["1.00000000000000011102230246251565404236316680908203125", exact(1, 0), "exact tie after 1"],
+        ["1.000000000000000111022302462515654042363166809082031250001", exact(4503599627370497, -52), "just above the tie after 1"],
+        ["1.00000000000000011102230246251565404236316680908203124999", exact(1, 0), "just below the tie after 1"],
+
+        // Denormals and underflow.
+        ["5.0216813883093447e-309", exact(1016399628385195, -1074), "denormal, 17 digits"],
+        ["4.9406564584124654e-324", exact(1, -1074), "smallest denormal"],
+        ["2.4703282292062328e-324", exact(1, -1074), "just above half the smallest denormal"],
+        ["2.4703282292062327e-324", 0, "just below half the smallest denormal"],
+        ["2.2250738585072011e-308", exact(4503599627370495, -1074), "largest denormal"],
+        ["1e-320", exact(253, -1071), "1e-320"],
+        ["1e-400", 0, "underflow to zero"],
+
+        // Overflow.
+        ["1.7976931348623158e308", exact(9007199254740991, 971), "just below halfway to 2^1024"],
+        ["1.7976931348623159e308", Infinity, "just above halfway to 2^1024"],
+        ["1e309", Infinity, "1e309"],
+
+        // Long significands.
+        ["1234567890123456789", exact(4822530820794753, 8), "19 digits"],
+        ["12345678901234567890", exact(6028163525993441, 11), "20 digits"],
+        ["123456789012345678901234567890", exact(3508852984519583, 45), "30 digits"],
+        ["3.14159265358979323846264338327950288", exact(884279719003555, -48), "36 digits of pi"],
+        ["0.30000000000000000555111512312578270211815834045410156250", exact(5404319552844595, -54), "exact decimal of 0.3"],
+
+        // Zero padding.
+        [zeros(45) + "1.5", exact(3, -1), "leading zeros"],
+        ["1.5" + zeros(45), exact(3, -1), "trailing zeros"],
+        ["0." + zeros(340) + "1e341", exact(1, 0), "zeros after the point"],
+        ["1" + zeros(400) + "e-400", exact(1, 0), "zeros before the point"],
+        ["0." + zeros(99) + "1", exact(492525077454931, -381), "1e-100 written out"],
+        ["1e" + zeros(32) + "22", exact(2384185791015625, 22), "zero-padded exponent"]
+    ];
+
+    for (var i = 0; i < cases.length; ++i) {
+        var s = cases[i][0];
+        var expected = cases[i][1];
+        var description = cases[i][2];
+        reportCompare (expected, Number(s), "Number: " + description);
+        reportCompare (-expected, Number("-" + s), "Number, negated: " + description);
+        reportCompare (expected, parseFloat(s + "x"), "parseFloat: " + description);
+        // JSON and source text have no leading zeros.
+        if (s.charAt(0) == "0" && s.charAt(1) != ".")
+            continue;
+        reportCompare (expected, JSON.parse(s), "JSON.parse: " + description);
+        reportCompare (expected, eval(s), "literal: " + description);
+    }
+
+    // Where the number ends.
+    reportCompare (1, parseFloat("1e"), "parseFloat of 1e");
+    reportCompare (1.5, parseFloat("1.5e+x"), "parseFloat of 1.5e+x");
+    reportCompare (true, isNaN(Number("1e")), "Number of 1e");
+    reportCompare (100, Number("  1e2  "), "Number with whitespace");
+}
@@ -0,0 +1,145 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+/*
+ * Number to string conversion takes a fast path that gives up on the rare
+ * doubles it cannot convert exactly. Checks it against strings recorded
+ * from the bignum dtoa for a pseudo-random sample of doubles, checks a hash
+ * of the strings for a much larger sample, and checks that they read back.
+ */
+
+test();
+
+function test()
+{
+    printStatus ("Number to string conversion test.");
+
+    var seed = 20120314;
+    function random(n)
+    {
+        seed = (seed * 16807) % 2147483647;
+        return seed % n;
+    }
+
+    // Doubles with random significands and exponents, powers of two, short
+    // decimal fractions, decimal integers scaled by powers of ten, and
+    // denormals.
+    function sample(i)
+    {
+        var significand = random(1 << 26) * 134217728 + random(1 << 27);
+        switch (i % 5) {
+        case 0: return significand * Math.pow(2, random(2098) - 1126);
+        case 1: return Math.pow(2, random(2098) - 1074);
+        case 2: return random(100000000) / (1 + random(10000));
+        case 3: return (significand % 1000000007) * Math.pow(10, random(40) - 20);
+        default: return significand * Math.pow(2, -1074 - random(3));
+        }
+    }
+
+    var expected = [
+    "8.993262952466265e+96", "1.0496681418073576e-140", "4095.24070337273",
+    "3766300920000000", "0", "2.6852888002446507e-47",
+    "1.5490367659397273e-120", "42210.67562557924", "1.5536440300000002e-7",
+    "3.9620019619813586e-308", "8.298818817608467e+193",
+    "1.201202692608752e+257", "6503.401834538719", "7482715990000",
+    "1.003134835744195e-308", "4.884506027742496e+293",
+    "7.029552803973744e+159", "310.38107839894144", "746536831",
+    "4.441561842646994e-308", "2.7288420947938166e+109",
+    "2.0065826040452475e+205", "13190.948113207547", "9027073.5",
+    "1.4131967523408884e-308", "2.76180022292538e-194",
+    "2.0128589904991042e-233", "17993.07594936709", "0.23615885",
+    "3.6744723306533877e-308", "1.4240614133698153e+29",
+    "4.512985939662074e-277", "11291.63913595934", "3103375790000000000",
+    "2.550132352629571e-308", "5.589473972663047e+189",
+    "1.0053823416929744e-87", "2062.6368782854834", "9.22614044e+25", "0", "0",
+    "2.0522684006491881e-289", "6897.236775515123", "2943184210000000000", "0",
+    "2.1120156192277764e+71", "9.85050154909862e+114", "24459.84041262136",
+    "0.0246793641", "0", "2.9808055557220377e-210", "2.070105401319524e-171",
+    "5042.604360852197", "0.000135113927", "0", "3.484726576074881e+266",
+    "1.1920928955078125e-7", "6602.591359773372", "4209687010000000", "0",
+    "1.6851575678328992e+45", "0.125", "88618.28280254776", "9.7617656e+25",
+    "1.16724215835722e-308", "3.869841121927803e+193",
+    "1.2758009537404886e-203", "8949.362490352456", "67988268800", "0",
+    "7.334234933344602e+282", "2.0927902484106784e+298", "58425.61842105263",
+    "3.57487619e-11", "0", "9.177340447812704e-209", "2.4178516392292583e+24",
+    "15724.435573889832", "8.32616378e+25", "0", "4.9688206229119034e-129",
+    "8.289046e-317", "21696.219491993375", "5.57626361e-10",
+    "1.7634670338286084e-308", "1.6914791414607596e-90",
+    "1.4836824602749686e-67", "34398.34665611397", "9.41868031e-12", "0",
+    "7.223223375794931e-231", "3.606632272572553e-130", "10230.23423297441",
+    "2.8996438e-11", "0", "43.05292325100041", "1.8726705418768793e-96",
+    "8745.083298451234", "57.647010599999994", "8.95108606049478e-309",
+    "2.2417792236730677e-308", "3.078281734093319e+113", "30027.680398370303",
+    "2.44825405e+27", "2.457272931385998e-308", "5.077635030420291e-308",
+    "5.966672584960166e-154", "8586.646505376344", "0.0000152492275", "0",
+    "6.926525294082496e+251", "7.029552803973744e+159", "31256.998979070955",
+    "54.9686744", "0", "2.440092816117257e-246", "4.930380657631324e-32",
+    "3249.638783269962", "7.38747588e+25", "0", "6.483975245979976e+255",
+    "9.797766621314685e+201", "51443.0459770115", "847.373888", "0",
+    "1.484657952984222e-241", "1.0295115178936058e-84", "12844.181195052899",
+    "827602046000000", "0", "2.88709530390489e+138", "7.475102707912205e+196",
+    "7360.054677206851", "483712131000000", "0", "8.331013310776684e-134",
+    "5.450188595210433e-107", "3226.479186376537", "2341356820000000", "0",
+    "3.6620376114004543e+31", "2.0194839173657902e-28", "51823.35388927821",
+    "0.871745113", "0", "1.960270140833656e+61", "2.3206684158876463e-215",
+    "41733.99393939394", "0.34888272000000004", "0", "1.8860233082232998e-264",
+    "1.742245718635205e+41", "11780.057443752992", "1.36972357e-8", "0",
+    "2.009120437281627e-229", "2.6414726556783262e+269", "12880.417210539037",
+    "6.6718855e+26", "0", "1.071536328348047e-78", "6.924462078501392e+274",
+    "9056.633423180592", "3.82938977e-8", "0", "1.5160422059699839e+172",
+    "2e-323", "3742.0263255929467", "535135.785", "0", "3.861627564668568e+99",
+    "3.061802069160839e+200", "2172.719519448079", "294830.39400000003",
+    "1.897216433012714e-308", "9.391327102267941e-242",
+    "7.418412301374843e-68", "5962.483179598481", "6598926090000000000",
+    "1.1487416749449537e-308", "2.8267893476497095e-64",
+    "3.00300673152188e+256", "5219.158223374176", "901002.693",
+    "1.561596918810992e-308", "3.658369445166883e-216", "5.78960446186581e+76",
+    "6894.640942651968", "0.000446897542", "2.179849310583697e-308",
+    "9.050875836011677e-176", "4.671939192445128e+195", "4026.1556479032865",
+    "240363.652", "4.94640339617625e-309", "8.329016855617375e+43",
+    "1.402757983365378e-191", "5183.334480079902", "6.62145511", "0"
+    ];
+    for (var i = 0; i < expected.length; ++i)
+        reportCompare (expected[i], String(sample(i)), "sample " + i);
+
+    var hash = 0;
+    var roundTripFailures = 0;
+    for (var i = expected.length; i < 200000; ++i) {
+        var x = sample(i);
+        var s = String(x);
+        for (var j = 0; j < s.length; ++j)
+            hash = (hash * 31 + s.charCodeAt(j)) % 2147483647;
+        if (Number(s) !== x)
+            ++roundTripFailures;
+    }
+    reportCompare (412027356, hash, "hash of 199800 samples");
+    reportCompare (0, roundTripFailures, "samples that do not read back");
+
+    // Neighbours of powers of two, where the double below is closer, and
+    // the ends of the range.
+    reportCompare ("5.960464477539063e-8", String(Math.pow(2, -24)), "2^-24");
+    reportCompare ("9007199254740992", String(Math.pow(2, 53)), "2^53");
+    reportCompare ("1.7976931348623157e+308", String(1.7976931348623157e308), "largest double");
+    reportCompare ("2.2250738585072014e-308", String(2.2250738585072014e-308), "smallest normal double");
+    reportCompare ("5e-324", String(5e-324), "smallest denormal");
+    reportCompare ("0.30000000000000004", String(0.1 + 0.2), "0.1 + 0.2");
+    reportCompare ("1e+21", String(1e21), "1e21");
+    reportCompare ("123456789012345680000", String(123456789012345678901), "21 digits");
+    reportCompare ("1e-7", String(1e-7), "1e-7");
+    reportCompare ("0.000001", String(1e-6), "1e-6");
+    reportCompare ("-1.5e-10", String(-1.5e-10), "negative");
+}
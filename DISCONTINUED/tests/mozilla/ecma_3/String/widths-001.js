@@ -0,0 +1,111 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+/*
+ * Strings are stored 8 bits wide when every character fits in Latin-1 and
+ * 16 bits wide otherwise. Concatenating, comparing, slicing and looking up
+ * properties must not depend on which width a string happens to have.
+ */
+
+test();
+
+function test()
+{
+    printStatus ("String width test.");
+
+    // "\xe9abc" and "\u2026abc" are 8 and 16 bits wide; these are the same
+    // "abc", one taken from each.
+    var narrow = ("\xe9abc").substring(1);
+    var wide = ("\u2026abc").substring(1);
+    var built = String.fromCharCode(0x61, 0x62, 0x63);
+
+    // Concatenation across widths.
+    var mixed = "caf\xe9" + "\u2026" + "na\xefve";
+    reportCompare(10, mixed.length, "length of a mixed concatenation");
+    reportCompare(0xe9, mixed.charCodeAt(3), "8-bit character before the boundary");
+    reportCompare(0x2026, mixed.charCodeAt(4), "16-bit character at the boundary");
+    reportCompare(0xef, mixed.charCodeAt(7), "8-bit character after the boundary");
+    reportCompare(3, mixed.indexOf("\xe9\u2026n"), "search across the boundary");
+    reportCompare(7, mixed.lastIndexOf("\xefv"), "search back into the 8-bit part");
+    reportCompare("caf\xe9|\u2026|\xff", ["caf\xe9", "\u2026", "\xff"].join("|"), "join of mixed widths");
+
+    var rope = "";
+    for (var i = 0; i < 100; ++i)
+        rope += (i % 10 == 9) ? "\u0100" : "\xff";
+    reportCompare(100, rope.length, "length of a mixed rope");
+    reportCompare(0x100, rope.charCodeAt(49), "16-bit character in a mixed rope");
+    reportCompare(0xff, rope.charCodeAt(50), "8-bit character in a mixed rope");
+    reportCompare(9, rope.indexOf("\u0100"), "search in a mixed rope");
+
+    // Comparison across widths.
+    reportCompare(true, narrow == wide, "== across widths");
+    reportCompare(true, narrow === wide, "=== across widths");
+    reportCompare(true, narrow === built, "=== against a built string");
+    reportCompare(false, narrow < wide || wide < narrow, "< across equal strings");
+    reportCompare(true, "\xff" < "\u0100", "highest 8-bit character is below the lowest 16-bit one");
+    reportCompare(true, "\xe9" == String.fromCharCode(0xe9), "Latin-1 escape against String.fromCharCode");
+    reportCompare(true, ("\u2026\xe9").substring(1) === "\xe9", "8-bit character taken from a 16-bit string");
+    reportCompare(true, (wide + "\xe9") > (narrow + "\xe8"), "> across widths");
+
+    var matched = "none";
+    switch (wide) {
+    case "ab":
+        matched = "ab";
+        break;
+    case narrow:
+        matched = "abc";
+        break;
+    }
+    reportCompare("abc", matched, "switch across widths");
+
+    // Substrings of strings that have been read 16 bits at a time.
+    var widened = "abcd\xe9fgh";
+    widened.toLowerCase();
+    widened.localeCompare("\u2026");
+    "x".replace("x", "$&" + widened);
+    reportCompare("cd\xe9f", widened.substring(2, 6), "substring of a widened string");
+    reportCompare("\xe9fgh", widened.slice(-4), "slice of a widened string");
+    reportCompare("\xe9", widened.charAt(4), "charAt of a widened string");
+    reportCompare(true, widened.substring(4, 5) === "\xe9", "substring of a widened string compared to a literal");
+    reportCompare(4, widened.indexOf("\xe9f"), "search in a widened string");
+    reportCompare("abcd\xe9fgh\u2026", widened + "\u2026", "widened string concatenated with a 16-bit one");
+
+    // The same name spelled in both widths is one property.
+    var o = {};
+    o[narrow] = 1;
+    reportCompare(1, o[wide], "get with a 16-bit name");
+    reportCompare(true, wide in o, "in with a 16-bit name");
+    reportCompare(true, o.hasOwnProperty(built), "hasOwnProperty with a built name");
+    o[wide] = 2;
+    reportCompare(2, o.abc, "put with a 16-bit name");
+    var names = [];
+    for (var name in o)
+        names.push(name);
+    reportCompare("abc", names.join(","), "for-in sees one property");
+    reportCompare(true, delete o[wide], "delete with a 16-bit name");
+    reportCompare(false, narrow in o, "deleted through the other width");
+
+    var latin = {};
+    latin["caf\xe9"] = 1;
+    var wideCafe = ("\u2026caf\xe9").substring(1);
+    reportCompare(1, latin[wideCafe], "Latin-1 name looked up with a 16-bit spelling");
+    latin[wideCafe] = 2;
+    reportCompare(2, latin["caf\xe9"], "Latin-1 name stored with a 16-bit spelling");
+
+    var abc = 3;
+    reportCompare(3, eval(wide), "variable named with a 16-bit string");
+}
@@ -0,0 +1,122 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+/*
+ * Typed arrays convert what is stored in them to their element type, check
+ * offsets and lengths against their buffer, count negative positions back
+ * from the end, and throw a RangeError rather than crash when a buffer
+ * cannot be allocated.
+ */
+
+test();
+
+function test()
+{
+    printStatus ("Typed array test.");
+
+    function errorName(f)
+    {
+        try {
+            f();
+        } catch (e) {
+            return e.name;
+        }
+        return "no error";
+    }
+
+    // Integer views wrap around; Float32Array rounds to the nearest float.
+    var u8 = new Uint8Array(4);
+    u8[0] = 256;
+    u8[1] = -1;
+    u8[2] = 257.9;
+    u8[3] = "300";
+    reportCompare("0,255,1,44", Array.prototype.join.call(u8, ","), "Uint8Array wraps around");
+
+    var i8 = new Int8Array(4);
+    i8[0] = 128;
+    i8[1] = 255;
+    i8[2] = -129;
+    i8[3] = 1e10 + 200;
+    reportCompare("-128,-1,127,-56", Array.prototype.join.call(i8, ","), "Int8Array wraps around");
+
+    var u32 = new Uint32Array(3);
+    u32[0] = -1;
+    u32[1] = 4294967296;
+    u32[2] = 4294967297.5;
+    reportCompare("4294967295,0,1", Array.prototype.join.call(u32, ","), "Uint32Array wraps around");
+
+    var f32 = new Float32Array(4);
+    f32[0] = 0.1;
+    f32[1] = 16777217;
+    f32[2] = 1e40;
+    f32[3] = NaN;
+    reportCompare(13421773 / 134217728, f32[0], "Float32Array rounds 0.1");
+    reportCompare(16777216, f32[1], "Float32Array rounds 2^24 + 1 to even");
+    reportCompare(Infinity, f32[2], "Float32Array overflows to Infinity");
+    reportCompare(true, isNaN(f32[3]), "Float32Array keeps NaN");
+
+    // Offsets and lengths that do not fit the buffer.
+    var buffer = new ArrayBuffer(8);
+    reportCompare("RangeError", errorName(function () { new ArrayBuffer(-1); }), "negative buffer length");
+    reportCompare("RangeError", errorName(function () { new Int8Array(-1); }), "negative array length");
+    reportCompare("RangeError", errorName(function () { new Int32Array(buffer, 2); }), "misaligned offset");
+    reportCompare("RangeError", errorName(function () { new Int32Array(buffer, 12); }), "offset past the end");
+    reportCompare("RangeError", errorName(function () { new Int32Array(buffer, -4); }), "negative offset");
+    reportCompare("RangeError", errorName(function () { new Int32Array(buffer, 4, 2); }), "length past the end");
+    reportCompare("RangeError", errorName(function () { new Int32Array(new ArrayBuffer(7)); }), "buffer not a multiple of the element size");
+    reportCompare(1, new Int32Array(buffer, 4).length, "offset at the last element");
+    reportCompare(0, new Int32Array(buffer, 8).length, "offset at the end");
+
+    // Negative positions count back from the end.
+    var a = new Int16Array([1, 2, 3, 4, 5]);
+    var sub = a.subarray(-2);
+    reportCompare("4,5", Array.prototype.join.call(sub, ","), "subarray from a negative position");
+    reportCompare(6, sub.byteOffset, "byteOffset of a subarray from a negative position");
+    reportCompare("2,3", Array.prototype.join.call(a.subarray(-4, -2), ","), "subarray between negative positions");
+    reportCompare("1,2,3,4,5", Array.prototype.join.call(a.subarray(-10), ","), "subarray from before the start");
+    reportCompare(0, a.subarray(3, 1).length, "subarray ending before it starts");
+    sub[0] = 40;
+    reportCompare(40, a[3], "subarray shares the buffer");
+
+    var bytes = new Uint8Array([10, 20, 30, 40, 50, 60]);
+    var slice = bytes.buffer.slice(-4, -1);
+    reportCompare(3, slice.byteLength, "slice between negative positions");
+    reportCompare("30,40,50", Array.prototype.join.call(new Uint8Array(slice), ","), "contents of a slice");
+    new Uint8Array(slice)[0] = 0;
+    reportCompare(30, bytes[2], "slice copies the buffer");
+    reportCompare(0, bytes.buffer.slice(-1, -3).byteLength, "slice ending before it starts");
+
+    // set() must fit the source at the offset.
+    var target = new Uint8Array(4);
+    reportCompare("RangeError", errorName(function () { target.set([1, 2, 3], 2); }), "set past the end");
+    reportCompare("RangeError", errorName(function () { target.set(new Uint8Array(5)); }), "set from a longer array");
+    reportCompare("RangeError", errorName(function () { target.set([1], 5); }), "set at an offset past the end");
+    reportCompare("RangeError", errorName(function () { target.set([1], -1); }), "set at a negative offset");
+    reportCompare("0,0,0,0", Array.prototype.join.call(target, ","), "failed set leaves the array alone");
+    target.set([1, 2], 2);
+    reportCompare("0,0,1,2", Array.prototype.join.call(target, ","), "set up to the end");
+
+    // A buffer past the heap limit throws, and leaves the heap usable.
+    if (typeof setHeapLimit == "function") {
+        setHeapLimit(64);
+        reportCompare("RangeError", errorName(function () { new ArrayBuffer(1500000000); }), "buffer past the heap limit");
+        reportCompare("RangeError", errorName(function () { new Float64Array(100000000); }), "typed array past the heap limit");
+        reportCompare("RangeError", errorName(function () { new Uint8Array(new Array(100000000)); }), "copied typed array past the heap limit");
+        reportCompare(1024, new ArrayBuffer(1024).byteLength, "buffer within the heap limit");
+        setHeapLimit(0);
+    }
+}
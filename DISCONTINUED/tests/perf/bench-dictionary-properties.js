@@ -0,0 +1,44 @@
+(function () {
+    for (var size = 1000; size <= 64000; size *= 4) {
+        var keys = [];
+        var missingKeys = [];
+        for (var i = 0; i < size; ++i) {
+            keys.push("key" + i);
+            missingKeys.push("missing" + i);
+        }
+        var rounds = 4000000 / size;
+
+        for (var round = 0; round < 10; ++round) {
+            var dictionary = {};
+            for (var i = 0; i < size; ++i)
+                dictionary[keys[i]] = i;
+        }
+
+        var sum = 0;
+        for (var round = 0; round < rounds; ++round) {
+            for (var i = 0; i < size; ++i)
+                sum += dictionary[keys[i]];
+        }
+
+        var found = 0;
+        for (var round = 0; round < rounds; ++round) {
+            for (var i = 0; i < size; ++i) {
+                if (missingKeys[i] in dictionary)
+                    ++found;
+            }
+        }
+
+        for (var round = 0; round < rounds; ++round) {
+            for (var i = round % 10; i < size; i += 10)
+                delete dictionary[keys[i]];
+            for (var i = round % 10; i < size; i += 10)
+                dictionary[keys[i]] = i;
+        }
+
+        var count = 0;
+        for (var round = 0; round < rounds / 10; ++round) {
+            for (var key in dictionary)
+                ++count;
+        }
+    }
+})();
@@ -0,0 +1,21 @@
+// Measures gc() pause time as the retained heap grows. The collector scans the
+// stack conservatively, so each pause is taken from inside a deep call chain
+// to give it a realistic number of candidate pointers.
+(function () {
+    var retained = [];
+
+    function pauseAtDepth(depth) {
+        if (depth)
+            return pauseAtDepth(depth - 1);
+        var start = new Date;
+        for (var i = 0; i < 10; ++i)
+            gc();
+        return (new Date - start) / 10;
+    }
+
+    for (var size = 12500; size <= 800000; size *= 2) {
+        while (retained.length < size)
+            retained.push({});
+        print(size + " live objects: " + pauseAtDepth(200) + "ms per gc()");
+    }
+})();
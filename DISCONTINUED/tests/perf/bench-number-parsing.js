@@ -0,0 +1,25 @@
+(function () {
+    var numbers = [];
+    var points = [];
+    for (var i = 0; i < 50000; ++i) {
+        var point = [String(i * 0.000137 + 12.5), String(-i * 0.00291 + 48.25), String(i % 1000), String(i * 1.1e-7)];
+        numbers.push.apply(numbers, point);
+        points.push("[" + point.join(",") + "]");
+    }
+    var prices = [];
+    for (var i = 0; i < 20000; ++i)
+        prices.push((i * 3.99 / 7).toFixed(2));
+    numbers.push.apply(numbers, prices);
+    var json = "{\"points\":[" + points.join(",") + "],\"prices\":[" + prices.join(",") + "]}";
+
+    var document = JSON.parse(json);
+
+    var sum = 0;
+    for (var i = 0; i < numbers.length; ++i)
+        sum += Number(numbers[i]);
+
+    for (var i = 0; i < numbers.length; ++i)
+        sum += parseFloat(numbers[i]);
+
+    var literals = eval("(function () { return [" + numbers.slice(0, 50000).join(",") + "]; })")();
+})();
@@ -0,0 +1,30 @@
+// Measures mark-phase throughput with 1, 2, 4 and 8 marker threads. The heap
+// is a forest of object trees that all stay alive, so each gc() spends nearly
+// all of its time marking; the sweep has nothing to reclaim.
+(function () {
+    var forest = [];
+
+    function tree(depth) {
+        if (!depth)
+            return { value: depth, name: "leaf" };
+        var children = [];
+        for (var i = 0; i < 4; ++i)
+            children.push(tree(depth - 1));
+        return { left: children[0], right: children[3], children: children };
+    }
+
+    // 64 trees of 5461 objects plus their child arrays.
+    for (var i = 0; i < 64; ++i)
+        forest.push(tree(6));
+    var cells = 64 * (5461 + 1365);
+
+    for (var threads = 1; threads <= 8; threads *= 2) {
+        setMarkerThreadCount(threads);
+        gc();
+        var start = new Date;
+        for (var i = 0; i < 10; ++i)
+            gc();
+        var ms = (new Date - start) / 10;
+        print(threads + " marker threads: " + ms + "ms per gc(), " + Math.round(cells / ms) + " cells/ms");
+    }
+})();
@@ -0,0 +1,40 @@
+(function () {
+    for (var count = 10000; count <= 160000; count *= 4) {
+        var s = "";
+        for (var i = 0; i < count; ++i)
+            s += "x";
+
+        s = "";
+        for (var i = 0; i < count; ++i)
+            s = (i % 10) + s;
+        s.charCodeAt(count >> 1);
+
+        s = "";
+        var seen = 0;
+        for (var i = 0; i < count; ++i) {
+            s += "line " + i + "\n";
+            if (!(i % 100)) {
+                seen += s.length + s.charCodeAt(i) + s.charAt(s.length >> 1).length;
+                seen += s.slice(-20).length + s.substring(5, 15).length;
+            }
+        }
+
+        s = "";
+        var found = 0;
+        for (var i = 0; i < count; ++i) {
+            s += "item" + i + ";";
+            if (!(i % 1000) && s.indexOf("item" + (i >> 1) + ";") >= 0)
+                ++found;
+        }
+
+        var a = "";
+        var b = "";
+        var equal = 0;
+        for (var i = 0; i < count; ++i) {
+            a += i % 7;
+            b += (i % 7) + "";
+            if (!(i % 1000) && a == b)
+                ++equal;
+        }
+    }
+})();
@@ -0,0 +1,39 @@
+(function () {
+    var lines = [];
+    for (var i = 0; i < 60000; ++i)
+        lines.push("2012-03-14 12:00:" + (i % 60) + " worker-" + (i % 16) + " INFO request " + i + " served in " + (i % 97) + "ms");
+    var log8 = lines.join("\n");
+    var log16 = log8 + "\n\u2026";
+    var needle = "worker-3 ERROR request failed with status 500 after retries";
+
+    function run(log) {
+        var count = 0;
+        for (var i = log.indexOf("\n"); i >= 0; i = log.indexOf("\n", i + 1))
+            ++count;
+
+        for (var i = log.indexOf("INFO"); i >= 0; i = log.indexOf("INFO", i + 4))
+            ++count;
+
+        var found = 0;
+        for (var i = 0; i < 100; ++i)
+            found += log.indexOf(needle) >= 0;
+
+        for (var i = log.lastIndexOf("served"); i >= 0; i = log.lastIndexOf("served", i - 1))
+            ++count;
+
+        count += log.split("\n").length;
+
+        var s = log;
+        for (var i = 0; i < 10; ++i)
+            s = s.replace("worker-" + (i + 5) + " INFO request " + (59990 - i), "");
+    }
+
+    run(log8);
+    run(log16);
+
+    var text = new Array(200001).join("ab");
+    var pattern = "a" + new Array(20).join("xy") + "b";
+    var found = 0;
+    for (var i = 0; i < 200; ++i)
+        found += text.indexOf(pattern) >= 0;
+})();
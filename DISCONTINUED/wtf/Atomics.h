@@ -100,9 +100,11 @@ namespace ATF {
 #if COMPILER(MINGW) || COMPILER(MSVC7_OR_LOWER) || OS(WINCE)
 inline int atomicIncrement(int* addend) { return InterlockedIncrement(reinterpret_cast<long*>(addend)); }
 inline int atomicDecrement(int* addend) { return InterlockedDecrement(reinterpret_cast<long*>(addend)); }
+inline bool weakCompareAndSwap(unsigned volatile* location, unsigned expected, unsigned newValue) { return static_cast<unsigned>(InterlockedCompareExchange(reinterpret_cast<long*>(const_cast<unsigned*>(location)), newValue, expected)) == expected; }
 #else
 inline int atomicIncrement(int volatile* addend) { return InterlockedIncrement(reinterpret_cast<long volatile*>(addend)); }
 inline int atomicDecrement(int volatile* addend) { return InterlockedDecrement(reinterpret_cast<long volatile*>(addend)); }
+inline bool weakCompareAndSwap(unsigned volatile* location, unsigned expected, unsigned newValue) { return static_cast<unsigned>(InterlockedCompareExchange(reinterpret_cast<long volatile*>(location), newValue, expected)) == expected; }
 #endif
 
 #elif OS(DARWIN)
@@ -110,17 +112,20 @@ inline int atomicDecrement(int volatile* addend) { return InterlockedDecrement(r
 
 inline int atomicIncrement(int volatile* addend) { return OSAtomicIncrement32Barrier(const_cast<int*>(addend)); }
 inline int atomicDecrement(int volatile* addend) { return OSAtomicDecrement32Barrier(const_cast<int*>(addend)); }
+inline bool weakCompareAndSwap(unsigned volatile* location, unsigned expected, unsigned newValue) { return OSAtomicCompareAndSwap32Barrier(expected, newValue, reinterpret_cast<int32_t volatile*>(location)); }
 
 #elif OS(ANDROID)
 
 inline int atomicIncrement(int volatile* addend) { return android_atomic_inc(addend); }
 inline int atomicDecrement(int volatile* addend) { return android_atomic_dec(addend); }
+inline bool weakCompareAndSwap(unsigned volatile* location, unsigned expected, unsigned newValue) { return !android_atomic_cmpxchg(expected, newValue, reinterpret_cast<int volatile*>(location)); }
 
 #elif COMPILER(GCC) && !CPU(SPARC64) && !OS(SYMBIAN) // sizeof(_Atomic_word) != sizeof(int) on sparc64 gcc
 #define WTF_USE_LOCKFREE_THREADSAFESHARED 1
 
 inline int atomicIncrement(int volatile* addend) { return __gnu_cxx::__exchange_and_add(addend, 1) + 1; }
 inline int atomicDecrement(int volatile* addend) { return __gnu_cxx::__exchange_and_add(addend, -1) - 1; }
+inline bool weakCompareAndSwap(unsigned volatile* location, unsigned expected, unsigned newValue) { return __sync_bool_compare_and_swap(location, expected, newValue); }
 
 #endif
 
@@ -78,6 +78,7 @@ namespace ATF {
 } // namespace ATF
 
 using ATF::currentTime;
+using ATF::currentTimeMS;
 using ATF::getLocalTime;
 
 #endif // CurrentTime_h
@@ -0,0 +1,335 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+#include "config.h"
+#include "FastDtoa.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+// The Grisu3 algorithm from Florian Loitsch, "Printing Floating-Point Numbers
+// Quickly and Accurately with Integers" (PLDI 2010). The double and the
+// neighbours halfway to the doubles on either side are scaled by a cached
+// power of ten so that they have a few integer digits, and digits are
+// generated until they single out the double. Grisu3 knows when the
+// imprecision of 64-bit arithmetic could have picked the wrong digits, and
+// then gives up.
+
+namespace ATF {
+
+// A floating-point number f * 2^e with a 64-bit significand.
+struct DiyFp {
+    DiyFp() : f(0), e(0) { }
+    DiyFp(uint64_t significand, int exponent) : f(significand), e(exponent) { }
+
+    uint64_t f;
+    int e;
+};
+
+static const int diyFpSignificandSize = 64;
+
+static inline DiyFp minus(const DiyFp& a, const DiyFp& b)
+{
+    ASSERT(a.e == b.e && a.f >= b.f);
+    return DiyFp(a.f - b.f, a.e);
+}
+
+// The upper 64 bits of the product, rounded.
+static inline DiyFp times(const DiyFp& x, const DiyFp& y)
+{
+    const uint64_t mask32 = 0xFFFFFFFFu;
+    uint64_t a = x.f >> 32;
+    uint64_t b = x.f & mask32;
+    uint64_t c = y.f >> 32;
+    uint64_t d = y.f & mask32;
+    uint64_t ac = a * c;
+    uint64_t bc = b * c;
+    uint64_t ad = a * d;
+    uint64_t bd = b * d;
+    uint64_t middle = (bd >> 32) + (ad & mask32) + (bc & mask32) + (1u << 31);
+    return DiyFp(ac + (ad >> 32) + (bc >> 32) + (middle >> 32), x.e + y.e + diyFpSignificandSize);
+}
+
+static inline DiyFp normalize(DiyFp x)
+{
+    ASSERT(x.f);
+    while (!(x.f & 0xFFC0000000000000ull)) {
+        x.f <<= 10;
+        x.e -= 10;
+    }
+    while (!(x.f & 0x8000000000000000ull)) {
+        x.f <<= 1;
+        x.e -= 1;
+    }
+    return x;
+}
+
+static const uint64_t doubleSignificandMask = 0x000FFFFFFFFFFFFFull;
+static const uint64_t doubleHiddenBit = 0x0010000000000000ull;
+static const int doubleExponentBias = 0x3FF + 52;
+static const int doubleDenormalExponent = 1 - doubleExponentBias;
+
+// Splits the double into its significand and exponent, and finds the
+// boundaries halfway to its neighbours, normalized to a common exponent.
+static inline void decompose(double d, DiyFp* w, DiyFp* lowerBoundary, DiyFp* upperBoundary)
+{
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    int biasedExponent = static_cast<int>(bits >> 52) & 0x7FF;
+    uint64_t significand = bits & doubleSignificandMask;
+    DiyFp v;
+    if (biasedExponent)
+        v = DiyFp(significand | doubleHiddenBit, biasedExponent - doubleExponentBias);
+    else
+        v = DiyFp(significand, doubleDenormalExponent);
+
+    *w = normalize(v);
+    DiyFp upper = normalize(DiyFp((v.f << 1) + 1, v.e - 1));
+    // The double below a power of two is half as far away, except when
+    // going down to the denormals, which are as far apart as the smallest
+    // normal doubles.
+    DiyFp lower;
+    if (!significand && biasedExponent > 1)
+        lower = DiyFp((v.f << 2) - 1, v.e - 2);
+    else
+        lower = DiyFp((v.f << 1) - 1, v.e - 1);
+    lower.f <<= lower.e - upper.e;
+    lower.e = upper.e;
+    *lowerBoundary = lower;
+    *upperBoundary = upper;
+}
+
+struct CachedPower {
+    uint64_t significand;
+    int16_t binaryExponent;
+    int16_t decimalExponent;
+};
+
+// 10^k, rounded to 64 bits, for every eighth k from -348 to 340.
+static const CachedPower cachedPowers[] = {
+    { 0xfa8fd5a0081c0288ull, -1220, -348 },
+    { 0xbaaee17fa23ebf76ull, -1193, -340 },
+    { 0x8b16fb203055ac76ull, -1166, -332 },
+    { 0xcf42894a5dce35eaull, -1140, -324 },
+    { 0x9a6bb0aa55653b2dull, -1113, -316 },
+    { 0xe61acf033d1a45dfull, -1087, -308 },
+    { 0xab70fe17c79ac6caull, -1060, -300 },
+    { 0xff77b1fcbebcdc4full, -1034, -292 },
+    { 0xbe5691ef416bd60cull, -1007, -284 },
+    { 0x8dd01fad907ffc3cull, -980, -276 },
+    { 0xd3515c2831559a83ull, -954, -268 },
+    { 0x9d71ac8fada6c9b5ull, -927, -260 },
+    { 0xea9c227723ee8bcbull, -901, -252 },
+    { 0xaecc49914078536dull, -874, -244 },
+    { 0x823c12795db6ce57ull, -847, -236 },
+    { 0xc21094364dfb5637ull, -821, -228 },
+    { 0x9096ea6f3848984full, -794, -220 },
+    { 0xd77485cb25823ac7ull, -768, -212 },
+    { 0xa086cfcd97bf97f4ull, -741, -204 },
+    { 0xef340a98172aace5ull, -715, -196 },
+    { 0xb23867fb2a35b28eull, -688, -188 },
+    { 0x84c8d4dfd2c63f3bull, -661, -180 },
+    { 0xc5dd44271ad3cdbaull, -635, -172 },
+    { 0x936b9fcebb25c996ull, -608, -164 },
+    { 0xdbac6c247d62a584ull, -582, -156 },
+    { 0xa3ab66580d5fdaf6ull, -555, -148 },
+    { 0xf3e2f893dec3f126ull, -529, -140 },
+    { 0xb5b5ada8aaff80b8ull, -502, -132 },
+    { 0x87625f056c7c4a8bull, -475, -124 },
+    { 0xc9bcff6034c13053ull, -449, -116 },
+    { 0x964e858c91ba2655ull, -422, -108 },
+    { 0xdff9772470297ebdull, -396, -100 },
+    { 0xa6dfbd9fb8e5b88full, -369, -92 },
+    { 0xf8a95fcf88747d94ull, -343, -84 },
+    { 0xb94470938fa89bcfull, -316, -76 },
+    { 0x8a08f0f8bf0f156bull, -289, -68 },
+    { 0xcdb02555653131b6ull, -263, -60 },
+    { 0x993fe2c6d07b7facull, -236, -52 },
+    { 0xe45c10c42a2b3b06ull, -210, -44 },
+    { 0xaa242499697392d3ull, -183, -36 },
+    { 0xfd87b5f28300ca0eull, -157, -28 },
+    { 0xbce5086492111aebull, -130, -20 },
+    { 0x8cbccc096f5088ccull, -103, -12 },
+    { 0xd1b71758e219652cull, -77, -4 },
+    { 0x9c40000000000000ull, -50, 4 },
+    { 0xe8d4a51000000000ull, -24, 12 },
+    { 0xad78ebc5ac620000ull, 3, 20 },
+    { 0x813f3978f8940984ull, 30, 28 },
+    { 0xc097ce7bc90715b3ull, 56, 36 },
+    { 0x8f7e32ce7bea5c70ull, 83, 44 },
+    { 0xd5d238a4abe98068ull, 109, 52 },
+    { 0x9f4f2726179a2245ull, 136, 60 },
+    { 0xed63a231d4c4fb27ull, 162, 68 },
+    { 0xb0de65388cc8ada8ull, 189, 76 },
+    { 0x83c7088e1aab65dbull, 216, 84 },
+    { 0xc45d1df942711d9aull, 242, 92 },
+    { 0x924d692ca61be758ull, 269, 100 },
+    { 0xda01ee641a708deaull, 295, 108 },
+    { 0xa26da3999aef774aull, 322, 116 },
+    { 0xf209787bb47d6b85ull, 348, 124 },
+    { 0xb454e4a179dd1877ull, 375, 132 },
+    { 0x865b86925b9bc5c2ull, 402, 140 },
+    { 0xc83553c5c8965d3dull, 428, 148 },
+    { 0x952ab45cfa97a0b3ull, 455, 156 },
+    { 0xde469fbd99a05fe3ull, 481, 164 },
+    { 0xa59bc234db398c25ull, 508, 172 },
+    { 0xf6c69a72a3989f5cull, 534, 180 },
+    { 0xb7dcbf5354e9beceull, 561, 188 },
+    { 0x88fcf317f22241e2ull, 588, 196 },
+    { 0xcc20ce9bd35c78a5ull, 614, 204 },
+    { 0x98165af37b2153dfull, 641, 212 },
+    { 0xe2a0b5dc971f303aull, 667, 220 },
+    { 0xa8d9d1535ce3b396ull, 694, 228 },
+    { 0xfb9b7cd9a4a7443cull, 720, 236 },
+    { 0xbb764c4ca7a44410ull, 747, 244 },
+    { 0x8bab8eefb6409c1aull, 774, 252 },
+    { 0xd01fef10a657842cull, 800, 260 },
+    { 0x9b10a4e5e9913129ull, 827, 268 },
+    { 0xe7109bfba19c0c9dull, 853, 276 },
+    { 0xac2820d9623bf429ull, 880, 284 },
+    { 0x80444b5e7aa7cf85ull, 907, 292 },
+    { 0xbf21e44003acdd2dull, 933, 300 },
+    { 0x8e679c2f5e44ff8full, 960, 308 },
+    { 0xd433179d9c8cb841ull, 986, 316 },
+    { 0x9e19db92b4e31ba9ull, 1013, 324 },
+    { 0xeb96bf6ebadf77d9ull, 1039, 332 },
+    { 0xaf87023b9bf0ee6bull, 1066, 340 },
+};
+
+static const int cachedPowersOffset = 348;
+static const int cachedPowersDecimalExponentDistance = 8;
+
+// The scaled boundaries have exponents in this range, which leaves between
+// 32 and 60 bits below the binary point, so the integer part fits in 32 bits.
+static const int minimalTargetExponent = -60;
+static const int maximalTargetExponent = -32;
+
+static inline void cachedPowerForBinaryExponentRange(int minimumExponent, int maximumExponent, DiyFp* power, int* decimalExponent)
+{
+    // 1 / log2(10)
+    double k = ceil((minimumExponent + diyFpSignificandSize - 1) * 0.30102999566398114);
+    int index = (cachedPowersOffset + static_cast<int>(k) - 1) / cachedPowersDecimalExponentDistance + 1;
+    ASSERT(index >= 0 && static_cast<unsigned>(index) < sizeof(cachedPowers) / sizeof(cachedPowers[0]));
+    const CachedPower& cachedPower = cachedPowers[index];
+    ASSERT_UNUSED(maximumExponent, minimumExponent <= cachedPower.binaryExponent && cachedPower.binaryExponent <= maximumExponent);
+    *power = DiyFp(cachedPower.significand, cachedPower.binaryExponent);
+    *decimalExponent = cachedPower.decimalExponent;
+}
+
+// The largest power of ten no greater than the number, with its number of
+// digits; 0 and 0 for 0.
+static inline void biggestPowerOfTen(uint32_t number, uint32_t* power, int* exponentPlusOne)
+{
+    static const uint32_t powersOfTen[] = { 0, 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+    int i = 10;
+    while (number < powersOfTen[i])
+        --i;
+    *power = powersOfTen[i];
+    *exponentPlusOne = i;
+}
+
+// Moves the last digit down while that brings the digits closer to the
+// double, then checks that they are certain to be the closest and to read
+// back as the double. All quantities are in units of the last digit's
+// scale: rest is how far the digits are below the upper boundary, and
+// unit the imprecision of the scaled values.
+static bool roundWeed(char* digits, int length, uint64_t distanceTooHighW, uint64_t unsafeInterval, uint64_t rest, uint64_t tenKappa, uint64_t unit)
+{
+    uint64_t smallDistance = distanceTooHighW - unit;
+    uint64_t bigDistance = distanceTooHighW + unit;
+    while (rest < smallDistance && unsafeInterval - rest >= tenKappa
+        && (rest + tenKappa < smallDistance || smallDistance - rest >= rest + tenKappa - smallDistance)) {
+        --digits[length - 1];
+        rest += tenKappa;
+    }
+
+    // The imprecision leaves it open whether the next lower digits would be
+    // closer.
+    if (rest < bigDistance && unsafeInterval - rest >= tenKappa
+        && (rest + tenKappa < bigDistance || bigDistance - rest > rest + tenKappa - bigDistance))
+        return false;
+
+    // The digits must lie inside the boundaries even allowing for the
+    // imprecision.
+    return 2 * unit <= rest && rest <= unsafeInterval - 4 * unit;
+}
+
+// Generates digits of the upper boundary until they are within the interval
+// between the boundaries, widened by one unit on either side to cover the
+// imprecision of the scaled values.
+static bool generateDigits(DiyFp low, DiyFp w, DiyFp high, char* digits, int* length, int* kappa)
+{
+    ASSERT(low.e == w.e && w.e == high.e);
+    ASSERT(minimalTargetExponent <= w.e && w.e <= maximalTargetExponent);
+    uint64_t unit = 1;
+    DiyFp tooLow(low.f - unit, low.e);
+    DiyFp tooHigh(high.f + unit, high.e);
+    uint64_t unsafeInterval = minus(tooHigh, tooLow).f;
+    int fractionalBits = -w.e;
+    uint64_t one = static_cast<uint64_t>(1) << fractionalBits;
+    uint32_t integrals = static_cast<uint32_t>(tooHigh.f >> fractionalBits);
+    uint64_t fractionals = tooHigh.f & (one - 1);
+
+    uint32_t divisor;
+    biggestPowerOfTen(integrals, &divisor, kappa);
+    *length = 0;
+    while (*kappa > 0) {
+        digits[(*length)++] = static_cast<char>('0' + integrals / divisor);
+        integrals %= divisor;
+        --*kappa;
+        uint64_t rest = (static_cast<uint64_t>(integrals) << fractionalBits) + fractionals;
+        if (rest < unsafeInterval)
+            return roundWeed(digits, *length, minus(tooHigh, w).f, unsafeInterval, rest, static_cast<uint64_t>(divisor) << fractionalBits, unit);
+        divisor /= 10;
+    }
+
+    while (true) {
+        fractionals *= 10;
+        unit *= 10;
+        unsafeInterval *= 10;
+        digits[(*length)++] = static_cast<char>('0' + (fractionals >> fractionalBits));
+        fractionals &= one - 1;
+        --*kappa;
+        if (fractionals < unsafeInterval)
+            return roundWeed(digits, *length, minus(tooHigh, w).f * unit, unsafeInterval, fractionals, one, unit);
+    }
+}
+
+bool fastDtoa(double d, char* digits, int* length, int* decimalPoint)
+{
+    ASSERT(d > 0 && d == d && d - d == 0);
+
+    DiyFp w;
+    DiyFp lowerBoundary;
+    DiyFp upperBoundary;
+    decompose(d, &w, &lowerBoundary, &upperBoundary);
+    ASSERT(upperBoundary.e == w.e);
+
+    DiyFp tenMinusK;
+    int minusK;
+    cachedPowerForBinaryExponentRange(minimalTargetExponent - (w.e + diyFpSignificandSize), maximalTargetExponent - (w.e + diyFpSignificandSize), &tenMinusK, &minusK);
+
+    int kappa;
+    if (!generateDigits(times(lowerBoundary, tenMinusK), times(w, tenMinusK), times(upperBoundary, tenMinusK), digits, length, &kappa))
+        return false;
+    *decimalPoint = *length - minusK + kappa;
+    return true;
+}
+
+} // namespace ATF
@@ -0,0 +1,35 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+#ifndef FastDtoa_h
+#define FastDtoa_h
+
+namespace ATF {
+
+    // Writes the shortest digits that read back as the given positive, finite
+    // double, choosing the ones closest to it, as dtoa() does. The digits are
+    // not terminated by 0; *decimalPoint is placed as dtoa() places *decpt.
+    // Returns false, leaving dtoa() to work it out with big numbers, in the
+    // rare cases where that cannot be decided with 64-bit arithmetic.
+    bool fastDtoa(double, char* digits, int* length, int* decimalPoint);
+
+} // namespace ATF
+
+using ATF::fastDtoa;
+
+#endif // FastDtoa_h
@@ -0,0 +1,35 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+#ifndef FastStrtod_h
+#define FastStrtod_h
+
+namespace ATF {
+
+    // Reads a plain decimal number, [+-]digits[.digits][(e|E)[+-]digits], of
+    // at most 19 significant digits, into the nearest double, as strtod()
+    // does, and sets *end past it. Returns false, leaving strtod() to work it
+    // out with big numbers, for anything else, and in the rare cases where
+    // the nearest double cannot be decided with 128-bit arithmetic.
+    bool fastStrtod(const char* string, double* result, char** end);
+
+} // namespace ATF
+
+using ATF::fastStrtod;
+
+#endif // FastStrtod_h
@@ -1181,6 +1181,12 @@ on MinGW. See https://bugs.webkit.org/show_bug.cgi?id=29268 */
 
 #define ENABLE_JSC_ZOMBIES 0
 
+/* Parallel marking needs helper threads and an atomic compare-and-swap for the mark bits. */
+#if !defined(ENABLE_PARALLEL_MARKING) && !ENABLE(SINGLE_THREADED) \
+    && (OS(DARWIN) || OS(WINDOWS) || OS(ANDROID) || (COMPILER(GCC) && !CPU(SPARC64) && !OS(SYMBIAN)))
+#define ENABLE_PARALLEL_MARKING 1
+#endif
+
 #if CPU(ARM_THUMB2)
 #define ENABLE_BRANCH_COMPACTION 1
 #endif
@@ -128,6 +128,11 @@ inline unsigned stringHash(const char* data, unsigned length)
     return hash;
 }
 
+inline unsigned stringHash(const LChar* data, unsigned length)
+{
+    return stringHash(reinterpret_cast<const char*>(data), length);
+}
+
 inline unsigned stringHash(const char* data)
 {
     unsigned hash = ATF::stringHashingStartValue;
@@ -163,6 +163,8 @@ limitations under the License.
 #include <string.h>
 #include <wtf/AlwaysInline.h>
 #include <wtf/Assertions.h>
+#include <wtf/FastDtoa.h>
+#include <wtf/FastStrtod.h>
 #include <wtf/FastMalloc.h>
 #include <wtf/MathExtras.h>
 #include <wtf/Vector.h>
@@ -1131,6 +1133,10 @@ double strtod(const char* s00, char** se)
     int inexact, oldinexact;
 #endif
 
+    double fastResult;
+    if (fastStrtod(s00, &fastResult, se))
+        return fastResult;
+
     sign = nz0 = nz = 0;
     dval(&rv) = 0;
     for (s = s00; ; s++)
@@ -1947,6 +1953,14 @@ void dtoa(DtoaBuffer result, double dd, int ndigits, int* decpt, int* sign, char
         return;
     }
 
+    int fastLength;
+    if (fastDtoa(dval(&u), result, &fastLength, decpt)) {
+        result[fastLength] = '\0';
+        if (rve)
+            *rve = result + fastLength;
+        return;
+    }
+
 #ifdef SET_INEXACT
     try_quick = oldinexact = get_inexact();
     inexact = 1;
@@ -71,11 +71,19 @@ namespace Aphid {
             if (aLength != bLength)
                 return false;
 
+            if (a->is8Bit()) {
+                if (b->is8Bit())
+                    return Aphid::equal(a->characters8(), b->characters8(), aLength);
+                return Aphid::equal(a->characters8(), b->characters16(), aLength);
+            }
+            if (b->is8Bit())
+                return Aphid::equal(a->characters16(), b->characters8(), aLength);
+
             // FIXME: perhaps we should have a more abstract macro that indicates when
             // going 4 bytes at a time is unsafe
 #if CPU(ARM) || CPU(SH4)
-            const UChar* aChars = a->characters();
-            const UChar* bChars = b->characters();
+            const UChar* aChars = a->characters16();
+            const UChar* bChars = b->characters16();
             for (unsigned i = 0; i != aLength; ++i) {
                 if (*aChars++ != *bChars++)
                     return false;
@@ -83,8 +91,8 @@ namespace Aphid {
             return true;
 #else
             /* Do it 4-bytes-at-a-time on architectures where it's safe */
-            const uint32_t* aChars = reinterpret_cast<const uint32_t*>(a->characters());
-            const uint32_t* bChars = reinterpret_cast<const uint32_t*>(b->characters());
+            const uint32_t* aChars = reinterpret_cast<const uint32_t*>(a->characters16());
+            const uint32_t* bChars = reinterpret_cast<const uint32_t*>(b->characters16());
 
             unsigned halfLength = aLength >> 1;
             for (unsigned i = 0; i != halfLength; ++i)
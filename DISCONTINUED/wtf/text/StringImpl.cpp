@@ -47,6 +47,7 @@ limitations under the License.
 #include "StringHash.h"
 #include <wtf/StdLibExtras.h>
 #include <wtf/ATFThreadData.h>
+#include <wtf/text/StringSearch.h>
 
 using namespace ATF;
 using namespace Unicode;
@@ -68,7 +69,10 @@ StringImpl::~StringImpl()
 #endif
 
     BufferOwnership ownership = bufferOwnership();
-    if (ownership != BufferInternal) {
+    if (ownership == BufferInternal) {
+        if (is8Bit() && m_copyData16)
+            fastFree(m_copyData16);
+    } else {
         if (ownership == BufferOwned) {
             ASSERT(!m_sharedBuffer);
             ASSERT(m_data);
@@ -103,6 +107,22 @@ PassRefPtr<StringImpl> StringImpl::createUninitialized(unsigned length, UChar*&
     return adoptRef(new (string) StringImpl(length));
 }
 
+PassRefPtr<StringImpl> StringImpl::createUninitialized(unsigned length, LChar*& data)
+{
+    if (!length) {
+        data = 0;
+        return empty();
+    }
+
+    if (length > ((std::numeric_limits<unsigned>::max() - sizeof(StringImpl)) / sizeof(LChar)))
+        CRASH();
+    size_t size = sizeof(StringImpl) + length * sizeof(LChar);
+    StringImpl* string = static_cast<StringImpl*>(fastMalloc(size));
+
+    data = reinterpret_cast<LChar*>(string + 1);
+    return adoptRef(new (string) StringImpl(length, Force8BitConstructor));
+}
+
 PassRefPtr<StringImpl> StringImpl::create(const UChar* characters, unsigned length)
 {
     if (!characters || !length)
@@ -114,17 +134,32 @@ PassRefPtr<StringImpl> StringImpl::create(const UChar* characters, unsigned leng
     return string.release();
 }
 
-PassRefPtr<StringImpl> StringImpl::create(const char* characters, unsigned length)
+PassRefPtr<StringImpl> StringImpl::create(const LChar* characters, unsigned length)
 {
     if (!characters || !length)
         return empty();
 
-    UChar* data;
+    LChar* data;
     RefPtr<StringImpl> string = createUninitialized(length, data);
-    for (unsigned i = 0; i != length; ++i) {
-        unsigned char c = characters[i];
-        data[i] = c;
-    }
+    memcpy(data, characters, length * sizeof(LChar));
+    return string.release();
+}
+
+PassRefPtr<StringImpl> StringImpl::create8BitIfPossible(const UChar* characters, unsigned length)
+{
+    if (!characters || !length)
+        return empty();
+
+    UChar ored = 0;
+    for (unsigned i = 0; i != length; ++i)
+        ored |= characters[i];
+    if (ored & ~0xFF)
+        return create(characters, length);
+
+    LChar* data;
+    RefPtr<StringImpl> string = createUninitialized(length, data);
+    for (unsigned i = 0; i != length; ++i)
+        data[i] = static_cast<LChar>(characters[i]);
     return string.release();
 }
 
@@ -145,6 +180,23 @@ PassRefPtr<StringImpl> StringImpl::create(const UChar* characters, unsigned leng
     return adoptRef(new StringImpl(characters, length, sharedBuffer));
 }
 
+const UChar* StringImpl::getData16SlowCase() const
+{
+    ASSERT(is8Bit());
+
+    // A substring shares the widened copy of the string it points into.
+    if (bufferOwnership() == BufferSubstring)
+        return m_substringBuffer->characters() + (m_data8 - m_substringBuffer->m_data8);
+
+    ASSERT(bufferOwnership() == BufferInternal);
+    if (!m_copyData16) {
+        UChar* copy = static_cast<UChar*>(fastMalloc(m_length * sizeof(UChar)));
+        copyChars(copy, m_data8, m_length);
+        m_copyData16 = copy;
+    }
+    return m_copyData16;
+}
+
 SharedUChar* StringImpl::sharedBuffer()
 {
     if (m_length < minLengthToShare)
@@ -174,8 +226,9 @@ bool StringImpl::containsOnlyWhitespace()
     // FIXME: The definition of whitespace here includes a number of characters
     // that are not whitespace from the point of view of RenderText; I wonder if
     // that's a problem in practice.
+    const UChar* characters = this->characters();
     for (unsigned i = 0; i < m_length; i++)
-        if (!isASCIISpace(m_data[i]))
+        if (!isASCIISpace(characters[i]))
             return false;
     return true;
 }
@@ -190,11 +243,15 @@ PassRefPtr<StringImpl> StringImpl::substring(unsigned start, unsigned length)
             return this;
         length = maxLength;
     }
+    if (is8Bit())
+        return create(m_data8 + start, length);
     return create(m_data + start, length);
 }
 
 UChar32 StringImpl::characterStartingAt(unsigned i)
 {
+    if (is8Bit())
+        return m_data8[i];
     if (U16_IS_SINGLE(m_data[i]))
         return m_data[i];
     if (i + 1 < m_length && U16_IS_LEAD(m_data[i]) && U16_IS_TRAIL(m_data[i + 1]))
@@ -208,10 +265,11 @@ PassRefPtr<StringImpl> StringImpl::lower()
     // no-op code path up through the first 'return' statement.
     
     // First scan the string for uppercase and non-ASCII characters:
+    const UChar* characters = this->characters();
     UChar ored = 0;
     bool noUpper = true;
-    const UChar *end = m_data + m_length;
-    for (const UChar* chp = m_data; chp != end; chp++) {
+    const UChar *end = characters + m_length;
+    for (const UChar* chp = characters; chp != end; chp++) {
         if (UNLIKELY(isASCIIUpper(*chp)))
             noUpper = false;
         ored |= *chp;
@@ -231,7 +289,7 @@ PassRefPtr<StringImpl> StringImpl::lower()
     if (!(ored & ~0x7F)) {
         // Do a faster loop for the case where all the characters are ASCII.
         for (int i = 0; i < length; i++) {
-            UChar c = m_data[i];
+            UChar c = characters[i];
             data[i] = toASCIILower(c);
         }
         return newImpl;
@@ -239,11 +297,11 @@ PassRefPtr<StringImpl> StringImpl::lower()
     
     // Do a slower implementation for cases that include non-ASCII characters.
     bool error;
-    int32_t realLength = Unicode::toLower(data, length, m_data, m_length, &error);
+    int32_t realLength = Unicode::toLower(data, length, characters, m_length, &error);
     if (!error && realLength == length)
         return newImpl;
     newImpl = createUninitialized(realLength, data);
-    Unicode::toLower(data, realLength, m_data, m_length, &error);
+    Unicode::toLower(data, realLength, characters, m_length, &error);
     if (error)
         return this;
     return newImpl;
@@ -262,9 +320,10 @@ PassRefPtr<StringImpl> StringImpl::upper()
     int32_t length = m_length;
 
     // Do a faster loop for the case where all the characters are ASCII.
+    const UChar* characters = this->characters();
     UChar ored = 0;
     for (int i = 0; i < length; i++) {
-        UChar c = m_data[i];
+        UChar c = characters[i];
         ored |= c;
         data[i] = toASCIIUpper(c);
     }
@@ -273,11 +332,11 @@ PassRefPtr<StringImpl> StringImpl::upper()
 
     // Do a slower implementation for cases that include non-ASCII characters.
     bool error;
-    int32_t realLength = Unicode::toUpper(data, length, m_data, m_length, &error);
+    int32_t realLength = Unicode::toUpper(data, length, characters, m_length, &error);
     if (!error && realLength == length)
         return newImpl;
     newImpl = createUninitialized(realLength, data);
-    Unicode::toUpper(data, realLength, m_data, m_length, &error);
+    Unicode::toUpper(data, realLength, characters, m_length, &error);
     if (error)
         return this;
     return newImpl.release();
@@ -291,7 +350,7 @@ PassRefPtr<StringImpl> StringImpl::secure(UChar character, bool hideLastCharacte
         const unsigned lastCharacterIndex = m_length - 1;
         for (unsigned i = 0; i < lastCharacterIndex; ++i)
             data[i] = character;
-        data[lastCharacterIndex] = hideLastCharacter ? character : m_data[lastCharacterIndex];
+        data[lastCharacterIndex] = hideLastCharacter ? character : (*this)[lastCharacterIndex];
     }
     return newImpl.release();
 }
@@ -306,9 +365,10 @@ PassRefPtr<StringImpl> StringImpl::foldCase()
     int32_t length = m_length;
 
     // Do a faster loop for the case where all the characters are ASCII.
+    const UChar* characters = this->characters();
     UChar ored = 0;
     for (int32_t i = 0; i < length; i++) {
-        UChar c = m_data[i];
+        UChar c = characters[i];
         ored |= c;
         data[i] = toASCIILower(c);
     }
@@ -317,11 +377,11 @@ PassRefPtr<StringImpl> StringImpl::foldCase()
 
     // Do a slower implementation for cases that include non-ASCII characters.
     bool error;
-    int32_t realLength = Unicode::foldCase(data, length, m_data, m_length, &error);
+    int32_t realLength = Unicode::foldCase(data, length, characters, m_length, &error);
     if (!error && realLength == length)
         return newImpl.release();
     newImpl = createUninitialized(realLength, data);
-    Unicode::foldCase(data, realLength, m_data, m_length, &error);
+    Unicode::foldCase(data, realLength, characters, m_length, &error);
     if (error)
         return this;
     return newImpl.release();
@@ -332,11 +392,12 @@ PassRefPtr<StringImpl> StringImpl::stripWhiteSpace()
     if (!m_length)
         return empty();
 
+    const UChar* characters = this->characters();
     unsigned start = 0;
     unsigned end = m_length - 1;
     
     // skip white space from start
-    while (start <= end && isSpaceOrNewline(m_data[start]))
+    while (start <= end && isSpaceOrNewline(characters[start]))
         start++;
     
     // only white space
@@ -344,17 +405,18 @@ PassRefPtr<StringImpl> StringImpl::stripWhiteSpace()
         return empty();
 
     // skip white space from end
-    while (end && isSpaceOrNewline(m_data[end]))
+    while (end && isSpaceOrNewline(characters[end]))
         end--;
 
     if (!start && end == m_length - 1)
         return this;
-    return create(m_data + start, end + 1 - start);
+    return create(characters + start, end + 1 - start);
 }
 
 PassRefPtr<StringImpl> StringImpl::removeCharacters(CharacterMatchFunctionPtr findMatch)
 {
-    const UChar* from = m_data;
+    const UChar* characters = this->characters();
+    const UChar* from = characters;
     const UChar* fromend = from + m_length;
 
     // Assume the common case will not remove any characters
@@ -365,10 +427,10 @@ PassRefPtr<StringImpl> StringImpl::removeCharacters(CharacterMatchFunctionPtr fi
 
     StringBuffer data(m_length);
     UChar* to = data.characters();
-    unsigned outc = from - m_data;
+    unsigned outc = from - characters;
 
     if (outc)
-        memcpy(to, m_data, outc * sizeof(UChar));
+        memcpy(to, characters, outc * sizeof(UChar));
 
     while (true) {
         while (from != fromend && findMatch(*from))
@@ -388,7 +450,7 @@ PassRefPtr<StringImpl> StringImpl::simplifyWhiteSpace()
 {
     StringBuffer data(m_length);
 
-    const UChar* from = m_data;
+    const UChar* from = characters();
     const UChar* fromend = from + m_length;
     int outc = 0;
     bool changedToSpace = false;
@@ -422,62 +484,62 @@ PassRefPtr<StringImpl> StringImpl::simplifyWhiteSpace()
 
 int StringImpl::toIntStrict(bool* ok, int base)
 {
-    return charactersToIntStrict(m_data, m_length, ok, base);
+    return charactersToIntStrict(characters(), m_length, ok, base);
 }
 
 unsigned StringImpl::toUIntStrict(bool* ok, int base)
 {
-    return charactersToUIntStrict(m_data, m_length, ok, base);
+    return charactersToUIntStrict(characters(), m_length, ok, base);
 }
 
 int64_t StringImpl::toInt64Strict(bool* ok, int base)
 {
-    return charactersToInt64Strict(m_data, m_length, ok, base);
+    return charactersToInt64Strict(characters(), m_length, ok, base);
 }
 
 uint64_t StringImpl::toUInt64Strict(bool* ok, int base)
 {
-    return charactersToUInt64Strict(m_data, m_length, ok, base);
+    return charactersToUInt64Strict(characters(), m_length, ok, base);
 }
 
 intptr_t StringImpl::toIntPtrStrict(bool* ok, int base)
 {
-    return charactersToIntPtrStrict(m_data, m_length, ok, base);
+    return charactersToIntPtrStrict(characters(), m_length, ok, base);
 }
 
 int StringImpl::toInt(bool* ok)
 {
-    return charactersToInt(m_data, m_length, ok);
+    return charactersToInt(characters(), m_length, ok);
 }
 
 unsigned StringImpl::toUInt(bool* ok)
 {
-    return charactersToUInt(m_data, m_length, ok);
+    return charactersToUInt(characters(), m_length, ok);
 }
 
 int64_t StringImpl::toInt64(bool* ok)
 {
-    return charactersToInt64(m_data, m_length, ok);
+    return charactersToInt64(characters(), m_length, ok);
 }
 
 uint64_t StringImpl::toUInt64(bool* ok)
 {
-    return charactersToUInt64(m_data, m_length, ok);
+    return charactersToUInt64(characters(), m_length, ok);
 }
 
 intptr_t StringImpl::toIntPtr(bool* ok)
 {
-    return charactersToIntPtr(m_data, m_length, ok);
+    return charactersToIntPtr(characters(), m_length, ok);
 }
 
 double StringImpl::toDouble(bool* ok)
 {
-    return charactersToDouble(m_data, m_length, ok);
+    return charactersToDouble(characters(), m_length, ok);
 }
 
 float StringImpl::toFloat(bool* ok)
 {
-    return charactersToFloat(m_data, m_length, ok);
+    return charactersToFloat(characters(), m_length, ok);
 }
 
 static bool equal(const UChar* a, const char* b, int length)
@@ -526,7 +588,7 @@ int StringImpl::find(const char* chs, int index, bool caseSensitive)
     const char* chsPlusOne = chs + 1;
     int chsLengthMinusOne = chsLength - 1;
     
-    const UChar* ptr = m_data + index - 1;
+    const UChar* ptr = characters() + index - 1;
     if (caseSensitive) {
         UChar c = *chs;
         do {
@@ -546,12 +608,21 @@ int StringImpl::find(const char* chs, int index, bool caseSensitive)
 
 int StringImpl::find(UChar c, int start)
 {
-    return Aphid::find(m_data, m_length, c, start);
+    if (start < 0 || static_cast<unsigned>(start) >= m_length)
+        return -1;
+    size_t result;
+    if (is8Bit()) {
+        if (c > 0xFF)
+            return -1;
+        result = findCharacter(m_data8, m_length, static_cast<LChar>(c), start);
+    } else
+        result = findCharacter(m_data, m_length, c, start);
+    return result == notFound ? -1 : static_cast<int>(result);
 }
 
 int StringImpl::find(CharacterMatchFunctionPtr matchFunction, int start)
 {
-    return Aphid::find(m_data, m_length, matchFunction, start);
+    return Aphid::find(characters(), m_length, matchFunction, start);
 }
 
 int StringImpl::find(StringImpl* str, int index, bool caseSensitive)
@@ -573,8 +644,8 @@ int StringImpl::find(StringImpl* str, int index, bool caseSensitive)
     if (delta < 0)
         return -1;
 
-    const UChar* uthis = m_data + index;
-    const UChar* ustr = str->m_data;
+    const UChar* uthis = characters() + index;
+    const UChar* ustr = str->characters();
     unsigned hthis = 0;
     unsigned hstr = 0;
     if (caseSensitive) {
@@ -612,7 +683,20 @@ int StringImpl::find(StringImpl* str, int index, bool caseSensitive)
 
 int StringImpl::reverseFind(UChar c, int index)
 {
-    return Aphid::reverseFind(m_data, m_length, c, index);
+    if (index >= static_cast<int>(m_length) || !m_length)
+        return -1;
+    if (index < 0)
+        index += static_cast<int>(m_length);
+    if (index < 0)
+        return -1;
+    size_t result;
+    if (is8Bit()) {
+        if (c > 0xFF)
+            return -1;
+        result = reverseFindCharacter(m_data8, static_cast<LChar>(c), index);
+    } else
+        result = reverseFindCharacter(m_data, c, index);
+    return result == notFound ? -1 : static_cast<int>(result);
 }
 
 int StringImpl::reverseFind(StringImpl* str, int index, bool caseSensitive)
@@ -632,8 +716,8 @@ int StringImpl::reverseFind(StringImpl* str, int index, bool caseSensitive)
     if ( index > delta )
         index = delta;
     
-    const UChar *uthis = m_data;
-    const UChar *ustr = str->m_data;
+    const UChar *uthis = characters();
+    const UChar *ustr = str->characters();
     unsigned hthis = 0;
     unsigned hstr = 0;
     int i;
@@ -686,9 +770,10 @@ PassRefPtr<StringImpl> StringImpl::replace(UChar oldC, UChar newC)
 {
     if (oldC == newC)
         return this;
+    const UChar* characters = this->characters();
     unsigned i;
     for (i = 0; i != m_length; ++i)
-        if (m_data[i] == oldC)
+        if (characters[i] == oldC)
             break;
     if (i == m_length)
         return this;
@@ -697,7 +782,7 @@ PassRefPtr<StringImpl> StringImpl::replace(UChar oldC, UChar newC)
     RefPtr<StringImpl> newImpl = createUninitialized(m_length, data);
 
     for (i = 0; i != m_length; ++i) {
-        UChar ch = m_data[i];
+        UChar ch = characters[i];
         if (ch == oldC)
             ch = newC;
         data[i] = ch;
@@ -767,15 +852,15 @@ PassRefPtr<StringImpl> StringImpl::replace(UChar pattern, StringImpl* replacemen
     
     while ((srcSegmentEnd = find(pattern, srcSegmentStart)) >= 0) {
         srcSegmentLength = srcSegmentEnd - srcSegmentStart;
-        memcpy(data + dstOffset, m_data + srcSegmentStart, srcSegmentLength * sizeof(UChar));
+        memcpy(data + dstOffset, characters() + srcSegmentStart, srcSegmentLength * sizeof(UChar));
         dstOffset += srcSegmentLength;
-        memcpy(data + dstOffset, replacement->m_data, repStrLength * sizeof(UChar));
+        memcpy(data + dstOffset, replacement->characters(), repStrLength * sizeof(UChar));
         dstOffset += repStrLength;
         srcSegmentStart = srcSegmentEnd + 1;
     }
 
     srcSegmentLength = m_length - srcSegmentStart;
-    memcpy(data + dstOffset, m_data + srcSegmentStart, srcSegmentLength * sizeof(UChar));
+    memcpy(data + dstOffset, characters() + srcSegmentStart, srcSegmentLength * sizeof(UChar));
 
     ASSERT(dstOffset + srcSegmentLength == static_cast<int>(newImpl->length()));
 
@@ -825,15 +910,15 @@ PassRefPtr<StringImpl> StringImpl::replace(StringImpl* pattern, StringImpl* repl
     
     while ((srcSegmentEnd = find(pattern, srcSegmentStart)) >= 0) {
         srcSegmentLength = srcSegmentEnd - srcSegmentStart;
-        memcpy(data + dstOffset, m_data + srcSegmentStart, srcSegmentLength * sizeof(UChar));
+        memcpy(data + dstOffset, characters() + srcSegmentStart, srcSegmentLength * sizeof(UChar));
         dstOffset += srcSegmentLength;
-        memcpy(data + dstOffset, replacement->m_data, repStrLength * sizeof(UChar));
+        memcpy(data + dstOffset, replacement->characters(), repStrLength * sizeof(UChar));
         dstOffset += repStrLength;
         srcSegmentStart = srcSegmentEnd + patternLength;
     }
 
     srcSegmentLength = m_length - srcSegmentStart;
-    memcpy(data + dstOffset, m_data + srcSegmentStart, srcSegmentLength * sizeof(UChar));
+    memcpy(data + dstOffset, characters() + srcSegmentStart, srcSegmentLength * sizeof(UChar));
 
     ASSERT(dstOffset + srcSegmentLength == static_cast<int>(newImpl->length()));
 
@@ -853,7 +938,19 @@ bool equal(const StringImpl* a, const char* b)
         return !a;
 
     unsigned length = a->length();
-    const UChar* as = a->characters();
+    if (a->is8Bit()) {
+        const LChar* as = a->characters8();
+        for (unsigned i = 0; i != length; ++i) {
+            LChar bc = b[i];
+            if (!bc)
+                return false;
+            if (as[i] != bc)
+                return false;
+        }
+        return !b[length];
+    }
+
+    const UChar* as = a->characters16();
     for (unsigned i = 0; i != length; ++i) {
         unsigned char bc = b[i];
         if (!bc)
@@ -865,6 +962,24 @@ bool equal(const StringImpl* a, const char* b)
     return !b[length];
 }
 
+bool equal(const StringImpl* a, const UChar* b, unsigned length)
+{
+    if (a->length() != length)
+        return false;
+    if (a->is8Bit())
+        return equal(a->characters8(), b, length);
+    return equal(a->characters16(), b, length);
+}
+
+bool equal(const StringImpl* a, const LChar* b, unsigned length)
+{
+    if (a->length() != length)
+        return false;
+    if (a->is8Bit())
+        return equal(a->characters8(), b, length);
+    return equal(a->characters16(), b, length);
+}
+
 bool equalIgnoringCase(StringImpl* a, StringImpl* b)
 {
     return CaseFoldingHash::equal(a, b);
@@ -920,7 +1035,7 @@ Vector<char> StringImpl::ascii()
 {
     Vector<char> buffer(m_length + 1);
     for (unsigned i = 0; i != m_length; ++i) {
-        UChar c = m_data[i];
+        UChar c = (*this)[i];
         if ((c >= 0x20 && c < 0x7F) || c == 0x00)
             buffer[i] = static_cast<char>(c);
         else
@@ -933,7 +1048,7 @@ Vector<char> StringImpl::ascii()
 ATF::Unicode::Direction StringImpl::defaultWritingDirection()
 {
     for (unsigned i = 0; i < m_length; ++i) {
-        ATF::Unicode::Direction charDirection = ATF::Unicode::direction(m_data[i]);
+        ATF::Unicode::Direction charDirection = ATF::Unicode::direction((*this)[i]);
         if (charDirection == ATF::Unicode::LeftToRight)
             return ATF::Unicode::LeftToRight;
         if (charDirection == ATF::Unicode::RightToLeft || charDirection == ATF::Unicode::RightToLeftArabic)
@@ -970,7 +1085,7 @@ int StringImpl::wordCount(int maxWordsToCount)
     unsigned i;
     bool atWord = false;
     for (i = 0; i < m_length; i++) {
-        if (u_isspace(m_data[i])) {
+        if (u_isspace((*this)[i])) {
             atWord = false;
         } else if (!atWord) {
             wordCount++;
@@ -991,7 +1106,7 @@ PassRefPtr<StringImpl> StringImpl::createWithTerminatingNullCharacter(const Stri
     if (length >= numeric_limits<unsigned>::max())
         CRASH();
     RefPtr<StringImpl> terminatedString = createUninitialized(length + 1, data);
-    memcpy(data, string.m_data, length * sizeof(UChar));
+    memcpy(data, string.characters(), length * sizeof(UChar));
     data[length] = 0;
     terminatedString->m_length--;
     terminatedString->m_hash = string.m_hash;
@@ -1001,6 +1116,8 @@ PassRefPtr<StringImpl> StringImpl::createWithTerminatingNullCharacter(const Stri
 
 PassRefPtr<StringImpl> StringImpl::threadsafeCopy() const
 {
+    if (is8Bit())
+        return create(m_data8, m_length);
     return create(m_data, m_length);
 }
 
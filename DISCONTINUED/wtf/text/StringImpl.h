@@ -64,6 +64,7 @@ namespace AJ {
 
 struct IdentifierCStringTranslator;
 struct IdentifierUCharBufferTranslator;
+struct IdentifierLCharBufferTranslator;
 
 }
 
@@ -87,6 +88,7 @@ typedef bool (*CharacterMatchFunctionPtr)(UChar);
 class StringImpl : public StringImplBase {
     friend struct AJ::IdentifierCStringTranslator;
     friend struct AJ::IdentifierUCharBufferTranslator;
+    friend struct AJ::IdentifierLCharBufferTranslator;
     friend struct CStringTranslator;
     friend struct HashAndCharactersTranslator;
     friend struct UCharBufferTranslator;
@@ -118,6 +120,20 @@ private:
         ASSERT(m_length);
     }
 
+    // Create a Latin-1 string with internal storage (BufferInternal). The UTF-16
+    // copy that characters() hands out is made on first use and kept in m_copyData16.
+    enum Force8Bit { Force8BitConstructor };
+    StringImpl(unsigned length, Force8Bit)
+        : StringImplBase(length, BufferInternal)
+        , m_data8(reinterpret_cast<const LChar*>(this + 1))
+        , m_copyData16(0)
+        , m_hash(0)
+    {
+        ASSERT(m_data8);
+        ASSERT(m_length);
+        m_refCountAndFlags |= s_refCountFlagIs8Bit;
+    }
+
     // Create a StringImpl adopting ownership of the provided buffer (BufferOwned)
     StringImpl(const UChar* characters, unsigned length)
         : StringImplBase(length, BufferOwned)
@@ -141,6 +157,20 @@ private:
         ASSERT(m_substringBuffer->bufferOwnership() != BufferSubstring);
     }
 
+    // Used to create new strings that are a substring of an existing 8-bit StringImpl (BufferSubstring)
+    StringImpl(const LChar* characters, unsigned length, PassRefPtr<StringImpl> base)
+        : StringImplBase(length, BufferSubstring)
+        , m_data8(characters)
+        , m_substringBuffer(base.releaseRef())
+        , m_hash(0)
+    {
+        ASSERT(m_data8);
+        ASSERT(m_length);
+        ASSERT(m_substringBuffer->bufferOwnership() != BufferSubstring);
+        ASSERT(m_substringBuffer->is8Bit());
+        m_refCountAndFlags |= s_refCountFlagIs8Bit;
+    }
+
     // Used to construct new strings sharing an existing SharedUChar (BufferShared)
     StringImpl(const UChar* characters, unsigned length, PassRefPtr<SharedUChar> sharedBuffer)
         : StringImplBase(length, BufferShared)
@@ -157,7 +187,7 @@ private:
     {
         ASSERT(!isStatic());
         ASSERT(!m_hash);
-        ASSERT(hash == computeHash(m_data, m_length));
+        ASSERT(hash == (is8Bit() ? computeHash(m_data8, m_length) : computeHash(m_data, m_length)));
         m_hash = hash;
     }
 
@@ -165,8 +195,11 @@ public:
     ~StringImpl();
 
     static PassRefPtr<StringImpl> create(const UChar*, unsigned length);
-    static PassRefPtr<StringImpl> create(const char*, unsigned length);
+    static PassRefPtr<StringImpl> create(const LChar*, unsigned length);
+    static PassRefPtr<StringImpl> create(const char* characters, unsigned length) { return create(reinterpret_cast<const LChar*>(characters), length); }
     static PassRefPtr<StringImpl> create(const char*);
+    // Makes an 8-bit string if every character is Latin-1.
+    static PassRefPtr<StringImpl> create8BitIfPossible(const UChar*, unsigned length);
     static PassRefPtr<StringImpl> create(const UChar*, unsigned length, PassRefPtr<SharedUChar> sharedBuffer);
     static PassRefPtr<StringImpl> create(PassRefPtr<StringImpl> rep, unsigned offset, unsigned length)
     {
@@ -177,10 +210,13 @@ public:
             return empty();
 
         StringImpl* ownerRep = (rep->bufferOwnership() == BufferSubstring) ? rep->m_substringBuffer : rep.get();
+        if (rep->is8Bit())
+            return adoptRef(new StringImpl(rep->m_data8 + offset, length, ownerRep));
         return adoptRef(new StringImpl(rep->m_data + offset, length, ownerRep));
     }
 
     static PassRefPtr<StringImpl> createUninitialized(unsigned length, UChar*& data);
+    static PassRefPtr<StringImpl> createUninitialized(unsigned length, LChar*& data);
     static PassRefPtr<StringImpl> tryCreateUninitialized(unsigned length, UChar*& output)
     {
         if (!length) {
@@ -200,8 +236,31 @@ public:
         output = reinterpret_cast<UChar*>(resultImpl + 1);
         return adoptRef(new(resultImpl) StringImpl(length));
     }
+    static PassRefPtr<StringImpl> tryCreateUninitialized(unsigned length, LChar*& output)
+    {
+        if (!length) {
+            output = 0;
+            return empty();
+        }
+
+        if (length > ((std::numeric_limits<unsigned>::max() - sizeof(StringImpl)) / sizeof(LChar))) {
+            output = 0;
+            return 0;
+        }
+        StringImpl* resultImpl;
+        if (!tryFastMalloc(sizeof(LChar) * length + sizeof(StringImpl)).getValue(resultImpl)) {
+            output = 0;
+            return 0;
+        }
+        output = reinterpret_cast<LChar*>(resultImpl + 1);
+        return adoptRef(new(resultImpl) StringImpl(length, Force8BitConstructor));
+    }
 
+    // The JIT reads characters straight out of m_data, so it must check
+    // the 8-bit flag first.
     static unsigned dataOffset() { return OBJECT_OFFSETOF(StringImpl, m_data); }
+    static unsigned flagsOffset() { return OBJECT_OFFSETOF(StringImpl, m_refCountAndFlags); }
+    static unsigned flagIs8Bit() { return s_refCountFlagIs8Bit; }
     static PassRefPtr<StringImpl> createWithTerminatingNullCharacter(const StringImpl&);
     static PassRefPtr<StringImpl> createStrippingNullCharacters(const UChar*, unsigned length);
 
@@ -219,7 +278,16 @@ public:
     static PassRefPtr<StringImpl> adopt(StringBuffer&);
 
     SharedUChar* sharedBuffer();
-    const UChar* characters() const { return m_data; }
+
+    const LChar* characters8() const { ASSERT(is8Bit()); return m_data8; }
+    const UChar* characters16() const { ASSERT(!is8Bit()); return m_data; }
+    // Widens an 8-bit string the first time it is asked for.
+    const UChar* characters() const
+    {
+        if (!is8Bit())
+            return m_data;
+        return getData16SlowCase();
+    }
 
     size_t cost()
     {
@@ -256,9 +324,10 @@ public:
             m_refCountAndFlags &= ~s_refCountFlagIsAtomic;
     }
 
-    unsigned hash() const { if (!m_hash) m_hash = computeHash(m_data, m_length); return m_hash; }
+    unsigned hash() const { if (!m_hash) m_hash = is8Bit() ? computeHash(m_data8, m_length) : computeHash(m_data, m_length); return m_hash; }
     unsigned existingHash() const { ASSERT(m_hash); return m_hash; }
     static unsigned computeHash(const UChar* data, unsigned length) { return ATF::stringHash(data, length); }
+    static unsigned computeHash(const LChar* data, unsigned length) { return ATF::stringHash(data, length); }
     static unsigned computeHash(const char* data, unsigned length) { return ATF::stringHash(data, length); }
     static unsigned computeHash(const char* data) { return ATF::stringHash(data); }
 
@@ -276,6 +345,21 @@ public:
             memcpy(destination, source, numCharacters * sizeof(UChar));
     }
 
+    static void copyChars(LChar* destination, const LChar* source, unsigned numCharacters)
+    {
+        if (numCharacters <= s_copyCharsInlineCutOff) {
+            for (unsigned i = 0; i < numCharacters; ++i)
+                destination[i] = source[i];
+        } else
+            memcpy(destination, source, numCharacters);
+    }
+
+    static void copyChars(UChar* destination, const LChar* source, unsigned numCharacters)
+    {
+        for (unsigned i = 0; i < numCharacters; ++i)
+            destination[i] = source[i];
+    }
+
     // Returns a StringImpl suitable for use on another thread.
     PassRefPtr<StringImpl> crossThreadString();
     // Makes a deep copy. Helpful only if you need to use a String on another thread
@@ -285,7 +369,13 @@ public:
 
     PassRefPtr<StringImpl> substring(unsigned pos, unsigned len = UINT_MAX);
 
-    UChar operator[](unsigned i) { ASSERT(i < m_length); return m_data[i]; }
+    UChar operator[](unsigned i) const
+    {
+        ASSERT(i < m_length);
+        if (is8Bit())
+            return m_data8[i];
+        return m_data[i];
+    }
     UChar32 characterStartingAt(unsigned);
 
     bool containsOnlyWhitespace();
@@ -348,20 +438,42 @@ private:
     static const unsigned s_copyCharsInlineCutOff = 20;
 
     static PassRefPtr<StringImpl> createStrippingNullCharactersSlowCase(const UChar*, unsigned length);
-    
+
+    const UChar* getData16SlowCase() const;
+
     BufferOwnership bufferOwnership() const { return static_cast<BufferOwnership>(m_refCountAndFlags & s_refCountMaskBufferOwnership); }
     bool isStatic() const { return m_refCountAndFlags & s_refCountFlagStatic; }
-    const UChar* m_data;
+    union {
+        const UChar* m_data;
+        const LChar* m_data8;
+    };
+    // 8-bit strings are only ever BufferInternal or BufferSubstring, so an
+    // internal one keeps its widened copy where an owned buffer would go.
     union {
         void* m_buffer;
         StringImpl* m_substringBuffer;
         SharedUChar* m_sharedBuffer;
+        mutable UChar* m_copyData16;
     };
     mutable unsigned m_hash;
 };
 
+inline bool equal(const LChar* a, const LChar* b, unsigned length) { return !memcmp(a, b, length * sizeof(LChar)); }
+inline bool equal(const UChar* a, const UChar* b, unsigned length) { return !memcmp(a, b, length * sizeof(UChar)); }
+inline bool equal(const LChar* a, const UChar* b, unsigned length)
+{
+    for (unsigned i = 0; i != length; ++i) {
+        if (a[i] != b[i])
+            return false;
+    }
+    return true;
+}
+inline bool equal(const UChar* a, const LChar* b, unsigned length) { return equal(b, a, length); }
+
 bool equal(const StringImpl*, const StringImpl*);
 bool equal(const StringImpl*, const char*);
+bool equal(const StringImpl*, const UChar*, unsigned length);
+bool equal(const StringImpl*, const LChar*, unsigned length);
 inline bool equal(const char* a, StringImpl* b) { return equal(b, a); }
 
 bool equalIgnoringCase(StringImpl*, StringImpl*);
@@ -0,0 +1,253 @@
+/*
+Copyright 2012 Aphid Mobile
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+#ifndef StringSearch_h
+#define StringSearch_h
+
+#include <string.h>
+#include <wtf/NotFound.h>
+#include <wtf/unicode/Unicode.h>
+
+#if CPU(X86_64) || (CPU(X86) && defined(__SSE2__))
+#define STRING_SEARCH_SSE2 1
+#include <emmintrin.h>
+#else
+#define STRING_SEARCH_SSE2 0
+#endif
+
+namespace ATF {
+
+// Searches of 8-bit or 16-bit characters for a character, or for a run of
+// characters of the same width; callers narrow or widen the run first.
+//
+// With SSE2, candidates are found a vector at a time by comparing with both
+// the first and the last character of the run, and only they are compared in
+// full. That is faster than skipping ahead on ordinary text, but text that
+// keeps matching both characters costs a full comparison per character, so a
+// long run switches to Boyer-Moore-Horspool once too many candidates fail.
+// Without SSE2, long runs always use Boyer-Moore-Horspool.
+
+static const unsigned horspoolMinimumMatchLength = 32;
+static const unsigned horspoolMinimumSearchLength = 1024;
+static const unsigned horspoolFailedCandidateAllowance = 64;
+
+#if STRING_SEARCH_SSE2
+
+inline __m128i splatCharacter(LChar character) { return _mm_set1_epi8(static_cast<char>(character)); }
+inline __m128i splatCharacter(UChar character) { return _mm_set1_epi16(static_cast<short>(character)); }
+
+// A bit for each byte of the vector of characters at the given address that
+// is part of a character equal to the splatted one.
+inline unsigned equalCharactersMask(const LChar* characters, __m128i character)
+{
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(characters)), character));
+}
+
+inline unsigned equalCharactersMask(const UChar* characters, __m128i character)
+{
+    return _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(characters)), character));
+}
+
+inline unsigned lowestSetBit(unsigned mask)
+{
+    ASSERT(mask);
+#if COMPILER(GCC)
+    return __builtin_ctz(mask);
+#else
+    unsigned i = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        ++i;
+    }
+    return i;
+#endif
+}
+
+inline unsigned highestSetBit(unsigned mask)
+{
+    ASSERT(mask);
+#if COMPILER(GCC)
+    return 31 - __builtin_clz(mask);
+#else
+    unsigned i = 31;
+    while (!(mask & 0x80000000u)) {
+        mask <<= 1;
+        --i;
+    }
+    return i;
+#endif
+}
+
+#endif // STRING_SEARCH_SSE2
+
+template<typename CharType>
+inline size_t findCharacter(const CharType* characters, unsigned length, CharType match, unsigned start)
+{
+    unsigned i = start;
+#if STRING_SEARCH_SSE2
+    const unsigned charactersPerVector = sizeof(__m128i) / sizeof(CharType);
+    __m128i matchVector = splatCharacter(match);
+    for (; i + charactersPerVector <= length; i += charactersPerVector) {
+        if (unsigned mask = equalCharactersMask(characters + i, matchVector))
+            return i + lowestSetBit(mask) / sizeof(CharType);
+    }
+#endif
+    for (; i < length; ++i) {
+        if (characters[i] == match)
+            return i;
+    }
+    return notFound;
+}
+
+// Finds the last match at or before start, which must be less than length.
+template<typename CharType>
+inline size_t reverseFindCharacter(const CharType* characters, CharType match, unsigned start)
+{
+    unsigned end = start + 1;
+#if STRING_SEARCH_SSE2
+    const unsigned charactersPerVector = sizeof(__m128i) / sizeof(CharType);
+    __m128i matchVector = splatCharacter(match);
+    for (; end >= charactersPerVector; end -= charactersPerVector) {
+        if (unsigned mask = equalCharactersMask(characters + end - charactersPerVector, matchVector))
+            return end - charactersPerVector + highestSetBit(mask) / sizeof(CharType);
+    }
+#endif
+    for (; end; --end) {
+        if (characters[end - 1] == match)
+            return end - 1;
+    }
+    return notFound;
+}
+
+template<typename CharType>
+inline bool equalCharacters(const CharType* a, const CharType* b, unsigned length)
+{
+    return !memcmp(a, b, length * sizeof(CharType));
+}
+
+template<typename CharType>
+inline size_t horspoolFindSubstring(const CharType* characters, unsigned length, const CharType* match, unsigned matchLength, unsigned start)
+{
+    // Characters with the same low byte share a shift, the smallest of theirs.
+    unsigned shifts[256];
+    for (unsigned i = 0; i < 256; ++i)
+        shifts[i] = matchLength;
+    for (unsigned i = 0; i < matchLength - 1; ++i)
+        shifts[match[i] & 0xFF] = matchLength - 1 - i;
+
+    CharType lastMatchCharacter = match[matchLength - 1];
+    unsigned last = length - matchLength;
+    for (unsigned i = start; i <= last; ) {
+        CharType character = characters[i + matchLength - 1];
+        if (character == lastMatchCharacter && equalCharacters(characters + i, match, matchLength - 1))
+            return i;
+        i += shifts[character & 0xFF];
+    }
+    return notFound;
+}
+
+// Finds the first match at or after start. The match must be at least two
+// characters long and no longer than the characters searched.
+template<typename CharType>
+inline size_t findSubstring(const CharType* characters, unsigned length, const CharType* match, unsigned matchLength, unsigned start)
+{
+    ASSERT(matchLength >= 2 && matchLength <= length);
+    unsigned last = length - matchLength;
+    if (start > last)
+        return notFound;
+    bool canUseHorspool = matchLength >= horspoolMinimumMatchLength && length - start >= horspoolMinimumSearchLength;
+#if !STRING_SEARCH_SSE2
+    if (canUseHorspool)
+        return horspoolFindSubstring(characters, length, match, matchLength, start);
+#endif
+
+    CharType firstMatchCharacter = match[0];
+    CharType lastMatchCharacter = match[matchLength - 1];
+    unsigned i = start;
+#if STRING_SEARCH_SSE2
+    const unsigned charactersPerVector = sizeof(__m128i) / sizeof(CharType);
+    const unsigned characterMask = (1 << sizeof(CharType)) - 1;
+    __m128i firstVector = splatCharacter(firstMatchCharacter);
+    __m128i lastVector = splatCharacter(lastMatchCharacter);
+    unsigned failedCandidates = 0;
+    for (; i + charactersPerVector - 1 <= last; i += charactersPerVector) {
+        unsigned mask = equalCharactersMask(characters + i, firstVector) & equalCharactersMask(characters + i + matchLength - 1, lastVector);
+        while (mask) {
+            unsigned bit = lowestSetBit(mask);
+            unsigned candidate = i + bit / sizeof(CharType);
+            if (equalCharacters(characters + candidate + 1, match + 1, matchLength - 2))
+                return candidate;
+            mask &= ~(characterMask << bit);
+            ++failedCandidates;
+        }
+        // More than one failed candidate in every eight characters.
+        if (canUseHorspool && failedCandidates > horspoolFailedCandidateAllowance + (i - start) / 8)
+            return horspoolFindSubstring(characters, length, match, matchLength, i + charactersPerVector);
+    }
+#endif
+    for (; i <= last; ++i) {
+        if (characters[i] == firstMatchCharacter && characters[i + matchLength - 1] == lastMatchCharacter
+            && equalCharacters(characters + i + 1, match + 1, matchLength - 2))
+            return i;
+    }
+    return notFound;
+}
+
+// Finds the last match starting at or before start, which must leave room for
+// the match. The match must be at least two characters long.
+template<typename CharType>
+inline size_t reverseFindSubstring(const CharType* characters, const CharType* match, unsigned matchLength, unsigned start)
+{
+    ASSERT(matchLength >= 2);
+    CharType firstMatchCharacter = match[0];
+    CharType lastMatchCharacter = match[matchLength - 1];
+    unsigned end = start + 1;
+#if STRING_SEARCH_SSE2
+    const unsigned charactersPerVector = sizeof(__m128i) / sizeof(CharType);
+    const unsigned characterMask = (1 << sizeof(CharType)) - 1;
+    __m128i firstVector = splatCharacter(firstMatchCharacter);
+    __m128i lastVector = splatCharacter(lastMatchCharacter);
+    for (; end >= charactersPerVector; end -= charactersPerVector) {
+        unsigned base = end - charactersPerVector;
+        unsigned mask = equalCharactersMask(characters + base, firstVector) & equalCharactersMask(characters + base + matchLength - 1, lastVector);
+        while (mask) {
+            unsigned bit = highestSetBit(mask) / sizeof(CharType) * sizeof(CharType);
+            unsigned candidate = base + bit / sizeof(CharType);
+            if (equalCharacters(characters + candidate + 1, match + 1, matchLength - 2))
+                return candidate;
+            mask &= ~(characterMask << bit);
+        }
+    }
+#endif
+    for (; end; --end) {
+        unsigned i = end - 1;
+        if (characters[i] == firstMatchCharacter && characters[i + matchLength - 1] == lastMatchCharacter
+            && equalCharacters(characters + i + 1, match + 1, matchLength - 2))
+            return i;
+    }
+    return notFound;
+}
+
+} // namespace ATF
+
+using ATF::findCharacter;
+using ATF::findSubstring;
+using ATF::reverseFindCharacter;
+using ATF::reverseFindSubstring;
+
+#endif // StringSearch_h
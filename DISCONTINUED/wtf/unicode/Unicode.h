@@ -57,4 +57,7 @@ limitations under the License.
 
 COMPILE_ASSERT(sizeof(UChar) == 2, UCharIsTwoBytes);
 
+// A Latin-1 code unit, as held by 8-bit strings.
+typedef unsigned char LChar;
+
 #endif // WTF_UNICODE_H